@@ -58,6 +58,122 @@
 		mutex.unlock();                           \
 	}
 
+// Per-thread buffers of the current thread, by queue.
+struct ThreadProducerBuffers {
+	struct Link {
+		uint64_t queue_id = 0;
+		void *buffer = nullptr;
+		void (*release)(void *) = nullptr;
+	};
+	LocalVector<Link> links;
+
+	~ThreadProducerBuffers() {
+		for (const Link &link : links) {
+			link.release(link.buffer);
+		}
+	}
+};
+
+static thread_local ThreadProducerBuffers thread_producer_buffers;
+static SafeNumeric<uint64_t> last_queue_id;
+
+CallQueue::ProducerBuffer *CallQueue::_get_producer_buffer() {
+	for (const ThreadProducerBuffers::Link &link : thread_producer_buffers.links) {
+		if (link.queue_id == id) {
+			return (ProducerBuffer *)link.buffer;
+		}
+	}
+
+	ProducerBuffer *producer = memnew(ProducerBuffer);
+	producer->refcount.init(2);
+	producer->head = memnew(ProducerPage);
+	producer->tail = producer->head;
+	producer_pages.increment();
+	producer_pages_peak.exchange_if_greater(producer_pages.get());
+	{
+		MutexLock lock(producers_mutex);
+		producers.push_back(producer);
+	}
+
+	ThreadProducerBuffers::Link link;
+	link.queue_id = id;
+	link.buffer = producer;
+	link.release = [](void *p_buffer) {
+		// The thread is exiting. The queue frees the buffer once drained, unless it's already gone.
+		ProducerBuffer *buffer = (ProducerBuffer *)p_buffer;
+		if (buffer->refcount.unref()) {
+			memdelete(buffer);
+		}
+	};
+	thread_producer_buffers.links.push_back(link);
+	return producer;
+}
+
+void CallQueue::_release_producer_buffer(ProducerBuffer *p_producer) {
+	ProducerPage *page = p_producer->head;
+	while (page) {
+		ProducerPage *next = page->next.load(std::memory_order_acquire);
+		memdelete(page);
+		producer_pages.decrement();
+		page = next;
+	}
+	p_producer->head = nullptr;
+	p_producer->tail = nullptr;
+	if (p_producer->refcount.unref()) {
+		memdelete(p_producer);
+	}
+}
+
+uint8_t *CallQueue::_reserve(uint32_t p_room_needed, ProducerBuffer *&r_producer) {
+	if (per_thread_buffers && this != MessageQueue::thread_singleton && !Thread::is_main_thread()) {
+		r_producer = _get_producer_buffer();
+		ProducerPage *page = r_producer->tail;
+		uint32_t used = page->bytes.load(std::memory_order_relaxed);
+		if (used + p_room_needed > uint32_t(PAGE_SIZE_BYTES)) {
+			if (producer_pages.increment() > max_pages) {
+				producer_pages.decrement();
+				return nullptr;
+			}
+			producer_pages_peak.exchange_if_greater(producer_pages.get());
+			ProducerPage *new_page = memnew(ProducerPage);
+			page->next.store(new_page, std::memory_order_release);
+			r_producer->tail = new_page;
+			page = new_page;
+			used = 0;
+		}
+		return &page->data[used];
+	}
+
+	r_producer = nullptr;
+	LOCK_MUTEX;
+
+	_ensure_first_page();
+
+	if ((page_bytes[pages_used - 1] + p_room_needed) > uint32_t(PAGE_SIZE_BYTES)) {
+		if (pages_used == max_pages) {
+			UNLOCK_MUTEX;
+			return nullptr;
+		}
+		_add_page();
+	}
+
+	// Keeps the mutex locked until _commit().
+	return &pages[pages_used - 1]->data[page_bytes[pages_used - 1]];
+}
+
+void CallQueue::_commit(uint32_t p_room_needed, ProducerBuffer *p_producer) {
+	if (p_producer) {
+		ProducerPage *page = p_producer->tail;
+		page->bytes.store(page->bytes.load(std::memory_order_relaxed) + p_room_needed, std::memory_order_release);
+		p_producer->pushed.store(p_producer->pushed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		return;
+	}
+
+	page_bytes[pages_used - 1] += p_room_needed;
+	push_count.increment();
+	UNLOCK_MUTEX;
+}
+
 void CallQueue::_add_page() {
 	if (pages_used == page_bytes.size()) {
 		pages.push_back(allocator->alloc());
@@ -88,24 +204,14 @@ Error CallQueue::push_callablep(const Callable &p_callable, const Variant **p_ar
 
 	ERR_FAIL_COND_V_MSG(room_needed > uint32_t(PAGE_SIZE_BYTES), ERR_INVALID_PARAMETER, "Message is too large to fit on a page (" + itos(PAGE_SIZE_BYTES) + " bytes), consider passing less arguments.");
 
-	LOCK_MUTEX;
-
-	_ensure_first_page();
-
-	if ((page_bytes[pages_used - 1] + room_needed) > uint32_t(PAGE_SIZE_BYTES)) {
-		if (pages_used == max_pages) {
-			fprintf(stderr, "Failed method: %s. Message queue out of memory. %s\n", String(p_callable).utf8().get_data(), error_text.utf8().get_data());
-			statistics();
-			UNLOCK_MUTEX;
-			return ERR_OUT_OF_MEMORY;
-		}
-		_add_page();
+	ProducerBuffer *producer = nullptr;
+	uint8_t *buffer_end = _reserve(room_needed, producer);
+	if (!buffer_end) {
+		fprintf(stderr, "Failed method: %s. Message queue out of memory. %s\n", String(p_callable).utf8().get_data(), error_text.utf8().get_data());
+		statistics();
+		return ERR_OUT_OF_MEMORY;
 	}
 
-	Page *page = pages[pages_used - 1];
-
-	uint8_t *buffer_end = &page->data[page_bytes[pages_used - 1]];
-
 	Message *msg = memnew_placement(buffer_end, Message);
 	msg->args = p_argcount;
 	msg->callable = p_callable;
@@ -126,37 +232,26 @@ Error CallQueue::push_callablep(const Callable &p_callable, const Variant **p_ar
 		*v = *p_args[i];
 	}
 
-	page_bytes[pages_used - 1] += room_needed;
-
-	UNLOCK_MUTEX;
+	_commit(room_needed, producer);
 
 	return OK;
 }
 
 Error CallQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
-	LOCK_MUTEX;
 	uint32_t room_needed = sizeof(Message) + sizeof(Variant);
 
-	_ensure_first_page();
-
-	if ((page_bytes[pages_used - 1] + room_needed) > uint32_t(PAGE_SIZE_BYTES)) {
-		if (pages_used == max_pages) {
-			String type;
-			if (ObjectDB::get_instance(p_id)) {
-				type = ObjectDB::get_instance(p_id)->get_class();
-			}
-			fprintf(stderr, "Failed set: %s: %s target ID: %s. Message queue out of memory. %s\n", type.utf8().get_data(), String(p_prop).utf8().get_data(), itos(p_id).utf8().get_data(), error_text.utf8().get_data());
-			statistics();
-
-			UNLOCK_MUTEX;
-			return ERR_OUT_OF_MEMORY;
+	ProducerBuffer *producer = nullptr;
+	uint8_t *buffer_end = _reserve(room_needed, producer);
+	if (!buffer_end) {
+		String type;
+		if (ObjectDB::get_instance(p_id)) {
+			type = ObjectDB::get_instance(p_id)->get_class();
 		}
-		_add_page();
+		fprintf(stderr, "Failed set: %s: %s target ID: %s. Message queue out of memory. %s\n", type.utf8().get_data(), String(p_prop).utf8().get_data(), itos(p_id).utf8().get_data(), error_text.utf8().get_data());
+		statistics();
+		return ERR_OUT_OF_MEMORY;
 	}
 
-	Page *page = pages[pages_used - 1];
-	uint8_t *buffer_end = &page->data[page_bytes[pages_used - 1]];
-
 	Message *msg = memnew_placement(buffer_end, Message);
 	msg->args = 1;
 	msg->callable = Callable(p_id, p_prop);
@@ -167,32 +262,23 @@ Error CallQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant
 	Variant *v = memnew_placement(buffer_end, Variant);
 	*v = p_value;
 
-	page_bytes[pages_used - 1] += room_needed;
-	UNLOCK_MUTEX;
+	_commit(room_needed, producer);
 
 	return OK;
 }
 
 Error CallQueue::push_notification(ObjectID p_id, int p_notification) {
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
-	LOCK_MUTEX;
 	uint32_t room_needed = sizeof(Message);
 
-	_ensure_first_page();
-
-	if ((page_bytes[pages_used - 1] + room_needed) > uint32_t(PAGE_SIZE_BYTES)) {
-		if (pages_used == max_pages) {
-			fprintf(stderr, "Failed notification: %d target ID: %s. Message queue out of memory. %s\n", p_notification, itos(p_id).utf8().get_data(), error_text.utf8().get_data());
-			statistics();
-			UNLOCK_MUTEX;
-			return ERR_OUT_OF_MEMORY;
-		}
-		_add_page();
+	ProducerBuffer *producer = nullptr;
+	uint8_t *buffer_end = _reserve(room_needed, producer);
+	if (!buffer_end) {
+		fprintf(stderr, "Failed notification: %d target ID: %s. Message queue out of memory. %s\n", p_notification, itos(p_id).utf8().get_data(), error_text.utf8().get_data());
+		statistics();
+		return ERR_OUT_OF_MEMORY;
 	}
 
-	Page *page = pages[pages_used - 1];
-	uint8_t *buffer_end = &page->data[page_bytes[pages_used - 1]];
-
 	Message *msg = memnew_placement(buffer_end, Message);
 
 	msg->type = TYPE_NOTIFICATION;
@@ -200,8 +286,7 @@ Error CallQueue::push_notification(ObjectID p_id, int p_notification) {
 	//msg->target;
 	msg->notification = p_notification;
 
-	page_bytes[pages_used - 1] += room_needed;
-	UNLOCK_MUTEX;
+	_commit(room_needed, producer);
 
 	return OK;
 }
@@ -223,15 +308,127 @@ void CallQueue::_call_function(const Callable &p_callable, const Variant *p_args
 	}
 }
 
-Error CallQueue::flush() {
-	LOCK_MUTEX;
+uint32_t CallQueue::_get_message_size(const Message *p_message) {
+	uint32_t size = sizeof(Message);
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		size += sizeof(Variant) * p_message->args;
+	}
+	return size;
+}
 
-	if (pages.size() == 0) {
-		// Never allocated
-		UNLOCK_MUTEX;
-		return OK; // Do nothing.
+void CallQueue::_process_message(Message *p_message) {
+	Object *target = p_message->callable.get_object();
+
+	switch (p_message->type & FLAG_MASK) {
+		case TYPE_CALL: {
+			if (target || (p_message->type & FLAG_NULL_IS_OK)) {
+				Variant *args = (Variant *)(p_message + 1);
+				_call_function(p_message->callable, args, p_message->args, p_message->type & FLAG_SHOW_ERROR);
+			}
+		} break;
+		case TYPE_NOTIFICATION: {
+			if (target) {
+				target->notification(p_message->notification);
+			}
+		} break;
+		case TYPE_SET: {
+			if (target) {
+				Variant *arg = (Variant *)(p_message + 1);
+				target->set(p_message->callable.get_method(), *arg);
+			}
+		} break;
+	}
+
+	_destroy_message(p_message);
+}
+
+void CallQueue::_destroy_message(Message *p_message) {
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int k = 0; k < p_message->args; k++) {
+			args[k].~Variant();
+		}
+	}
+
+	p_message->~Message();
+}
+
+// Runs (or just destroys) the messages published so far in per-thread buffers, returns how many.
+uint32_t CallQueue::_drain_producers(bool p_execute) {
+	{
+		MutexLock lock(producers_mutex);
+		flush_producers = producers;
 	}
 
+	uint32_t count = 0;
+	for (ProducerBuffer *producer : flush_producers) {
+		while (true) {
+			ProducerPage *page = producer->head;
+			if (producer->head_offset < page->bytes.load(std::memory_order_acquire)) {
+				Message *message = (Message *)&page->data[producer->head_offset];
+				// Pre-advance so this function is reentrant.
+				producer->head_offset += _get_message_size(message);
+				if (p_execute) {
+					_process_message(message);
+				} else {
+					_destroy_message(message);
+				}
+				producer->consumed.store(producer->consumed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+				count++;
+				continue;
+			}
+
+			ProducerPage *next = page->next.load(std::memory_order_acquire);
+			if (!next) {
+				break;
+			}
+			// The producer only moves to a new page once done with the previous one, check for a last message.
+			if (producer->head_offset < page->bytes.load(std::memory_order_acquire)) {
+				continue;
+			}
+			producer->head = next;
+			producer->head_offset = 0;
+			memdelete(page);
+			producer_pages.decrement();
+		}
+	}
+
+	// Forget the buffers of exited threads once drained.
+	MutexLock lock(producers_mutex);
+	for (uint32_t i = 0; i < producers.size(); i++) {
+		ProducerBuffer *producer = producers[i];
+		if (producer->refcount.get() == 1 && producer->consumed.load(std::memory_order_acquire) == producer->pushed.load(std::memory_order_acquire)) {
+			producers.remove_at_unordered(i);
+			i--;
+			// Keep its pushes accounted for, so the push total never goes backwards.
+			retired_push_total += producer->pushed.load(std::memory_order_relaxed);
+			_release_producer_buffer(producer);
+		}
+	}
+	flush_producers.clear();
+	return count;
+}
+
+uint64_t CallQueue::_get_total_push_count() const {
+	uint64_t total = push_count.get();
+	MutexLock lock(producers_mutex);
+	total += retired_push_total;
+	for (const ProducerBuffer *producer : producers) {
+		total += producer->pushed.load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+void CallQueue::_update_flush_statistics(uint32_t p_flushed) {
+	uint64_t push_total = _get_total_push_count();
+	last_flush_pushes = push_total - last_flush_push_total;
+	last_flush_push_total = push_total;
+	last_flush_messages = p_flushed;
+}
+
+Error CallQueue::flush() {
+	LOCK_MUTEX;
+
 	if (flushing) {
 		UNLOCK_MUTEX;
 		return ERR_BUSY;
@@ -239,6 +436,22 @@ Error CallQueue::flush() {
 
 	flushing = true;
 
+	// Messages from other threads go first, they were typically pushed before the main thread got to flush.
+	uint32_t flushed = 0;
+	if (producer_pages.get() && Thread::is_main_thread()) {
+		UNLOCK_MUTEX;
+		flushed += _drain_producers(true);
+		LOCK_MUTEX;
+	}
+
+	if (pages.size() == 0) {
+		// Never allocated
+		_update_flush_statistics(flushed);
+		flushing = false;
+		UNLOCK_MUTEX;
+		return OK;
+	}
+
 	uint32_t i = 0;
 	uint32_t offset = 0;
 
@@ -249,46 +462,13 @@ Error CallQueue::flush() {
 
 		Message *message = (Message *)&page->data[offset];
 
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			advance += sizeof(Variant) * message->args;
-		}
-
 		//pre-advance so this function is reentrant
-		offset += advance;
-
-		Object *target = message->callable.get_object();
+		offset += _get_message_size(message);
 
 		UNLOCK_MUTEX;
 
-		switch (message->type & FLAG_MASK) {
-			case TYPE_CALL: {
-				if (target || (message->type & FLAG_NULL_IS_OK)) {
-					Variant *args = (Variant *)(message + 1);
-					_call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
-				}
-			} break;
-			case TYPE_NOTIFICATION: {
-				if (target) {
-					target->notification(message->notification);
-				}
-			} break;
-			case TYPE_SET: {
-				if (target) {
-					Variant *arg = (Variant *)(message + 1);
-					target->set(message->callable.get_method(), *arg);
-				}
-			} break;
-		}
-
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int k = 0; k < message->args; k++) {
-				args[k].~Variant();
-			}
-		}
-
-		message->~Message();
+		_process_message(message);
+		flushed++;
 
 		LOCK_MUTEX;
 		if (offset == page_bytes[i]) {
@@ -300,12 +480,18 @@ Error CallQueue::flush() {
 	page_bytes[0] = 0;
 	pages_used = 1;
 
+	_update_flush_statistics(flushed);
+
 	flushing = false;
 	UNLOCK_MUTEX;
 	return OK;
 }
 
 void CallQueue::clear() {
+	if (producer_pages.get() && Thread::is_main_thread()) {
+		_drain_producers(false);
+	}
+
 	LOCK_MUTEX;
 
 	if (pages.size() == 0) {
@@ -316,27 +502,9 @@ void CallQueue::clear() {
 	for (uint32_t i = 0; i < pages_used; i++) {
 		uint32_t offset = 0;
 		while (offset < page_bytes[i]) {
-			Page *page = pages[i];
-
-			//lock on each iteration, so a call can re-add itself to the message queue
-
-			Message *message = (Message *)&page->data[offset];
-
-			uint32_t advance = sizeof(Message);
-			if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-				advance += sizeof(Variant) * message->args;
-			}
-
-			offset += advance;
-
-			if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-				Variant *args = (Variant *)(message + 1);
-				for (int k = 0; k < message->args; k++) {
-					args[k].~Variant();
-				}
-			}
-
-			message->~Message();
+			Message *message = (Message *)&pages[i]->data[offset];
+			offset += _get_message_size(message);
+			_destroy_message(message);
 		}
 	}
 
@@ -446,6 +614,15 @@ bool CallQueue::is_flushing() const {
 }
 
 bool CallQueue::has_messages() const {
+	if (producer_pages.get()) {
+		MutexLock lock(producers_mutex);
+		for (const ProducerBuffer *producer : producers) {
+			if (producer->consumed.load(std::memory_order_acquire) != producer->pushed.load(std::memory_order_acquire)) {
+				return true;
+			}
+		}
+	}
+
 	if (pages_used == 0) {
 		return false;
 	}
@@ -457,7 +634,24 @@ bool CallQueue::has_messages() const {
 }
 
 int CallQueue::get_max_buffer_usage() const {
-	return pages.size() * PAGE_SIZE_BYTES;
+	return (pages.size() + producer_pages_peak.get()) * PAGE_SIZE_BYTES;
+}
+
+void CallQueue::set_per_thread_buffers_enabled(bool p_enabled) {
+	// Messages already in per-thread buffers are still flushed after disabling.
+	per_thread_buffers = p_enabled;
+}
+
+bool CallQueue::is_per_thread_buffers_enabled() const {
+	return per_thread_buffers;
+}
+
+uint32_t CallQueue::get_last_flush_push_count() const {
+	return last_flush_pushes;
+}
+
+uint32_t CallQueue::get_last_flush_message_count() const {
+	return last_flush_messages;
 }
 
 CallQueue::CallQueue(Allocator *p_custom_allocator, uint32_t p_max_pages, const String &p_error_text) {
@@ -470,6 +664,7 @@ CallQueue::CallQueue(Allocator *p_custom_allocator, uint32_t p_max_pages, const
 	}
 	max_pages = p_max_pages;
 	error_text = p_error_text;
+	id = last_queue_id.increment();
 }
 
 CallQueue::~CallQueue() {
@@ -478,6 +673,13 @@ CallQueue::~CallQueue() {
 	for (uint32_t i = 0; i < pages.size(); i++) {
 		allocator->free(pages[i]);
 	}
+	{
+		MutexLock lock(producers_mutex);
+		for (ProducerBuffer *producer : producers) {
+			_release_producer_buffer(producer);
+		}
+		producers.clear();
+	}
 	if (!allocator_is_custom) {
 		memdelete(allocator);
 	}
@@ -509,6 +711,7 @@ MessageQueue::MessageQueue() :
 				"Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_mb' in project settings.") {
 	ERR_FAIL_COND_MSG(main_singleton != nullptr, "A MessageQueue singleton already exists.");
 	main_singleton = this;
+	set_per_thread_buffers_enabled(GLOBAL_DEF_RST("threading/message_queue/per_thread_buffers", false));
 }
 
 MessageQueue::~MessageQueue() {
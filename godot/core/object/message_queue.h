@@ -35,6 +35,7 @@
 #include "core/os/thread_safe.h"
 #include "core/templates/local_vector.h"
 #include "core/templates/paged_allocator.h"
+#include "core/templates/safe_refcount.h"
 #include "core/variant/variant.h"
 
 class Object;
@@ -77,6 +78,38 @@ private:
 	uint32_t pages_used = 0;
 	bool flushing = false;
 
+	// Per-thread buffers: messages pushed from threads other than the main one are appended,
+	// without locking, to a buffer owned by the pushing thread. The main thread drains them when flushing.
+	struct ProducerPage {
+		uint8_t data[PAGE_SIZE_BYTES]; // First, to keep the same alignment as Page.
+		std::atomic<ProducerPage *> next = nullptr;
+		std::atomic<uint32_t> bytes = 0; // Published once the messages are fully written.
+	};
+
+	struct ProducerBuffer {
+		ProducerPage *head = nullptr; // Read end, main thread only.
+		uint32_t head_offset = 0;
+		ProducerPage *tail = nullptr; // Write end, producer thread only.
+		std::atomic<uint64_t> pushed = 0;
+		std::atomic<uint64_t> consumed = 0;
+		SafeRefCount refcount; // Held by the queue and by the producer thread.
+	};
+
+	uint64_t id = 0; // Identifies the queue in per-thread buffer lookups, as addresses can be reused.
+	bool per_thread_buffers = false;
+	mutable Mutex producers_mutex;
+	LocalVector<ProducerBuffer *> producers;
+	LocalVector<ProducerBuffer *> flush_producers;
+	SafeNumeric<uint32_t> producer_pages;
+	SafeNumeric<uint32_t> producer_pages_peak;
+
+	// Statistics.
+	SafeNumeric<uint64_t> push_count; // Pushes through the shared buffer, per-thread buffers count their own.
+	uint64_t retired_push_total = 0; // Pushes of per-thread buffers already released, guarded by producers_mutex.
+	uint64_t last_flush_push_total = 0;
+	uint32_t last_flush_pushes = 0;
+	uint32_t last_flush_messages = 0;
+
 #ifdef DEV_ENABLED
 	bool is_current_thread_override = false;
 #endif
@@ -100,6 +133,18 @@ private:
 
 	void _add_page();
 
+	ProducerBuffer *_get_producer_buffer();
+	uint8_t *_reserve(uint32_t p_room_needed, ProducerBuffer *&r_producer);
+	void _commit(uint32_t p_room_needed, ProducerBuffer *p_producer);
+	void _release_producer_buffer(ProducerBuffer *p_producer);
+	uint32_t _drain_producers(bool p_execute);
+	uint64_t _get_total_push_count() const;
+	void _update_flush_statistics(uint32_t p_flushed);
+
+	static uint32_t _get_message_size(const Message *p_message);
+	void _process_message(Message *p_message);
+	static void _destroy_message(Message *p_message);
+
 	void _call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error);
 
 	String error_text;
@@ -153,6 +198,14 @@ public:
 	bool is_flushing() const;
 	int get_max_buffer_usage() const;
 
+	// Lets threads other than the main one push without locking, see ProducerBuffer.
+	// Only the main thread may flush the queue then. Ordering is only preserved among the messages pushed by a same thread.
+	void set_per_thread_buffers_enabled(bool p_enabled);
+	bool is_per_thread_buffers_enabled() const;
+
+	uint32_t get_last_flush_push_count() const;
+	uint32_t get_last_flush_message_count() const;
+
 	CallQueue(Allocator *p_custom_allocator = nullptr, uint32_t p_max_pages = 8192, const String &p_error_text = String());
 	virtual ~CallQueue();
 };
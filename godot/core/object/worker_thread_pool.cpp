@@ -37,6 +37,62 @@
 
 WorkerThreadPool::Task *const WorkerThreadPool::ThreadData::YIELDING = (Task *)1;
 
+// How many extra tasks a thread moves at once from the global queue to its own deque, for others to steal.
+static const uint32_t MAX_GLOBAL_QUEUE_BATCH = 8;
+
+bool WorkerThreadPool::TaskDeque::push(Task *p_task) {
+	int64_t b = bottom.load(std::memory_order_relaxed);
+	int64_t t = top.load(std::memory_order_acquire);
+	if (b - t >= CAPACITY) {
+		return false;
+	}
+	buffer[b & (CAPACITY - 1)].store(p_task, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	bottom.store(b + 1, std::memory_order_relaxed);
+	return true;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskDeque::pop() {
+	int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+	if (t > b) {
+		// Empty.
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	Task *task = buffer[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (t == b) {
+		// Last one, race against thieves.
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			task = nullptr;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return task;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskDeque::steal() {
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t b = bottom.load(std::memory_order_acquire);
+	if (t >= b) {
+		return nullptr;
+	}
+	Task *task = buffer[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+		return nullptr; // Lost the race against the owner or another thief.
+	}
+	return task;
+}
+
+bool WorkerThreadPool::TaskDeque::is_empty() const {
+	int64_t t = top.load(std::memory_order_acquire);
+	int64_t b = bottom.load(std::memory_order_acquire);
+	return b <= t;
+}
+
 void WorkerThreadPool::Task::free_template_userdata() {
 	ERR_FAIL_NULL(template_userdata);
 	ERR_FAIL_NULL(native_func_userdata);
@@ -183,7 +239,17 @@ void WorkerThreadPool::_thread_function(void *p_user) {
 
 	while (true) {
 		Task *task_to_process = nullptr;
-		{
+
+		// Lock-free path: the thread's own deque, then stealing from the others.
+		// Skipped while the global queue has tasks, so the ones posted from outside the pool don't starve.
+		if (singleton->work_stealing && singleton->task_queue_count.get() == 0) {
+			task_to_process = thread_data->deque.pop();
+			if (!task_to_process) {
+				task_to_process = singleton->_steal_task(thread_data);
+			}
+		}
+
+		if (!task_to_process) {
 			MutexLock lock(singleton->task_mutex);
 
 			bool exit = singleton->_handle_runlevel(thread_data, lock);
@@ -193,10 +259,8 @@ void WorkerThreadPool::_thread_function(void *p_user) {
 
 			thread_data->signaled = false;
 
-			if (singleton->task_queue.first()) {
-				task_to_process = singleton->task_queue.first()->self();
-				singleton->task_queue.remove(singleton->task_queue.first());
-			} else {
+			task_to_process = singleton->_take_task(thread_data);
+			if (!task_to_process && !singleton->_has_stealable_tasks()) {
 				thread_data->cond_var.wait(lock);
 			}
 		}
@@ -233,7 +297,11 @@ void WorkerThreadPool::_post_tasks(Task **p_tasks, uint32_t p_count, bool p_high
 	for (uint32_t i = 0; i < p_count; i++) {
 		p_tasks[i]->low_priority = !p_high_priority;
 		if (p_high_priority || low_priority_threads_used < max_low_priority_threads) {
-			task_queue.add_last(&p_tasks[i]->task_elem);
+			// Tasks posted from a pool thread go to its own deque, where idle threads can steal them.
+			if (!caller_pool_thread || !work_stealing || !caller_pool_thread->deque.push(p_tasks[i])) {
+				task_queue.add_last(&p_tasks[i]->task_elem);
+				task_queue_count.increment();
+			}
 			if (!p_high_priority) {
 				low_priority_threads_used++;
 			}
@@ -317,6 +385,7 @@ bool WorkerThreadPool::_try_promote_low_priority_task() {
 		Task *low_prio_task = low_priority_task_queue.first()->self();
 		low_priority_task_queue.remove(low_priority_task_queue.first());
 		task_queue.add_last(&low_prio_task->task_elem);
+		task_queue_count.increment();
 		low_priority_threads_used++;
 		return true;
 	} else {
@@ -324,6 +393,60 @@ bool WorkerThreadPool::_try_promote_low_priority_task() {
 	}
 }
 
+WorkerThreadPool::Task *WorkerThreadPool::_take_task(ThreadData *p_thread_data) {
+	if (task_queue.first()) {
+		Task *task = task_queue.first()->self();
+		task_queue.remove(task_queue.first());
+		task_queue_count.decrement();
+
+		if (work_stealing) {
+			// Take a share of the backlog along, so other threads can get it without locking.
+			uint32_t batch = MIN(task_queue_count.get() / threads.size(), MAX_GLOBAL_QUEUE_BATCH);
+			for (uint32_t i = 0; i < batch; i++) {
+				Task *extra = task_queue.first()->self();
+				if (!p_thread_data->deque.push(extra)) {
+					break;
+				}
+				task_queue.remove(task_queue.first());
+				task_queue_count.decrement();
+			}
+		}
+		return task;
+	}
+
+	if (!work_stealing) {
+		return nullptr;
+	}
+	Task *task = p_thread_data->deque.pop();
+	if (!task) {
+		task = _steal_task(p_thread_data);
+	}
+	return task;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_steal_task(ThreadData *p_thread_data) {
+	uint32_t thread_count = threads.size();
+	for (uint32_t i = 1; i < thread_count; i++) {
+		Task *task = threads[(p_thread_data->index + i) % thread_count].deque.steal();
+		if (task) {
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+bool WorkerThreadPool::_has_stealable_tasks() const {
+	if (!work_stealing) {
+		return false;
+	}
+	for (const ThreadData &th : threads) {
+		if (!th.deque.is_empty()) {
+			return true;
+		}
+	}
+	return false;
+}
+
 WorkerThreadPool::TaskID WorkerThreadPool::add_native_task(void (*p_func)(void *), void *p_userdata, bool p_high_priority, const String &p_description) {
 	return _add_task(Callable(), p_func, p_userdata, nullptr, p_high_priority, p_description);
 }
@@ -452,6 +575,16 @@ void WorkerThreadPool::_wait_collaboratively(ThreadData *p_caller_pool_thread, T
 	while (true) {
 		Task *task_to_process = nullptr;
 		bool relock_unlockables = false;
+
+		// Tasks this thread posted itself (typically what it's awaiting) can be run without locking.
+		if (work_stealing && task_queue_count.get() == 0) {
+			task_to_process = p_caller_pool_thread->deque.pop();
+			if (task_to_process) {
+				_process_task(task_to_process);
+				continue;
+			}
+		}
+
 		{
 			MutexLock lock(task_mutex);
 
@@ -479,7 +612,7 @@ void WorkerThreadPool::_wait_collaboratively(ThreadData *p_caller_pool_thread, T
 				if (was_signaled) {
 					// This thread was awaken for some additional reason, but it's about to exit.
 					// Let's find out what may be pending and forward the requests.
-					uint32_t to_process = task_queue.first() ? 1 : 0;
+					uint32_t to_process = task_queue.first() || !p_caller_pool_thread->deque.is_empty() ? 1 : 0;
 					uint32_t to_promote = p_caller_pool_thread->current_task->low_priority && low_priority_task_queue.first() ? 1 : 0;
 					if (to_process || to_promote) {
 						// This thread must be left alone since it won't loop again.
@@ -497,12 +630,9 @@ void WorkerThreadPool::_wait_collaboratively(ThreadData *p_caller_pool_thread, T
 				}
 			}
 
-			if (singleton->task_queue.first()) {
-				task_to_process = task_queue.first()->self();
-				task_queue.remove(task_queue.first());
-			}
+			task_to_process = _take_task(p_caller_pool_thread);
 
-			if (!task_to_process) {
+			if (!task_to_process && !_has_stealable_tasks()) {
 				p_caller_pool_thread->awaited_task = p_task;
 
 				_unlock_unlockable_mutexes();
@@ -543,7 +673,7 @@ bool WorkerThreadPool::_handle_runlevel(ThreadData *p_thread_data, MutexLock<Bin
 		} break;
 		case RUNLEVEL_PRE_EXIT_LANGUAGES: {
 			if (!p_thread_data->pre_exited_languages) {
-				if (!task_queue.first() && !low_priority_task_queue.first()) {
+				if (!task_queue.first() && !low_priority_task_queue.first() && !_has_stealable_tasks()) {
 					p_thread_data->pre_exited_languages = true;
 					runlevel_data.pre_exit_languages.num_idle_threads++;
 					control_cond_var.notify_all();
@@ -749,10 +879,12 @@ void WorkerThreadPool::thread_exit_unlock_allowance_zone(uint32_t p_zone_id) {
 }
 #endif
 
-void WorkerThreadPool::init(int p_thread_count, float p_low_priority_task_ratio) {
+void WorkerThreadPool::init(int p_thread_count, float p_low_priority_task_ratio, bool p_work_stealing) {
 	ERR_FAIL_COND(threads.size() > 0);
 
 	runlevel = RUNLEVEL_NORMAL;
+	work_stealing = p_work_stealing;
+	notify_index = 0;
 
 	if (p_thread_count < 0) {
 		p_thread_count = OS::get_singleton()->get_default_thread_pool_size();
@@ -760,7 +892,7 @@ void WorkerThreadPool::init(int p_thread_count, float p_low_priority_task_ratio)
 
 	max_low_priority_threads = CLAMP(p_thread_count * p_low_priority_task_ratio, 1, p_thread_count - 1);
 
-	print_verbose(vformat("WorkerThreadPool: %d threads, %d max low-priority.", p_thread_count, max_low_priority_threads));
+	print_verbose(vformat("WorkerThreadPool: %d threads, %d max low-priority, work stealing %s.", p_thread_count, max_low_priority_threads, work_stealing ? "enabled" : "disabled"));
 
 	threads.resize(p_thread_count);
 
@@ -819,6 +951,7 @@ void WorkerThreadPool::finish() {
 	}
 
 	threads.clear();
+	thread_ids.clear();
 }
 
 void WorkerThreadPool::_bind_methods() {
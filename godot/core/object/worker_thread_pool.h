@@ -106,6 +106,22 @@ private:
 	SelfList<Task>::List task_queue;
 
 	BinaryMutex task_mutex;
+	SafeNumeric<uint32_t> task_queue_count; // Size of task_queue, readable without locking.
+
+	// Chase-Lev work-stealing deque. Only the owner thread pushes and pops (LIFO), other threads steal (FIFO).
+	// Pushes still happen with task_mutex locked, so a thread about to sleep can't miss them.
+	struct TaskDeque {
+		static const int64_t CAPACITY = 256; // Power of 2. When full, tasks go to the global queue instead.
+
+		std::atomic<int64_t> top = 0;
+		std::atomic<int64_t> bottom = 0;
+		std::atomic<Task *> buffer[CAPACITY] = {};
+
+		bool push(Task *p_task);
+		Task *pop();
+		Task *steal();
+		bool is_empty() const;
+	};
 
 	struct ThreadData {
 		static Task *const YIELDING; // Too bad constexpr doesn't work here.
@@ -119,6 +135,7 @@ private:
 		Task *current_task = nullptr;
 		Task *awaited_task = nullptr; // Null if not awaiting the condition variable, or special value (YIELDING).
 		ConditionVariable cond_var;
+		TaskDeque deque;
 
 		ThreadData() :
 				signaled(false),
@@ -163,6 +180,7 @@ private:
 	uint32_t max_low_priority_threads = 0;
 	uint32_t low_priority_threads_used = 0;
 	uint32_t notify_index = 0; // For rotating across threads, no help distributing load.
+	bool work_stealing = false;
 
 	uint64_t last_task = 1;
 
@@ -175,6 +193,10 @@ private:
 
 	bool _try_promote_low_priority_task();
 
+	Task *_take_task(ThreadData *p_thread_data);
+	Task *_steal_task(ThreadData *p_thread_data);
+	bool _has_stealable_tasks() const;
+
 	static WorkerThreadPool *singleton;
 
 #ifdef THREADS_ENABLED
@@ -282,7 +304,7 @@ public:
 	static void thread_exit_unlock_allowance_zone(uint32_t p_zone_id) {}
 #endif
 
-	void init(int p_thread_count = -1, float p_low_priority_task_ratio = 0.3);
+	void init(int p_thread_count = -1, float p_low_priority_task_ratio = 0.3, bool p_work_stealing = false);
 	void exit_languages_threads();
 	void finish();
 	WorkerThreadPool();
@@ -14,6 +14,8 @@ def get_doc_classes():
         "Multigoal",
         "Domain",
         "Plan",
+        "PlannerState",
+        "PlanRequest",
     ]
 
 
@@ -32,12 +32,16 @@
 
 #include "modules/goal_task_planner/multigoal.h"
 #include "modules/goal_task_planner/plan.h"
+#include "modules/goal_task_planner/planner_state.h"
 
 void Domain::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("add_multigoal_methods", "methods"), &Domain::add_multigoal_methods);
 	ClassDB::bind_method(D_METHOD("add_unigoal_methods", "task_name", "methods"), &Domain::add_unigoal_methods);
 	ClassDB::bind_method(D_METHOD("add_task_methods", "task_name", "methods"), &Domain::add_task_methods);
 	ClassDB::bind_method(D_METHOD("add_actions", "actions"), &Domain::add_actions);
+	ClassDB::bind_method(D_METHOD("declare_state_variable", "name", "subjects", "type"), &Domain::declare_state_variable, DEFVAL(Variant::NIL));
+	ClassDB::bind_method(D_METHOD("has_state_variables"), &Domain::has_state_variables);
+	ClassDB::bind_method(D_METHOD("create_state", "state"), &Domain::create_state);
 
 	ClassDB::bind_static_method("Domain", D_METHOD("method_verify_goal", "state", "method", "state_var", "arguments", "desired_values", "depth", "verbose"), &Domain::method_verify_goal);
 
@@ -130,3 +134,41 @@ void Domain::add_actions(TypedArray<Callable> p_actions) {
 		action_dictionary[method_name] = action;
 	}
 }
+
+void Domain::declare_state_variable(const StringName &p_name, const Array &p_subjects, Variant::Type p_type) {
+	ERR_FAIL_COND_MSG(state_variable_indices.has(p_name), vformat("State variable \"%s\" is already declared.", p_name));
+
+	StateVariable variable;
+	variable.name = p_name;
+	variable.type = p_type;
+	variable.offset = state_slot_types.size();
+	variable.subjects = p_subjects.duplicate();
+	for (int32_t i = 0; i < p_subjects.size(); i++) {
+		ERR_FAIL_COND_MSG(variable.subject_indices.has(p_subjects[i]), vformat("Subject \"%s\" is declared twice in state variable \"%s\".", p_subjects[i], p_name));
+		variable.subject_indices.insert(p_subjects[i], variable.offset + i);
+	}
+	for (int32_t i = 0; i < p_subjects.size(); i++) {
+		state_slot_types.push_back(p_type);
+	}
+
+	state_variable_indices.insert(p_name, state_variables.size());
+	state_variables.push_back(variable);
+}
+
+Ref<PlannerState> Domain::create_state(const Dictionary &p_state) {
+	Ref<PlannerState> state;
+	state.instantiate();
+	state->setup(this, p_state);
+	return state;
+}
+
+int32_t Domain::find_state_variable(const Variant &p_name) const {
+	const int32_t *index = state_variable_indices.getptr(p_name);
+	return index ? *index : -1;
+}
+
+int32_t Domain::find_state_slot(int32_t p_variable_index, const Variant &p_subject) const {
+	ERR_FAIL_INDEX_V(p_variable_index, (int32_t)state_variables.size(), -1);
+	const int32_t *slot = state_variables[p_variable_index].subject_indices.getptr(p_subject);
+	return slot ? *slot : -1;
+}
@@ -37,9 +37,12 @@
 
 #include "multigoal.h"
 
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "core/variant/typed_array.h"
 
 class Plan;
+class PlannerState;
 class Domain : public Resource {
 	GDCLASS(Domain, Resource);
 
@@ -49,6 +52,18 @@ private:
 	Dictionary unigoal_method_dictionary;
 	TypedArray<Callable> multigoal_method_list;
 
+	// Declared state variables, used by compiled planning.
+	struct StateVariable {
+		StringName name;
+		Variant::Type type = Variant::NIL;
+		int32_t offset = 0;
+		Array subjects;
+		HashMap<Variant, int32_t, VariantHasher, StringLikeVariantComparator> subject_indices;
+	};
+	LocalVector<StateVariable> state_variables;
+	HashMap<Variant, int32_t, VariantHasher, StringLikeVariantComparator> state_variable_indices;
+	LocalVector<Variant::Type> state_slot_types;
+
 public:
 	Domain();
 	void set_actions(Dictionary p_value) { action_dictionary = p_value; }
@@ -67,6 +82,19 @@ public:
 	void add_unigoal_methods(String p_task_name, TypedArray<Callable> p_methods);
 	void add_multigoal_methods(TypedArray<Callable> p_methods);
 
+	void declare_state_variable(const StringName &p_name, const Array &p_subjects, Variant::Type p_type = Variant::NIL);
+	bool has_state_variables() const { return !state_variables.is_empty(); }
+	Ref<PlannerState> create_state(const Dictionary &p_state);
+
+	int32_t get_state_variable_count() const { return state_variables.size(); }
+	int32_t find_state_variable(const Variant &p_name) const;
+	int32_t find_state_slot(int32_t p_variable_index, const Variant &p_subject) const;
+	StringName get_state_variable_name(int32_t p_variable_index) const { return state_variables[p_variable_index].name; }
+	Array get_state_variable_subjects(int32_t p_variable_index) const { return state_variables[p_variable_index].subjects; }
+	int32_t get_state_variable_offset(int32_t p_variable_index) const { return state_variables[p_variable_index].offset; }
+	int32_t get_state_slot_count() const { return state_slot_types.size(); }
+	Variant::Type get_state_slot_type(int32_t p_slot) const { return state_slot_types[p_slot]; }
+
 public:
 	static Variant method_verify_goal(Dictionary p_state, String p_method, String p_state_var, String p_arguments, Variant p_desired_values, int p_depth, int verbose);
 
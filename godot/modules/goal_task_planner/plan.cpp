@@ -30,11 +30,20 @@
 
 #include "plan.h"
 
+#include "core/os/os.h"
 #include "core/variant/callable.h"
 #include "core/variant/typed_array.h"
 
 #include "modules/goal_task_planner/domain.h"
 #include "modules/goal_task_planner/multigoal.h"
+#include "modules/goal_task_planner/plan_request.h"
+#include "modules/goal_task_planner/planner_state.h"
+
+// First depth bound of iterative deepening, doubled after every search cut off by the bound.
+static const int ITERATIVE_DEEPENING_START_DEPTH = 16;
+// Last depth bound of iterative deepening when max_depth is unbounded, so cyclic domains
+// stop deepening instead of overflowing the bound (and then the native stack).
+static const int ITERATIVE_DEEPENING_MAX_DEPTH = 1024;
 
 int Plan::get_verbose() const { return verbose; }
 
@@ -251,7 +260,12 @@ Variant Plan::find_plan(Dictionary p_state, Array p_todo_list) {
 		print_line("    state = " + _item_to_string(p_state) + "\n    todo_list = " + _item_to_string(p_todo_list));
 	}
 
-	Variant result = _seek_plan(p_state, p_todo_list, Array(), 0);
+	Variant result;
+	if (current_domain.is_valid() && current_domain->has_state_variables()) {
+		result = _find_plan_compiled(current_domain->create_state(p_state), p_todo_list);
+	} else {
+		result = _find_plan_dictionary(p_state, p_todo_list);
+	}
 
 	if (verbose >= 1) {
 		print_line("result = " + _item_to_string(result));
@@ -260,7 +274,244 @@ Variant Plan::find_plan(Dictionary p_state, Array p_todo_list) {
 	return result;
 }
 
+Variant Plan::find_plan_from_state(Ref<PlannerState> p_state, Array p_todo_list) {
+	ERR_FAIL_COND_V(p_state.is_null(), false);
+	ERR_FAIL_COND_V_MSG(current_domain.is_null() || p_state->get_domain() != current_domain, false, "The state must be created by the current domain.");
+	return _find_plan_compiled(p_state, p_todo_list);
+}
+
+void Plan::set_parallel_refinement(bool p_enabled) {
+	parallel_refinement = p_enabled;
+}
+
+bool Plan::get_parallel_refinement() const {
+	return parallel_refinement;
+}
+
+Ref<PlanRequest> Plan::find_plan_async(Dictionary p_state, Array p_todo_list, int p_timeout_msec) {
+	Ref<PlanRequest> request;
+	request.instantiate();
+	if (current_domain.is_null()) {
+		request->status.set(PlanRequest::STATUS_FAILED);
+		ERR_FAIL_V_MSG(request, "A current domain is required to find a plan.");
+	}
+
+	// The search runs on a private planner and state, so this planner and the caller's
+	// state can be used or modified while the request is running.
+	Ref<Plan> planner = _make_search_copy();
+	request->planner = planner;
+	request->state = p_state.duplicate(true);
+	request->todo_list = p_todo_list.duplicate(true);
+
+	if (parallel_refinement && !p_todo_list.is_empty() && p_todo_list[0].is_array()) {
+		const Array first_task = p_todo_list[0];
+		const Dictionary task_methods = current_domain->get_task_methods();
+		if (!first_task.is_empty() && task_methods.has(first_task[0])) {
+			const Array methods = task_methods[first_task[0]];
+			if (methods.size() > 1) {
+				request->branch_methods = methods;
+			}
+		}
+	}
+
+	const int branch_count = request->get_branch_count();
+	request->start_usec = OS::get_singleton()->get_ticks_usec();
+	request->deadline_usec = p_timeout_msec > 0 ? request->start_usec + uint64_t(p_timeout_msec) * 1000 : 0;
+	request->pending_branches.set(branch_count);
+	request->group_id = WorkerThreadPool::get_singleton()->add_template_group_task(planner.ptr(), &Plan::_run_async_branch, request.ptr(), branch_count, -1, false, SNAME("Plan::find_plan_async"));
+	return request;
+}
+
+Ref<Plan> Plan::_make_search_copy() const {
+	Ref<Plan> planner;
+	planner.instantiate();
+	planner->verbose = verbose;
+	planner->verify_goals = verify_goals;
+	planner->domains = domains;
+	planner->current_domain = current_domain;
+	planner->transposition_table_enabled = transposition_table_enabled;
+	planner->transposition_table_size = transposition_table_size;
+	planner->max_depth = max_depth;
+	planner->iterative_deepening = iterative_deepening;
+	return planner;
+}
+
+void Plan::_run_async_branch(uint32_t p_branch, PlanRequest *p_request) {
+	// Every branch searches with its own planner, the search bounds and the
+	// transposition table are not shared between threads.
+	const Ref<Plan> planner = _make_search_copy();
+	planner->search_request = p_request;
+	const bool compiled = current_domain->has_state_variables();
+	Ref<PlannerState> planner_state;
+	Variant state;
+	if (compiled) {
+		planner_state = current_domain->create_state(p_request->state);
+		state = planner_state;
+	} else {
+		state = p_request->state.duplicate(true);
+	}
+
+	Array todo_list = p_request->todo_list;
+	if (!p_request->branch_methods.is_empty()) {
+		// The branch commits to one method of the first task, the same step as one
+		// iteration of _refine_task_and_continue, and searches the rest sequentially.
+		const Array first_task = todo_list[0];
+		const Callable method = p_request->branch_methods[p_branch];
+		if (verbose >= 2) {
+			print_line("Branch " + itos(p_branch) + ", Trying method: " + _item_to_string(method));
+		}
+		const int checkpoint = compiled ? planner_state->get_checkpoint() : 0;
+		Variant subtasks;
+		const bool called = _call_with_state(method, state, first_task, subtasks);
+		if (compiled) {
+			// Methods only inspect the state, drop anything they wrote, as _refine_task_compiled does.
+			planner_state->rollback(checkpoint);
+		}
+		if (!called || !subtasks.is_array()) {
+			p_request->_finish_branch(false);
+			return;
+		}
+		Array branch_todo_list = Array(subtasks).duplicate();
+		branch_todo_list.append_array(todo_list.slice(1));
+		todo_list = branch_todo_list;
+	}
+
+	Variant plan;
+	if (compiled) {
+		plan = planner->_find_plan_compiled(planner_state, todo_list);
+	} else {
+		plan = planner->_find_plan_dictionary(state, todo_list);
+	}
+	p_request->_finish_branch(plan);
+}
+
+void Plan::set_transposition_table_enabled(bool p_enabled) {
+	transposition_table_enabled = p_enabled;
+	if (!p_enabled) {
+		transposition_table.clear();
+	}
+}
+
+bool Plan::is_transposition_table_enabled() const {
+	return transposition_table_enabled;
+}
+
+void Plan::set_transposition_table_size(int p_size) {
+	ERR_FAIL_COND(p_size < 1);
+	transposition_table_size = p_size;
+}
+
+int Plan::get_transposition_table_size() const {
+	return transposition_table_size;
+}
+
+void Plan::set_max_depth(int p_depth) {
+	ERR_FAIL_COND(p_depth < 0);
+	max_depth = p_depth;
+}
+
+int Plan::get_max_depth() const {
+	return max_depth;
+}
+
+void Plan::set_iterative_deepening(bool p_enabled) {
+	iterative_deepening = p_enabled;
+}
+
+bool Plan::is_iterative_deepening() const {
+	return iterative_deepening;
+}
+
+Dictionary Plan::get_search_stats() const {
+	Dictionary stats;
+	stats["transposition_hits"] = transposition_hits;
+	stats["transposition_misses"] = transposition_misses;
+	stats["transposition_evictions"] = transposition_evictions;
+	stats["transposition_entries"] = transposition_table.size();
+	const uint64_t lookups = transposition_hits + transposition_misses;
+	stats["transposition_hit_rate"] = lookups > 0 ? double(transposition_hits) / double(lookups) : 0.0;
+	stats["deepening_iterations"] = deepening_iterations;
+	return stats;
+}
+
+void Plan::reset_search_stats() {
+	transposition_hits = 0;
+	transposition_misses = 0;
+	transposition_evictions = 0;
+	deepening_iterations = 0;
+}
+
+Plan::TranspositionKey Plan::_make_transposition_key(const Variant &p_state, const Array &p_todo_list) {
+	TranspositionKey key;
+	key.state = p_state;
+	key.todo_list = p_todo_list;
+	key.hash = hash_murmur3_one_32(p_todo_list.recursive_hash(0), p_state.recursive_hash(0));
+	return key;
+}
+
+const Plan::TranspositionEntry *Plan::_find_transposition(const TranspositionKey &p_key) {
+	const TranspositionEntry *entry = transposition_table.getptr(p_key);
+	if (entry) {
+		transposition_hits++;
+	} else {
+		transposition_misses++;
+	}
+	return entry;
+}
+
+void Plan::_store_transposition(const TranspositionKey &p_key, bool p_failed, const Array &p_plan_suffix) {
+	if (transposition_table.size() >= uint32_t(transposition_table_size)) {
+		// The table iterates in insertion order, so this evicts the oldest entry.
+		transposition_table.remove(transposition_table.begin());
+		transposition_evictions++;
+	}
+	TranspositionEntry entry;
+	entry.failed = p_failed;
+	entry.plan_suffix = p_plan_suffix;
+	transposition_table.insert(p_key, entry);
+}
+
+void Plan::_begin_search() {
+	transposition_table.clear();
+	search_depth_limit = 0;
+	search_depth_cutoffs = 0;
+}
+
+bool Plan::_is_search_cut_off(int p_depth, int p_depth_limit, uint64_t &r_cutoffs) {
+	if ((search_request && search_request->_should_stop()) || (p_depth_limit > 0 && p_depth > p_depth_limit)) {
+		r_cutoffs++;
+		return true;
+	}
+	return false;
+}
+
+Variant Plan::_find_plan_dictionary(const Dictionary &p_state, const Array &p_todo_list) {
+	_begin_search();
+	int depth_limit = iterative_deepening ? ITERATIVE_DEEPENING_START_DEPTH : max_depth;
+	while (true) {
+		if (max_depth > 0 && (depth_limit == 0 || depth_limit > max_depth)) {
+			depth_limit = max_depth;
+		}
+		search_depth_limit = depth_limit;
+		search_depth_cutoffs = 0;
+		deepening_iterations++;
+		const Variant plan = _seek_plan(p_state, p_todo_list, Array(), 0);
+		if (plan.is_array() || !iterative_deepening || search_depth_cutoffs == 0 || depth_limit == max_depth || (max_depth == 0 && depth_limit >= ITERATIVE_DEEPENING_MAX_DEPTH) || (search_request && search_request->_should_stop())) {
+			return plan;
+		}
+		const int next_depth_limit = depth_limit > INT_MAX / 2 ? INT_MAX : depth_limit * 2;
+		if (verbose >= 1) {
+			print_line(vformat("Iterative deepening: no plan within depth %d, retrying with depth %d.", depth_limit, next_depth_limit));
+		}
+		depth_limit = next_depth_limit;
+	}
+}
+
 Variant Plan::_seek_plan(Dictionary p_state, Array p_todo_list, Array p_plan, int p_depth) {
+	if (_is_search_cut_off(p_depth, search_depth_limit, search_depth_cutoffs)) {
+		return false;
+	}
+
 	if (verbose >= 2) {
 		print_line("Depth: " + itos(p_depth) + ", Todo List: " + _item_to_string(p_todo_list));
 	}
@@ -271,6 +522,36 @@ Variant Plan::_seek_plan(Dictionary p_state, Array p_todo_list, Array p_plan, in
 		}
 		return p_plan;
 	}
+	if (!transposition_table_enabled) {
+		return _expand_todo_item(p_state, p_todo_list, p_plan, p_depth);
+	}
+
+	TranspositionKey key = _make_transposition_key(p_state, p_todo_list);
+	const TranspositionEntry *entry = _find_transposition(key);
+	if (entry) {
+		if (entry->failed) {
+			return false;
+		}
+		Array plan = p_plan.duplicate();
+		plan.append_array(entry->plan_suffix);
+		return plan;
+	}
+
+	// Actions may modify the state in place, so the key keeps the state it was reached with.
+	key.state = p_state.duplicate(true);
+	key.todo_list = p_todo_list.duplicate();
+	const int plan_size = p_plan.size();
+	const uint64_t cutoffs = search_depth_cutoffs;
+	const Variant plan = _expand_todo_item(p_state, p_todo_list, p_plan, p_depth);
+	if (plan.is_array()) {
+		_store_transposition(key, false, Array(plan).slice(plan_size));
+	} else if (cutoffs == search_depth_cutoffs) {
+		_store_transposition(key, true, Array());
+	}
+	return plan;
+}
+
+Variant Plan::_expand_todo_item(Dictionary p_state, Array p_todo_list, Array p_plan, int p_depth) {
 	Variant todo_item = p_todo_list.front();
 	p_todo_list = p_todo_list.slice(1);
 	if (Object::cast_to<Multigoal>(todo_item)) {
@@ -303,6 +584,10 @@ Dictionary Plan::run_lazy_lookahead(Dictionary p_state, Array p_todo_list, int p
 		print_line(vformat("To do: %s", p_todo_list));
 	}
 
+	if (current_domain.is_valid() && current_domain->has_state_variables()) {
+		return _run_lazy_lookahead_compiled(p_state, p_todo_list, p_max_tries);
+	}
+
 	Dictionary ordinals;
 	ordinals[1] = "st";
 	ordinals[2] = "nd";
@@ -397,6 +682,424 @@ Variant Plan::_apply_task_and_continue(Dictionary p_state, Callable p_command, A
 	return next_state;
 }
 
+String Plan::_get_undeclared_goals_compiled(const PlannerState *p_state, const Ref<Multigoal> &p_goal) {
+	PackedStringArray undeclared;
+	const Dictionary goal_state = p_goal->get_state();
+	for (const Variant &state_variable_name : goal_state.keys()) {
+		const Variant &goal_values = goal_state[state_variable_name];
+		if (goal_values.get_type() != Variant::DICTIONARY) {
+			continue;
+		}
+		const Dictionary subjects = goal_values;
+		for (const Variant &subject : subjects.keys()) {
+			if (p_state->find_slot(state_variable_name, subject) < 0) {
+				undeclared.push_back(vformat("\"%s\" for \"%s\"", state_variable_name, subject));
+			}
+		}
+	}
+	return String(", ").join(undeclared);
+}
+
+Variant Plan::_find_plan_compiled(const Ref<PlannerState> &p_state, const Array &p_todo_list) {
+	ERR_FAIL_COND_V(p_state.is_null() || current_domain.is_null(), false);
+
+	// Goals on undeclared variables can never be achieved by an action, report them once here
+	// instead of at every expansion of the multigoal.
+	for (int i = 0; i < p_todo_list.size(); i++) {
+		const Ref<Multigoal> goal = p_todo_list[i];
+		if (goal.is_null()) {
+			continue;
+		}
+		const String undeclared = _get_undeclared_goals_compiled(p_state.ptr(), goal);
+		ERR_FAIL_COND_V_MSG(!undeclared.is_empty(), false, vformat("Multigoal refers to %s, which are not declared state variables of the domain.", undeclared));
+	}
+
+	CompiledSearch search;
+	search.state = p_state.ptr();
+	search.state_variant = p_state;
+	search.actions = current_domain->get_actions();
+	search.task_methods = current_domain->get_task_methods();
+	search.unigoal_methods = current_domain->get_unigoal_methods();
+	search.multigoal_methods = current_domain->get_multigoal_methods();
+	search.todo_stack.reserve(p_todo_list.size());
+	for (int i = p_todo_list.size() - 1; i >= 0; i--) {
+		search.todo_stack.push_back(p_todo_list[i]);
+	}
+
+	_begin_search();
+	const int checkpoint = p_state->get_checkpoint();
+	int depth_limit = iterative_deepening ? ITERATIVE_DEEPENING_START_DEPTH : max_depth;
+	bool found = false;
+	while (true) {
+		if (max_depth > 0 && (depth_limit == 0 || depth_limit > max_depth)) {
+			depth_limit = max_depth;
+		}
+		search.depth_limit = depth_limit;
+		search.depth_cutoffs = 0;
+		deepening_iterations++;
+		found = _seek_plan_compiled(search, 0);
+		// The state is handed back unchanged, applying the plan is up to the caller.
+		p_state->rollback(checkpoint);
+		if (found || !iterative_deepening || search.depth_cutoffs == 0 || depth_limit == max_depth || (max_depth == 0 && depth_limit >= ITERATIVE_DEEPENING_MAX_DEPTH) || (search_request && search_request->_should_stop())) {
+			break;
+		}
+		const int next_depth_limit = depth_limit > INT_MAX / 2 ? INT_MAX : depth_limit * 2;
+		if (verbose >= 1) {
+			print_line(vformat("Iterative deepening: no plan within depth %d, retrying with depth %d.", depth_limit, next_depth_limit));
+		}
+		depth_limit = next_depth_limit;
+	}
+	if (!found) {
+		return false;
+	}
+
+	Array plan;
+	plan.resize(search.plan.size());
+	for (uint32_t i = 0; i < search.plan.size(); i++) {
+		plan[i] = search.plan[i];
+	}
+	return plan;
+}
+
+bool Plan::_seek_plan_compiled(CompiledSearch &p_search, int p_depth) {
+	if (_is_search_cut_off(p_depth, p_search.depth_limit, p_search.depth_cutoffs)) {
+		return false;
+	}
+
+	if (p_search.todo_stack.is_empty()) {
+		if (verbose >= 3) {
+			print_line("Depth: " + itos(p_depth) + " no more tasks or goals, return plan.");
+		}
+		return true;
+	}
+	if (!transposition_table_enabled) {
+		return _expand_todo_item_compiled(p_search, p_depth);
+	}
+
+	// Slot values and the todo list in execution order, the same key a Dictionary search uses.
+	const PlannerState *state = p_search.state;
+	Array state_values;
+	state_values.resize(state->get_slot_count());
+	for (int32_t i = 0; i < state->get_slot_count(); i++) {
+		state_values[i] = state->get_slot(i);
+	}
+	Array todo_list;
+	todo_list.resize(p_search.todo_stack.size());
+	for (uint32_t i = 0; i < p_search.todo_stack.size(); i++) {
+		todo_list[i] = p_search.todo_stack[p_search.todo_stack.size() - 1 - i];
+	}
+
+	const TranspositionKey key = _make_transposition_key(state_values, todo_list);
+	const TranspositionEntry *entry = _find_transposition(key);
+	if (entry) {
+		if (entry->failed) {
+			return false;
+		}
+		// A found plan ends the search, the todo list and the state are not needed anymore.
+		for (int i = 0; i < entry->plan_suffix.size(); i++) {
+			p_search.plan.push_back(entry->plan_suffix[i]);
+		}
+		return true;
+	}
+
+	const uint32_t plan_size = p_search.plan.size();
+	const uint64_t cutoffs = p_search.depth_cutoffs;
+	const bool found = _expand_todo_item_compiled(p_search, p_depth);
+	if (found) {
+		Array plan_suffix;
+		plan_suffix.resize(p_search.plan.size() - plan_size);
+		for (uint32_t i = plan_size; i < p_search.plan.size(); i++) {
+			plan_suffix[i - plan_size] = p_search.plan[i];
+		}
+		_store_transposition(key, false, plan_suffix);
+	} else if (cutoffs == p_search.depth_cutoffs) {
+		_store_transposition(key, true, Array());
+	}
+	return found;
+}
+
+bool Plan::_expand_todo_item_compiled(CompiledSearch &p_search, int p_depth) {
+	const Variant todo_item = p_search.todo_stack[p_search.todo_stack.size() - 1];
+	p_search.todo_stack.remove_at(p_search.todo_stack.size() - 1);
+	if (verbose >= 2) {
+		print_line("Depth: " + itos(p_depth) + ", Todo item: " + _item_to_string(todo_item));
+	}
+
+	bool found = false;
+	if (Object::cast_to<Multigoal>(todo_item)) {
+		found = _refine_multigoal_compiled(p_search, todo_item, p_depth);
+	} else if (todo_item.is_array() && !Array(todo_item).is_empty()) {
+		const Array item = todo_item;
+		const Variant &item_name = item[0];
+		const String verification = item_name.get_type() == Variant::STRING ? String(item_name) : String();
+		if (verification == "_verify_g") {
+			// Verification tasks are checked natively, the default callables expect a Dictionary state.
+			found = _is_goal_achieved_compiled(p_search.state, item[2], item[3], item[4]) && _seek_plan_compiled(p_search, p_depth + 1);
+		} else if (verification == "_verify_mg") {
+			found = _split_multigoal_compiled(p_search.state, item[2]).is_empty() && _seek_plan_compiled(p_search, p_depth + 1);
+		} else if (p_search.actions.has(item_name)) {
+			found = _apply_action_compiled(p_search, item, p_depth);
+		} else if (p_search.task_methods.has(item_name)) {
+			found = _refine_task_compiled(p_search, item, p_depth);
+		} else if (p_search.unigoal_methods.has(item_name)) {
+			found = _refine_unigoal_compiled(p_search, item, p_depth);
+		}
+	}
+
+	if (!found) {
+		// Leave the todo list as the caller passed it, so it can try its next alternative.
+		p_search.todo_stack.push_back(todo_item);
+	}
+	return found;
+}
+
+bool Plan::_apply_action_compiled(CompiledSearch &p_search, const Array &p_action, int p_depth) {
+	const Callable action = p_search.actions[p_action[0]];
+	if (verbose >= 2) {
+		print_line("Depth: " + itos(p_depth) + ", Action: " + _item_to_string(p_action));
+	}
+
+	const int checkpoint = p_search.state->get_checkpoint();
+	Variant applied;
+	if (_call_with_state(action, p_search.state_variant, p_action, applied) && applied.booleanize()) {
+		p_search.plan.push_back(p_action);
+		if (_seek_plan_compiled(p_search, p_depth + 1)) {
+			return true;
+		}
+		p_search.plan.remove_at(p_search.plan.size() - 1);
+	} else if (verbose >= 2) {
+		print_line("Recursive call: Not applicable action: " + _item_to_string(p_action));
+	}
+
+	p_search.state->rollback(checkpoint);
+	return false;
+}
+
+bool Plan::_refine_task_compiled(CompiledSearch &p_search, const Array &p_task, int p_depth) {
+	const Array relevant = p_search.task_methods[p_task[0]];
+	for (int i = 0; i < relevant.size(); i++) {
+		const Callable method = relevant[i];
+		if (verbose >= 2) {
+			print_line("Depth: " + itos(p_depth) + ", Trying method: " + _item_to_string(method));
+		}
+
+		const int checkpoint = p_search.state->get_checkpoint();
+		Variant result;
+		const bool called = _call_with_state(method, p_search.state_variant, p_task, result);
+		// Methods only inspect the state, drop anything they wrote.
+		p_search.state->rollback(checkpoint);
+		if (called && result.is_array() && _continue_with_subtasks_compiled(p_search, result, Variant(), p_depth)) {
+			return true;
+		}
+	}
+
+	if (verbose >= 2) {
+		print_line("Recursive call: Failed to accomplish task: " + _item_to_string(p_task));
+	}
+	return false;
+}
+
+bool Plan::_refine_unigoal_compiled(CompiledSearch &p_search, const Array &p_goal, int p_depth) {
+	ERR_FAIL_COND_V(p_goal.size() < 3, false);
+	const Variant &state_variable_name = p_goal[0];
+	const Variant &argument = p_goal[1];
+	const Variant &value = p_goal[2];
+
+	if (_is_goal_achieved_compiled(p_search.state, state_variable_name, argument, value)) {
+		if (verbose >= 3) {
+			print_line("Intermediate computation: Goal already achieved.");
+		}
+		return _seek_plan_compiled(p_search, p_depth + 1);
+	}
+
+	const Array relevant = p_search.unigoal_methods[state_variable_name];
+	for (int i = 0; i < relevant.size(); i++) {
+		const Callable method = relevant[i];
+		if (verbose >= 2) {
+			print_line("Depth: " + itos(p_depth) + ", Trying method: " + _item_to_string(method));
+		}
+
+		const int checkpoint = p_search.state->get_checkpoint();
+		const Variant *arguments[3] = { &p_search.state_variant, &argument, &value };
+		Variant result;
+		Callable::CallError call_error;
+		method.callp(arguments, 3, result, call_error);
+		p_search.state->rollback(checkpoint);
+		if (call_error.error != Callable::CallError::CALL_OK || !result.is_array()) {
+			continue;
+		}
+
+		const Variant verification = verify_goals ? Variant(varray("_verify_g", method.get_method(), state_variable_name, argument, value, p_depth, verbose)) : Variant();
+		if (_continue_with_subtasks_compiled(p_search, result, verification, p_depth)) {
+			return true;
+		}
+	}
+
+	if (verbose >= 2) {
+		print_line("Recursive call: Failed to achieve goal: " + _item_to_string(p_goal));
+	}
+	return false;
+}
+
+bool Plan::_refine_multigoal_compiled(CompiledSearch &p_search, const Ref<Multigoal> &p_goal, int p_depth) {
+	const Callable split_multigoal = callable_mp_static(&Multigoal::method_split_multigoal);
+	const Variant goal_variant = p_goal;
+
+	for (int i = 0; i < p_search.multigoal_methods.size(); i++) {
+		const Callable method = p_search.multigoal_methods[i];
+		if (verbose >= 2) {
+			print_line("Depth: " + itos(p_depth) + ", Trying method: " + _item_to_string(method));
+		}
+
+		Variant result;
+		if (method == split_multigoal) {
+			result = _split_multigoal_compiled(p_search.state, p_goal);
+		} else {
+			const int checkpoint = p_search.state->get_checkpoint();
+			const Variant *arguments[2] = { &p_search.state_variant, &goal_variant };
+			Callable::CallError call_error;
+			method.callp(arguments, 2, result, call_error);
+			p_search.state->rollback(checkpoint);
+			if (call_error.error != Callable::CallError::CALL_OK) {
+				continue;
+			}
+		}
+		if (!result.is_array()) {
+			continue;
+		}
+
+		const Variant verification = verify_goals ? Variant(varray("_verify_mg", method.get_method(), p_goal, p_depth, verbose)) : Variant();
+		if (_continue_with_subtasks_compiled(p_search, result, verification, p_depth)) {
+			return true;
+		}
+	}
+
+	if (verbose >= 2) {
+		print_line("Recursive call: Failed to achieve multigoal: " + _item_to_string(p_goal));
+	}
+	return false;
+}
+
+bool Plan::_continue_with_subtasks_compiled(CompiledSearch &p_search, const Array &p_subtasks, const Variant &p_verification, int p_depth) {
+	const uint32_t todo_size = p_search.todo_stack.size();
+	if (p_verification.get_type() != Variant::NIL) {
+		p_search.todo_stack.push_back(p_verification);
+	}
+	for (int i = p_subtasks.size() - 1; i >= 0; i--) {
+		p_search.todo_stack.push_back(p_subtasks[i]);
+	}
+
+	if (_seek_plan_compiled(p_search, p_depth + 1)) {
+		return true;
+	}
+	p_search.todo_stack.resize(todo_size);
+	return false;
+}
+
+bool Plan::_is_goal_achieved_compiled(const PlannerState *p_state, const Variant &p_variable, const Variant &p_subject, const Variant &p_value) {
+	const int32_t slot = p_state->find_slot(p_variable, p_subject);
+	if (slot >= 0) {
+		return p_state->get_slot(slot) == p_value;
+	}
+	return p_state->get_value(p_variable, p_subject) == p_value;
+}
+
+Array Plan::_split_multigoal_compiled(const PlannerState *p_state, const Ref<Multigoal> &p_goal) {
+	Array goals;
+	ERR_FAIL_COND_V(p_goal.is_null(), goals);
+
+	const Dictionary goal_state = p_goal->get_state();
+	for (const Variant &state_variable_name : goal_state.keys()) {
+		const Variant &goal_values = goal_state[state_variable_name];
+		if (goal_values.get_type() != Variant::DICTIONARY) {
+			continue;
+		}
+		const Dictionary subjects = goal_values;
+		for (const Variant &subject : subjects.keys()) {
+			const Variant &value = subjects[subject];
+			const int32_t slot = p_state->find_slot(state_variable_name, subject);
+			if (slot < 0) {
+				// Not a declared slot, so no action can change it: it only holds if the constant already matches.
+				// Multigoals of the todo list are validated once by _find_plan_compiled().
+				if (p_state->get_value(state_variable_name, subject) != value) {
+					goals.push_back(varray(state_variable_name, subject, value));
+				}
+				continue;
+			}
+			if (p_state->get_slot(slot) != value) {
+				goals.push_back(varray(state_variable_name, subject, value));
+			}
+		}
+	}
+	if (!goals.is_empty()) {
+		// Achieve goals, then check whether they're all simultaneously true.
+		goals.push_back(p_goal);
+	}
+	return goals;
+}
+
+bool Plan::_call_with_state(const Callable &p_callable, const Variant &p_state, const Array &p_task, Variant &r_result) {
+	// Same arguments as the task, with the state in place of the task name.
+	const int argument_count = MAX(p_task.size(), 1);
+	const Variant **arguments = (const Variant **)alloca(sizeof(Variant *) * argument_count);
+	arguments[0] = &p_state;
+	for (int i = 1; i < p_task.size(); i++) {
+		arguments[i] = &p_task[i];
+	}
+
+	Callable::CallError call_error;
+	p_callable.callp(arguments, argument_count, r_result, call_error);
+	ERR_FAIL_COND_V_MSG(call_error.error != Callable::CallError::CALL_OK, false, "Error calling " + String(p_callable) + ": " + Variant::get_callable_error_text(p_callable, arguments, argument_count, call_error));
+	return true;
+}
+
+Dictionary Plan::_run_lazy_lookahead_compiled(const Dictionary &p_state, const Array &p_todo_list, int p_max_tries) {
+	const Ref<PlannerState> state = current_domain->create_state(p_state);
+	const Dictionary actions = current_domain->get_actions();
+
+	for (int tries = 1; tries <= p_max_tries; tries++) {
+		const Variant plan = _find_plan_compiled(state, p_todo_list);
+		if (!plan.is_array()) {
+			if (verbose >= 1) {
+				print_line("run_lazy_lookahead: find_plan has failed");
+			}
+			return state->to_dictionary();
+		}
+
+		const Array action_list = plan;
+		if (action_list.is_empty()) {
+			if (verbose >= 1) {
+				print_line(vformat("run_lazy_lookahead: Empty plan => success\nafter %s calls to find_plan.", tries));
+			}
+			return state->to_dictionary();
+		}
+
+		for (int i = 0; i < action_list.size(); i++) {
+			const Array action = action_list[i];
+			const Callable command = actions[action[0]];
+			const int checkpoint = state->get_checkpoint();
+			Variant applied;
+			if (!_call_with_state(command, state, action, applied) || !applied.booleanize()) {
+				state->rollback(checkpoint);
+				if (verbose >= 1) {
+					print_line(vformat("run_lazy_lookahead: WARNING: action %s failed; will call find_plan.", _item_to_string(action)));
+				}
+				break;
+			}
+		}
+		state->clear_undo_log();
+
+		if (verbose >= 1) {
+			print_line("RunLazyLookahead> Plan ended; will call find_plan again.");
+		}
+	}
+
+	if (verbose >= 1) {
+		print_line("run_lazy_lookahead: Too many tries, giving up.");
+	}
+	return state->to_dictionary();
+}
+
 void Plan::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_verify_goals"), &Plan::get_verify_goals);
 	ClassDB::bind_method(D_METHOD("set_verify_goals", "value"), &Plan::set_verify_goals);
@@ -415,6 +1118,31 @@ void Plan::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "current_domain", PROPERTY_HINT_RESOURCE_TYPE, "Domain"), "set_current_domain", "get_current_domain");
 
 	ClassDB::bind_method(D_METHOD("find_plan", "state", "todo_list"), &Plan::find_plan);
+	ClassDB::bind_method(D_METHOD("find_plan_from_state", "state", "todo_list"), &Plan::find_plan_from_state);
+	ClassDB::bind_method(D_METHOD("find_plan_async", "state", "todo_list", "timeout_msec"), &Plan::find_plan_async, DEFVAL(0));
+
+	ClassDB::bind_method(D_METHOD("get_search_stats"), &Plan::get_search_stats);
+	ClassDB::bind_method(D_METHOD("reset_search_stats"), &Plan::reset_search_stats);
+
+	ClassDB::bind_method(D_METHOD("set_transposition_table_enabled", "enabled"), &Plan::set_transposition_table_enabled);
+	ClassDB::bind_method(D_METHOD("is_transposition_table_enabled"), &Plan::is_transposition_table_enabled);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "transposition_table_enabled"), "set_transposition_table_enabled", "is_transposition_table_enabled");
+
+	ClassDB::bind_method(D_METHOD("set_transposition_table_size", "size"), &Plan::set_transposition_table_size);
+	ClassDB::bind_method(D_METHOD("get_transposition_table_size"), &Plan::get_transposition_table_size);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "transposition_table_size", PROPERTY_HINT_RANGE, "1,1048576,1,or_greater"), "set_transposition_table_size", "get_transposition_table_size");
+
+	ClassDB::bind_method(D_METHOD("set_max_depth", "depth"), &Plan::set_max_depth);
+	ClassDB::bind_method(D_METHOD("get_max_depth"), &Plan::get_max_depth);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_depth", PROPERTY_HINT_RANGE, "0,4096,1,or_greater"), "set_max_depth", "get_max_depth");
+
+	ClassDB::bind_method(D_METHOD("set_iterative_deepening", "enabled"), &Plan::set_iterative_deepening);
+	ClassDB::bind_method(D_METHOD("is_iterative_deepening"), &Plan::is_iterative_deepening);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "iterative_deepening"), "set_iterative_deepening", "is_iterative_deepening");
+
+	ClassDB::bind_method(D_METHOD("set_parallel_refinement", "enabled"), &Plan::set_parallel_refinement);
+	ClassDB::bind_method(D_METHOD("get_parallel_refinement"), &Plan::get_parallel_refinement);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "parallel_refinement"), "set_parallel_refinement", "get_parallel_refinement");
 	ClassDB::bind_method(D_METHOD("run_lazy_lookahead", "state", "todo_list", "max_tries"), &Plan::run_lazy_lookahead, DEFVAL(10));
 }
 
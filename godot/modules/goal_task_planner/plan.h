@@ -36,11 +36,15 @@
 // Author: Dana Nau <nau@umd.edu>, July 7, 2021
 
 #include "core/io/resource.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "core/variant/typed_array.h"
 
 #include "modules/goal_task_planner/multigoal.h"
+#include "modules/goal_task_planner/planner_state.h"
 
 class Domain;
+class PlanRequest;
 class Plan : public Resource {
 	GDCLASS(Plan, Resource);
 
@@ -58,6 +62,57 @@ class Plan : public Resource {
 	// supposed to achieve. The verification task won't insert anything into the
 	// final plan; it just will verify whether m did what it was supposed to do.
 	bool verify_goals = true;
+
+	// Asynchronous searches try the methods of the first task on separate worker threads.
+	bool parallel_refinement = true;
+	// Set on the private planner of an asynchronous search, checked once per expanded node.
+	PlanRequest *search_request = nullptr;
+	Ref<Plan> _make_search_copy() const;
+	void _run_async_branch(uint32_t p_branch, PlanRequest *p_request);
+
+	// Transposition table: the outcome of searching a todo list from a state only depends
+	// on both, so identical (state, todo list) pairs met again while backtracking reuse
+	// the recorded failure or plan suffix. The table is cleared at the start of every search.
+	struct TranspositionKey {
+		Variant state;
+		Array todo_list;
+		uint32_t hash = 0;
+	};
+	struct TranspositionKeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const TranspositionKey &p_key) { return p_key.hash; }
+	};
+	struct TranspositionKeyComparator {
+		static bool compare(const TranspositionKey &p_lhs, const TranspositionKey &p_rhs) {
+			return p_lhs.hash == p_rhs.hash && p_lhs.state == p_rhs.state && p_lhs.todo_list == p_rhs.todo_list;
+		}
+	};
+	struct TranspositionEntry {
+		bool failed = true;
+		// Actions appended to the plan by the search from this point.
+		Array plan_suffix;
+	};
+	bool transposition_table_enabled = false;
+	int transposition_table_size = 65536;
+	HashMap<TranspositionKey, TranspositionEntry, TranspositionKeyHasher, TranspositionKeyComparator> transposition_table;
+	uint64_t transposition_hits = 0;
+	uint64_t transposition_misses = 0;
+	uint64_t transposition_evictions = 0;
+	static TranspositionKey _make_transposition_key(const Variant &p_state, const Array &p_todo_list);
+	const TranspositionEntry *_find_transposition(const TranspositionKey &p_key);
+	void _store_transposition(const TranspositionKey &p_key, bool p_failed, const Array &p_plan_suffix);
+
+	// Depth bound of the recursive search, 0 is unbounded. A search cut off by the bound
+	// is not a proof of failure, so it is counted and never stored as a failed transposition.
+	int max_depth = 0;
+	bool iterative_deepening = false;
+	int search_depth_limit = 0;
+	uint64_t search_depth_cutoffs = 0;
+	uint64_t deepening_iterations = 0;
+	void _begin_search();
+	bool _is_search_cut_off(int p_depth, int p_depth_limit, uint64_t &r_cutoffs);
+	Variant _find_plan_dictionary(const Dictionary &p_state, const Array &p_todo_list);
+	Variant _expand_todo_item(Dictionary p_state, Array p_todo_list, Array p_plan, int p_depth);
+
 	static String _item_to_string(Variant p_item);
 	Variant _seek_plan(Dictionary p_state, Array p_todo_list, Array p_plan, int p_depth);
 	Variant _apply_task_and_continue(Dictionary p_state, Callable p_command, Array p_arguments);
@@ -66,6 +121,35 @@ class Plan : public Resource {
 	Variant _refine_multigoal_and_continue(const Dictionary p_state, const Ref<Multigoal> p_goal, const Array p_todo_list, const Array p_plan, const int p_depth);
 	Variant _refine_unigoal_and_continue(const Dictionary p_state, const Array p_first_goal, const Array p_todo_list, const Array p_plan, const int p_depth);
 
+	// Compiled planning, used when the current domain declares its state variables.
+	// The todo list is a stack (next item last) and the state is rolled back on
+	// backtracking, so no recursion level copies the state, the todo list or the plan.
+	struct CompiledSearch {
+		PlannerState *state = nullptr;
+		Variant state_variant;
+		Dictionary actions;
+		Dictionary task_methods;
+		Dictionary unigoal_methods;
+		Array multigoal_methods;
+		LocalVector<Variant> todo_stack;
+		LocalVector<Variant> plan;
+		int depth_limit = 0;
+		uint64_t depth_cutoffs = 0;
+	};
+	Variant _find_plan_compiled(const Ref<PlannerState> &p_state, const Array &p_todo_list);
+	bool _seek_plan_compiled(CompiledSearch &p_search, int p_depth);
+	bool _expand_todo_item_compiled(CompiledSearch &p_search, int p_depth);
+	bool _apply_action_compiled(CompiledSearch &p_search, const Array &p_action, int p_depth);
+	bool _refine_task_compiled(CompiledSearch &p_search, const Array &p_task, int p_depth);
+	bool _refine_unigoal_compiled(CompiledSearch &p_search, const Array &p_goal, int p_depth);
+	bool _refine_multigoal_compiled(CompiledSearch &p_search, const Ref<Multigoal> &p_goal, int p_depth);
+	bool _continue_with_subtasks_compiled(CompiledSearch &p_search, const Array &p_subtasks, const Variant &p_verification, int p_depth);
+	static bool _is_goal_achieved_compiled(const PlannerState *p_state, const Variant &p_variable, const Variant &p_subject, const Variant &p_value);
+	static Array _split_multigoal_compiled(const PlannerState *p_state, const Ref<Multigoal> &p_goal);
+	static String _get_undeclared_goals_compiled(const PlannerState *p_state, const Ref<Multigoal> &p_goal);
+	static bool _call_with_state(const Callable &p_callable, const Variant &p_state, const Array &p_task, Variant &r_result);
+	Dictionary _run_lazy_lookahead_compiled(const Dictionary &p_state, const Array &p_todo_list, int p_max_tries);
+
 public:
 	int get_verbose() const;
 	void set_verbose(int p_level);
@@ -76,6 +160,20 @@ public:
 	void set_verify_goals(bool p_value);
 	bool get_verify_goals() const;
 	Variant find_plan(Dictionary p_state, Array p_todo_list);
+	Variant find_plan_from_state(Ref<PlannerState> p_state, Array p_todo_list);
+	void set_parallel_refinement(bool p_enabled);
+	bool get_parallel_refinement() const;
+	void set_transposition_table_enabled(bool p_enabled);
+	bool is_transposition_table_enabled() const;
+	void set_transposition_table_size(int p_size);
+	int get_transposition_table_size() const;
+	void set_max_depth(int p_depth);
+	int get_max_depth() const;
+	void set_iterative_deepening(bool p_enabled);
+	bool is_iterative_deepening() const;
+	Dictionary get_search_stats() const;
+	void reset_search_stats();
+	Ref<PlanRequest> find_plan_async(Dictionary p_state, Array p_todo_list, int p_timeout_msec = 0);
 	Dictionary run_lazy_lookahead(Dictionary p_state, Array p_todo_list, int p_max_tries = 10);
 
 protected:
@@ -0,0 +1,144 @@
+/**************************************************************************/
+/*  plan_request.cpp                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "plan_request.h"
+
+#include "core/os/os.h"
+
+#include "modules/goal_task_planner/plan.h"
+
+// The deadline is only checked every so many expanded nodes, reading the clock is not free.
+static const uint64_t DEADLINE_CHECK_INTERVAL = 64;
+
+bool PlanRequest::_should_stop() {
+	const uint64_t nodes = expanded_nodes.increment();
+	if (cancel_requested.is_set() || timed_out.is_set() || status.get() != STATUS_RUNNING) {
+		// Cancelled by the caller, or another branch already found a plan.
+		return true;
+	}
+	if (deadline_usec > 0 && nodes % DEADLINE_CHECK_INTERVAL == 0 && OS::get_singleton()->get_ticks_usec() > deadline_usec) {
+		timed_out.set();
+		return true;
+	}
+	return false;
+}
+
+void PlanRequest::_finish_branch(const Variant &p_plan) {
+	MutexLock lock(result_mutex);
+	if (p_plan.is_array() && status.get() == STATUS_RUNNING) {
+		// First solution wins, the other branches stop at their next expanded node.
+		result = p_plan;
+		status.set(STATUS_SUCCEEDED);
+		end_usec = OS::get_singleton()->get_ticks_usec();
+	}
+	if (pending_branches.decrement() == 0 && status.get() == STATUS_RUNNING) {
+		if (cancel_requested.is_set()) {
+			status.set(STATUS_CANCELLED);
+		} else if (timed_out.is_set()) {
+			status.set(STATUS_TIMED_OUT);
+		} else {
+			status.set(STATUS_FAILED);
+		}
+		end_usec = OS::get_singleton()->get_ticks_usec();
+	}
+}
+
+void PlanRequest::_wait_for_branches() {
+	MutexLock lock(group_mutex);
+	if (group_id == -1) {
+		return;
+	}
+	// Every group must be waited on once to be released by the pool.
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+	group_id = -1;
+}
+
+PlanRequest::Status PlanRequest::get_status() const {
+	return Status(status.get());
+}
+
+bool PlanRequest::is_done() {
+	if (status.get() == STATUS_RUNNING) {
+		return false;
+	}
+	_wait_for_branches();
+	return true;
+}
+
+void PlanRequest::cancel() {
+	cancel_requested.set();
+}
+
+void PlanRequest::wait() {
+	_wait_for_branches();
+}
+
+Variant PlanRequest::get_result() {
+	MutexLock lock(result_mutex);
+	return result;
+}
+
+int64_t PlanRequest::get_expanded_nodes() const {
+	return expanded_nodes.get();
+}
+
+int PlanRequest::get_branch_count() const {
+	return MAX(branch_methods.size(), 1);
+}
+
+double PlanRequest::get_elapsed_time() const {
+	if (start_usec == 0) {
+		return 0.0;
+	}
+	const uint64_t end = status.get() == STATUS_RUNNING ? OS::get_singleton()->get_ticks_usec() : end_usec;
+	return double(end - start_usec) / 1000000.0;
+}
+
+PlanRequest::~PlanRequest() {
+	cancel_requested.set();
+	_wait_for_branches();
+}
+
+void PlanRequest::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_status"), &PlanRequest::get_status);
+	ClassDB::bind_method(D_METHOD("is_done"), &PlanRequest::is_done);
+	ClassDB::bind_method(D_METHOD("cancel"), &PlanRequest::cancel);
+	ClassDB::bind_method(D_METHOD("wait"), &PlanRequest::wait);
+	ClassDB::bind_method(D_METHOD("get_result"), &PlanRequest::get_result);
+	ClassDB::bind_method(D_METHOD("get_expanded_nodes"), &PlanRequest::get_expanded_nodes);
+	ClassDB::bind_method(D_METHOD("get_branch_count"), &PlanRequest::get_branch_count);
+	ClassDB::bind_method(D_METHOD("get_elapsed_time"), &PlanRequest::get_elapsed_time);
+
+	BIND_ENUM_CONSTANT(STATUS_RUNNING);
+	BIND_ENUM_CONSTANT(STATUS_SUCCEEDED);
+	BIND_ENUM_CONSTANT(STATUS_FAILED);
+	BIND_ENUM_CONSTANT(STATUS_CANCELLED);
+	BIND_ENUM_CONSTANT(STATUS_TIMED_OUT);
+}
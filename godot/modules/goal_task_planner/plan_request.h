@@ -0,0 +1,104 @@
+/**************************************************************************/
+/*  plan_request.h                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef PLAN_REQUEST_H
+#define PLAN_REQUEST_H
+
+#include "core/object/ref_counted.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/templates/safe_refcount.h"
+#include "core/variant/array.h"
+#include "core/variant/dictionary.h"
+
+class Plan;
+
+// Handle of a plan search running on the WorkerThreadPool, see Plan::find_plan_async.
+// The search owns a private copy of the planner and of the initial state, so the
+// caller keeps using its Plan and state while the request runs.
+class PlanRequest : public RefCounted {
+	GDCLASS(PlanRequest, RefCounted);
+
+public:
+	enum Status {
+		STATUS_RUNNING,
+		STATUS_SUCCEEDED,
+		STATUS_FAILED,
+		STATUS_CANCELLED,
+		STATUS_TIMED_OUT,
+	};
+
+private:
+	friend class Plan;
+
+	Ref<Plan> planner;
+	Dictionary state;
+	Array todo_list;
+	// Methods of the first task, each one refined by its own branch. Empty for a single branch.
+	Array branch_methods;
+
+	uint64_t start_usec = 0;
+	uint64_t end_usec = 0;
+	uint64_t deadline_usec = 0;
+	SafeFlag cancel_requested;
+	SafeFlag timed_out;
+	SafeNumeric<uint32_t> status;
+	SafeNumeric<uint64_t> expanded_nodes;
+	SafeNumeric<uint32_t> pending_branches;
+
+	Mutex result_mutex;
+	Variant result = false;
+
+	BinaryMutex group_mutex;
+	WorkerThreadPool::GroupID group_id = -1;
+
+	bool _should_stop();
+	void _finish_branch(const Variant &p_plan);
+	void _wait_for_branches();
+
+protected:
+	static void _bind_methods();
+
+public:
+	Status get_status() const;
+	bool is_done();
+	void cancel();
+	void wait();
+	Variant get_result();
+	int64_t get_expanded_nodes() const;
+	int get_branch_count() const;
+	double get_elapsed_time() const;
+
+	~PlanRequest();
+};
+
+VARIANT_ENUM_CAST(PlanRequest::Status);
+
+#endif // PLAN_REQUEST_H
@@ -0,0 +1,146 @@
+/**************************************************************************/
+/*  planner_state.cpp                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "planner_state.h"
+
+#include "modules/goal_task_planner/domain.h"
+
+void PlannerState::setup(const Ref<Domain> &p_domain, const Dictionary &p_state) {
+	ERR_FAIL_COND(p_domain.is_null());
+	domain = p_domain;
+	values.clear();
+	undo_log.clear();
+	constants.clear();
+	values.resize(domain->get_state_slot_count());
+
+	for (const Variant &key : p_state.keys()) {
+		const int32_t variable_index = domain->find_state_variable(key);
+		if (variable_index < 0) {
+			constants[key] = p_state[key];
+			continue;
+		}
+		const Variant &variable_values = p_state[key];
+		ERR_CONTINUE_MSG(variable_values.get_type() != Variant::DICTIONARY, vformat("State variable \"%s\" must be a Dictionary of subjects.", key));
+		const Dictionary subjects = variable_values;
+		for (const Variant &subject : subjects.keys()) {
+			const int32_t slot = domain->find_state_slot(variable_index, subject);
+			ERR_CONTINUE_MSG(slot < 0, vformat("Subject \"%s\" of state variable \"%s\" was not declared.", subject, key));
+			set_slot(slot, subjects[subject]);
+		}
+	}
+	undo_log.clear();
+}
+
+int32_t PlannerState::find_slot(const Variant &p_variable, const Variant &p_subject) const {
+	if (domain.is_null()) {
+		return -1;
+	}
+	const int32_t variable_index = domain->find_state_variable(p_variable);
+	if (variable_index < 0) {
+		return -1;
+	}
+	const int32_t slot = domain->find_state_slot(variable_index, p_subject);
+	// The domain may have declared more variables since this state was set up.
+	return slot < (int32_t)values.size() ? slot : -1;
+}
+
+bool PlannerState::set_slot(int32_t p_slot, const Variant &p_value) {
+	ERR_FAIL_INDEX_V(p_slot, (int32_t)values.size(), false);
+	const Variant::Type type = domain->get_state_slot_type(p_slot);
+	ERR_FAIL_COND_V_MSG(type != Variant::NIL && p_value.get_type() != Variant::NIL && !Variant::can_convert_strict(p_value.get_type(), type), false,
+			vformat("Cannot assign a value of type %s to a state variable of type %s.", Variant::get_type_name(p_value.get_type()), Variant::get_type_name(type)));
+
+	UndoEntry entry;
+	entry.slot = p_slot;
+	entry.value = values[p_slot];
+	undo_log.push_back(entry);
+	values[p_slot] = p_value;
+	return true;
+}
+
+Variant PlannerState::get_value(const StringName &p_variable, const Variant &p_subject) const {
+	const int32_t slot = find_slot(p_variable, p_subject);
+	if (slot >= 0) {
+		return values[slot];
+	}
+	const Variant constant = constants.get(p_variable, Variant());
+	if (constant.get_type() == Variant::DICTIONARY) {
+		return Dictionary(constant).get(p_subject, Variant());
+	}
+	return Variant();
+}
+
+bool PlannerState::set_value(const StringName &p_variable, const Variant &p_subject, const Variant &p_value) {
+	const int32_t slot = find_slot(p_variable, p_subject);
+	ERR_FAIL_COND_V_MSG(slot < 0, false, vformat("\"%s\" of state variable \"%s\" was not declared in the domain.", p_subject, p_variable));
+	return set_slot(slot, p_value);
+}
+
+Variant PlannerState::get_constant(const StringName &p_name) const {
+	return constants.get(p_name, Variant());
+}
+
+void PlannerState::rollback(int p_checkpoint) {
+	ERR_FAIL_COND(p_checkpoint < 0);
+	while ((int)undo_log.size() > p_checkpoint) {
+		UndoEntry &entry = undo_log[undo_log.size() - 1];
+		values[entry.slot] = entry.value;
+		undo_log.remove_at(undo_log.size() - 1);
+	}
+}
+
+Dictionary PlannerState::to_dictionary() const {
+	Dictionary state = constants.duplicate();
+	if (domain.is_null()) {
+		return state;
+	}
+	for (int32_t variable_index = 0; variable_index < domain->get_state_variable_count(); variable_index++) {
+		Dictionary subjects;
+		const Array variable_subjects = domain->get_state_variable_subjects(variable_index);
+		for (int32_t i = 0; i < variable_subjects.size(); i++) {
+			const int32_t slot = domain->get_state_variable_offset(variable_index) + i;
+			if (slot < (int32_t)values.size() && values[slot].get_type() != Variant::NIL) {
+				subjects[variable_subjects[i]] = values[slot];
+			}
+		}
+		state[domain->get_state_variable_name(variable_index)] = subjects;
+	}
+	return state;
+}
+
+void PlannerState::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_domain"), &PlannerState::get_domain);
+	ClassDB::bind_method(D_METHOD("get_value", "variable", "subject"), &PlannerState::get_value);
+	ClassDB::bind_method(D_METHOD("set_value", "variable", "subject", "value"), &PlannerState::set_value);
+	ClassDB::bind_method(D_METHOD("get_constant", "name"), &PlannerState::get_constant);
+	ClassDB::bind_method(D_METHOD("get_checkpoint"), &PlannerState::get_checkpoint);
+	ClassDB::bind_method(D_METHOD("rollback", "checkpoint"), &PlannerState::rollback);
+	ClassDB::bind_method(D_METHOD("to_dictionary"), &PlannerState::to_dictionary);
+}
@@ -0,0 +1,82 @@
+/**************************************************************************/
+/*  planner_state.h                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef PLANNER_STATE_H
+#define PLANNER_STATE_H
+
+#include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/dictionary.h"
+
+class Domain;
+
+// Flat planning state for domains that declare their state variables.
+// Every (variable, subject) pair owns one slot, and every write is recorded in
+// an undo log so the planner backtracks by rolling back instead of copying states.
+// Entries of the initial state that are not declared are kept as read-only constants.
+// Only slot assignments are logged: an Array or Dictionary value changed in place is
+// not rolled back, so such values have to be replaced with set_value instead.
+class PlannerState : public RefCounted {
+	GDCLASS(PlannerState, RefCounted);
+
+	struct UndoEntry {
+		int32_t slot = -1;
+		Variant value;
+	};
+
+	Ref<Domain> domain;
+	LocalVector<Variant> values;
+	LocalVector<UndoEntry> undo_log;
+	Dictionary constants;
+
+protected:
+	static void _bind_methods();
+
+public:
+	void setup(const Ref<Domain> &p_domain, const Dictionary &p_state);
+	Ref<Domain> get_domain() const { return domain; }
+
+	int32_t find_slot(const Variant &p_variable, const Variant &p_subject) const;
+	int32_t get_slot_count() const { return values.size(); }
+	const Variant &get_slot(int32_t p_slot) const { return values[p_slot]; }
+	bool set_slot(int32_t p_slot, const Variant &p_value);
+
+	Variant get_value(const StringName &p_variable, const Variant &p_subject) const;
+	bool set_value(const StringName &p_variable, const Variant &p_subject, const Variant &p_value);
+	Variant get_constant(const StringName &p_name) const;
+
+	int get_checkpoint() const { return undo_log.size(); }
+	void rollback(int p_checkpoint);
+	void clear_undo_log() { undo_log.clear(); }
+
+	Dictionary to_dictionary() const;
+};
+
+#endif // PLANNER_STATE_H
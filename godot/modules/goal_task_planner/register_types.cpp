@@ -37,6 +37,8 @@
 #include "domain.h"
 #include "multigoal.h"
 #include "plan.h"
+#include "plan_request.h"
+#include "planner_state.h"
 
 void initialize_goal_task_planner_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
@@ -45,6 +47,8 @@ void initialize_goal_task_planner_module(ModuleInitializationLevel p_level) {
 	ClassDB::register_class<Domain>();
 	ClassDB::register_class<Multigoal>();
 	ClassDB::register_class<Plan>();
+	ClassDB::register_class<PlannerState>();
+	ClassDB::register_class<PlanRequest>();
 }
 
 void uninitialize_goal_task_planner_module(ModuleInitializationLevel p_level) {
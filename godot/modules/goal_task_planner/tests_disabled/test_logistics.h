@@ -38,12 +38,15 @@
 #include "core/variant/array.h"
 #include "core/variant/callable.h"
 #include "core/variant/dictionary.h"
+#include "core/os/os.h"
 #include "core/variant/typed_array.h"
 #include "tests/test_macros.h"
 
 #include "modules/goal_task_planner/domain.h"
 #include "modules/goal_task_planner/multigoal.h"
 #include "modules/goal_task_planner/plan.h"
+#include "modules/goal_task_planner/plan_request.h"
+#include "modules/goal_task_planner/planner_state.h"
 
 namespace TestLogistics {
 
@@ -323,6 +326,190 @@ Variant method_move_between_city(Dictionary p_state, String p_object, String p_l
 	return false;
 }
 
+// Compiled versions of the actions and methods. They work on a PlannerState,
+// actions modify it in place and return whether they were applicable.
+
+static bool compiled_drive_truck(PlannerState *p_state, String p_truck, String p_location) {
+	return p_state->set_value(SNAME("truck_at"), p_truck, p_location);
+}
+
+static bool compiled_fly_plane(PlannerState *p_state, String p_plane, String p_airport) {
+	return p_state->set_value(SNAME("plane_at"), p_plane, p_airport);
+}
+
+static bool compiled_load_truck(PlannerState *p_state, String p_object, String p_truck) {
+	return p_state->set_value(SNAME("at"), p_object, p_truck);
+}
+
+static bool compiled_load_plane(PlannerState *p_state, String p_object, String p_plane) {
+	return p_state->set_value(SNAME("at"), p_object, p_plane);
+}
+
+static bool compiled_unload_plane(PlannerState *p_state, String p_object, String p_airport) {
+	const Variant plane = p_state->get_value(SNAME("at"), p_object);
+	if (p_state->get_value(SNAME("plane_at"), plane) == p_airport) {
+		p_state->set_value(SNAME("at"), p_object, p_airport);
+	}
+	return true;
+}
+
+static bool compiled_unload_truck(PlannerState *p_state, String p_object, String p_location) {
+	const Variant truck = p_state->get_value(SNAME("at"), p_object);
+	if (p_state->get_value(SNAME("truck_at"), truck) == p_location) {
+		p_state->set_value(SNAME("at"), p_object, p_location);
+	}
+	return true;
+}
+
+static Variant _compiled_city_of(PlannerState *p_state, const Variant &p_location) {
+	return p_state->get_value(SNAME("in_city"), p_location);
+}
+
+static Variant _compiled_find_truck(PlannerState *p_state, String p_object) {
+	const Array trucks = p_state->get_constant(SNAME("trucks"));
+	const Variant city = _compiled_city_of(p_state, p_state->get_value(SNAME("at"), p_object));
+	for (const Variant &truck : trucks) {
+		if (_compiled_city_of(p_state, p_state->get_value(SNAME("truck_at"), truck)) == city) {
+			return truck;
+		}
+	}
+	return false;
+}
+
+static Variant _compiled_find_plane(PlannerState *p_state, String p_object) {
+	const Array airplanes = p_state->get_constant(SNAME("airplanes"));
+	const Variant city = _compiled_city_of(p_state, p_state->get_value(SNAME("at"), p_object));
+	Variant last_plane;
+	for (const Variant &plane : airplanes) {
+		if (_compiled_city_of(p_state, p_state->get_value(SNAME("plane_at"), plane)) == city) {
+			return plane;
+		}
+		last_plane = plane;
+	}
+	return last_plane;
+}
+
+static Variant _compiled_find_airport(PlannerState *p_state, const Variant &p_location) {
+	const Array airports = p_state->get_constant(SNAME("airports"));
+	const Variant city = _compiled_city_of(p_state, p_location);
+	for (const Variant &airport : airports) {
+		if (_compiled_city_of(p_state, airport) == city) {
+			return airport;
+		}
+	}
+	return false;
+}
+
+static Variant compiled_method_drive_truck(PlannerState *p_state, String p_truck, String p_location) {
+	const Array trucks = p_state->get_constant(SNAME("trucks"));
+	const Array locations = p_state->get_constant(SNAME("locations"));
+	if (trucks.has(p_truck) && locations.has(p_location) && _compiled_city_of(p_state, p_state->get_value(SNAME("truck_at"), p_truck)) == _compiled_city_of(p_state, p_location)) {
+		return varray(varray("drive_truck", p_truck, p_location));
+	}
+	return false;
+}
+
+static Variant compiled_method_load_truck(PlannerState *p_state, String p_object, String p_truck) {
+	const Array packages = p_state->get_constant(SNAME("packages"));
+	const Array trucks = p_state->get_constant(SNAME("trucks"));
+	if (packages.has(p_object) && trucks.has(p_truck) && p_state->get_value(SNAME("at"), p_object) == p_state->get_value(SNAME("truck_at"), p_truck)) {
+		return varray(varray("load_truck", p_object, p_truck));
+	}
+	return false;
+}
+
+static Variant compiled_method_unload_truck(PlannerState *p_state, String p_object, String p_location) {
+	const Array packages = p_state->get_constant(SNAME("packages"));
+	const Array trucks = p_state->get_constant(SNAME("trucks"));
+	const Array locations = p_state->get_constant(SNAME("locations"));
+	if (packages.has(p_object) && trucks.has(p_state->get_value(SNAME("at"), p_object)) && locations.has(p_location)) {
+		return varray(varray("unload_truck", p_object, p_location));
+	}
+	return false;
+}
+
+static Variant compiled_method_fly_plane(PlannerState *p_state, String p_plane, String p_airport) {
+	const Array airplanes = p_state->get_constant(SNAME("airplanes"));
+	const Array airports = p_state->get_constant(SNAME("airports"));
+	if (airplanes.has(p_plane) && airports.has(p_airport)) {
+		return varray(varray("fly_plane", p_plane, p_airport));
+	}
+	return false;
+}
+
+static Variant compiled_method_load_plane(PlannerState *p_state, String p_object, String p_plane) {
+	const Array packages = p_state->get_constant(SNAME("packages"));
+	const Array airplanes = p_state->get_constant(SNAME("airplanes"));
+	if (packages.has(p_object) && airplanes.has(p_plane) && p_state->get_value(SNAME("at"), p_object) == p_state->get_value(SNAME("plane_at"), p_plane)) {
+		return varray(varray("load_plane", p_object, p_plane));
+	}
+	return false;
+}
+
+static Variant compiled_method_unload_plane(PlannerState *p_state, String p_object, String p_airport) {
+	const Array packages = p_state->get_constant(SNAME("packages"));
+	const Array airplanes = p_state->get_constant(SNAME("airplanes"));
+	const Array airports = p_state->get_constant(SNAME("airports"));
+	if (packages.has(p_object) && airplanes.has(p_state->get_value(SNAME("at"), p_object)) && airports.has(p_airport)) {
+		return varray(varray("unload_plane", p_object, p_airport));
+	}
+	return false;
+}
+
+static Variant compiled_method_move_within_city(PlannerState *p_state, String p_object, String p_location) {
+	const Array packages = p_state->get_constant(SNAME("packages"));
+	const Array locations = p_state->get_constant(SNAME("locations"));
+	const Variant at = p_state->get_value(SNAME("at"), p_object);
+	if (packages.has(p_object) && locations.has(at) && _compiled_city_of(p_state, at) == _compiled_city_of(p_state, p_location)) {
+		const Variant truck = _compiled_find_truck(p_state, p_object);
+		if (truck) {
+			Array plan;
+			plan.push_back(varray("truck_at", truck, at));
+			plan.push_back(varray("at", p_object, truck));
+			plan.push_back(varray("truck_at", truck, p_location));
+			plan.push_back(varray("at", p_object, p_location));
+			return plan;
+		}
+	}
+	return false;
+}
+
+static Variant compiled_method_move_between_airports(PlannerState *p_state, String p_object, String p_airport) {
+	const Array packages = p_state->get_constant(SNAME("packages"));
+	const Array airports = p_state->get_constant(SNAME("airports"));
+	const Variant at = p_state->get_value(SNAME("at"), p_object);
+	if (packages.has(p_object) && airports.has(at) && airports.has(p_airport) && _compiled_city_of(p_state, at) != _compiled_city_of(p_state, p_airport)) {
+		const Variant plane = _compiled_find_plane(p_state, p_object);
+		if (plane) {
+			Array plan;
+			plan.push_back(varray("plane_at", plane, at));
+			plan.push_back(varray("at", p_object, plane));
+			plan.push_back(varray("plane_at", plane, p_airport));
+			plan.push_back(varray("at", p_object, p_airport));
+			return plan;
+		}
+	}
+	return false;
+}
+
+static Variant compiled_method_move_between_city(PlannerState *p_state, String p_object, String p_location) {
+	const Array packages = p_state->get_constant(SNAME("packages"));
+	const Array locations = p_state->get_constant(SNAME("locations"));
+	const Variant at = p_state->get_value(SNAME("at"), p_object);
+	if (packages.has(p_object) && locations.has(at) && _compiled_city_of(p_state, at) != _compiled_city_of(p_state, p_location)) {
+		const Variant airport_1 = _compiled_find_airport(p_state, at);
+		const Variant airport_2 = _compiled_find_airport(p_state, p_location);
+		if (airport_1 != Variant(false) && airport_2 != Variant(false)) {
+			Array plan;
+			plan.push_back(varray("at", p_object, airport_1));
+			plan.push_back(varray("at", p_object, airport_2));
+			plan.push_back(varray("at", p_object, p_location));
+			return plan;
+		}
+	}
+	return false;
+}
+
 void before_each(Dictionary &p_state, Ref<Plan> p_planner, Ref<Domain> p_the_domain) {
 	ERR_FAIL_COND(p_planner.is_null());
 	ERR_FAIL_COND(p_the_domain.is_null());
@@ -415,6 +602,47 @@ void before_each(Dictionary &p_state, Ref<Plan> p_planner, Ref<Domain> p_the_dom
 	p_state["in_city"] = in_city;
 }
 
+// Same initial state as before_each, planned with the compiled actions and methods.
+void before_each_compiled(Dictionary &p_state, Ref<Plan> p_planner, Ref<Domain> p_the_domain) {
+	before_each(p_state, p_planner, Ref<Domain>(memnew(Domain)));
+	TypedArray<Domain> domains;
+	domains.push_back(p_the_domain);
+	p_planner->set_domains(domains);
+	p_planner->set_current_domain(p_the_domain);
+
+	p_the_domain->declare_state_variable("at", p_state["packages"], Variant::STRING);
+	p_the_domain->declare_state_variable("truck_at", p_state["trucks"], Variant::STRING);
+	p_the_domain->declare_state_variable("plane_at", p_state["airplanes"], Variant::STRING);
+
+	// Action names have to match the ones used by the methods.
+	Dictionary actions;
+	actions["drive_truck"] = callable_mp_static(&compiled_drive_truck);
+	actions["load_truck"] = callable_mp_static(&compiled_load_truck);
+	actions["unload_truck"] = callable_mp_static(&compiled_unload_truck);
+	actions["fly_plane"] = callable_mp_static(&compiled_fly_plane);
+	actions["load_plane"] = callable_mp_static(&compiled_load_plane);
+	actions["unload_plane"] = callable_mp_static(&compiled_unload_plane);
+	p_the_domain->set_actions(actions);
+
+	TypedArray<Callable> truck_at_methods;
+	truck_at_methods.push_back(callable_mp_static(&compiled_method_drive_truck));
+	p_the_domain->add_unigoal_methods("truck_at", truck_at_methods);
+
+	TypedArray<Callable> plane_at_methods;
+	plane_at_methods.push_back(callable_mp_static(&compiled_method_fly_plane));
+	p_the_domain->add_unigoal_methods("plane_at", plane_at_methods);
+
+	TypedArray<Callable> at_methods;
+	at_methods.push_back(callable_mp_static(&compiled_method_load_truck));
+	at_methods.push_back(callable_mp_static(&compiled_method_unload_truck));
+	at_methods.push_back(callable_mp_static(&compiled_method_load_plane));
+	at_methods.push_back(callable_mp_static(&compiled_method_unload_plane));
+	at_methods.push_back(callable_mp_static(&compiled_method_move_within_city));
+	at_methods.push_back(callable_mp_static(&compiled_method_move_between_airports));
+	at_methods.push_back(callable_mp_static(&compiled_method_move_between_city));
+	p_the_domain->add_unigoal_methods("at", at_methods);
+}
+
 TEST_CASE("[Modules][GoalTaskPlanner] m_drive_truck") {
 	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
 	Ref<Domain> the_domain = Ref<Domain>(memnew(Domain));
@@ -600,6 +828,249 @@ TEST_CASE("[Modules][GoalTaskPlanner] Multigoal") {
 	CHECK_EQ(plan, answer);
 }
 
+TEST_CASE("[Modules][GoalTaskPlanner] Compiled Move Goal 2") {
+	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> the_domain = Ref<Domain>(memnew(Domain));
+	Dictionary state1;
+	before_each_compiled(state1, planner, the_domain);
+
+	Array task;
+	task.push_back(varray("at", "package1", "location10"));
+
+	Variant plan = planner->find_plan(state1, task);
+
+	Array answer;
+	answer.push_back(varray("drive_truck", "truck1", "location1"));
+	answer.push_back(varray("load_truck", "package1", "truck1"));
+	answer.push_back(varray("drive_truck", "truck1", "airport1"));
+	answer.push_back(varray("unload_truck", "package1", "airport1"));
+	answer.push_back(varray("fly_plane", "plane2", "airport1"));
+	answer.push_back(varray("load_plane", "package1", "plane2"));
+	answer.push_back(varray("fly_plane", "plane2", "airport2"));
+	answer.push_back(varray("unload_plane", "package1", "airport2"));
+	answer.push_back(varray("drive_truck", "truck6", "airport2"));
+	answer.push_back(varray("load_truck", "package1", "truck6"));
+	answer.push_back(varray("drive_truck", "truck6", "location10"));
+	answer.push_back(varray("unload_truck", "package1", "location10"));
+	CHECK_EQ(plan, answer);
+}
+
+TEST_CASE("[Modules][GoalTaskPlanner] Compiled run_lazy_lookahead") {
+	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> the_domain = Ref<Domain>(memnew(Domain));
+	Dictionary state;
+	before_each_compiled(state, planner, the_domain);
+	Array task;
+	task.push_back(varray("at", "package1", "location2"));
+	Dictionary final_state = planner->run_lazy_lookahead(state, task);
+
+	Dictionary at = final_state["at"];
+	Dictionary truck_at = final_state["truck_at"];
+	CHECK_EQ(at["package1"], Variant("location2"));
+	CHECK_EQ(truck_at["truck1"], Variant("location2"));
+	CHECK_EQ(final_state["in_city"], state["in_city"]);
+}
+
+TEST_CASE("[Modules][GoalTaskPlanner] Async Move Goal 2") {
+	Array task;
+	task.push_back(varray("at", "package1", "location10"));
+
+	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> the_domain = Ref<Domain>(memnew(Domain));
+	Dictionary state1;
+	before_each(state1, planner, the_domain);
+	Variant plan = planner->find_plan(state1, task);
+
+	Ref<PlanRequest> request = planner->find_plan_async(state1, task);
+	request->wait();
+	CHECK(request->is_done());
+	CHECK_EQ(request->get_status(), PlanRequest::STATUS_SUCCEEDED);
+	CHECK_EQ(request->get_result(), plan);
+	CHECK(request->get_expanded_nodes() > 0);
+
+	Ref<Plan> compiled_planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> compiled_domain = Ref<Domain>(memnew(Domain));
+	Dictionary state2;
+	before_each_compiled(state2, compiled_planner, compiled_domain);
+
+	request = compiled_planner->find_plan_async(state2, task);
+	request->wait();
+	CHECK_EQ(request->get_status(), PlanRequest::STATUS_SUCCEEDED);
+	CHECK_EQ(request->get_result(), plan);
+}
+
+static bool compiled_knock(PlannerState *p_state, String p_door) {
+	return p_state->get_value(SNAME("door"), p_door) == Variant("closed");
+}
+
+static Variant compiled_method_leave_careless(PlannerState *p_state, String p_door) {
+	// Writes from a method have to be dropped before its subtasks are planned.
+	p_state->set_value(SNAME("door"), p_door, "open");
+	return varray(varray("knock", p_door));
+}
+
+static Variant compiled_method_leave_never(PlannerState *p_state, String p_door) {
+	return false;
+}
+
+TEST_CASE("[Modules][GoalTaskPlanner] Async compiled branch drops method writes") {
+	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> the_domain = Ref<Domain>(memnew(Domain));
+	TypedArray<Domain> domains;
+	domains.push_back(the_domain);
+	planner->set_domains(domains);
+	planner->set_current_domain(the_domain);
+	Array doors;
+	doors.push_back("front");
+	the_domain->declare_state_variable("door", doors, Variant::STRING);
+	Dictionary actions;
+	actions["knock"] = callable_mp_static(&compiled_knock);
+	the_domain->set_actions(actions);
+	TypedArray<Callable> leave_methods;
+	leave_methods.push_back(callable_mp_static(&compiled_method_leave_careless));
+	leave_methods.push_back(callable_mp_static(&compiled_method_leave_never));
+	the_domain->add_task_methods("leave", leave_methods);
+
+	Dictionary door;
+	door["front"] = "closed";
+	Dictionary state;
+	state["door"] = door;
+	Array task;
+	task.push_back(varray("leave", "front"));
+	Variant plan = planner->find_plan(state.duplicate(true), task);
+	CHECK_EQ(plan, Variant(varray(varray("knock", "front"))));
+
+	// Each method of "leave" runs in its own branch.
+	planner->set_parallel_refinement(true);
+	Ref<PlanRequest> request = planner->find_plan_async(state, task);
+	request->wait();
+	CHECK_EQ(request->get_status(), PlanRequest::STATUS_SUCCEEDED);
+	CHECK_EQ(request->get_result(), plan);
+}
+
+TEST_CASE("[Modules][GoalTaskPlanner] Async cancel") {
+	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> the_domain = Ref<Domain>(memnew(Domain));
+	Dictionary state1;
+	before_each(state1, planner, the_domain);
+
+	Array task;
+	task.push_back(varray("at", "package1", "location10"));
+	task.push_back(varray("at", "package2", "location3"));
+
+	Ref<PlanRequest> request = planner->find_plan_async(state1, task);
+	request->cancel();
+	request->wait();
+	CHECK(request->is_done());
+	// The search may have finished before it saw the cancellation.
+	CHECK(request->get_status() != PlanRequest::STATUS_RUNNING);
+	CHECK(request->get_status() != PlanRequest::STATUS_FAILED);
+}
+
+TEST_CASE("[Modules][GoalTaskPlanner] Transposition table and iterative deepening") {
+	Array task;
+	task.push_back(varray("at", "package1", "location10"));
+	task.push_back(varray("at", "package2", "location3"));
+
+	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> the_domain = Ref<Domain>(memnew(Domain));
+	Dictionary state1;
+	before_each(state1, planner, the_domain);
+	Variant plan = planner->find_plan(state1.duplicate(true), task);
+	CHECK(plan.is_array());
+
+	planner->set_transposition_table_enabled(true);
+	CHECK_EQ(planner->find_plan(state1.duplicate(true), task), plan);
+	Dictionary stats = planner->get_search_stats();
+	CHECK(int64_t(stats["transposition_misses"]) > 0);
+
+	planner->set_iterative_deepening(true);
+	planner->reset_search_stats();
+	CHECK(planner->find_plan(state1.duplicate(true), task).is_array());
+	stats = planner->get_search_stats();
+	CHECK(int64_t(stats["deepening_iterations"]) > 1);
+
+	// A bound below the plan length cuts every branch off.
+	planner->set_iterative_deepening(false);
+	planner->set_max_depth(4);
+	CHECK_EQ(planner->find_plan(state1.duplicate(true), task), Variant(false));
+
+	Ref<Plan> compiled_planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> compiled_domain = Ref<Domain>(memnew(Domain));
+	Dictionary state2;
+	before_each_compiled(state2, compiled_planner, compiled_domain);
+	Variant compiled_plan = compiled_planner->find_plan(state2, task);
+	compiled_planner->set_transposition_table_enabled(true);
+	CHECK_EQ(compiled_planner->find_plan(state2, task), compiled_plan);
+	// Iterative deepening may find a shorter plan than the depth-first search.
+	compiled_planner->set_iterative_deepening(true);
+	CHECK(compiled_planner->find_plan(state2, task).is_array());
+}
+
+static Variant method_wander(Dictionary p_state) {
+	// Always refines into itself, so the search can only be cut off.
+	return varray(varray("wander"));
+}
+
+TEST_CASE("[Modules][GoalTaskPlanner] Iterative deepening stops on a cyclic domain") {
+	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> the_domain = Ref<Domain>(memnew(Domain));
+	TypedArray<Domain> domains;
+	domains.push_back(the_domain);
+	planner->set_domains(domains);
+	planner->set_current_domain(the_domain);
+	TypedArray<Callable> wander_methods;
+	wander_methods.push_back(callable_mp_static(&method_wander));
+	the_domain->add_task_methods("wander", wander_methods);
+
+	Array task;
+	task.push_back(varray("wander"));
+	planner->set_iterative_deepening(true);
+	CHECK_EQ(planner->find_plan(Dictionary(), task), Variant(false));
+	// 16, 32, ..., 1024.
+	CHECK_EQ(int64_t(planner->get_search_stats()["deepening_iterations"]), 7);
+
+	// An explicit bound replaces the default ceiling.
+	planner->reset_search_stats();
+	planner->set_max_depth(100);
+	CHECK_EQ(planner->find_plan(Dictionary(), task), Variant(false));
+	// 16, 32, 64, 100.
+	CHECK_EQ(int64_t(planner->get_search_stats()["deepening_iterations"]), 4);
+}
+
+TEST_CASE("[Modules][GoalTaskPlanner][Benchmark] Dictionary and compiled planning") {
+	const int iterations = 200;
+	Array task;
+	task.push_back(varray("at", "package1", "location10"));
+	task.push_back(varray("at", "package2", "location3"));
+
+	Ref<Plan> planner = Ref<Plan>(memnew(Plan));
+	Dictionary state;
+	before_each(state, planner, Ref<Domain>(memnew(Domain)));
+	Variant dictionary_plan;
+	uint64_t start_usec = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		dictionary_plan = planner->find_plan(state, task);
+	}
+	const uint64_t dictionary_usec = OS::get_singleton()->get_ticks_usec() - start_usec;
+
+	Ref<Plan> compiled_planner = Ref<Plan>(memnew(Plan));
+	Ref<Domain> compiled_domain = Ref<Domain>(memnew(Domain));
+	Dictionary compiled_state;
+	before_each_compiled(compiled_state, compiled_planner, compiled_domain);
+	Ref<PlannerState> planner_state = compiled_domain->create_state(compiled_state);
+	Variant compiled_plan;
+	start_usec = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		compiled_plan = compiled_planner->find_plan_from_state(planner_state, task);
+	}
+	const uint64_t compiled_usec = OS::get_singleton()->get_ticks_usec() - start_usec;
+
+	CHECK(dictionary_plan.is_array());
+	CHECK_EQ(compiled_plan, dictionary_plan);
+	MESSAGE(vformat("Logistics, %d plans: Dictionary states %d usec, compiled states %d usec.", iterations, dictionary_usec, compiled_usec));
+}
+
 } // namespace TestLogistics
 
 #endif // TEST_LOGISTICS_H
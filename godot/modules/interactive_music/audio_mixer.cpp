@@ -0,0 +1,124 @@
+/**************************************************************************/
+/*  audio_mixer.cpp                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "audio_mixer.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+void AudioMixer::clear(AudioFrame *r_dst, int p_frames) {
+	memset((void *)r_dst, 0, sizeof(AudioFrame) * p_frames);
+}
+
+void AudioMixer::scale(AudioFrame *r_buffer, float p_gain, int p_frames) {
+	float *buffer = &r_buffer->left;
+	const int count = p_frames * 2;
+	int i = 0;
+#if defined(__SSE2__)
+	const __m128 gain = _mm_set1_ps(p_gain);
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), gain));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 4 <= count; i += 4) {
+		vst1q_f32(buffer + i, vmulq_n_f32(vld1q_f32(buffer + i), p_gain));
+	}
+#endif
+	for (; i < count; i++) {
+		buffer[i] *= p_gain;
+	}
+}
+
+void AudioMixer::mix(AudioFrame *r_dst, const AudioFrame *p_src, float p_gain, int p_frames) {
+	float *dst = &r_dst->left;
+	const float *src = &p_src->left;
+	const int count = p_frames * 2;
+	int i = 0;
+#if defined(__SSE2__)
+	const __m128 gain = _mm_set1_ps(p_gain);
+	for (; i + 8 <= count; i += 8) {
+		__m128 a = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), gain));
+		__m128 b = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), gain));
+		_mm_storeu_ps(dst + i, a);
+		_mm_storeu_ps(dst + i + 4, b);
+	}
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), gain)));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 4 <= count; i += 4) {
+		vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), p_gain));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] += src[i] * p_gain;
+	}
+}
+
+void AudioMixer::mix_ramp(AudioFrame *r_dst, const AudioFrame *p_src, float p_from, float p_step, int p_frames) {
+	float *dst = &r_dst->left;
+	const float *src = &p_src->left;
+	int frame = 0;
+	// Gains are computed from the frame index rather than accumulated, so long
+	// ramps do not drift.
+#if defined(__SSE2__)
+	const __m128 from = _mm_set1_ps(p_from);
+	const __m128 step = _mm_set1_ps(p_step);
+	__m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+	const __m128 index_inc = _mm_set1_ps(2.0f);
+	for (; frame + 2 <= p_frames; frame += 2) {
+		const __m128 gain = _mm_add_ps(from, _mm_mul_ps(step, index));
+		float *d = dst + frame * 2;
+		_mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(_mm_loadu_ps(src + frame * 2), gain)));
+		index = _mm_add_ps(index, index_inc);
+	}
+#elif defined(__ARM_NEON)
+	const float32x4_t from = vdupq_n_f32(p_from);
+	static const float index_init[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+	float32x4_t index = vld1q_f32(index_init);
+	const float32x4_t index_inc = vdupq_n_f32(2.0f);
+	for (; frame + 2 <= p_frames; frame += 2) {
+		const float32x4_t gain = vmlaq_n_f32(from, index, p_step);
+		float *d = dst + frame * 2;
+		vst1q_f32(d, vmlaq_f32(vld1q_f32(d), vld1q_f32(src + frame * 2), gain));
+		index = vaddq_f32(index, index_inc);
+	}
+#endif
+	for (; frame < p_frames; frame++) {
+		const float gain = p_from + p_step * frame;
+		dst[frame * 2] += src[frame * 2] * gain;
+		dst[frame * 2 + 1] += src[frame * 2 + 1] * gain;
+	}
+}
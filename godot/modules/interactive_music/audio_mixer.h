@@ -0,0 +1,49 @@
+/**************************************************************************/
+/*  audio_mixer.h                                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include "core/math/audio_frame.h"
+
+// Block kernels shared by the interactive, synchronized and playlist
+// playbacks. AudioFrame is two packed floats, so the SIMD paths treat a block
+// as an array of 2 * p_frames floats.
+class AudioMixer {
+public:
+	static void clear(AudioFrame *r_dst, int p_frames);
+	static void scale(AudioFrame *r_buffer, float p_gain, int p_frames);
+	// r_dst += p_src * p_gain
+	static void mix(AudioFrame *r_dst, const AudioFrame *p_src, float p_gain, int p_frames);
+	// r_dst[i] += p_src[i] * (p_from + p_step * i)
+	static void mix_ramp(AudioFrame *r_dst, const AudioFrame *p_src, float p_from, float p_step, int p_frames);
+};
+
+#endif // AUDIO_MIXER_H
@@ -30,6 +30,7 @@
 
 #include "audio_stream_interactive.h"
 
+#include "audio_mixer.h"
 #include "core/math/math_funcs.h"
 #include "core/string/print_string.h"
 
@@ -614,6 +615,7 @@ void AudioStreamPlaybackInteractive::_queue(int p_to_clip_index, bool p_is_auto_
 		state.fade_volume = 1.0;
 		state.fade_speed = 0;
 		state.first_mix = true;
+		_schedule_fade(state);
 
 		state.playback->start(0);
 
@@ -847,6 +849,24 @@ void AudioStreamPlaybackInteractive::_queue(int p_to_clip_index, bool p_is_auto_
 
 		to_state.auto_advance = auto_advance_to;
 	}
+
+	// Turn the new fade parameters into per-frame envelopes once, rather than
+	// re-deriving them on every mixed frame.
+	for (int i = 0; i < stream->clip_count; i++) {
+		if (states[i].active) {
+			_schedule_fade(states[i]);
+		}
+	}
+}
+
+void AudioStreamPlaybackInteractive::_schedule_fade(State &p_state) {
+	p_state.fade_step = p_state.fade_speed / double(AudioServer::get_singleton()->get_mix_rate());
+	if (p_state.fade_step == 0.0) {
+		p_state.fade_ramp_frames = 0;
+		return;
+	}
+	double remaining = p_state.fade_step > 0.0 ? 1.0 - p_state.fade_volume : p_state.fade_volume;
+	p_state.fade_ramp_frames = MAX(1, int(Math::ceil(remaining / Math::abs(p_state.fade_step))));
 }
 
 void AudioStreamPlaybackInteractive::seek(double p_time) {
@@ -872,9 +892,7 @@ int AudioStreamPlaybackInteractive::mix(AudioFrame *p_buffer, float p_rate_scale
 	while (todo) {
 		int to_mix = MIN(todo, BUFFER_SIZE);
 		_mix_internal(to_mix);
-		for (int i = 0; i < to_mix; i++) {
-			p_buffer[i] = mix_buffer[i];
-		}
+		memcpy(p_buffer, mix_buffer, sizeof(AudioFrame) * to_mix);
 		p_buffer += to_mix;
 		todo -= to_mix;
 	}
@@ -883,9 +901,7 @@ int AudioStreamPlaybackInteractive::mix(AudioFrame *p_buffer, float p_rate_scale
 }
 
 void AudioStreamPlaybackInteractive::_mix_internal(int p_frames) {
-	for (int i = 0; i < p_frames; i++) {
-		mix_buffer[i] = AudioFrame(0, 0);
-	}
+	AudioMixer::clear(mix_buffer, p_frames);
 
 	for (int i = 0; i < stream->clip_count; i++) {
 		if (!states[i].active) {
@@ -926,37 +942,54 @@ void AudioStreamPlaybackInteractive::_mix_internal_state(int p_state_idx, int p_
 	state.previous_position = state.playback->get_playback_position();
 	state.playback->mix(temp_buffer + from_frame, 1.0, p_frames - from_frame);
 
-	double frame_fade_inc = state.fade_speed * frame_inc;
-	for (int i = from_frame; i < p_frames; i++) {
-		if (state.fade_wait) {
-			// This is for fade out of existing stream;
-			state.fade_wait -= frame_inc;
-			if (state.fade_wait < 0.0) {
-				state.fade_wait = 0.0;
-			}
-		} else if (frame_fade_inc > 0) {
-			state.fade_volume += frame_fade_inc;
-			if (state.fade_volume >= 1.0) {
-				state.fade_speed = 0.0;
-				frame_fade_inc = 0.0;
+	int frame = from_frame;
+	bool faded_out = false;
+
+	if (state.fade_wait > 0.0) {
+		// This is for fade out of existing stream, hold the volume until it kicks in.
+		int wait_frames = MIN(p_frames - frame, int(Math::ceil(state.fade_wait * mix_rate)));
+		if (state.fade_volume != 0.0) {
+			AudioMixer::mix(mix_buffer + frame, temp_buffer + frame, state.fade_volume, wait_frames);
+		}
+		state.fade_wait = MAX(0.0, state.fade_wait - wait_frames * frame_inc);
+		frame += wait_frames;
+	}
+
+	if (frame < p_frames && state.fade_ramp_frames > 0) {
+		// Ramp up to the frame that reaches the target volume.
+		int ramp_frames = MIN(p_frames - frame, state.fade_ramp_frames - 1);
+		if (ramp_frames > 0) {
+			AudioMixer::mix_ramp(mix_buffer + frame, temp_buffer + frame, state.fade_volume + state.fade_step, state.fade_step, ramp_frames);
+			state.fade_volume += state.fade_step * ramp_frames;
+			state.fade_ramp_frames -= ramp_frames;
+			frame += ramp_frames;
+		}
+		if (frame < p_frames) {
+			// This frame reaches the target.
+			bool fade_in = state.fade_step > 0.0;
+			state.fade_speed = 0.0;
+			state.fade_step = 0.0;
+			state.fade_ramp_frames = 0;
+			if (fade_in) {
 				state.fade_volume = 1.0;
 				queue_next = state.auto_advance;
-			}
-		} else if (frame_fade_inc < 0.0) {
-			state.fade_volume += frame_fade_inc;
-			if (state.fade_volume <= 0.0) {
-				state.fade_speed = 0.0;
-				frame_fade_inc = 0.0;
+			} else {
 				state.fade_volume = 0.0;
-				state.playback->stop(); // Stop playback and break, no point to continue mixing
-				break;
+				state.playback->stop(); // Stop playback, no point to continue mixing
+				faded_out = true;
 			}
 		}
+	}
 
-		mix_buffer[i] += temp_buffer[i] * state.fade_volume;
-		state.previous_position += frame_inc;
+	if (!faded_out && frame < p_frames) {
+		if (state.fade_volume != 0.0) {
+			AudioMixer::mix(mix_buffer + frame, temp_buffer + frame, state.fade_volume, p_frames - frame);
+		}
+		frame = p_frames;
 	}
 
+	state.previous_position += (frame - from_frame) * frame_inc;
+
 	if (!state.playback->is_playing()) {
 		// It finished because it either reached end or faded out, so deactivate and continue.
 		state.active = false;
@@ -222,11 +222,17 @@ private:
 		int auto_advance = -1;
 		bool first_mix = true;
 		double previous_position = 0;
+		// Fade envelope in frames, scheduled by _schedule_fade whenever a
+		// transition changes fade_volume or fade_speed.
+		double fade_step = 0; // Volume change per frame.
+		int fade_ramp_frames = 0; // Frames until the ramp reaches its target, 0 if not fading.
 
 		void reset_fade() {
 			fade_wait = 0;
 			fade_volume = 1.0;
 			fade_speed = 0;
+			fade_step = 0;
+			fade_ramp_frames = 0;
 		}
 	};
 
@@ -240,6 +246,7 @@ private:
 	void _mix_internal_state(int p_state_idx, int p_frames);
 
 	void _queue(int p_to_clip_index, bool p_is_auto_advance);
+	void _schedule_fade(State &p_state);
 
 	int switch_request = -1;
 
@@ -30,6 +30,7 @@
 
 #include "audio_stream_playlist.h"
 
+#include "audio_mixer.h"
 #include "core/math/math_funcs.h"
 #include "core/string/print_string.h"
 
@@ -277,7 +278,34 @@ int AudioStreamPlaybackPlaylist::mix(AudioFrame *p_buffer, float p_rate_scale, i
 
 		offset += time_dec * to_mix;
 
-		for (int i = 0; i < to_mix; i++) {
+		int i = 0;
+		while (i < to_mix) {
+			// Copy the frames that play before the current stream runs out in
+			// one go, with the previous stream fading out on top.
+			int run = 0;
+			double run_todo = stream_todo;
+			while (i + run < to_mix && run_todo - time_dec >= 0) {
+				run_todo -= time_dec;
+				run++;
+			}
+			if (run > 0) {
+				memcpy(p_buffer, mix_buffer + i, sizeof(AudioFrame) * run);
+				if (fade_index != -1) {
+					int fade_frames = MIN(run, MAX(1, int(Math::ceil(fade_volume / fade_dec))));
+					AudioMixer::mix_ramp(p_buffer, fade_buffer + i, fade_volume, -fade_dec, fade_frames);
+					fade_volume -= fade_dec * fade_frames;
+					if (fade_volume <= 0.0) {
+						playback[fade_index]->stop();
+						fade_index = -1;
+					}
+				}
+				stream_todo = run_todo;
+				p_buffer += run;
+				i += run;
+				continue;
+			}
+
+			// The current stream ends on this frame.
 			*p_buffer = mix_buffer[i];
 			stream_todo -= time_dec;
 			if (stream_todo < 0) {
@@ -362,6 +390,7 @@ int AudioStreamPlaybackPlaylist::mix(AudioFrame *p_buffer, float p_rate_scale, i
 			}
 
 			p_buffer++;
+			i++;
 		}
 
 		todo -= to_mix;
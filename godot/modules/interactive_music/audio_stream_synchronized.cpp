@@ -30,6 +30,7 @@
 
 #include "audio_stream_synchronized.h"
 
+#include "audio_mixer.h"
 #include "core/math/math_funcs.h"
 #include "core/string/print_string.h"
 
@@ -232,25 +233,21 @@ int AudioStreamPlaybackSynchronized::mix(AudioFrame *p_buffer, float p_rate_scal
 				float volume = Math::db_to_linear(stream->audio_stream_volume_db[i]);
 				if (first) {
 					playback[i]->mix(p_buffer, p_rate_scale, to_mix);
-					for (int j = 0; j < to_mix; j++) {
-						p_buffer[j] *= volume;
+					if (volume != 1.0f) {
+						AudioMixer::scale(p_buffer, volume, to_mix);
 					}
 					first = false;
 					any_active = true;
 				} else {
 					playback[i]->mix(mix_buffer, p_rate_scale, to_mix);
-					for (int j = 0; j < to_mix; j++) {
-						p_buffer[j] += mix_buffer[j] * volume;
-					}
+					AudioMixer::mix(p_buffer, mix_buffer, volume, to_mix);
 				}
 			}
 		}
 
 		if (first) {
 			// Nothing mixed, put zeroes.
-			for (int j = 0; j < to_mix; j++) {
-				p_buffer[j] = AudioFrame(0, 0);
-			}
+			AudioMixer::clear(p_buffer, to_mix);
 		}
 
 		p_buffer += to_mix;
@@ -29,9 +29,17 @@
 /**************************************************************************/
 
 #include "lasso.h"
+#include <core/config/engine.h>
 #include <core/math/math_defs.h>
 #include <servers/xr_server.h>
 
+// Points moving less than this distance keep their box in the BVH.
+static const real_t POSITION_MARGIN = 0.05;
+// Half angles of the cones tried before falling back to scoring every point.
+static const real_t SNAPPING_CONE_ANGLES[] = { Math_PI / 12.0, Math_PI / 4.0 };
+// Points more than this angle away from the snapped point can't be redirected to.
+static const real_t REDIRECTING_CONE_ANGLE = Math_PI / 4.0;
+
 LassoPoint::LassoPoint() {};
 
 LassoPoint::~LassoPoint() {
@@ -59,6 +67,14 @@ void LassoPoint::_bind_methods() {
 			&LassoPoint::register_point);
 	ClassDB::bind_method(D_METHOD("unregister_point"),
 			&LassoPoint::unregister_point);
+	ClassDB::bind_method(D_METHOD("update_position"),
+			&LassoPoint::update_position);
+}
+
+void LassoPoint::_update_database() {
+	if (indexing_database) {
+		indexing_database->_update_point_data(database_index);
+	}
 }
 
 void LassoPoint::set_snap_locked(bool p_enable) {
@@ -84,6 +100,12 @@ void LassoPoint::unregister_point() {
 	database.unref();
 }
 
+void LassoPoint::update_position() {
+	if (indexing_database && origin != nullptr) {
+		indexing_database->_set_point_position(database_index, get_origin_pos());
+	}
+}
+
 float LassoPoint::get_snap_score() {
 	return last_snap_score;
 }
@@ -112,18 +134,21 @@ Node *LassoPoint::get_origin() {
 }
 void LassoPoint::enable_snapping(bool on) {
 	snapping_enabled = on;
+	_update_database();
 }
 bool LassoPoint::get_snapping_enabled() {
 	return snapping_enabled;
 }
 void LassoPoint::set_size(float p_size) {
 	size = p_size;
+	_update_database();
 }
 float LassoPoint::get_size() {
 	return size;
 }
 void LassoPoint::set_snapping_power(float p_snapping_power) {
 	snapping_power = p_snapping_power;
+	_update_database();
 }
 float LassoPoint::get_snapping_power() {
 	return snapping_power;
@@ -131,12 +156,25 @@ float LassoPoint::get_snapping_power() {
 
 LassoDB::LassoDB() {}
 
-LassoDB::~LassoDB() {}
+LassoDB::~LassoDB() {
+	for (uint32_t i = 0; i < points.size(); i++) {
+		bvh.remove(bvh_ids[i]);
+		points[i]->indexing_database = nullptr;
+	}
+}
 
 void LassoDB::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("add_point", "point"), &LassoDB::add_point);
 	ClassDB::bind_method(D_METHOD("remove_point", "point"),
 			&LassoDB::remove_point);
+	ClassDB::bind_method(D_METHOD("update_positions"),
+			&LassoDB::update_positions);
+	ClassDB::bind_method(D_METHOD("set_auto_update_positions", "p_enable"),
+			&LassoDB::set_auto_update_positions);
+	ClassDB::bind_method(D_METHOD("get_auto_update_positions"),
+			&LassoDB::get_auto_update_positions);
+	ClassDB::bind_method(D_METHOD("get_point_count"),
+			&LassoDB::get_point_count);
 	ClassDB::bind_method(D_METHOD("calc_top_two_snapping_power", "source",
 								 "current_snap",
 								 "snap_max_power_increase",
@@ -145,68 +183,333 @@ void LassoDB::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("calc_top_redirecting_power", "snapped_point",
 								 "viewpoint", "redirection_direction"),
 			&LassoDB::calc_top_redirecting_power);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "auto_update_positions"),
+			"set_auto_update_positions", "get_auto_update_positions");
 }
+
 void LassoDB::add_point(Ref<LassoPoint> point) {
-	if (point.is_valid() && !points.has(point)) {
-		points.append(point);
+	if (point.is_null()) {
+		return;
 	}
+	if (point->indexing_database == this) {
+		// Registered again, possibly with another origin.
+		origins[point->database_index] = point->origin;
+		_set_point_position(point->database_index, point->get_origin_pos());
+		return;
+	}
+	ERR_FAIL_COND_MSG(point->indexing_database != nullptr, "The point is already added to another LassoDB.");
+
+	const uint32_t index = points.size();
+	point->indexing_database = this;
+	point->database_index = index;
+	points.push_back(point);
+	origins.push_back(point->origin);
+	positions.push_back(point->get_origin_pos());
+	sizes.push_back(0.0);
+	snapping_powers.push_back(0.0);
+	snapping_enabled.push_back(false);
+	query_stamps.push_back(0);
+	_update_point_data(index);
+
+	const AABB box = AABB(positions[index], Vector3()).grow(POSITION_MARGIN);
+	bvh_ids.push_back(bvh.insert(box, point.ptr()));
+	bvh_boxes.push_back(box);
+	bounds = index == 0 ? box : bounds.merge(box);
 }
 
 void LassoDB::remove_point(Ref<LassoPoint> point) {
-	int index = points.find(point);
-	if (index >= 0) {
-		points.remove_at(index);
+	if (point.is_null() || point->indexing_database != this) {
+		return;
+	}
+	const uint32_t index = point->database_index;
+	const uint32_t last = points.size() - 1;
+	bvh.remove(bvh_ids[index]);
+	point->indexing_database = nullptr;
+	point->last_snap_score = 0.0;
+	if (index != last) {
+		points[index] = points[last];
+		origins[index] = origins[last];
+		positions[index] = positions[last];
+		sizes[index] = sizes[last];
+		snapping_powers[index] = snapping_powers[last];
+		snapping_enabled[index] = snapping_enabled[last];
+		query_stamps[index] = query_stamps[last];
+		bvh_ids[index] = bvh_ids[last];
+		bvh_boxes[index] = bvh_boxes[last];
+		points[index]->database_index = index;
+	}
+	points.resize(last);
+	origins.resize(last);
+	positions.resize(last);
+	sizes.resize(last);
+	snapping_powers.resize(last);
+	snapping_enabled.resize(last);
+	query_stamps.resize(last);
+	bvh_ids.resize(last);
+	bvh_boxes.resize(last);
+	max_snapping_power_dirty = true;
+}
+
+void LassoDB::_update_point_data(uint32_t p_index) {
+	const LassoPoint *point = points[p_index].ptr();
+	sizes[p_index] = point->size;
+	snapping_powers[p_index] = point->snapping_power;
+	snapping_enabled[p_index] = point->snapping_enabled;
+	if (point->snapping_power >= max_snapping_power) {
+		max_snapping_power = point->snapping_power;
+	} else {
+		max_snapping_power_dirty = true;
+	}
+}
+
+void LassoDB::_set_point_position(uint32_t p_index, const Vector3 &p_position) {
+	positions[p_index] = p_position;
+	if (bvh_boxes[p_index].has_point(p_position)) {
+		return;
 	}
+	const AABB box = AABB(p_position, Vector3()).grow(POSITION_MARGIN);
+	bvh.update(bvh_ids[p_index], box);
+	bvh_boxes[p_index] = box;
+	bounds = bounds.merge(box);
+}
+
+void LassoDB::update_positions() {
+	for (uint32_t i = 0; i < points.size(); i++) {
+		if (origins[i] != nullptr) {
+			_set_point_position(i, origins[i]->get_global_transform().origin);
+		}
+	}
+}
+
+void LassoDB::_refresh_positions() {
+	if (!auto_update_positions) {
+		return;
+	}
+	// Queries of the same frame share one update, the hands usually query several times per frame.
+	const uint64_t process_frame = Engine::get_singleton()->get_process_frames();
+	const uint64_t physics_frame = Engine::get_singleton()->get_physics_frames();
+	if (process_frame == last_update_process_frame && physics_frame == last_update_physics_frame) {
+		return;
+	}
+	last_update_process_frame = process_frame;
+	last_update_physics_frame = physics_frame;
+	update_positions();
+}
+
+void LassoDB::set_auto_update_positions(bool p_enable) {
+	auto_update_positions = p_enable;
+	last_update_process_frame = UINT64_MAX;
+	last_update_physics_frame = UINT64_MAX;
+}
+
+bool LassoDB::get_auto_update_positions() const {
+	return auto_update_positions;
+}
+
+int LassoDB::get_point_count() const {
+	return points.size();
+}
+
+float LassoDB::_get_max_snapping_power() {
+	if (max_snapping_power_dirty) {
+		max_snapping_power = 0.0;
+		for (uint32_t i = 0; i < snapping_powers.size(); i++) {
+			max_snapping_power = MAX(max_snapping_power, snapping_powers[i]);
+		}
+		max_snapping_power_dirty = false;
+	}
+	return max_snapping_power;
+}
+
+void LassoDB::_set_snap_score(uint32_t p_index, float p_score) {
+	points[p_index]->set_snap_score(p_score);
+	scored_indices.push_back(p_index);
+}
+
+void LassoDB::_reset_snap_scores() {
+	// Points that are not scored by this query would otherwise keep the score of an older one.
+	for (const uint32_t index : scored_indices) {
+		if (index < points.size()) {
+			points[index]->set_snap_score(0.0);
+		}
+	}
+	scored_indices.clear();
+}
+
+bool LassoDB::_is_candidate(uint32_t p_index) const {
+	return snapping_enabled[p_index] && points[p_index]->valid_origin();
+}
+
+float LassoDB::_calc_snapping_power(uint32_t p_index, const Transform3D &p_source) const {
+	Vector3 point_local = p_source.xform_inv(positions[p_index]);
+	float euclidian_dist = point_local.length();
+	float angular_dist = point_local.angle_to(Vector3(0, 0, -1));
+	float rejection_length =
+			Vector3(point_local[0], point_local[1], 0).length();
+
+	if (rejection_length <= sizes[p_index]) {
+		return snapping_powers[p_index] / (1.0 + euclidian_dist) /
+				(0.01 + angular_dist);
+	}
+	return snapping_powers[p_index] / (1.0 + euclidian_dist) /
+			(0.1 + angular_dist);
+}
+
+bool LassoDB::IndexQuery::operator()(void *p_data) {
+	indices->push_back(static_cast<LassoPoint *>(p_data)->database_index);
+	return false;
+}
+
+void LassoDB::_query_cone(const Vector3 &p_apex, const Vector3 &p_axis, real_t p_half_angle) {
+	// A square pyramid around the cone, cut off past the farthest point of the database.
+	real_t far_distance = 0.0;
+	for (int i = 0; i < 8; i++) {
+		far_distance = MAX(far_distance, p_apex.distance_to(bounds.get_endpoint(i)));
+	}
+	far_distance += POSITION_MARGIN;
+
+	const Vector3 forward = p_axis.normalized();
+	const Vector3 right = forward.cross(Math::abs(forward.y) < 0.9 ? Vector3(0, 1, 0) : Vector3(1, 0, 0)).normalized();
+	const Vector3 up = forward.cross(right);
+	const real_t sine = Math::sin(p_half_angle);
+	const real_t cosine = Math::cos(p_half_angle);
+	const real_t spread = far_distance * Math::tan(p_half_angle);
+
+	const Plane planes[5] = {
+		Plane(right * cosine - forward * sine, p_apex),
+		Plane(-right * cosine - forward * sine, p_apex),
+		Plane(up * cosine - forward * sine, p_apex),
+		Plane(-up * cosine - forward * sine, p_apex),
+		Plane(forward, p_apex + forward * far_distance),
+	};
+	const Vector3 far_center = p_apex + forward * far_distance;
+	const Vector3 hull_points[5] = {
+		p_apex,
+		far_center + (right + up) * spread,
+		far_center + (right - up) * spread,
+		far_center + (-right + up) * spread,
+		far_center + (-right - up) * spread,
+	};
+
+	query_indices.clear();
+	IndexQuery query;
+	query.indices = &query_indices;
+	bvh.convex_query(planes, 5, hull_points, 5, query);
+}
+
+void LassoDB::_query_box(const AABB &p_box) {
+	query_indices.clear();
+	IndexQuery query;
+	query.indices = &query_indices;
+	bvh.aabb_query(p_box, query);
 }
 
 Array LassoDB::calc_top_two_snapping_power(Transform3D source, Node *current_snap,
 		float snap_max_power_increase,
 		float snap_increase_amount,
 		bool snap_lock) {
-	Array output;
-	Ref<LassoPoint> first;
-	Ref<LassoPoint> second;
-	for (int i = 0; i < points.size(); i++) {
-		Ref<LassoPoint> next = points[i];
-		if (next.is_valid() && next->valid_origin() && next->snapping_enabled) {
-			Vector3 point_local = source.xform_inv(next->get_origin_pos());
-			float euclidian_dist = point_local.length();
-			float angular_dist = point_local.angle_to(Vector3(0, 0, -1));
-			float rejection_length =
-					Vector3(point_local[0], point_local[1], 0).length();
-
-			float snapping_power = 0;
-			if (rejection_length <= next->size) {
-				snapping_power = next->snapping_power / (1.0 + euclidian_dist) /
-								 (0.01 + angular_dist);
-			} else {
-				snapping_power = next->snapping_power / (1.0 + euclidian_dist) /
-								 (0.1 + angular_dist);
+	_refresh_positions();
+	_reset_snap_scores();
+
+	int64_t current = -1;
+	float current_score = 0.0;
+	if (current_snap != nullptr) {
+		for (uint32_t i = 0; i < points.size(); i++) {
+			if (origins[i] == current_snap && _is_candidate(i)) {
+				current = i;
+				break;
 			}
+		}
+	}
+	if (current >= 0) {
+		current_score = _calc_snapping_power(current, source);
+		current_score += current_score * pow(snap_increase_amount, 2) *
+				snap_max_power_increase;
+		_set_snap_score(current, current_score);
+		if (points[current]->snap_locked && snap_lock) {
+			Array output;
+			output.push_back(points[current]);
+			output.push_back(Ref<LassoPoint>());
+			return output;
+		}
+	}
+
+	int64_t first = -1;
+	int64_t second = -1;
+	float first_score = 0.0;
+	float second_score = 0.0;
+	auto consider = [&](int64_t p_index, float p_score) {
+		if (first < 0 || first_score < p_score) {
+			second = first;
+			second_score = first_score;
+			first = p_index;
+			first_score = p_score;
+		} else if (second < 0 || second_score < p_score) {
+			second = p_index;
+			second_score = p_score;
+		}
+	};
 
-			if (next->matching_origin(current_snap)) {
-				snapping_power += snapping_power * pow(snap_increase_amount, 2) *
-								  snap_max_power_increase;
-				if (next->snap_locked && snap_lock) {
-					next->set_snap_score(snapping_power);
-					first = next;
-					second.unref();
-					break;
+	// A point at distance d and angle a from the pointing direction scores at most
+	// max_snapping_power / ((1 + d) * (0.01 + a)). After scoring the points inside a
+	// cone of half angle theta, the only other points that can beat the second best
+	// score are within the distance where that bound falls below it, so a box query
+	// of that radius completes the search.
+	bool resolved = false;
+	if (source.basis.is_orthonormal() && !points.is_empty()) {
+		const Vector3 forward = -source.basis.get_column(2);
+		auto score_indices = [&]() {
+			for (const uint32_t index : query_indices) {
+				if (query_stamps[index] == query_stamp || index == current || !_is_candidate(index)) {
+					continue;
 				}
+				query_stamps[index] = query_stamp;
+				const float score = _calc_snapping_power(index, source);
+				_set_snap_score(index, score);
+				consider(index, score);
+			}
+		};
+		for (const real_t half_angle : SNAPPING_CONE_ANGLES) {
+			first = -1;
+			second = -1;
+			if (current >= 0) {
+				consider(current, current_score);
+			}
+			query_stamp++;
+			_query_cone(source.origin, forward, half_angle);
+			score_indices();
+			if (second < 0 || second_score <= 0.0) {
+				continue;
 			}
-			next->set_snap_score(snapping_power);
-
-			if (first.is_null() || first->get_snap_score() < next->get_snap_score()) {
-				second = first;
-				first = next;
-			} else if (second.is_null() ||
-					   second->get_snap_score() < next->get_snap_score()) {
-				second = next;
+			const real_t radius = _get_max_snapping_power() / (second_score * (0.01 + half_angle)) - 1.0;
+			if (radius > 0.0) {
+				_query_box(AABB(source.origin - Vector3(radius, radius, radius), Vector3(radius, radius, radius) * 2.0));
+				score_indices();
 			}
+			resolved = true;
+			break;
 		}
 	}
-	output.push_back(first);
-	output.push_back(second);
+
+	if (!resolved) {
+		first = -1;
+		second = -1;
+		if (current >= 0) {
+			consider(current, current_score);
+		}
+		for (uint32_t i = 0; i < points.size(); i++) {
+			if (i == current || !_is_candidate(i)) {
+				continue;
+			}
+			const float score = _calc_snapping_power(i, source);
+			_set_snap_score(i, score);
+			consider(i, score);
+		}
+	}
+
+	Array output;
+	output.push_back(first >= 0 ? points[first] : Ref<LassoPoint>());
+	output.push_back(second >= 0 ? points[second] : Ref<LassoPoint>());
 	return output;
 }
 
@@ -230,15 +533,24 @@ Node *LassoDB::calc_top_redirecting_power(Node *snapped_origin,
 		Basis local_basis =
 				Basis(x_vector, y_vector,
 						z_vector); // ITS FUCKING TRANSPOSED BY DEFAULT. WHY!?
-		Ref<LassoPoint> first;
+		int64_t first = -1;
 		float redirect_power = INFINITY; // The lower is better.
-		for (int i = 0; i < points.size(); i++) {
-			Ref<LassoPoint> next = points[i];
+		// Only points within 45 degrees of the snapped point can be redirected to, so
+		// when the snapped point gives a direction only that cone is searched.
+		_refresh_positions();
+		if (snapped_vector.is_zero_approx() || points.is_empty()) {
+			query_indices.clear();
+			for (uint32_t i = 0; i < points.size(); i++) {
+				query_indices.push_back(i);
+			}
+		} else {
+			_query_cone(viewpoint.origin, -z_vector, REDIRECTING_CONE_ANGLE);
+		}
+		for (const uint32_t index : query_indices) {
 			float next_power = 0;
-			if (next.is_valid() && next->valid_origin() &&
-					!next->matching_origin(snapped_origin_Node3D)) {
-				Vector3 point_vector = viewpoint.origin - next->get_origin_pos();
-				if (point_vector.angle_to(snapped_vector) < Math_PI / 4.0) {
+			if (_is_candidate(index) && origins[index] != snapped_origin_Node3D) {
+				Vector3 point_vector = viewpoint.origin - positions[index];
+				if (point_vector.angle_to(snapped_vector) < REDIRECTING_CONE_ANGLE) {
 					Vector3 point_xyz = local_basis.xform(point_vector);
 					Vector2 point_xy = Vector2(point_xyz[0], -point_xyz[1]);
 
@@ -282,13 +594,13 @@ Node *LassoDB::calc_top_redirecting_power(Node *snapped_origin,
 					}
 					if (next_power < redirect_power) {
 						redirect_power = next_power;
-						first = next;
+						first = index;
 					}
 				}
 			}
 		}
-		if (first.is_valid() && first->valid_origin()) {
-			output = first->get_origin();
+		if (first >= 0) {
+			output = origins[first];
 		}
 	}
 	return output;
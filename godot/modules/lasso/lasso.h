@@ -32,8 +32,10 @@
 #define LASSO_H
 #ifndef _3D_DISABLED
 
+#include "core/math/dynamic_bvh.h"
 #include "core/object/object.h"
 #include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
 #include "core/variant/variant.h"
 #include "scene/3d/node_3d.h"
 
@@ -44,10 +46,15 @@ class LassoDB;
 
 class LassoPoint : public RefCounted {
 	GDCLASS(LassoPoint, RefCounted);
+	friend class LassoDB;
 
 	Node3D *origin = nullptr;
 	float last_snap_score = 0.0;
 	Ref<LassoDB> database;
+	// Set by the LassoDB that stores this point's data.
+	LassoDB *indexing_database = nullptr;
+	uint32_t database_index = 0;
+	void _update_database();
 
 public:
 	float snapping_power = 1.0;
@@ -58,6 +65,7 @@ public:
 	~LassoPoint();
 	void register_point(Ref<LassoDB> p_database, Node *p_origin);
 	void unregister_point();
+	void update_position();
 	float get_snap_score();
 	void set_snap_score(float score);
 	Vector3 get_origin_pos();
@@ -77,14 +85,63 @@ public:
 
 class LassoDB : public RefCounted {
 	GDCLASS(LassoDB, RefCounted);
+	friend class LassoPoint;
 
-	Array points;
+	// Point data is stored contiguously and indexed by LassoPoint::database_index.
+	// Removing a point moves the last point into its slot.
+	LocalVector<Ref<LassoPoint>> points;
+	LocalVector<Node3D *> origins;
+	LocalVector<Vector3> positions;
+	LocalVector<float> sizes;
+	LocalVector<float> snapping_powers;
+	LocalVector<bool> snapping_enabled;
+
+	// Positions are indexed by a BVH of slightly enlarged boxes, so points moving
+	// less than the margin don't touch the tree.
+	DynamicBVH bvh;
+	LocalVector<DynamicBVH::ID> bvh_ids;
+	LocalVector<AABB> bvh_boxes;
+	AABB bounds;
+	LocalVector<uint32_t> query_indices;
+	// Points already scored by the current query carry its stamp.
+	LocalVector<uint32_t> query_stamps;
+	uint32_t query_stamp = 0;
+	// Points given a score by the last query, reset by the next one.
+	LocalVector<uint32_t> scored_indices;
+
+	float max_snapping_power = 0.0;
+	bool max_snapping_power_dirty = false;
+
+	// Polling every origin each frame costs as much as the query it saves, so moving
+	// points are updated by their owner unless this is enabled.
+	bool auto_update_positions = false;
+	uint64_t last_update_process_frame = UINT64_MAX;
+	uint64_t last_update_physics_frame = UINT64_MAX;
+
+	void _update_point_data(uint32_t p_index);
+	void _set_point_position(uint32_t p_index, const Vector3 &p_position);
+	void _refresh_positions();
+	void _set_snap_score(uint32_t p_index, float p_score);
+	void _reset_snap_scores();
+	float _get_max_snapping_power();
+	bool _is_candidate(uint32_t p_index) const;
+	float _calc_snapping_power(uint32_t p_index, const Transform3D &p_source) const;
+	struct IndexQuery {
+		LocalVector<uint32_t> *indices = nullptr;
+		bool operator()(void *p_data);
+	};
+	void _query_cone(const Vector3 &p_apex, const Vector3 &p_axis, real_t p_half_angle);
+	void _query_box(const AABB &p_box);
 
 public:
 	LassoDB();
 	~LassoDB();
 	void add_point(Ref<LassoPoint> point);
 	void remove_point(Ref<LassoPoint> point);
+	void update_positions();
+	void set_auto_update_positions(bool p_enable);
+	bool get_auto_update_positions() const;
+	int get_point_count() const;
 	Array calc_top_two_snapping_power(Transform3D source, Node *current_snap, float snap_max_power_increase, float snap_increase_amount, bool snap_lock);
 	Node *calc_top_redirecting_power(Node *snapped_point, Transform3D viewpoint, Vector2 redirection_direction);
 	static void _bind_methods();
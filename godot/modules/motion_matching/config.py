@@ -19,6 +19,7 @@ def get_doc_classes():
         "MMTrajectoryFeature",
         "MMAnimationNode",
         "MMQueryInput",
+        "MMQueryScheduler",
     ]
 
 
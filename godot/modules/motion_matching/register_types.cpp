@@ -51,8 +51,13 @@
 #include "mm_animation_library.h"
 #include "mm_animation_node.h"
 #include "mm_query.h"
+#include "mm_query_scheduler.h"
 #include "mm_trajectory_point.h"
 
+#include "core/config/engine.h"
+
+static MMQueryScheduler* _query_scheduler = nullptr;
+
 void initialize_motion_matching_module(ModuleInitializationLevel p_level) {
     if (p_level == MODULE_INITIALIZATION_LEVEL_SCENE) {
         ClassDB::register_abstract_class<MMFeature>();
@@ -63,6 +68,10 @@ void initialize_motion_matching_module(ModuleInitializationLevel p_level) {
         ClassDB::register_class<MMAnimationNode>();
         ClassDB::register_class<MMQueryInput>();
 
+        ClassDB::register_abstract_class<MMQueryScheduler>();
+        _query_scheduler = memnew(MMQueryScheduler);
+        Engine::get_singleton()->add_singleton(Engine::Singleton("MMQueryScheduler", MMQueryScheduler::get_singleton()));
+
         ClassDB::register_class<MMCharacter>();
 
         ClassDB::register_class<DampedSkeletonModifier>();
@@ -78,4 +87,10 @@ void initialize_motion_matching_module(ModuleInitializationLevel p_level) {
 }
 
 void uninitialize_motion_matching_module(ModuleInitializationLevel p_level) {
+    if (p_level == MODULE_INITIALIZATION_LEVEL_SCENE) {
+        if (_query_scheduler) {
+            memdelete(_query_scheduler);
+            _query_scheduler = nullptr;
+        }
+    }
 }
@@ -31,49 +31,61 @@
 #ifndef CIRCULAR_BUFFER_H
 #define CIRCULAR_BUFFER_H
 
+#include <algorithm>
 #include <cstddef>
-#include <deque>
 #include <vector>
 
+// Fixed-capacity ring buffer. Storage is allocated up front, so pushing never
+// allocates; once full, pushing drops the oldest item.
 template <typename T>
 class CircularBuffer {
 
 private:
-    std::deque<T> buffer;
+    std::vector<T> buffer;
     size_t max_size;
+    size_t head = 0;
+    size_t count = 0;
 
 public:
     explicit CircularBuffer(size_t size)
-        : max_size(size) {
+        : buffer(size), max_size(size) {
     }
 
     void clear() {
-        buffer.clear();
+        head = 0;
+        count = 0;
     }
 
     void push(T item) {
-        if (buffer.size() == max_size) {
-            buffer.pop_front();
+        if (max_size == 0) {
+            return;
         }
-        buffer.push_back(item);
+        if (count == max_size) {
+            buffer[head] = item;
+            head = (head + 1) % max_size;
+            return;
+        }
+        buffer[(head + count) % max_size] = item;
+        count++;
     }
 
     T pop() {
-        T val = buffer.front();
-        buffer.pop_front();
+        T val = buffer[head];
+        head = (head + 1) % max_size;
+        count--;
         return val;
     }
 
     bool empty() const {
-        return buffer.empty();
+        return count == 0;
     }
 
     bool is_full() const {
-        return buffer.size() == max_size;
+        return count == max_size;
     }
 
     bool is_empty() const {
-        return buffer.empty();
+        return count == 0;
     }
 
     size_t capacity() const {
@@ -81,26 +93,36 @@ public:
     }
 
     size_t size() const {
-        return buffer.size();
+        return count;
     }
 
     void resize(size_t size) {
-        max_size = size;
-        while (buffer.size() > max_size) {
-            buffer.pop_front();
+        std::vector<T> items = to_vector();
+        if (items.size() > size) {
+            items.erase(items.begin(), items.begin() + (items.size() - size));
         }
+        buffer = std::vector<T>(size);
+        std::copy(items.begin(), items.end(), buffer.begin());
+        max_size = size;
+        head = 0;
+        count = items.size();
     }
 
     T& operator[](size_t index) {
-        return buffer[index];
+        return buffer[(head + index) % max_size];
     }
 
     const T& operator[](size_t index) const {
-        return buffer[index];
+        return buffer[(head + index) % max_size];
     }
 
     std::vector<T> to_vector() const {
-        return std::vector<T>(buffer.begin(), buffer.end());
+        std::vector<T> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            result.push_back((*this)[i]);
+        }
+        return result;
     }
 };
 #endif // CIRCULAR_BUFFER_H
@@ -40,6 +40,17 @@
         variable = value;             \
     }
 
+// Same as GETSET, but calls on_changed() after the value is set.
+#define GETSET_CHANGED(type, variable, on_changed, ...) \
+    type variable{__VA_ARGS__};                         \
+    type get_##variable() const {                       \
+        return variable;                                \
+    }                                                   \
+    void set_##variable(type value) {                   \
+        variable = value;                               \
+        on_changed();                                   \
+    }
+
 #define STR(x) #x
 
 #define STRING_PREFIX(prefix, s) STR(prefix##s)
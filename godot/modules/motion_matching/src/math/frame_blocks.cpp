@@ -0,0 +1,131 @@
+/**************************************************************************/
+/*  frame_blocks.cpp                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "frame_blocks.h"
+
+#include "core/os/memory.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+FrameBlocks::~FrameBlocks() {
+    clear();
+}
+
+void FrameBlocks::build(const float* p_data, int64_t p_frame_count, int64_t p_dim_count, const int32_t* p_order) {
+    clear();
+    if (p_frame_count <= 0 || p_dim_count <= 0) {
+        return;
+    }
+
+    frame_count = p_frame_count;
+    dim_count = p_dim_count;
+    if (p_order) {
+        order.resize(p_frame_count);
+        memcpy(order.ptr(), p_order, p_frame_count * sizeof(int32_t));
+    }
+
+    const size_t size = get_block_count() * dim_count * LANES * sizeof(float);
+    data = static_cast<float*>(Memory::alloc_aligned_static(size, ALIGNMENT));
+    memset(data, 0, size);
+
+    for (int64_t slot = 0; slot < frame_count; ++slot) {
+        const float* frame = p_data + get_frame_index(slot) * dim_count;
+        float* block = data + (slot / LANES) * dim_count * LANES;
+        const int64_t lane = slot % LANES;
+        for (int64_t d = 0; d < dim_count; ++d) {
+            block[d * LANES + lane] = frame[d];
+        }
+    }
+}
+
+void FrameBlocks::clear() {
+    if (data) {
+        Memory::free_aligned_static(data);
+        data = nullptr;
+    }
+    frame_count = 0;
+    dim_count = 0;
+    order.clear();
+}
+
+void FrameBlocks::score(const float* p_query, const float* p_weights, int64_t p_first_block, int64_t p_block_count, float* r_costs) const {
+    for (int64_t b = 0; b < p_block_count; ++b) {
+        const float* block = data + (p_first_block + b) * dim_count * LANES;
+        float* costs = r_costs + b * LANES;
+#if defined(__AVX__)
+        __m256 acc = _mm256_setzero_ps();
+        for (int64_t d = 0; d < dim_count; ++d) {
+            const __m256 diff = _mm256_sub_ps(_mm256_load_ps(block + d * LANES), _mm256_set1_ps(p_query[d]));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_mul_ps(diff, diff), _mm256_set1_ps(p_weights[d])));
+        }
+        _mm256_storeu_ps(costs, acc);
+#elif defined(__SSE2__)
+        __m128 acc_lo = _mm_setzero_ps();
+        __m128 acc_hi = _mm_setzero_ps();
+        for (int64_t d = 0; d < dim_count; ++d) {
+            const __m128 query = _mm_set1_ps(p_query[d]);
+            const __m128 weight = _mm_set1_ps(p_weights[d]);
+            const __m128 diff_lo = _mm_sub_ps(_mm_load_ps(block + d * LANES), query);
+            const __m128 diff_hi = _mm_sub_ps(_mm_load_ps(block + d * LANES + 4), query);
+            acc_lo = _mm_add_ps(acc_lo, _mm_mul_ps(_mm_mul_ps(diff_lo, diff_lo), weight));
+            acc_hi = _mm_add_ps(acc_hi, _mm_mul_ps(_mm_mul_ps(diff_hi, diff_hi), weight));
+        }
+        _mm_storeu_ps(costs, acc_lo);
+        _mm_storeu_ps(costs + 4, acc_hi);
+#elif defined(__ARM_NEON)
+        float32x4_t acc_lo = vdupq_n_f32(0.f);
+        float32x4_t acc_hi = vdupq_n_f32(0.f);
+        for (int64_t d = 0; d < dim_count; ++d) {
+            const float32x4_t query = vdupq_n_f32(p_query[d]);
+            const float32x4_t weight = vdupq_n_f32(p_weights[d]);
+            const float32x4_t diff_lo = vsubq_f32(vld1q_f32(block + d * LANES), query);
+            const float32x4_t diff_hi = vsubq_f32(vld1q_f32(block + d * LANES + 4), query);
+            acc_lo = vmlaq_f32(acc_lo, vmulq_f32(diff_lo, diff_lo), weight);
+            acc_hi = vmlaq_f32(acc_hi, vmulq_f32(diff_hi, diff_hi), weight);
+        }
+        vst1q_f32(costs, acc_lo);
+        vst1q_f32(costs + 4, acc_hi);
+#else
+        for (int32_t lane = 0; lane < LANES; ++lane) {
+            costs[lane] = 0.f;
+        }
+        for (int64_t d = 0; d < dim_count; ++d) {
+            for (int32_t lane = 0; lane < LANES; ++lane) {
+                const float diff = block[d * LANES + lane] - p_query[d];
+                costs[lane] += diff * diff * p_weights[d];
+            }
+        }
+#endif
+    }
+}
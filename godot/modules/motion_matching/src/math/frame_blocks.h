@@ -0,0 +1,75 @@
+/**************************************************************************/
+/*  frame_blocks.h                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef FRAME_BLOCKS_H
+#define FRAME_BLOCKS_H
+
+#include "core/templates/local_vector.h"
+
+#include <cstdint>
+
+// Structure-of-arrays copy of a motion database, used to score many frames at
+// once. Frames are grouped in blocks of LANES, and every block stores each
+// dimension of its frames contiguously:
+//     block 0: [dim 0: frame 0..7][dim 1: frame 0..7]...
+// Blocks are aligned to 32 bytes and the last one is zero padded.
+class FrameBlocks {
+public:
+    static constexpr int32_t LANES = 8;
+    static constexpr size_t ALIGNMENT = 32;
+
+    FrameBlocks() = default;
+    FrameBlocks(const FrameBlocks&) = delete;
+    FrameBlocks& operator=(const FrameBlocks&) = delete;
+    ~FrameBlocks();
+
+    // Lays out p_data (one row of p_dim_count floats per frame). When p_order is
+    // given, slot i holds frame p_order[i] instead of frame i.
+    void build(const float* p_data, int64_t p_frame_count, int64_t p_dim_count, const int32_t* p_order = nullptr);
+    void clear();
+
+    // Writes the weighted squared distance between p_query and every frame of
+    // blocks [p_first_block, p_first_block + p_block_count) to r_costs, LANES per block.
+    void score(const float* p_query, const float* p_weights, int64_t p_first_block, int64_t p_block_count, float* r_costs) const;
+
+    bool is_empty() const { return data == nullptr; }
+    int64_t get_frame_count() const { return frame_count; }
+    int64_t get_dim_count() const { return dim_count; }
+    int64_t get_block_count() const { return (frame_count + LANES - 1) / LANES; }
+    int64_t get_frame_index(int64_t p_slot) const { return order.is_empty() ? p_slot : order[p_slot]; }
+
+private:
+    float* data = nullptr;
+    int64_t frame_count = 0;
+    int64_t dim_count = 0;
+    LocalVector<int32_t> order;
+};
+
+#endif // FRAME_BLOCKS_H
@@ -0,0 +1,391 @@
+/**************************************************************************/
+/*  kd_tree.cpp                                                           */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "kd_tree.h"
+
+#include "core/templates/local_vector.h"
+
+#include <algorithm>
+
+namespace {
+
+struct KDTreeBuilder {
+    const float* data = nullptr;
+    const float* weights = nullptr;
+    int64_t dim_count = 0;
+    LocalVector<int32_t> nodes;
+    LocalVector<float> bounds;
+    int32_t* indices = nullptr;
+
+    int32_t build_node(int32_t p_begin, int32_t p_end, int32_t p_depth) {
+        const int32_t node = nodes.size() / KDTree::NODE_STRIDE;
+        nodes.push_back(-1);
+        nodes.push_back(p_begin);
+        nodes.push_back(p_end);
+        nodes.push_back(-1);
+
+        bounds.resize(bounds.size() + 2 * dim_count);
+        float* lo = bounds.ptr() + node * 2 * dim_count;
+        float* hi = lo + dim_count;
+        for (int64_t d = 0; d < dim_count; ++d) {
+            lo[d] = FLT_MAX;
+            hi[d] = -FLT_MAX;
+        }
+        for (int32_t i = p_begin; i < p_end; ++i) {
+            const float* frame = data + indices[i] * dim_count;
+            for (int64_t d = 0; d < dim_count; ++d) {
+                lo[d] = MIN(lo[d], frame[d]);
+                hi[d] = MAX(hi[d], frame[d]);
+            }
+        }
+
+        if (p_end - p_begin <= KDTree::LEAF_SIZE || p_depth >= KDTree::MAX_DEPTH - 1) {
+            return node;
+        }
+
+        // Split along the dimension with the largest weighted extent.
+        int32_t split_dim = -1;
+        float split_extent = 0.f;
+        for (int64_t d = 0; d < dim_count; ++d) {
+            const float extent = (hi[d] - lo[d]) * (hi[d] - lo[d]) * weights[d];
+            if (extent > split_extent) {
+                split_extent = extent;
+                split_dim = d;
+            }
+        }
+        if (split_dim < 0) {
+            // All frames are identical, nothing to split.
+            return node;
+        }
+
+        const int32_t mid = (p_begin + p_end) / 2;
+        const float* frames = data;
+        const int64_t stride = dim_count;
+        std::nth_element(indices + p_begin, indices + mid, indices + p_end, [frames, stride, split_dim](int32_t a, int32_t b) {
+            return frames[a * stride + split_dim] < frames[b * stride + split_dim];
+        });
+
+        nodes[node * KDTree::NODE_STRIDE] = split_dim;
+        build_node(p_begin, mid, p_depth + 1);
+        const int32_t right = build_node(mid, p_end, p_depth + 1);
+        nodes[node * KDTree::NODE_STRIDE + 3] = right;
+        return node;
+    }
+};
+
+// Blocks scored per call when scanning frame blocks.
+constexpr int64_t SCORE_CHUNK_BLOCKS = 4;
+
+} // namespace
+
+KDTree::KDTree(const PackedInt32Array& p_nodes, const PackedFloat32Array& p_bounds, const PackedInt32Array& p_indices)
+    : nodes(p_nodes), bounds(p_bounds), indices(p_indices) {
+}
+
+void KDTree::build(const float* p_data, int64_t p_frame_count, const float* p_weights, int64_t p_dim_count, PackedInt32Array& r_nodes, PackedFloat32Array& r_bounds, PackedInt32Array& r_indices) {
+    r_nodes.clear();
+    r_bounds.clear();
+    r_indices.clear();
+
+    if (p_frame_count <= 0 || p_dim_count <= 0) {
+        return;
+    }
+    ERR_FAIL_COND_MSG(p_frame_count > INT32_MAX, "Motion database is too large to be indexed.");
+
+    KDTreeBuilder builder;
+    builder.data = p_data;
+    builder.weights = p_weights;
+    builder.dim_count = p_dim_count;
+
+    r_indices.resize(p_frame_count);
+    builder.indices = r_indices.ptrw();
+    for (int32_t i = 0; i < p_frame_count; ++i) {
+        builder.indices[i] = i;
+    }
+
+    builder.build_node(0, p_frame_count, 0);
+
+    r_nodes.resize(builder.nodes.size());
+    memcpy(r_nodes.ptrw(), builder.nodes.ptr(), builder.nodes.size() * sizeof(int32_t));
+    r_bounds.resize(builder.bounds.size());
+    memcpy(r_bounds.ptrw(), builder.bounds.ptr(), builder.bounds.size() * sizeof(float));
+}
+
+float KDTree::frame_cost(const float* p_query, const float* p_frame, const float* p_weights, int64_t p_dim_count) {
+    float cost = 0.f;
+    for (int64_t d = 0; d < p_dim_count; ++d) {
+        const float diff = p_query[d] - p_frame[d];
+        cost += diff * diff * p_weights[d];
+    }
+    return cost;
+}
+
+KDTree::SearchResult KDTree::linear_search(const float* p_data, int64_t p_frame_count, const float* p_query, const float* p_weights, int64_t p_dim_count) {
+    SearchResult result;
+    for (int64_t frame_index = 0; frame_index < p_frame_count; ++frame_index) {
+        const float cost = frame_cost(p_query, p_data + frame_index * p_dim_count, p_weights, p_dim_count);
+        if (cost < result.cost) {
+            result.cost = cost;
+            result.frame_index = frame_index;
+        }
+    }
+    result.visited_frames = p_frame_count;
+    return result;
+}
+
+KDTree::SearchResult KDTree::linear_search(const FrameBlocks& p_blocks, const float* p_query, const float* p_weights) {
+    SearchResult result;
+    float costs[SCORE_CHUNK_BLOCKS * FrameBlocks::LANES];
+    const int64_t frame_count = p_blocks.get_frame_count();
+    const int64_t block_count = p_blocks.get_block_count();
+    for (int64_t first_block = 0; first_block < block_count; first_block += SCORE_CHUNK_BLOCKS) {
+        const int64_t chunk_blocks = MIN(SCORE_CHUNK_BLOCKS, block_count - first_block);
+        p_blocks.score(p_query, p_weights, first_block, chunk_blocks, costs);
+
+        const int64_t first_slot = first_block * FrameBlocks::LANES;
+        const int64_t slot_count = MIN(chunk_blocks * FrameBlocks::LANES, frame_count - first_slot);
+        for (int64_t i = 0; i < slot_count; ++i) {
+            if (costs[i] < result.cost) {
+                result.cost = costs[i];
+                result.frame_index = first_slot + i;
+            }
+        }
+    }
+    if (result.frame_index >= 0) {
+        result.frame_index = p_blocks.get_frame_index(result.frame_index);
+    }
+    result.visited_frames = frame_count;
+    return result;
+}
+
+KDTree::SearchResult KDTree::linear_search(const QuantizedFrames& p_frames, const float* p_query, const float* p_weights) {
+    QuantizedFrames::Query quantized_query;
+    p_frames.prepare_query(p_query, p_weights, quantized_query);
+
+    SearchResult result;
+    const int64_t frame_count = p_frames.get_frame_count();
+    for (int64_t frame_index = 0; frame_index < frame_count; ++frame_index) {
+        const float cost = p_frames.frame_cost(quantized_query, frame_index);
+        if (cost < result.cost) {
+            result.cost = cost;
+            result.frame_index = frame_index;
+        }
+    }
+    result.visited_frames = frame_count;
+    return result;
+}
+
+bool KDTree::is_valid(int64_t p_frame_count, int64_t p_dim_count) const {
+    if (nodes.is_empty() || nodes.size() % NODE_STRIDE != 0 || p_frame_count <= 0 || p_frame_count > INT32_MAX) {
+        return false;
+    }
+    const int64_t node_count = nodes.size() / NODE_STRIDE;
+    if (indices.size() != p_frame_count || bounds.size() != node_count * 2 * p_dim_count) {
+        return false;
+    }
+
+    // The indices have to be a permutation of the frames.
+    LocalVector<uint8_t> seen;
+    seen.resize(p_frame_count);
+    memset(seen.ptr(), 0, p_frame_count);
+    const int32_t* index_data = indices.ptr();
+    for (int64_t i = 0; i < p_frame_count; ++i) {
+        const int32_t frame_index = index_data[i];
+        if (frame_index < 0 || frame_index >= p_frame_count || seen[frame_index]) {
+            return false;
+        }
+        seen[frame_index] = 1;
+    }
+
+    // Walk the nodes in the depth-first order they are stored in. Every node has to
+    // be reached exactly once, and children have to split the range of their parent.
+    struct StackEntry {
+        int32_t node;
+        int32_t begin;
+        int32_t end;
+        int32_t depth;
+    };
+    StackEntry stack[MAX_DEPTH + 2];
+    int32_t stack_size = 0;
+    stack[stack_size++] = { 0, 0, int32_t(p_frame_count), 0 };
+
+    const int32_t* node_data = nodes.ptr();
+    int64_t next_node = 0;
+    while (stack_size > 0) {
+        const StackEntry entry = stack[--stack_size];
+        if (entry.node != next_node || entry.depth >= MAX_DEPTH) {
+            return false;
+        }
+        ++next_node;
+
+        const int32_t* node = node_data + entry.node * NODE_STRIDE;
+        if (node[1] != entry.begin || node[2] != entry.end) {
+            return false;
+        }
+        if (node[0] < 0) {
+            if (node[0] != -1 || node[3] != -1) {
+                return false;
+            }
+            continue;
+        }
+        if (node[0] >= p_dim_count) {
+            return false;
+        }
+
+        const int32_t right = node[3];
+        if (right <= entry.node + 1 || right >= node_count) {
+            return false;
+        }
+        const int32_t mid = node_data[right * NODE_STRIDE + 1];
+        if (mid < entry.begin || mid > entry.end) {
+            return false;
+        }
+        // The left child is stored right after its parent, visit it first.
+        stack[stack_size++] = { right, mid, entry.end, entry.depth + 1 };
+        stack[stack_size++] = { entry.node + 1, entry.begin, mid, entry.depth + 1 };
+    }
+    return next_node == node_count;
+}
+
+template <typename ScoreLeaf>
+KDTree::SearchResult KDTree::_search(const float* p_query, const float* p_weights, int64_t p_dim_count, float p_error_bound, const ScoreLeaf& p_score_leaf) const {
+    struct StackEntry {
+        int32_t node;
+        float bound;
+    };
+    // Children are pushed in pairs, so the stack never holds more than one entry per level.
+    StackEntry stack[MAX_DEPTH + 2];
+    int32_t stack_size = 0;
+    stack[stack_size++] = { 0, _box_cost(0, p_query, p_weights, p_dim_count) };
+
+    const float scale = 1.f + MAX(p_error_bound, 0.f);
+    const int32_t* node_data = nodes.ptr();
+
+    SearchResult result;
+    while (stack_size > 0) {
+        const StackEntry entry = stack[--stack_size];
+        if (entry.bound * scale >= result.cost) {
+            continue;
+        }
+
+        const int32_t* node = node_data + entry.node * NODE_STRIDE;
+        if (node[0] < 0) {
+            p_score_leaf(node[1], node[2], result);
+            result.visited_frames += node[2] - node[1];
+            continue;
+        }
+
+        const int32_t left = entry.node + 1;
+        const int32_t right = node[3];
+        const float left_bound = _box_cost(left, p_query, p_weights, p_dim_count);
+        const float right_bound = _box_cost(right, p_query, p_weights, p_dim_count);
+        // Visit the closest child first so the farthest one is more likely to be pruned.
+        if (left_bound <= right_bound) {
+            stack[stack_size++] = { right, right_bound };
+            stack[stack_size++] = { left, left_bound };
+        } else {
+            stack[stack_size++] = { left, left_bound };
+            stack[stack_size++] = { right, right_bound };
+        }
+    }
+
+    return result;
+}
+
+KDTree::SearchResult KDTree::search(const float* p_data, const FrameBlocks* p_blocks, const float* p_query, const float* p_weights, int64_t p_dim_count, float p_error_bound) const {
+    const int32_t* index_data = indices.ptr();
+
+    if (p_blocks) {
+        // Leaves are contiguous slots of the blocks, score them a few blocks at a time.
+        return _search(p_query, p_weights, p_dim_count, p_error_bound, [&](int32_t p_begin, int32_t p_end, SearchResult& r_result) {
+            float costs[SCORE_CHUNK_BLOCKS * FrameBlocks::LANES];
+            const int64_t last_block = (p_end - 1) / FrameBlocks::LANES;
+            for (int64_t first_block = p_begin / FrameBlocks::LANES; first_block <= last_block; first_block += SCORE_CHUNK_BLOCKS) {
+                const int64_t chunk_blocks = MIN(SCORE_CHUNK_BLOCKS, last_block - first_block + 1);
+                p_blocks->score(p_query, p_weights, first_block, chunk_blocks, costs);
+
+                const int64_t first_slot = first_block * FrameBlocks::LANES;
+                const int64_t begin = MAX(first_slot, (int64_t)p_begin);
+                const int64_t end = MIN(first_slot + chunk_blocks * FrameBlocks::LANES, (int64_t)p_end);
+                for (int64_t slot = begin; slot < end; ++slot) {
+                    if (costs[slot - first_slot] < r_result.cost) {
+                        r_result.cost = costs[slot - first_slot];
+                        r_result.frame_index = index_data[slot];
+                    }
+                }
+            }
+        });
+    }
+
+    return _search(p_query, p_weights, p_dim_count, p_error_bound, [&](int32_t p_begin, int32_t p_end, SearchResult& r_result) {
+        for (int32_t i = p_begin; i < p_end; ++i) {
+            const int32_t frame_index = index_data[i];
+            const float cost = frame_cost(p_query, p_data + frame_index * p_dim_count, p_weights, p_dim_count);
+            if (cost < r_result.cost) {
+                r_result.cost = cost;
+                r_result.frame_index = frame_index;
+            }
+        }
+    });
+}
+
+KDTree::SearchResult KDTree::search(const QuantizedFrames& p_frames, const float* p_query, const float* p_weights, int64_t p_dim_count, float p_error_bound) const {
+    const int32_t* index_data = indices.ptr();
+    QuantizedFrames::Query quantized_query;
+    p_frames.prepare_query(p_query, p_weights, quantized_query);
+
+    return _search(p_query, p_weights, p_dim_count, p_error_bound, [&](int32_t p_begin, int32_t p_end, SearchResult& r_result) {
+        for (int32_t i = p_begin; i < p_end; ++i) {
+            const int32_t frame_index = index_data[i];
+            const float cost = p_frames.frame_cost(quantized_query, frame_index);
+            if (cost < r_result.cost) {
+                r_result.cost = cost;
+                r_result.frame_index = frame_index;
+            }
+        }
+    });
+}
+
+float KDTree::_box_cost(int32_t p_node, const float* p_query, const float* p_weights, int64_t p_dim_count) const {
+    const float* lo = bounds.ptr() + p_node * 2 * p_dim_count;
+    const float* hi = lo + p_dim_count;
+
+    float cost = 0.f;
+    for (int64_t d = 0; d < p_dim_count; ++d) {
+        float diff = 0.f;
+        if (p_query[d] < lo[d]) {
+            diff = lo[d] - p_query[d];
+        } else if (p_query[d] > hi[d]) {
+            diff = p_query[d] - hi[d];
+        }
+        cost += diff * diff * p_weights[d];
+    }
+    return cost;
+}
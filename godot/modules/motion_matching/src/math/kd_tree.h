@@ -0,0 +1,91 @@
+/**************************************************************************/
+/*  kd_tree.h                                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+#include "core/variant/variant.h"
+
+#include "frame_blocks.h"
+#include "quantized_frames.h"
+
+#include <cfloat>
+#include <cstdint>
+
+// Flattened kd-tree over the frames of a motion database.
+// Every node stores its split dimension, the range of frames it covers in the
+// permuted index array and the bounding box of those frames, so the whole tree
+// can be serialized as packed arrays alongside the baked data.
+// Frame costs are weighted squared distances, with one weight per dimension.
+class KDTree {
+public:
+    static constexpr int32_t LEAF_SIZE = 16;
+    static constexpr int32_t NODE_STRIDE = 4; // Split dimension (-1 for leaves), begin, end, right child.
+    static constexpr int32_t MAX_DEPTH = 64;
+
+    struct SearchResult {
+        int64_t frame_index = -1;
+        float cost = FLT_MAX;
+        int64_t visited_frames = 0;
+    };
+
+    KDTree(const PackedInt32Array& p_nodes, const PackedFloat32Array& p_bounds, const PackedInt32Array& p_indices);
+
+    static void build(const float* p_data, int64_t p_frame_count, const float* p_weights, int64_t p_dim_count, PackedInt32Array& r_nodes, PackedFloat32Array& r_bounds, PackedInt32Array& r_indices);
+
+    static float frame_cost(const float* p_query, const float* p_frame, const float* p_weights, int64_t p_dim_count);
+    static SearchResult linear_search(const float* p_data, int64_t p_frame_count, const float* p_query, const float* p_weights, int64_t p_dim_count);
+    static SearchResult linear_search(const FrameBlocks& p_blocks, const float* p_query, const float* p_weights);
+    static SearchResult linear_search(const QuantizedFrames& p_frames, const float* p_query, const float* p_weights);
+
+    bool is_valid(int64_t p_frame_count, int64_t p_dim_count) const;
+
+    // Finds the cheapest frame. With a positive p_error_bound the search is
+    // approximate and the returned cost is at most (1 + p_error_bound) times the optimal cost.
+    // When p_blocks is given, it must have been built in the order of the tree indices
+    // and leaves are scored with it instead of p_data.
+    SearchResult search(const float* p_data, const FrameBlocks* p_blocks, const float* p_query, const float* p_weights, int64_t p_dim_count, float p_error_bound = 0.f) const;
+    // Same search with leaves scored on quantized frames. The bounds are those of the
+    // original frames, so pruning can be off by the quantization error.
+    SearchResult search(const QuantizedFrames& p_frames, const float* p_query, const float* p_weights, int64_t p_dim_count, float p_error_bound = 0.f) const;
+
+    const int32_t* get_indices() const { return indices.ptr(); }
+
+private:
+    const PackedInt32Array& nodes;
+    const PackedFloat32Array& bounds;
+    const PackedInt32Array& indices;
+
+    float _box_cost(int32_t p_node, const float* p_query, const float* p_weights, int64_t p_dim_count) const;
+    template <typename ScoreLeaf>
+    SearchResult _search(const float* p_query, const float* p_weights, int64_t p_dim_count, float p_error_bound, const ScoreLeaf& p_score_leaf) const;
+};
+
+#endif // KD_TREE_H
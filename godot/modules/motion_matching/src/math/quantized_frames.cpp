@@ -0,0 +1,128 @@
+/**************************************************************************/
+/*  quantized_frames.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "quantized_frames.h"
+
+#include <cfloat>
+
+QuantizedFrames::QuantizedFrames(const PackedByteArray& p_data, const PackedFloat32Array& p_scales, const PackedFloat32Array& p_offsets, int64_t p_frame_count)
+    : data(p_data), scales(p_scales), offsets(p_offsets), frame_count(p_frame_count) {
+    // The value size is implied by the size of the data, anything else than 8 or 16 bits is invalid.
+    const int64_t value_count = frame_count * scales.size();
+    if (value_count <= 0 || offsets.size() != scales.size()) {
+        return;
+    }
+    if (data.size() == value_count) {
+        bytes_per_value = 1;
+    } else if (data.size() == value_count * 2) {
+        bytes_per_value = 2;
+    }
+}
+
+void QuantizedFrames::quantize(const float* p_data, int64_t p_frame_count, int64_t p_dim_count, int32_t p_bits, PackedByteArray& r_data, PackedFloat32Array& r_scales, PackedFloat32Array& r_offsets) {
+    r_data.clear();
+    r_scales.clear();
+    r_offsets.clear();
+    ERR_FAIL_COND(p_bits != 8 && p_bits != 16);
+    if (p_frame_count <= 0 || p_dim_count <= 0) {
+        return;
+    }
+
+    const float max_level = p_bits == 8 ? float(UINT8_MAX) : float(UINT16_MAX);
+    r_scales.resize(p_dim_count);
+    r_offsets.resize(p_dim_count);
+    float* scales_w = r_scales.ptrw();
+    float* offsets_w = r_offsets.ptrw();
+    for (int64_t d = 0; d < p_dim_count; ++d) {
+        float lo = FLT_MAX;
+        float hi = -FLT_MAX;
+        for (int64_t f = 0; f < p_frame_count; ++f) {
+            lo = MIN(lo, p_data[f * p_dim_count + d]);
+            hi = MAX(hi, p_data[f * p_dim_count + d]);
+        }
+        offsets_w[d] = lo;
+        // Constant dimensions still need a non zero scale to prepare queries.
+        scales_w[d] = hi > lo ? (hi - lo) / max_level : 1.f;
+    }
+
+    const int32_t bytes = p_bits / 8;
+    r_data.resize(p_frame_count * p_dim_count * bytes);
+    uint8_t* data_w = r_data.ptrw();
+    for (int64_t i = 0; i < p_frame_count * p_dim_count; ++i) {
+        const int64_t d = i % p_dim_count;
+        const float level = CLAMP(Math::round((p_data[i] - offsets_w[d]) / scales_w[d]), 0.f, max_level);
+        if (bytes == 1) {
+            data_w[i] = uint8_t(level);
+        } else {
+            reinterpret_cast<uint16_t*>(data_w)[i] = uint16_t(level);
+        }
+    }
+}
+
+void QuantizedFrames::prepare_query(const float* p_query, const float* p_weights, Query& r_query) const {
+    // w * (q - (o + s * x))^2 == (w * s^2) * ((q - o) / s - x)^2
+    const int64_t dim_count = scales.size();
+    r_query.values.resize(dim_count);
+    r_query.weights.resize(dim_count);
+    for (int64_t d = 0; d < dim_count; ++d) {
+        r_query.values[d] = (p_query[d] - offsets[d]) / scales[d];
+        r_query.weights[d] = p_weights[d] * scales[d] * scales[d];
+    }
+}
+
+float QuantizedFrames::frame_cost(const Query& p_query, int64_t p_frame_index) const {
+    const int64_t dim_count = p_query.values.size();
+    const float* values = p_query.values.ptr();
+    const float* weights = p_query.weights.ptr();
+    float cost = 0.f;
+    if (bytes_per_value == 1) {
+        const uint8_t* frame = data.ptr() + p_frame_index * dim_count;
+        for (int64_t d = 0; d < dim_count; ++d) {
+            const float diff = values[d] - float(frame[d]);
+            cost += diff * diff * weights[d];
+        }
+    } else {
+        const uint16_t* frame = reinterpret_cast<const uint16_t*>(data.ptr()) + p_frame_index * dim_count;
+        for (int64_t d = 0; d < dim_count; ++d) {
+            const float diff = values[d] - float(frame[d]);
+            cost += diff * diff * weights[d];
+        }
+    }
+    return cost;
+}
+
+void QuantizedFrames::dequantize(int64_t p_frame_index, float* r_frame) const {
+    const int64_t dim_count = scales.size();
+    for (int64_t d = 0; d < dim_count; ++d) {
+        const int64_t i = p_frame_index * dim_count + d;
+        const float level = bytes_per_value == 1 ? float(data[i]) : float(reinterpret_cast<const uint16_t*>(data.ptr())[i]);
+        r_frame[d] = offsets[d] + level * scales[d];
+    }
+}
@@ -0,0 +1,72 @@
+/**************************************************************************/
+/*  quantized_frames.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef QUANTIZED_FRAMES_H
+#define QUANTIZED_FRAMES_H
+
+#include "core/templates/local_vector.h"
+#include "core/variant/variant.h"
+
+#include <cstdint>
+
+// Read-only view of a motion database quantized to 8 or 16 bits per dimension.
+// Each dimension d stores round((value - offset[d]) / scale[d]), one row of
+// dimensions per frame, so the packed bytes can be searched in place.
+class QuantizedFrames {
+public:
+    // Prepared query, expressed in quantized units so frames are scored without
+    // converting them back to normalized values.
+    struct Query {
+        LocalVector<float> values;
+        LocalVector<float> weights;
+    };
+
+    QuantizedFrames(const PackedByteArray& p_data, const PackedFloat32Array& p_scales, const PackedFloat32Array& p_offsets, int64_t p_frame_count);
+
+    static void quantize(const float* p_data, int64_t p_frame_count, int64_t p_dim_count, int32_t p_bits, PackedByteArray& r_data, PackedFloat32Array& r_scales, PackedFloat32Array& r_offsets);
+
+    bool is_valid(int64_t p_dim_count) const { return bytes_per_value > 0 && scales.size() == p_dim_count; }
+    int32_t get_bytes_per_value() const { return bytes_per_value; }
+    int64_t get_frame_count() const { return frame_count; }
+
+    void prepare_query(const float* p_query, const float* p_weights, Query& r_query) const;
+    // Weighted squared distance between the query and the dequantized frame.
+    float frame_cost(const Query& p_query, int64_t p_frame_index) const;
+    void dequantize(int64_t p_frame_index, float* r_frame) const;
+
+private:
+    const PackedByteArray& data;
+    const PackedFloat32Array& scales;
+    const PackedFloat32Array& offsets;
+    int64_t frame_count = 0;
+    int32_t bytes_per_value = 0;
+};
+
+#endif // QUANTIZED_FRAMES_H
@@ -34,8 +34,14 @@
 #include "features/mm_feature.h"
 #include "math/stats.hpp"
 
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+
+#include <algorithm>
+
 MMAnimationLibrary::MMAnimationLibrary()
     : AnimationLibrary() {
+    search_cache_dirty.set();
 }
 
 MMAnimationLibrary::~MMAnimationLibrary() {
@@ -45,6 +51,15 @@ void MMAnimationLibrary::bake_data(const AnimationMixer* p_player, const Skeleto
     motion_data.clear();
     db_anim_index.clear();
     db_time_index.clear();
+    dim_weights.clear();
+    quantized_data.clear();
+    quantization_scales.clear();
+    quantization_offsets.clear();
+    quantization_error.clear();
+    kd_nodes.clear();
+    kd_bounds.clear();
+    kd_indices.clear();
+    _invalidate_search_cache();
 
     int64_t dim_count = 0;
     for (auto i = 0; i < features.size(); ++i) {
@@ -130,63 +145,176 @@ void MMAnimationLibrary::bake_data(const AnimationMixer* p_player, const Skeleto
     _normalize_data(data, dim_count);
 
     motion_data = data.duplicate();
+
+    // Fold the per-feature cost normalization into one weight per dimension,
+    // so searches only need a single weighted squared distance per frame.
+    dim_weights = _compute_dim_weights();
+    KDTree::build(motion_data.ptr(), db_anim_index.size(), dim_weights.ptr(), dim_count, kd_nodes, kd_bounds, kd_indices);
+
+    if (storage_format != Float32) {
+        // The tree is built on the float data, searches then score the quantized frames in place.
+        QuantizedFrames::quantize(motion_data.ptr(), db_anim_index.size(), dim_count, storage_format == Quantized8 ? 8 : 16, quantized_data, quantization_scales, quantization_offsets);
+        quantization_error = _measure_quantization_error(motion_data, dim_count);
+        motion_data.clear();
+    }
+    _invalidate_search_cache();
 }
 
 MMQueryOutput MMAnimationLibrary::query(const MMQueryInput& p_query_input) {
-    // TODO: Use fancier search algorithms
     // TODO: Do this using an offset array instead
     List<StringName> animation_list;
     get_animation_list(&animation_list);
-    int32_t dim_count = 0;
-    PackedFloat32Array query_vector = PackedFloat32Array();
+    LocalVector<float> query_vector;
+    ERR_FAIL_COND_V(!_build_query_vector(p_query_input, query_vector), MMQueryOutput());
+    const int64_t dim_count = query_vector.size();
+
+    MMQueryOutput result;
+
+    _update_search_cache();
+    ERR_FAIL_COND_V_MSG(search_weights.size() != dim_count, result, "Query does not match the baked data, bake the library again.");
+
+    const KDTree::SearchResult search_result = _search(query_vector.ptr(), search_mode);
+    if (search_result.frame_index < 0) {
+        return result;
+    }
+
+    PackedFloat32Array frame_data;
+    frame_data.resize(dim_count);
+    _get_frame(search_result.frame_index, dim_count, frame_data.ptrw());
+
+    int64_t start_feature_index = 0;
+    Dictionary feature_costs;
     for (int64_t feature_index = 0; feature_index < features.size(); feature_index++) {
         const MMFeature* feature = Object::cast_to<MMFeature>(features[feature_index]);
         if (!feature) {
             continue;
         }
-        PackedFloat32Array feature_data = feature->evaluate_runtime_data(p_query_input);
-        feature->normalize(feature_data.ptrw());
-        query_vector.append_array(feature_data);
-        dim_count += feature->get_dimension_count();
+
+        const float feature_cost = feature->compute_cost(
+            (query_vector.ptr() + start_feature_index),
+            (frame_data.ptr() + start_feature_index));
+
+        feature_costs.get_or_add(feature->get_class(), feature_cost);
+        start_feature_index += feature->get_dimension_count();
     }
 
-    float cost = FLT_MAX;
-    MMQueryOutput result;
+    result.cost = search_result.cost;
+    result.matched_frame_data = frame_data;
+    String library_name = get_path().get_file().get_basename() + "/";
+    if (library_name.is_empty()) {
+        library_name = get_name() + "/";
+    }
+    result.animation_match = library_name + animation_list.get(db_anim_index[search_result.frame_index]);
+    result.time_match = db_time_index[search_result.frame_index];
+    result.feature_costs = feature_costs;
 
-    for (int64_t start_frame_index = 0; start_frame_index < motion_data.size(); start_frame_index += dim_count) {
-        int start_feature_index = start_frame_index;
-        float frame_cost = 0.f;
-        Dictionary feature_costs;
-        for (int64_t feature_index = 0; feature_index < features.size(); feature_index++) {
-            const MMFeature* feature = Object::cast_to<MMFeature>(features[feature_index]);
-            if (!feature) {
-                continue;
-            }
+    return result;
+}
+
+float MMAnimationLibrary::compute_animation_cost(const MMQueryInput& p_query_input, const String& p_animation, float p_time) const {
+    // Animations are matched with the library prefix, e.g. "library/animation".
+    const String animation_name = p_animation.get_file();
+
+    List<StringName> animation_list;
+    get_animation_list(&animation_list);
+    int32_t animation_index = 0;
+    for (const StringName& name : animation_list) {
+        if (name == animation_name) {
+            break;
+        }
+        animation_index++;
+    }
+    if (animation_index >= animation_list.size()) {
+        return FLT_MAX;
+    }
 
-            const float feature_cost = feature->compute_cost(
-                (query_vector.ptr() + start_feature_index - start_frame_index),
-                (motion_data.ptr() + start_feature_index));
+    // Frames are baked animation by animation, so the index is sorted.
+    const int32_t* anim_index_begin = db_anim_index.ptr();
+    const int32_t* anim_index_end = anim_index_begin + db_anim_index.size();
+    const int32_t* first_frame = std::lower_bound(anim_index_begin, anim_index_end, animation_index);
+    const int64_t frame_index = (first_frame - anim_index_begin) + int64_t(p_time * sampling_rate);
+    if (first_frame == anim_index_end || frame_index >= db_anim_index.size() || db_anim_index[frame_index] != animation_index) {
+        return FLT_MAX;
+    }
+
+    LocalVector<float> query_vector;
+    ERR_FAIL_COND_V(!_build_query_vector(p_query_input, query_vector), FLT_MAX);
 
-            feature_costs.get_or_add(feature->get_class(), feature_cost);
-            frame_cost += feature_cost;
-            start_feature_index += feature->get_dimension_count();
+    _update_search_cache();
+    const int64_t dim_count = query_vector.size();
+    ERR_FAIL_COND_V(search_weights.size() != dim_count || frame_index >= _get_frame_count(dim_count), FLT_MAX);
+    LocalVector<float> frame;
+    frame.resize(dim_count);
+    _get_frame(frame_index, dim_count, frame.ptr());
+    return KDTree::frame_cost(query_vector.ptr(), frame.ptr(), search_weights.ptr(), dim_count);
+}
+
+Dictionary MMAnimationLibrary::benchmark_search(int32_t p_query_count, float p_noise) const {
+    Dictionary stats;
+    ERR_FAIL_COND_V(p_query_count <= 0, stats);
+
+    const int64_t dim_count = get_dim_count();
+    const int64_t frame_count = dim_count > 0 ? _get_frame_count(dim_count) : 0;
+    ERR_FAIL_COND_V_MSG(frame_count == 0, stats, "The library has no baked data to benchmark.");
+
+    // Queries are perturbed database frames, so they land close to real poses
+    // the way runtime queries do.
+    RandomPCG rng;
+    LocalVector<float> queries;
+    queries.resize(p_query_count * dim_count);
+    for (int32_t query_index = 0; query_index < p_query_count; query_index++) {
+        float* query = queries.ptr() + query_index * dim_count;
+        _get_frame(rng.rand(frame_count), dim_count, query);
+        for (int64_t dim_index = 0; dim_index < dim_count; dim_index++) {
+            query[dim_index] += rng.randfn(0.f, p_noise);
         }
+    }
 
-        if (frame_cost < cost) {
-            cost = frame_cost;
-            result.cost = cost;
-            result.matched_frame_data = motion_data.slice(start_frame_index, start_frame_index + dim_count);
-            String library_name = get_path().get_file().get_basename() + "/";
-            if (library_name.is_empty()) {
-                library_name = get_name() + "/";
-            }
-            result.animation_match = library_name + animation_list.get(db_anim_index[start_frame_index / dim_count]);
-            result.time_match = db_time_index[start_frame_index / dim_count];
-            result.feature_costs = feature_costs;
+    const SearchMode search_modes[] = { Linear, Tree, ApproximateTree };
+    const char* search_mode_names[] = { "linear", "tree", "approximate_tree" };
+    LocalVector<float> linear_costs;
+    LocalVector<float> costs;
+    costs.resize(p_query_count);
+    for (int32_t mode_index = 0; mode_index < 3; mode_index++) {
+        int64_t visited_frames = 0;
+        const uint64_t start_usec = OS::get_singleton()->get_ticks_usec();
+        for (int32_t query_index = 0; query_index < p_query_count; query_index++) {
+            const KDTree::SearchResult result = _search(queries.ptr() + query_index * dim_count, search_modes[mode_index]);
+            costs[query_index] = result.cost;
+            visited_frames += result.visited_frames;
         }
+        const uint64_t elapsed_usec = OS::get_singleton()->get_ticks_usec() - start_usec;
+
+        if (search_modes[mode_index] == Linear) {
+            linear_costs = costs;
+        }
+
+        double error_sum = 0.0;
+        double error_max = 0.0;
+        for (int32_t query_index = 0; query_index < p_query_count; query_index++) {
+            const double error = (costs[query_index] - linear_costs[query_index]) / MAX(linear_costs[query_index], (float)CMP_EPSILON);
+            error_sum += error;
+            error_max = MAX(error_max, error);
+        }
+
+        Dictionary mode_stats;
+        mode_stats["usec"] = elapsed_usec;
+        mode_stats["usec_per_query"] = double(elapsed_usec) / p_query_count;
+        mode_stats["visited_frames_per_query"] = double(visited_frames) / p_query_count;
+        mode_stats["mean_relative_error"] = error_sum / p_query_count;
+        mode_stats["max_relative_error"] = error_max;
+        stats[search_mode_names[mode_index]] = mode_stats;
     }
 
-    return result;
+    stats["frame_count"] = frame_count;
+    stats["dim_count"] = dim_count;
+    stats["query_count"] = p_query_count;
+    stats["soa_layout"] = soa_layout;
+    stats["quantized"] = _is_quantized();
+    if (_is_quantized()) {
+        stats["quantization_error"] = quantization_error;
+    }
+    return stats;
 }
 
 int64_t MMAnimationLibrary::get_dim_count() const {
@@ -229,12 +357,17 @@ void MMAnimationLibrary::display_data(const Ref<EditorNode3DGizmo>& p_gizmo, con
         }
     }
 
-    int32_t frame_index = start_frame_index + p_pose_index * dim_count;
+    const int32_t frame_index = (start_frame_index + p_pose_index * dim_count) / MAX(dim_count, 1);
+    ERR_FAIL_COND(dim_count == 0 || frame_index >= _get_frame_count(dim_count));
+    LocalVector<float> frame;
+    frame.resize(dim_count);
+    _get_frame(frame_index, dim_count, frame.ptr());
+
+    int32_t dim_index = 0;
     for (int64_t feature_index = 0; feature_index < features.size(); feature_index++) {
         const MMFeature* feature = Object::cast_to<MMFeature>(features[feature_index]);
-        const float* frame_motion_data = motion_data.ptr() + frame_index;
-        feature->display_data(p_gizmo, p_transform, frame_motion_data);
-        frame_index += feature->get_dimension_count();
+        feature->display_data(p_gizmo, p_transform, frame.ptr() + dim_index);
+        dim_index += feature->get_dimension_count();
     }
 }
 #endif
@@ -253,10 +386,208 @@ void MMAnimationLibrary::_normalize_data(PackedFloat32Array& p_data, size_t p_di
     }
 }
 
+bool MMAnimationLibrary::_build_query_vector(const MMQueryInput& p_query_input, LocalVector<float>& r_query_vector) const {
+    r_query_vector.clear();
+    r_query_vector.reserve(dim_weights.size());
+    int64_t dim_count = 0;
+    for (int64_t feature_index = 0; feature_index < features.size(); feature_index++) {
+        const MMFeature* feature = Object::cast_to<MMFeature>(features[feature_index]);
+        if (!feature) {
+            continue;
+        }
+        const PackedFloat32Array feature_data = feature->evaluate_runtime_data(p_query_input);
+        const int64_t feature_dim_count = feature->get_dimension_count();
+        ERR_FAIL_COND_V(feature_data.size() != feature_dim_count, false);
+        r_query_vector.resize(dim_count + feature_dim_count);
+        memcpy(r_query_vector.ptr() + dim_count, feature_data.ptr(), feature_dim_count * sizeof(float));
+        feature->normalize(r_query_vector.ptr() + dim_count);
+        dim_count += feature_dim_count;
+    }
+    return true;
+}
+
+PackedFloat32Array MMAnimationLibrary::_compute_dim_weights() const {
+    // MMFeature::compute_cost averages the squared differences of each feature.
+    PackedFloat32Array weights;
+    for (int64_t feature_index = 0; feature_index < features.size(); feature_index++) {
+        const MMFeature* feature = Object::cast_to<MMFeature>(features[feature_index]);
+        if (!feature) {
+            continue;
+        }
+        const int64_t feature_dim_count = feature->get_dimension_count();
+        for (int64_t dim_index = 0; dim_index < feature_dim_count; dim_index++) {
+            weights.push_back(1.f / feature_dim_count);
+        }
+    }
+    return weights;
+}
+
+bool MMAnimationLibrary::_is_quantized() const {
+    return motion_data.is_empty() && !quantized_data.is_empty();
+}
+
+int64_t MMAnimationLibrary::_get_frame_count(int64_t p_dim_count) const {
+    if (_is_quantized()) {
+        return db_anim_index.size();
+    }
+    return motion_data.size() / p_dim_count;
+}
+
+void MMAnimationLibrary::_get_frame(int64_t p_frame_index, int64_t p_dim_count, float* r_frame) const {
+    if (_is_quantized()) {
+        const QuantizedFrames frames(quantized_data, quantization_scales, quantization_offsets, db_anim_index.size());
+        ERR_FAIL_COND(!frames.is_valid(p_dim_count));
+        frames.dequantize(p_frame_index, r_frame);
+        return;
+    }
+    memcpy(r_frame, motion_data.ptr() + p_frame_index * p_dim_count, p_dim_count * sizeof(float));
+}
+
+Dictionary MMAnimationLibrary::_measure_quantization_error(const PackedFloat32Array& p_data, int64_t p_dim_count) const {
+    Dictionary error;
+    const int64_t frame_count = p_data.size() / p_dim_count;
+    const QuantizedFrames frames(quantized_data, quantization_scales, quantization_offsets, frame_count);
+    ERR_FAIL_COND_V(!frames.is_valid(p_dim_count) || dim_weights.size() != p_dim_count, error);
+
+    // Error of the stored values, in normalized feature units.
+    LocalVector<float> frame;
+    frame.resize(p_dim_count);
+    double value_error_sum = 0.0;
+    double value_error_max = 0.0;
+    for (int64_t frame_index = 0; frame_index < frame_count; frame_index++) {
+        frames.dequantize(frame_index, frame.ptr());
+        for (int64_t dim_index = 0; dim_index < p_dim_count; dim_index++) {
+            const double value_error = Math::abs(frame[dim_index] - p_data[frame_index * p_dim_count + dim_index]);
+            value_error_sum += value_error;
+            value_error_max = MAX(value_error_max, value_error);
+        }
+    }
+
+    // Error of the search, with the same kind of queries as benchmark_search. The quantized
+    // match is scored against the float frames so the error is what a query actually loses.
+    const int32_t query_count = MIN(frame_count, (int64_t)256);
+    RandomPCG rng;
+    LocalVector<float> query;
+    query.resize(p_dim_count);
+    int32_t match_count = 0;
+    double cost_error_sum = 0.0;
+    double cost_error_max = 0.0;
+    for (int32_t query_index = 0; query_index < query_count; query_index++) {
+        const float* source = p_data.ptr() + rng.rand(frame_count) * p_dim_count;
+        for (int64_t dim_index = 0; dim_index < p_dim_count; dim_index++) {
+            query[dim_index] = source[dim_index] + rng.randfn(0.f, 0.1f);
+        }
+
+        const KDTree::SearchResult float_result = KDTree::linear_search(p_data.ptr(), frame_count, query.ptr(), dim_weights.ptr(), p_dim_count);
+        const KDTree::SearchResult quantized_result = KDTree::linear_search(frames, query.ptr(), dim_weights.ptr());
+        const float matched_cost = KDTree::frame_cost(query.ptr(), p_data.ptr() + quantized_result.frame_index * p_dim_count, dim_weights.ptr(), p_dim_count);
+        const double cost_error = (matched_cost - float_result.cost) / MAX(float_result.cost, (float)CMP_EPSILON);
+        cost_error_sum += cost_error;
+        cost_error_max = MAX(cost_error_max, cost_error);
+        match_count += quantized_result.frame_index == float_result.frame_index ? 1 : 0;
+    }
+
+    error["mean_value_error"] = value_error_sum / (frame_count * p_dim_count);
+    error["max_value_error"] = value_error_max;
+    error["mean_relative_cost_error"] = query_count > 0 ? cost_error_sum / query_count : 0.0;
+    error["max_relative_cost_error"] = cost_error_max;
+    error["match_rate"] = query_count > 0 ? double(match_count) / query_count : 1.0;
+    error["compression_ratio"] = double(p_data.size() * sizeof(float)) / quantized_data.size();
+    return error;
+}
+
+void MMAnimationLibrary::_invalidate_search_cache() {
+    search_cache_dirty.set();
+}
+
+void MMAnimationLibrary::_update_search_cache() const {
+    if (!search_cache_dirty.is_set()) {
+        return;
+    }
+
+    MutexLock lock(search_cache_mutex);
+    if (!search_cache_dirty.is_set()) {
+        return;
+    }
+
+    // Libraries baked before weights were stored derive them from the features.
+    search_weights = dim_weights.is_empty() ? _compute_dim_weights() : dim_weights;
+
+    frame_blocks.clear();
+    const int64_t dim_count = search_weights.size();
+    // The tree is checked once here rather than on every search, it walks every node and index.
+    const KDTree tree(kd_nodes, kd_bounds, kd_indices);
+    search_tree_valid = dim_count > 0 && tree.is_valid(_get_frame_count(dim_count), dim_count);
+    if (soa_layout && dim_count > 0 && !motion_data.is_empty() && motion_data.size() % dim_count == 0) {
+        const int64_t frame_count = motion_data.size() / dim_count;
+        // Lay the blocks out in tree order so every leaf maps to contiguous slots.
+        const int32_t* order = search_tree_valid ? tree.get_indices() : nullptr;
+        frame_blocks.build(motion_data.ptr(), frame_count, dim_count, order);
+    }
+
+    search_cache_dirty.clear();
+}
+
+KDTree::SearchResult MMAnimationLibrary::_search(const float* p_query, SearchMode p_search_mode) const {
+    _update_search_cache();
+
+    const int64_t dim_count = search_weights.size();
+    if (dim_count == 0) {
+        return KDTree::SearchResult();
+    }
+    const int64_t frame_count = _get_frame_count(dim_count);
+    const FrameBlocks* blocks = frame_blocks.is_empty() ? nullptr : &frame_blocks;
+    const QuantizedFrames quantized_frames(quantized_data, quantization_scales, quantization_offsets, frame_count);
+    const bool quantized = _is_quantized();
+    ERR_FAIL_COND_V_MSG(quantized && !quantized_frames.is_valid(dim_count), KDTree::SearchResult(), "Quantized motion data does not match the baked data, bake the library again.");
+
+    if (p_search_mode != Linear) {
+        if (search_tree_valid) {
+            const KDTree tree(kd_nodes, kd_bounds, kd_indices);
+            const float error_bound = p_search_mode == ApproximateTree ? approximation_error : 0.f;
+            if (quantized) {
+                return tree.search(quantized_frames, p_query, search_weights.ptr(), dim_count, error_bound);
+            }
+            return tree.search(motion_data.ptr(), blocks, p_query, search_weights.ptr(), dim_count, error_bound);
+        }
+        WARN_PRINT_ONCE("MMAnimationLibrary search tree is missing or out of date, falling back to a linear search. Bake the library again to rebuild it.");
+    }
+
+    if (quantized) {
+        return KDTree::linear_search(quantized_frames, p_query, search_weights.ptr());
+    }
+    if (blocks) {
+        return KDTree::linear_search(*blocks, p_query, search_weights.ptr());
+    }
+    return KDTree::linear_search(motion_data.ptr(), frame_count, p_query, search_weights.ptr(), dim_count);
+}
+
 void MMAnimationLibrary::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("benchmark_search", "query_count", "noise"), &MMAnimationLibrary::benchmark_search, DEFVAL(1000), DEFVAL(0.1f));
+
     BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::ARRAY, features, PROPERTY_HINT_TYPE_STRING, Variant::get_type_name(Variant::OBJECT) + '/' + Variant::get_type_name(Variant::BASIS) + ":MMFeature", PROPERTY_USAGE_DEFAULT);
     BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::FLOAT, sampling_rate);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::INT, search_mode, PROPERTY_HINT_ENUM, "Linear,Tree,ApproximateTree");
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::FLOAT, approximation_error, PROPERTY_HINT_RANGE, "0,10,0.01");
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::BOOL, soa_layout);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::INT, storage_format, PROPERTY_HINT_ENUM, "Float32,Quantized16,Quantized8");
     BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_FLOAT32_ARRAY, motion_data);
     BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_INT32_ARRAY, db_anim_index);
     BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_FLOAT32_ARRAY, db_time_index);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_FLOAT32_ARRAY, dim_weights, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_BYTE_ARRAY, quantized_data, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_FLOAT32_ARRAY, quantization_scales, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_FLOAT32_ARRAY, quantization_offsets, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::DICTIONARY, quantization_error, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_INT32_ARRAY, kd_nodes, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_FLOAT32_ARRAY, kd_bounds, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR);
+    BINDER_PROPERTY_PARAMS(MMAnimationLibrary, Variant::PACKED_INT32_ARRAY, kd_indices, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR);
+
+    BIND_ENUM_CONSTANT(Linear);
+    BIND_ENUM_CONSTANT(Tree);
+    BIND_ENUM_CONSTANT(ApproximateTree);
+
+    BIND_ENUM_CONSTANT(Float32);
+    BIND_ENUM_CONSTANT(Quantized16);
+    BIND_ENUM_CONSTANT(Quantized8);
 }
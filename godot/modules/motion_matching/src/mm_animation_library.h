@@ -35,11 +35,15 @@
 #include "editor/plugins/node_3d_editor_gizmos.h"
 #endif
 
+#include "core/os/mutex.h"
+#include "core/templates/safe_refcount.h"
 #include "scene/3d/skeleton_3d.h"
 #include "scene/resources/animation_library.h"
 
 #include "common.h"
 #include "features/mm_feature.h"
+#include "math/frame_blocks.h"
+#include "math/kd_tree.h"
 #include "mm_query.h"
 
 class MMFeature;
@@ -47,13 +51,24 @@ class MMFeature;
 class MMAnimationLibrary : public AnimationLibrary {
     GDCLASS(MMAnimationLibrary, AnimationLibrary)
 
+public:
+    enum SearchMode { Linear,
+                      Tree,
+                      ApproximateTree };
+
+    enum StorageFormat { Float32,
+                         Quantized16,
+                         Quantized8 };
+
 public:
     MMAnimationLibrary(/* args */);
     virtual ~MMAnimationLibrary();
     void bake_data(const AnimationMixer* p_player, const Skeleton3D* p_skeleton);
     MMQueryOutput query(const MMQueryInput& p_query_input);
+    float compute_animation_cost(const MMQueryInput& p_query_input, const String& p_animation, float p_time) const;
     int64_t get_dim_count() const;
     int64_t get_animation_pose_count(String p_animation_name) const;
+    Dictionary benchmark_search(int32_t p_query_count, float p_noise) const;
 
 #ifdef TOOLS_ENABLED
     void display_data(const Ref<EditorNode3DGizmo>& p_gizmo, const Transform3D& p_transform, String p_animation_name, int32_t p_pose_index) const;
@@ -61,16 +76,52 @@ public:
 
     GETSET(TypedArray<MMFeature>, features)
     GETSET(float, sampling_rate, 1.f)
+    GETSET(SearchMode, search_mode, Tree)
+    GETSET(float, approximation_error, 0.1f)
+    GETSET_CHANGED(bool, soa_layout, _invalidate_search_cache, true)
+    GETSET(StorageFormat, storage_format, Float32)
 
     // Database data
-    GETSET(PackedFloat32Array, motion_data)
-    GETSET(PackedInt32Array, db_anim_index)
+    GETSET_CHANGED(PackedFloat32Array, motion_data, _invalidate_search_cache)
+    GETSET_CHANGED(PackedInt32Array, db_anim_index, _invalidate_search_cache)
     GETSET(PackedFloat32Array, db_time_index)
+    GETSET_CHANGED(PackedFloat32Array, dim_weights, _invalidate_search_cache)
+
+    // Quantized database data, replaces motion_data when storage_format is not Float32
+    GETSET_CHANGED(PackedByteArray, quantized_data, _invalidate_search_cache)
+    GETSET_CHANGED(PackedFloat32Array, quantization_scales, _invalidate_search_cache)
+    GETSET_CHANGED(PackedFloat32Array, quantization_offsets, _invalidate_search_cache)
+    GETSET(Dictionary, quantization_error)
+
+    // Search tree data
+    GETSET_CHANGED(PackedInt32Array, kd_nodes, _invalidate_search_cache)
+    GETSET_CHANGED(PackedFloat32Array, kd_bounds, _invalidate_search_cache)
+    GETSET_CHANGED(PackedInt32Array, kd_indices, _invalidate_search_cache)
 protected:
     static void _bind_methods();
 
 private:
+    // Runtime copy of the database laid out for SIMD scoring, rebuilt on the
+    // first search after the baked data changes.
+    mutable FrameBlocks frame_blocks;
+    mutable PackedFloat32Array search_weights;
+    mutable bool search_tree_valid = false;
+    mutable BinaryMutex search_cache_mutex;
+    mutable SafeFlag search_cache_dirty;
+
     void _normalize_data(PackedFloat32Array& p_data, size_t p_dim_count) const;
+    bool _build_query_vector(const MMQueryInput& p_query_input, LocalVector<float>& r_query_vector) const;
+    PackedFloat32Array _compute_dim_weights() const;
+    bool _is_quantized() const;
+    int64_t _get_frame_count(int64_t p_dim_count) const;
+    void _get_frame(int64_t p_frame_index, int64_t p_dim_count, float* r_frame) const;
+    Dictionary _measure_quantization_error(const PackedFloat32Array& p_data, int64_t p_dim_count) const;
+    void _invalidate_search_cache();
+    void _update_search_cache() const;
+    KDTree::SearchResult _search(const float* p_query, SearchMode p_search_mode) const;
 };
 
+VARIANT_ENUM_CAST(MMAnimationLibrary::SearchMode);
+VARIANT_ENUM_CAST(MMAnimationLibrary::StorageFormat);
+
 #endif // MM_ANIMATION_LIBRARY_H
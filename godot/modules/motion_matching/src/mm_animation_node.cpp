@@ -31,6 +31,7 @@
 #include "mm_animation_node.h"
 
 #include "mm_query.h"
+#include "mm_query_scheduler.h"
 
 #ifdef TOOLS_ENABLED
 #include "editor/plugins/animation_tree_editor_plugin.h"
@@ -62,20 +63,48 @@ AnimationNode::NodeTimeInfo MMAnimationNode::_process(const AnimationMixer::Play
     _current_animation_info.playback_info = p_playback_info;
     _current_animation_info.playback_info.weight = 1.0;
 
+    MMQueryInput* query_input = Object::cast_to<MMQueryInput>(get_parameter(MOTION_MATCHING_INPUT_PARAM));
+    const NodeTimeInfo nti = _process_matching(p_playback_info, p_test_only, query_input);
+
+    if (query_input) {
+        // Lets the scheduler compare the query against what is playing now.
+        query_input->current_animation = _current_animation_info.name;
+        query_input->current_time = nti.position + nti.delta;
+    }
+
+    return nti;
+}
+
+AnimationNode::NodeTimeInfo MMAnimationNode::_process_matching(const AnimationMixer::PlaybackInfo p_playback_info, bool p_test_only, MMQueryInput* p_query_input) {
+    if (p_query_input && p_query_input->schedule_state == MMQueryInput::ScheduleState::Pending) {
+        // The first node that needs a scheduled result runs the whole batch.
+        MMQueryScheduler::get_singleton()->flush();
+    }
+
+    if (p_query_input && p_query_input->schedule_state == MMQueryInput::ScheduleState::Skipped) {
+        p_query_input->schedule_state = MMQueryInput::ScheduleState::Unscheduled;
+        _time_since_last_query += p_playback_info.delta;
+        return _update_current_animation(p_test_only);
+    }
+
+    if (p_query_input && p_query_input->schedule_state == MMQueryInput::ScheduleState::Done) {
+        p_query_input->schedule_state = MMQueryInput::ScheduleState::Unscheduled;
+        _time_since_last_query = 0.f;
+        _apply_query_output(p_query_input->scheduled_output, p_playback_info, p_test_only);
+        return _update_current_animation(p_test_only);
+    }
+
     const bool is_about_to_end = false; // TODO: Implement this
 
     // We run queries periodically, or when the animation is about to end
-    const bool has_current_animation = !_last_query_output.animation_match.is_empty();
-    const bool should_query = (_time_since_last_query > (1.0 / query_frequency)) || is_about_to_end || !has_current_animation;
+    const bool should_query = is_query_due() || is_about_to_end;
 
     if (!should_query) {
         _time_since_last_query += p_playback_info.delta;
         return _update_current_animation(p_test_only);
     }
 
-    MMQueryInput* query_input = Object::cast_to<MMQueryInput>(get_parameter(MOTION_MATCHING_INPUT_PARAM));
-
-    if (!query_input || !query_input->is_valid()) {
+    if (!p_query_input || !p_query_input->is_valid()) {
         _time_since_last_query += p_playback_info.delta;
         return _update_current_animation(p_test_only);
     }
@@ -84,23 +113,31 @@ AnimationNode::NodeTimeInfo MMAnimationNode::_process(const AnimationMixer::Play
 
     // Run query
     Ref<MMAnimationLibrary> animation_library = get_animation_tree()->get_animation_library(library);
-    ERR_FAIL_COND_V_MSG(animation_library.is_null(), cur_nti, "Library not found: " + library);
-    const MMQueryOutput query_output = animation_library->query(*query_input);
+    ERR_FAIL_COND_V_MSG(animation_library.is_null(), get_node_time_info(), "Library not found: " + library);
+    const MMQueryOutput query_output = animation_library->query(*p_query_input);
+    _apply_query_output(query_output, p_playback_info, p_test_only);
 
-    const bool is_same_animation = query_output.animation_match == _last_query_output.animation_match;
-    const bool is_same_time = abs(query_output.time_match - p_playback_info.time) < QUERY_TIME_ERROR;
+    return _update_current_animation(p_test_only);
+}
+
+bool MMAnimationNode::is_query_due() const {
+    const bool has_current_animation = !_last_query_output.animation_match.is_empty();
+    return (_time_since_last_query > (1.0 / query_frequency)) || !has_current_animation;
+}
+
+void MMAnimationNode::_apply_query_output(const MMQueryOutput& p_query_output, const AnimationMixer::PlaybackInfo p_playback_info, bool p_test_only) {
+    const bool is_same_animation = p_query_output.animation_match == _last_query_output.animation_match;
+    const bool is_same_time = abs(p_query_output.time_match - p_playback_info.time) < QUERY_TIME_ERROR;
 
     // Play selected animation
     if (!is_same_animation || !is_same_time) {
-        const String animation_match = query_output.animation_match;
-        const float time_match = query_output.time_match;
+        const String animation_match = p_query_output.animation_match;
+        const float time_match = p_query_output.time_match;
         if (!p_test_only) {
             _start_transition(animation_match, time_match);
         }
-        _last_query_output = query_output;
+        _last_query_output = p_query_output;
     }
-
-    return _update_current_animation(p_test_only);
 }
 
 void MMAnimationNode::_start_transition(const StringName p_animation, float p_time) {
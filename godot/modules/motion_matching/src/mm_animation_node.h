@@ -54,6 +54,8 @@ public:
     virtual String get_caption() const override;
     virtual bool has_filter() const override;
 
+    bool is_query_due() const;
+
     static StringName MOTION_MATCHING_INPUT_PARAM;
 
 protected:
@@ -70,6 +72,8 @@ private:
 
     AnimationInfo _current_animation_info;
 
+    AnimationNode::NodeTimeInfo _process_matching(const AnimationMixer::PlaybackInfo p_playback_info, bool p_test_only, MMQueryInput* p_query_input);
+    void _apply_query_output(const MMQueryOutput& p_query_output, const AnimationMixer::PlaybackInfo p_playback_info, bool p_test_only);
     void _start_transition(const StringName p_animation, float p_time);
     AnimationNode::NodeTimeInfo _update_current_animation(bool p_test_only);
 
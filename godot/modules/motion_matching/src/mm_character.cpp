@@ -33,9 +33,32 @@
 #include "math/spring.hpp"
 #include "mm_animation_library.h"
 #include "mm_animation_node.h"
+#include "mm_query_scheduler.h"
 
 #include <cstdint>
 
+SafeNumeric<uint64_t> MMCharacter::_pipeline_buffer_allocations;
+
+namespace {
+
+// Storage of a pipeline buffer, compared before and after it is written to count
+// the writes that had to allocate, whatever the reason.
+template <typename T>
+struct BufferStorage {
+    const T* data;
+    size_t capacity;
+
+    explicit BufferStorage(const std::vector<T>& p_buffer)
+        : data(p_buffer.data()), capacity(p_buffer.capacity()) {
+    }
+
+    bool reallocated(const std::vector<T>& p_buffer) const {
+        return p_buffer.data() != data || p_buffer.capacity() != capacity;
+    }
+};
+
+} // namespace
+
 MMCharacter::MMCharacter()
     : CharacterBody3D() {
 }
@@ -59,24 +82,27 @@ void MMCharacter::_update_character(float delta_t) {
 
 Vector3 MMCharacter::_update_trajectory(float delta_t) {
     Vector3 current_velocity = get_velocity();
-    Vector3 current_up_direction = get("up_direction");
+    // The getter is private in CharacterBody3D, go through the property once per tick.
+    _up_direction = get(SNAME("up_direction"));
+    const Vector3 current_up_direction = _up_direction;
 
     // Update the velocity.
     const Vector3 up_velocity = current_velocity.dot(current_up_direction) * current_up_direction;
     Vector3 ground_velocity = current_velocity - up_velocity;
-    Array result = Spring::simple_spring_damper_exact(
+    Spring::_simple_spring_damper_exact(
         ground_velocity,
         _spring_acceleration,
         target_velocity,
         halflife,
         delta_t);
-    Vector3 new_velocity = (Vector3)result[0] + up_velocity;
-    _spring_acceleration = result[1];
+    Vector3 new_velocity = ground_velocity + up_velocity;
 
     if (!is_on_floor()) {
         new_velocity += get_gravity() * delta_t;
     }
 
+    _ensure_pipeline_capacity();
+
     _generate_trajectory(delta_t);
 
     _update_history(delta_t);
@@ -108,20 +134,18 @@ void MMCharacter::_generate_trajectory(float delta_time) {
     MMTrajectoryPoint point = _get_current_trajectory_point();
 
     Vector3 spring_acceleration = _spring_acceleration;
+    const Vector3 current_up_direction = _up_direction;
 
     // The first point represents the player's current position, and is not considered part
     // of the trajectory for motion matching
     for (size_t i = 0; i < trajectory_point_count + 1; i++) {
         _trajectory[i] = point;
 
-        Vector3 current_up_direction = get("up_direction");
-
         // Update velocity
         const Vector3 up_velocity = point.velocity.dot(current_up_direction) * current_up_direction;
         Vector3 ground_velocity = point.velocity - up_velocity;
-        Array result = Spring::simple_spring_damper_exact(ground_velocity, spring_acceleration, target_velocity, halflife, delta_t);
-        point.velocity = (Vector3)result[0] + up_velocity;
-        spring_acceleration = result[1];
+        Spring::_simple_spring_damper_exact(ground_velocity, spring_acceleration, target_velocity, halflife, delta_t);
+        point.velocity = ground_velocity + up_velocity;
 
         // Update facing
         if (point.velocity.length_squared() > SMALL_NUMBER && !is_strafing) {
@@ -163,26 +187,40 @@ void MMCharacter::_update_history(double delta_t) {
     _history_buffer.push(_get_current_trajectory_point());
 }
 
-void MMCharacter::_move_with_collisions(MMTrajectoryPoint& point, float delta_t) {
-    const Vector3 motion = point.velocity * delta_t;
+void MMCharacter::_ensure_pipeline_capacity() {
+    // Buffers only change size when the point counts are edited, never per tick.
+    if (_trajectory.size() != trajectory_point_count + 1) {
+        const BufferStorage<MMTrajectoryPoint> storage(_trajectory);
+        _trajectory.resize(trajectory_point_count + 1);
+        if (storage.reallocated(_trajectory)) {
+            _pipeline_buffer_allocations.increment();
+        }
+    }
+    if (_trajectory_history.size() != history_point_count) {
+        const BufferStorage<MMTrajectoryPoint> storage(_trajectory_history);
+        _trajectory_history.resize(history_point_count);
+        if (storage.reallocated(_trajectory_history)) {
+            _pipeline_buffer_allocations.increment();
+        }
+    }
+}
 
-    Ref<PhysicsTestMotionParameters3D> params;
-    params.instantiate();
-    Vector3 current_up_direction = get("up_direction");
-    params->set_from(point.get_transform(current_up_direction));
-    params->set_motion(motion);
-    params->set_max_collisions(6);
-    params->set_recovery_as_collision_enabled(false);
+bool MMCharacter::_probe_motion(const MMTrajectoryPoint& point, const Vector3& motion, int max_collisions, bool recovery_as_collision) {
+    // Each predicted point starts where the previous probe ended, so probes run in sequence
+    // and share one parameter/result pair instead of allocating test motion objects.
+    _probe_parameters.from = point.get_transform(_up_direction);
+    _probe_parameters.motion = motion;
+    _probe_parameters.max_collisions = max_collisions;
+    _probe_parameters.recovery_as_collision = recovery_as_collision;
+    _probe_result.collision_count = 0;
 
-    Ref<PhysicsTestMotionResult3D> collision_result;
-    collision_result.instantiate();
+    return PhysicsServer3D::get_singleton()->body_test_motion(get_rid(), _probe_parameters, &_probe_result);
+}
 
-    bool is_colliding = PhysicsServer3D::get_singleton()->body_test_motion(
-        get_rid(),
-        params->get_parameters(),
-        collision_result->get_result_ptr());
+void MMCharacter::_move_with_collisions(MMTrajectoryPoint& point, float delta_t) {
+    const Vector3 motion = point.velocity * delta_t;
 
-    if (!is_colliding) {
+    if (!_probe_motion(point, motion, 6, false)) {
         // We move in the direction of motion as usual
         point.position += motion;
 
@@ -191,11 +229,11 @@ void MMCharacter::_move_with_collisions(MMTrajectoryPoint& point, float delta_t)
         return;
     }
 
-    _fill_collision_state(collision_result, point.collision_state);
+    _fill_collision_state(_probe_result, point.collision_state);
 
     // Update final position
     Vector3 result_velocity = point.velocity;
-    point.position += collision_result->get_travel();
+    point.position += _probe_result.travel;
 
     if (point.collision_state.against_wall) {
 
@@ -211,53 +249,43 @@ void MMCharacter::_move_with_collisions(MMTrajectoryPoint& point, float delta_t)
 
     point.velocity = result_velocity;
     // Move the remaining part of motion
-    point.position += point.velocity * delta_t * (1.0 - collision_result->get_collision_safe_fraction());
+    point.position += point.velocity * delta_t * (1.0 - _probe_result.collision_safe_fraction);
 }
 
-void MMCharacter::_fill_collision_state(const Ref<PhysicsTestMotionResult3D> collision_result, MMCollisionState& state) {
+void MMCharacter::_fill_collision_state(const PhysicsServer3D::MotionResult& collision_result, MMCollisionState& state) {
     real_t wall_depth = -1.0;
     real_t floor_depth = -1.0;
 
+    const Vector3 current_up_direction = _up_direction;
     state.on_floor = false;
-    for (int i = collision_result->get_collision_count() - 1; i >= 0; i--) {
-        Vector3 current_up_direction = get("up_direction");
-        real_t floor_angle = Math::acos(collision_result->get_collision_normal(i).dot(current_up_direction));
-        if (floor_angle <= get_floor_max_angle() && collision_result->get_collision_depth(i) > floor_depth) {
+    for (int i = collision_result.collision_count - 1; i >= 0; i--) {
+        const PhysicsServer3D::MotionCollision& collision = collision_result.collisions[i];
+        real_t floor_angle = collision.get_angle(current_up_direction);
+        if (floor_angle <= get_floor_max_angle() && collision.depth > floor_depth) {
             state.on_floor = true;
-            state.floor_normal = collision_result->get_collision_normal(i);
-            state.floor_position = collision_result->get_collision_point(i);
-            floor_depth = collision_result->get_collision_depth(i);
+            state.floor_normal = collision.normal;
+            state.floor_position = collision.position;
+            floor_depth = collision.depth;
             continue;
         }
 
         state.against_wall = true;
-        if (collision_result->get_collision_depth(i) > wall_depth) {
+        if (collision.depth > wall_depth) {
             state.against_wall = true;
-            state.wall_normal = collision_result->get_collision_normal(i);
-            wall_depth = collision_result->get_collision_depth(i);
+            state.wall_normal = collision.normal;
+            wall_depth = collision.depth;
         }
     }
 }
 
 void MMCharacter::_fall_to_floor(MMTrajectoryPoint& point, float delta_t) {
     const Vector3 motion = get_gravity() * delta_t * delta_t;
-    Ref<PhysicsTestMotionParameters3D> params;
-    params.instantiate();
-    Vector3 current_up_direction = get("up_direction");
-    params->set_from(point.get_transform(current_up_direction));
-    params->set_motion(motion);
-
-    Ref<PhysicsTestMotionResult3D> collision_result;
-    collision_result.instantiate();
-
-    if (PhysicsServer3D::get_singleton()->body_test_motion(
-            get_rid(),
-            params->get_parameters(),
-            collision_result->get_result_ptr())) {
-        point.position += collision_result->get_travel();
+
+    if (_probe_motion(point, motion, 1, false)) {
+        point.position += _probe_result.travel;
         point.velocity.y = 0.0;
         point.collision_state.on_floor = true;
-        point.collision_state.floor_normal = collision_result->get_collision_normal();
+        point.collision_state.floor_normal = _probe_result.collisions[0].normal;
     } else {
         point.position += motion;
         point.velocity += get_gravity() * delta_t;
@@ -266,24 +294,75 @@ void MMCharacter::_fall_to_floor(MMTrajectoryPoint& point, float delta_t) {
 }
 
 void MMCharacter::_fill_query_input(MMQueryInput& input) {
+    // The copies reuse the storage of the previous tick once it is large enough.
+    const BufferStorage<MMTrajectoryPoint> trajectory_storage(input.trajectory);
+    const BufferStorage<MMTrajectoryPoint> history_storage(input.trajectory_history);
+    const BufferStorage<BoneState> skeleton_storage(input.skeleton_state.bone_states);
+
     input.controller_velocity = get_velocity();
     input.trajectory = get_trajectory();
     input.trajectory_history = get_trajectory_history();
     input.controller_transform = get_global_transform();
     input.character_transform = skeleton->get_global_transform();
     input.skeleton_state = _skeleton_state;
+
+    const uint64_t allocations = trajectory_storage.reallocated(input.trajectory) + history_storage.reallocated(input.trajectory_history) + skeleton_storage.reallocated(input.skeleton_state.bone_states);
+    if (allocations > 0) {
+        _pipeline_buffer_allocations.add(allocations);
+    }
+}
+
+void MMCharacter::_find_motion_matching_nodes(const String& p_base_path, const Ref<AnimationNode>& p_node) {
+    if (p_node.is_null()) {
+        return;
+    }
+
+    const Ref<MMAnimationNode> mm_node = p_node;
+    if (mm_node.is_valid()) {
+        MMNodeInput node_input;
+        node_input.param = p_base_path + MMAnimationNode::MOTION_MATCHING_INPUT_PARAM;
+        node_input.node = mm_node;
+        node_input.query_input.instantiate();
+        _mm_inputs.push_back(node_input);
+    }
+
+    List<AnimationNode::ChildNode> child_nodes;
+    p_node->get_child_nodes(&child_nodes);
+    for (const AnimationNode::ChildNode& child_node : child_nodes) {
+        _find_motion_matching_nodes(p_base_path + child_node.name + "/", child_node.node);
+    }
 }
 
 void MMCharacter::_update_query() {
+    if (!animation_tree) {
+        return;
+    }
+
+    MMQueryScheduler* scheduler = MMQueryScheduler::get_singleton();
+    const bool use_scheduler = scheduler && scheduler->get_enabled();
+
     // Fill query_input with data from the controller
-    if (animation_tree) {
-        Ref<MMQueryInput> query_input;
-        query_input.instantiate();
-        _fill_query_input(**query_input);
-        for (const StringName& param : _mm_input_params) {
-            animation_tree->set(param, query_input);
+    for (const MMNodeInput& node_input : _mm_inputs) {
+        _fill_query_input(**node_input.query_input);
+        animation_tree->set(node_input.param, node_input.query_input);
+
+        if (!use_scheduler || !animation_tree->has_animation_library(node_input.node->get_library())) {
+            continue;
+        }
+
+        // In budget mode the scheduler decides when to search, otherwise the node does.
+        if (scheduler->get_budget_mode() || node_input.node->is_query_due()) {
+            Ref<MMAnimationLibrary> library = animation_tree->get_animation_library(node_input.node->get_library());
+            if (library.is_valid()) {
+                scheduler->submit(library, node_input.query_input);
+            }
         }
     }
+
+    if (use_scheduler && animation_tree->get_physics_process_priority() <= get_physics_process_priority()) {
+        // Trees have to process after every character submitted its query, so they all land in one batch.
+        WARN_PRINT_ONCE("MMQueryScheduler: the AnimationTree of an MMCharacter processes before it, so its query result is applied one frame late. Give the AnimationTree a higher physics process priority than the MMCharacter to batch it.");
+    }
 }
 
 void MMCharacter::_apply_root_motion() {
@@ -331,7 +410,14 @@ void MMCharacter::_reset_skeleton_state() {
 }
 
 void MMCharacter::_update_skeleton_state(double delta_t) {
-    SkeletonState current_state(skeleton);
+    SkeletonState& current_state = _current_skeleton_state;
+    if (current_state.bone_states.size() != _skeleton_state.bone_states.size()) {
+        const BufferStorage<BoneState> storage(current_state.bone_states);
+        current_state.bone_states.resize(_skeleton_state.bone_states.size());
+        if (storage.reallocated(current_state.bone_states)) {
+            _pipeline_buffer_allocations.increment();
+        }
+    }
     _fill_current_skeleton_state(current_state);
 
     for (int b = 0; b < skeleton->get_bone_count(); ++b) {
@@ -348,6 +434,29 @@ void MMCharacter::_update_skeleton_state(double delta_t) {
     }
 }
 
+void MMCharacter::trajectory_to_dict(const std::vector<MMTrajectoryPoint>& p_trajectory, TypedArray<Dictionary>& r_result) const {
+    static const String position_key = "position";
+    static const String velocity_key = "velocity";
+    static const String facing_key = "facing";
+    static const String on_floor_key = "on_floor";
+
+    if (r_result.size() != (int64_t)p_trajectory.size()) {
+        r_result.resize(p_trajectory.size());
+        for (int64_t i = 0; i < r_result.size(); ++i) {
+            r_result[i] = Dictionary();
+        }
+    }
+
+    for (size_t i = 0; i < p_trajectory.size(); ++i) {
+        const MMTrajectoryPoint& point = p_trajectory[i];
+        Dictionary trajectory_data = r_result[i];
+        trajectory_data[position_key] = point.position;
+        trajectory_data[velocity_key] = point.velocity;
+        trajectory_data[facing_key] = point.facing_angle;
+        trajectory_data[on_floor_key] = point.collision_state.on_floor;
+    }
+}
+
 Dictionary MMCharacter::_output_to_dict(const MMQueryOutput& output) {
     Dictionary result;
 
@@ -423,21 +532,13 @@ void MMCharacter::_notification(int p_what) {
             _history_buffer.push(_get_current_trajectory_point());
         }
 
-        _trajectory.resize(trajectory_point_count + 1);
-        _trajectory_history.resize(history_point_count);
+        _ensure_pipeline_capacity();
 
         if (animation_tree) {
             animation_tree->set_callback_mode_process(AnimationMixer::ANIMATION_CALLBACK_MODE_PROCESS_PHYSICS);
 
-            List<PropertyInfo> properties;
-            animation_tree->get_property_list(&properties);
-            for (const PropertyInfo& prop : properties) {
-                const bool is_object = prop.type == Variant::OBJECT;
-                const bool is_mm_input = prop.class_name == "MMQueryInput";
-                if (is_object && is_mm_input) {
-                    _mm_input_params.push_back(prop.name);
-                }
-            }
+            _mm_inputs.clear();
+            _find_motion_matching_nodes(Animation::PARAMETERS_BASE_PATH, animation_tree->get_root_animation_node());
         }
 
         if (skeleton && animation_tree) {
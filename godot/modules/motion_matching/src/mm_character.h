@@ -33,12 +33,14 @@
 
 #include "circular_buffer.h"
 #include "common.h"
+#include "mm_animation_node.h"
 #include "mm_character.h"
 #include "mm_query.h"
 #include "mm_trajectory_point.h"
 #include "synchronizers/mm_synchronizer.h"
 
 #include "core/input/input_event.h"
+#include "core/templates/safe_refcount.h"
 #include "scene/3d/physics/character_body_3d.h"
 #include "scene/3d/skeleton_3d.h"
 #include "scene/animation/animation_player.h"
@@ -71,25 +73,31 @@ public:
         return result;
     }
 
+    // The returned arrays are cached and updated in place, so scripts polling them
+    // every frame do not allocate once the point counts stop changing. Callers that
+    // keep a result across calls see it change, they have to duplicate it.
     TypedArray<Dictionary> get_trajectory_typed_array() const {
-        return trajectory_to_dict(_trajectory);
+        trajectory_to_dict(_trajectory, _trajectory_dicts);
+        return _trajectory_dicts;
     }
 
     TypedArray<Dictionary> get_trajectory_history_typed_array() const {
-        return trajectory_to_dict(_trajectory_history);
+        trajectory_to_dict(_trajectory_history, _trajectory_history_dicts);
+        return _trajectory_history_dicts;
     }
 
-    TypedArray<Dictionary> trajectory_to_dict(const std::vector<MMTrajectoryPoint>& p_trajectory) const {
-        TypedArray<Dictionary> result;
-        for (const MMTrajectoryPoint& point : p_trajectory) {
-            Dictionary trajectory_data;
-            trajectory_data.get_or_add("position", point.position);
-            trajectory_data.get_or_add("velocity", point.velocity);
-            trajectory_data.get_or_add("facing", point.facing_angle);
-            trajectory_data.get_or_add("on_floor", point.collision_state.on_floor);
-            result.push_back(trajectory_data);
-        }
-        return result;
+    void trajectory_to_dict(const std::vector<MMTrajectoryPoint>& p_trajectory, TypedArray<Dictionary>& r_result) const;
+
+    // Number of times the trajectory, history, skeleton and query input buffers of all
+    // characters moved to a new allocation. Stays constant while the point counts and the
+    // skeleton do not change. It does not count other heap allocations, such as the ones
+    // done by the physics queries.
+    static uint64_t get_pipeline_buffer_allocation_count() {
+        return _pipeline_buffer_allocations.get();
+    }
+
+    static void reset_pipeline_buffer_allocation_count() {
+        _pipeline_buffer_allocations.set(0);
     }
 
     AnimationMixer* get_animation_mixer() const;
@@ -127,12 +135,15 @@ private:
     MMTrajectoryPoint _get_current_trajectory_point() const;
     void _generate_trajectory(float delta_time);
     void _update_history(double delta_t);
+    void _ensure_pipeline_capacity();
     void _move_with_collisions(MMTrajectoryPoint& point, float delta_t);
-    void _fill_collision_state(const Ref<PhysicsTestMotionResult3D> collision_result, MMCollisionState& state);
+    void _fill_collision_state(const PhysicsServer3D::MotionResult& collision_result, MMCollisionState& state);
     void _fall_to_floor(MMTrajectoryPoint& point, float delta_t);
+    bool _probe_motion(const MMTrajectoryPoint& point, const Vector3& motion, int max_collisions, bool recovery_as_collision);
 
     // Motion Matching
     void _fill_query_input(MMQueryInput& input);
+    void _find_motion_matching_nodes(const String& p_base_path, const Ref<AnimationNode>& p_node);
     void _update_query();
     void _apply_root_motion();
     void _update_synchronizer(double delta_t);
@@ -147,18 +158,32 @@ private:
 private:
     // Controller
     Vector3 _spring_acceleration;
+    Vector3 _up_direction{0, 1, 0};
 
     // Trajectory
     std::vector<MMTrajectoryPoint> _trajectory;
     std::vector<MMTrajectoryPoint> _trajectory_history;
     CircularBuffer<MMTrajectoryPoint> _history_buffer{HISTORY_BUFFER_SIZE};
+    mutable TypedArray<Dictionary> _trajectory_dicts;
+    mutable TypedArray<Dictionary> _trajectory_history_dicts;
+    static SafeNumeric<uint64_t> _pipeline_buffer_allocations;
+
+    // Collision probes, reused by every predicted point.
+    PhysicsServer3D::MotionParameters _probe_parameters;
+    PhysicsServer3D::MotionResult _probe_result;
 
     // Skeleton State
     SkeletonState _skeleton_state;
+    SkeletonState _current_skeleton_state;
     int32_t _root_bone_idx{-1};
 
     // Motion Matching parameters
-    List<StringName> _mm_input_params;
+    struct MMNodeInput {
+        StringName param;
+        Ref<MMAnimationNode> node;
+        Ref<MMQueryInput> query_input;
+    };
+    LocalVector<MMNodeInput> _mm_inputs;
 };
 
 #endif // MM_CHARACTER_H
@@ -37,6 +37,14 @@
 #include "mm_bone_state.h"
 #include "mm_trajectory_point.h"
 
+struct MMQueryOutput {
+    String animation_match;
+    float time_match = 0.f;
+    float cost = FLT_MAX;
+    PackedFloat32Array matched_frame_data;
+    Dictionary feature_costs;
+};
+
 class MMQueryInput : public RefCounted {
     GDCLASS(MMQueryInput, RefCounted);
 
@@ -54,17 +62,23 @@ public:
         return !trajectory.empty();
     }
 
+    // Scheduling state, managed by MMQueryScheduler
+    enum class ScheduleState { Unscheduled,
+                               Pending,
+                               Skipped,
+                               Done };
+    ScheduleState schedule_state = ScheduleState::Unscheduled;
+    MMQueryOutput scheduled_output;
+    uint32_t frames_since_search = 0;
+    bool has_schedule_phase = false;
+
+    // Playback state reported by MMAnimationNode
+    StringName current_animation;
+    float current_time = 0.f;
+
 protected:
     static void _bind_methods() {
     }
 };
 
-struct MMQueryOutput {
-    String animation_match;
-    float time_match;
-    float cost;
-    PackedFloat32Array matched_frame_data;
-    Dictionary feature_costs;
-};
-
 #endif // MM_QUERY_H
@@ -0,0 +1,182 @@
+/**************************************************************************/
+/*  mm_query_scheduler.cpp                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "mm_query_scheduler.h"
+
+#include "mm_character.h"
+
+#include "core/object/worker_thread_pool.h"
+#include "core/os/os.h"
+
+MMQueryScheduler* MMQueryScheduler::singleton = nullptr;
+
+MMQueryScheduler::MMQueryScheduler() {
+    singleton = this;
+}
+
+MMQueryScheduler::~MMQueryScheduler() {
+    singleton = nullptr;
+}
+
+MMQueryScheduler* MMQueryScheduler::get_singleton() {
+    return singleton;
+}
+
+void MMQueryScheduler::submit(const Ref<MMAnimationLibrary>& p_library, const Ref<MMQueryInput>& p_query_input) {
+    ERR_FAIL_COND(p_library.is_null() || p_query_input.is_null());
+
+    if (!p_query_input->is_valid()) {
+        return;
+    }
+
+    if (p_query_input->schedule_state == MMQueryInput::ScheduleState::Pending) {
+        // Not flushed since the last submission, the pending job will use the updated input.
+        return;
+    }
+
+    MutexLock lock(_mutex);
+    _submitted_count++;
+
+    if (budget_mode) {
+        const uint32_t interval = MAX(query_interval, 1);
+        if (!p_query_input->has_schedule_phase) {
+            // Spread characters over the interval so their searches do not land on the same frames.
+            p_query_input->frames_since_search = _next_schedule_phase++ % interval;
+            p_query_input->has_schedule_phase = true;
+        }
+        p_query_input->frames_since_search++;
+        if (p_query_input->frames_since_search < interval) {
+            p_query_input->schedule_state = MMQueryInput::ScheduleState::Skipped;
+            _skipped_count++;
+            return;
+        }
+    }
+
+    p_query_input->schedule_state = MMQueryInput::ScheduleState::Pending;
+    _pending_jobs.push_back({ p_library, p_query_input });
+}
+
+void MMQueryScheduler::flush() {
+    MutexLock flush_lock(_flush_mutex);
+    {
+        MutexLock lock(_mutex);
+        if (_pending_jobs.is_empty()) {
+            return;
+        }
+        SWAP(_pending_jobs, _running_jobs);
+    }
+
+    const uint64_t start_usec = OS::get_singleton()->get_ticks_usec();
+    uint64_t skipped_count = 0;
+
+    if (budget_mode && max_queries_per_frame > 0 && _running_jobs.size() > (uint32_t)max_queries_per_frame) {
+        // Search the stalest characters first, the others wait for the next frames.
+        struct StalestFirst {
+            bool operator()(const Job& p_a, const Job& p_b) const {
+                return p_a.query_input->frames_since_search > p_b.query_input->frames_since_search;
+            }
+        };
+        _running_jobs.sort_custom<StalestFirst>();
+        for (uint32_t i = max_queries_per_frame; i < _running_jobs.size(); i++) {
+            _running_jobs[i].query_input->schedule_state = MMQueryInput::ScheduleState::Skipped;
+            skipped_count++;
+        }
+        _running_jobs.resize(max_queries_per_frame);
+    }
+
+    _thread_early_exit_count.set(0);
+    WorkerThreadPool::GroupID group_task = WorkerThreadPool::get_singleton()->add_template_group_task(this, &MMQueryScheduler::_run_job, _running_jobs.ptr(), _running_jobs.size(), -1, true, SNAME("MMQueryScheduler"));
+    WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_task);
+
+    const uint64_t early_exits = _thread_early_exit_count.get();
+    const uint32_t batch_size = _running_jobs.size();
+    _running_jobs.clear();
+
+    MutexLock lock(_mutex);
+    _early_exit_count += early_exits;
+    _skipped_count += skipped_count + early_exits;
+    _searched_count += batch_size - early_exits;
+    _last_batch_size = batch_size;
+    _last_flush_usec = OS::get_singleton()->get_ticks_usec() - start_usec;
+}
+
+void MMQueryScheduler::_run_job(uint32_t p_index, Job* p_jobs) {
+    Job& job = p_jobs[p_index];
+    MMQueryInput& query_input = **job.query_input;
+    query_input.frames_since_search = 0;
+
+    if (budget_mode && early_exit_cost > 0.f && !query_input.current_animation.is_empty()) {
+        // Keep playing the current animation when it still matches the query well enough.
+        const float current_cost = job.library->compute_animation_cost(query_input, query_input.current_animation, query_input.current_time);
+        if (current_cost < early_exit_cost) {
+            query_input.schedule_state = MMQueryInput::ScheduleState::Skipped;
+            _thread_early_exit_count.increment();
+            return;
+        }
+    }
+
+    query_input.scheduled_output = job.library->query(query_input);
+    query_input.schedule_state = MMQueryInput::ScheduleState::Done;
+}
+
+Dictionary MMQueryScheduler::get_stats() const {
+    MutexLock lock(_mutex);
+    Dictionary stats;
+    stats["submitted"] = _submitted_count;
+    stats["searched"] = _searched_count;
+    stats["skipped"] = _skipped_count;
+    stats["early_exits"] = _early_exit_count;
+    stats["last_batch_size"] = _last_batch_size;
+    stats["last_flush_usec"] = _last_flush_usec;
+    stats["trajectory_buffer_allocations"] = MMCharacter::get_pipeline_buffer_allocation_count();
+    return stats;
+}
+
+void MMQueryScheduler::reset_stats() {
+    MutexLock lock(_mutex);
+    _submitted_count = 0;
+    _searched_count = 0;
+    _skipped_count = 0;
+    _early_exit_count = 0;
+    _last_batch_size = 0;
+    _last_flush_usec = 0;
+    MMCharacter::reset_pipeline_buffer_allocation_count();
+}
+
+void MMQueryScheduler::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("get_stats"), &MMQueryScheduler::get_stats);
+    ClassDB::bind_method(D_METHOD("reset_stats"), &MMQueryScheduler::reset_stats);
+
+    BINDER_PROPERTY_PARAMS(MMQueryScheduler, Variant::BOOL, enabled);
+    BINDER_PROPERTY_PARAMS(MMQueryScheduler, Variant::BOOL, budget_mode);
+    BINDER_PROPERTY_PARAMS(MMQueryScheduler, Variant::INT, query_interval, PROPERTY_HINT_RANGE, "1,60,1,or_greater");
+    BINDER_PROPERTY_PARAMS(MMQueryScheduler, Variant::INT, max_queries_per_frame, PROPERTY_HINT_RANGE, "0,256,1,or_greater");
+    BINDER_PROPERTY_PARAMS(MMQueryScheduler, Variant::FLOAT, early_exit_cost, PROPERTY_HINT_RANGE, "0,10,0.001,or_greater");
+}
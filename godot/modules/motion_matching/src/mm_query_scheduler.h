@@ -0,0 +1,102 @@
+/**************************************************************************/
+/*  mm_query_scheduler.h                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef MM_QUERY_SCHEDULER_H
+#define MM_QUERY_SCHEDULER_H
+
+#include "core/object/object.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+
+#include "common.h"
+#include "mm_animation_library.h"
+#include "mm_query.h"
+
+// Batches the motion matching queries of every MMCharacter for a physics frame
+// and runs them in parallel on the WorkerThreadPool. Characters submit their
+// query input after updating it, and the first MMAnimationNode that needs a
+// result flushes the whole batch before blending.
+class MMQueryScheduler : public Object {
+    GDCLASS(MMQueryScheduler, Object)
+
+public:
+    MMQueryScheduler();
+    virtual ~MMQueryScheduler();
+
+    static MMQueryScheduler* get_singleton();
+
+    void submit(const Ref<MMAnimationLibrary>& p_library, const Ref<MMQueryInput>& p_query_input);
+    void flush();
+
+    Dictionary get_stats() const;
+    void reset_stats();
+
+    GETSET(bool, enabled, false)
+
+    // Budget
+    GETSET(bool, budget_mode, false)
+    GETSET(int32_t, query_interval, 4)
+    GETSET(int32_t, max_queries_per_frame, 0)
+    GETSET(float, early_exit_cost, 0.f)
+
+protected:
+    static void _bind_methods();
+
+private:
+    struct Job {
+        Ref<MMAnimationLibrary> library;
+        Ref<MMQueryInput> query_input;
+    };
+
+    static MMQueryScheduler* singleton;
+
+    // Characters can submit from several threads, _mutex guards the pending jobs and
+    // the stats. _flush_mutex is held for a whole batch, so a node flushing while
+    // another batch runs waits for the results instead of searching on its own.
+    Mutex _mutex;
+    BinaryMutex _flush_mutex;
+    LocalVector<Job> _pending_jobs;
+    LocalVector<Job> _running_jobs;
+    uint32_t _next_schedule_phase = 0;
+
+    // Stats
+    uint64_t _submitted_count = 0;
+    uint64_t _searched_count = 0;
+    uint64_t _skipped_count = 0;
+    uint64_t _early_exit_count = 0;
+    uint64_t _last_flush_usec = 0;
+    uint32_t _last_batch_size = 0;
+    SafeNumeric<uint64_t> _thread_early_exit_count;
+
+    void _run_job(uint32_t p_index, Job* p_jobs);
+};
+
+#endif // MM_QUERY_SCHEDULER_H
@@ -56,6 +56,8 @@ private:
 	NodePath root_path = NodePath(".."); // Start with parent, like with AnimationPlayer.
 	uint64_t sync_interval_usec = 0;
 	uint64_t delta_interval_usec = 0;
+	real_t interest_radius = 0.0;
+	real_t replication_priority = 1.0;
 	VisibilityUpdateMode visibility_update_mode = VISIBILITY_PROCESS_IDLE;
 	HashSet<Callable> visibility_filters;
 	HashSet<int> peer_visibility;
@@ -99,6 +101,14 @@ public:
 	void set_delta_interval(double p_interval);
 	double get_delta_interval() const;
 
+	void set_interest_radius(real_t p_radius);
+	real_t get_interest_radius() const;
+
+	void set_replication_priority(real_t p_priority);
+	real_t get_replication_priority() const;
+
+	bool get_interest_position(Vector3 &r_position);
+
 	void set_replication_config(Ref<SceneReplicationConfig> p_config);
 	Ref<SceneReplicationConfig> get_replication_config();
 
@@ -637,6 +637,30 @@ int SceneMultiplayer::get_max_delta_packet_size() const {
 	return replicator->get_max_delta_packet_size();
 }
 
+void SceneMultiplayer::set_interest_cell_size(real_t p_size) {
+	replicator->set_interest_cell_size(p_size);
+}
+
+real_t SceneMultiplayer::get_interest_cell_size() const {
+	return replicator->get_interest_cell_size();
+}
+
+void SceneMultiplayer::set_peer_interest_origin(int p_peer, const Vector3 &p_origin) {
+	replicator->set_peer_interest_origin(p_peer, p_origin);
+}
+
+void SceneMultiplayer::clear_peer_interest_origin(int p_peer) {
+	replicator->clear_peer_interest_origin(p_peer);
+}
+
+void SceneMultiplayer::set_max_peer_bandwidth(int p_bytes_per_second) {
+	replicator->set_max_peer_bandwidth(p_bytes_per_second);
+}
+
+int SceneMultiplayer::get_max_peer_bandwidth() const {
+	return replicator->get_max_peer_bandwidth();
+}
+
 void SceneMultiplayer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_root_path", "path"), &SceneMultiplayer::set_root_path);
 	ClassDB::bind_method(D_METHOD("get_root_path"), &SceneMultiplayer::get_root_path);
@@ -665,6 +689,12 @@ void SceneMultiplayer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_max_sync_packet_size", "size"), &SceneMultiplayer::set_max_sync_packet_size);
 	ClassDB::bind_method(D_METHOD("get_max_delta_packet_size"), &SceneMultiplayer::get_max_delta_packet_size);
 	ClassDB::bind_method(D_METHOD("set_max_delta_packet_size", "size"), &SceneMultiplayer::set_max_delta_packet_size);
+	ClassDB::bind_method(D_METHOD("get_interest_cell_size"), &SceneMultiplayer::get_interest_cell_size);
+	ClassDB::bind_method(D_METHOD("set_interest_cell_size", "size"), &SceneMultiplayer::set_interest_cell_size);
+	ClassDB::bind_method(D_METHOD("set_peer_interest_origin", "peer", "origin"), &SceneMultiplayer::set_peer_interest_origin);
+	ClassDB::bind_method(D_METHOD("clear_peer_interest_origin", "peer"), &SceneMultiplayer::clear_peer_interest_origin);
+	ClassDB::bind_method(D_METHOD("get_max_peer_bandwidth"), &SceneMultiplayer::get_max_peer_bandwidth);
+	ClassDB::bind_method(D_METHOD("set_max_peer_bandwidth", "bytes_per_second"), &SceneMultiplayer::set_max_peer_bandwidth);
 
 	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "root_path"), "set_root_path", "get_root_path");
 	ADD_PROPERTY(PropertyInfo(Variant::CALLABLE, "auth_callback"), "set_auth_callback", "get_auth_callback");
@@ -674,6 +704,8 @@ void SceneMultiplayer::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "server_relay"), "set_server_relay_enabled", "is_server_relay_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_sync_packet_size"), "set_max_sync_packet_size", "get_max_sync_packet_size");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_delta_packet_size"), "set_max_delta_packet_size", "get_max_delta_packet_size");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "interest_cell_size", PROPERTY_HINT_RANGE, "0.01,1000,0.01,or_greater,suffix:m"), "set_interest_cell_size", "get_interest_cell_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_peer_bandwidth", PROPERTY_HINT_RANGE, "0,1048576,1,or_greater,suffix:B/s"), "set_max_peer_bandwidth", "get_max_peer_bandwidth");
 
 	ADD_PROPERTY_DEFAULT("refuse_new_connections", false);
 
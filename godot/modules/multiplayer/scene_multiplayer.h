@@ -201,6 +201,15 @@ public:
 	void set_max_delta_packet_size(int p_size);
 	int get_max_delta_packet_size() const;
 
+	void set_interest_cell_size(real_t p_size);
+	real_t get_interest_cell_size() const;
+
+	void set_peer_interest_origin(int p_peer, const Vector3 &p_origin);
+	void clear_peer_interest_origin(int p_peer);
+
+	void set_max_peer_bandwidth(int p_bytes_per_second);
+	int get_max_peer_bandwidth() const;
+
 	SceneMultiplayer();
 	~SceneMultiplayer();
 };
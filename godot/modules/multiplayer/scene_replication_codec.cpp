@@ -0,0 +1,471 @@
+/**************************************************************************/
+/*  scene_replication_codec.cpp                                           */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "scene_replication_codec.h"
+
+#include "core/io/marshalls.h"
+#include "scene/main/multiplayer_api.h"
+
+// Keeps fixed point values (and their differences) well within the 63 bits varbits can represent.
+static const int64_t MAX_FIXED_POINT = int64_t(1) << 52;
+
+static int _bit_length(uint64_t p_value) {
+	int bits = 0;
+	while (p_value) {
+		bits++;
+		p_value >>= 1;
+	}
+	return bits;
+}
+
+/// BitWriter
+
+void SceneReplicationCodec::BitWriter::write(uint64_t p_value, int p_bits) {
+	DEV_ASSERT(p_bits >= 0 && p_bits <= 64);
+	if (p_bits > 32) {
+		write(p_value & 0xFFFFFFFF, 32);
+		write(p_value >> 32, p_bits - 32);
+		return;
+	}
+	if (p_bits < 32) {
+		p_value &= (uint64_t(1) << p_bits) - 1;
+	}
+	scratch |= p_value << scratch_bits;
+	scratch_bits += p_bits;
+	while (scratch_bits >= 8) {
+		buffer.push_back(scratch & 0xFF);
+		scratch >>= 8;
+		scratch_bits -= 8;
+	}
+}
+
+void SceneReplicationCodec::BitWriter::write_varbits(uint64_t p_value) {
+	int bits = _bit_length(p_value);
+	DEV_ASSERT(bits < 64);
+	write(bits, 6);
+	write(p_value, bits);
+}
+
+void SceneReplicationCodec::BitWriter::flush() {
+	if (scratch_bits > 0) {
+		buffer.push_back(scratch & 0xFF);
+		scratch = 0;
+		scratch_bits = 0;
+	}
+}
+
+/// BitReader
+
+uint64_t SceneReplicationCodec::BitReader::read(int p_bits) {
+	DEV_ASSERT(p_bits >= 0 && p_bits <= 64);
+	uint64_t out = 0;
+	int done = 0;
+	while (done < p_bits) {
+		if (bit_pos >= size * 8) {
+			overflow = true;
+			return 0;
+		}
+		const int offset = bit_pos & 7;
+		const int take = MIN(8 - offset, p_bits - done);
+		const uint64_t chunk = (buffer[bit_pos >> 3] >> offset) & ((1u << take) - 1);
+		out |= chunk << done;
+		done += take;
+		bit_pos += take;
+	}
+	return out;
+}
+
+uint64_t SceneReplicationCodec::BitReader::read_varbits() {
+	int bits = read(6);
+	return read(bits);
+}
+
+/// SceneReplicationCodec
+
+bool SceneReplicationCodec::_get_components(const Variant &p_value, const Quantization &p_quantization, ValueType &r_type, real_t *r_components, int &r_count) {
+	if (p_quantization.mode == SceneReplicationConfig::QUANTIZATION_SMALLEST_THREE) {
+		if (p_value.get_type() != Variant::QUATERNION) {
+			return false;
+		}
+		const Quaternion q = p_value.operator Quaternion().normalized();
+		r_type = VALUE_QUATERNION;
+		r_components[0] = q.x;
+		r_components[1] = q.y;
+		r_components[2] = q.z;
+		r_components[3] = q.w;
+		r_count = 4;
+		return true;
+	}
+	switch (p_value.get_type()) {
+		case Variant::FLOAT: {
+			r_type = VALUE_FLOAT;
+			r_components[0] = p_value;
+			r_count = 1;
+		} break;
+		case Variant::VECTOR2: {
+			const Vector2 v = p_value;
+			r_type = VALUE_VECTOR2;
+			r_components[0] = v.x;
+			r_components[1] = v.y;
+			r_count = 2;
+		} break;
+		case Variant::VECTOR3: {
+			const Vector3 v = p_value;
+			r_type = VALUE_VECTOR3;
+			r_components[0] = v.x;
+			r_components[1] = v.y;
+			r_components[2] = v.z;
+			r_count = 3;
+		} break;
+		case Variant::VECTOR4: {
+			const Vector4 v = p_value;
+			r_type = VALUE_VECTOR4;
+			r_components[0] = v.x;
+			r_components[1] = v.y;
+			r_components[2] = v.z;
+			r_components[3] = v.w;
+			r_count = 4;
+		} break;
+		case Variant::QUATERNION: {
+			const Quaternion q = p_value;
+			r_type = VALUE_QUATERNION;
+			r_components[0] = q.x;
+			r_components[1] = q.y;
+			r_components[2] = q.z;
+			r_components[3] = q.w;
+			r_count = 4;
+		} break;
+		default:
+			return false;
+	}
+	for (int i = 0; i < r_count; i++) {
+		if (!Math::is_finite(r_components[i])) {
+			return false; // Let the variant encoding carry NaN and infinity.
+		}
+	}
+	return true;
+}
+
+Variant SceneReplicationCodec::_make_value(ValueType p_type, const real_t *p_components) {
+	switch (p_type) {
+		case VALUE_FLOAT:
+			return p_components[0];
+		case VALUE_VECTOR2:
+			return Vector2(p_components[0], p_components[1]);
+		case VALUE_VECTOR3:
+			return Vector3(p_components[0], p_components[1], p_components[2]);
+		case VALUE_VECTOR4:
+			return Vector4(p_components[0], p_components[1], p_components[2], p_components[3]);
+		case VALUE_QUATERNION:
+			return Quaternion(p_components[0], p_components[1], p_components[2], p_components[3]);
+		default:
+			break;
+	}
+	return Variant();
+}
+
+int SceneReplicationCodec::_quantize(const Quantization &p_quantization, ValueType p_type, real_t *p_components, int p_count, int64_t *r_quantized, int &r_quantized_count) {
+	const int64_t max_value = (int64_t(1) << p_quantization.bits) - 1;
+	switch (p_quantization.mode) {
+		case SceneReplicationConfig::QUANTIZATION_FIXED_POINT: {
+			for (int i = 0; i < p_count; i++) {
+				r_quantized[i] = CLAMP(int64_t(Math::round(double(p_components[i]) / p_quantization.step)), -MAX_FIXED_POINT, MAX_FIXED_POINT);
+			}
+			r_quantized_count = p_count;
+			return 0;
+		}
+		case SceneReplicationConfig::QUANTIZATION_RANGE: {
+			const double from = p_quantization.range.x;
+			const double length = p_quantization.range.y - p_quantization.range.x;
+			for (int i = 0; i < p_count; i++) {
+				const double t = CLAMP((p_components[i] - from) / length, 0.0, 1.0);
+				r_quantized[i] = int64_t(Math::round(t * max_value));
+			}
+			r_quantized_count = p_count;
+			return 0;
+		}
+		case SceneReplicationConfig::QUANTIZATION_SMALLEST_THREE: {
+			// Drop the largest component of the unit quaternion, it can be rebuilt from the three others,
+			// which are then known to fit in [-1/sqrt(2), 1/sqrt(2)].
+			int largest = 0;
+			for (int i = 1; i < 4; i++) {
+				if (Math::abs(p_components[i]) > Math::abs(p_components[largest])) {
+					largest = i;
+				}
+			}
+			// q and -q are the same rotation, make the dropped component positive.
+			const real_t sign = p_components[largest] < 0 ? -1 : 1;
+			int idx = 0;
+			for (int i = 0; i < 4; i++) {
+				if (i == largest) {
+					continue;
+				}
+				const double t = CLAMP((p_components[i] * sign + Math_SQRT12) / (2 * Math_SQRT12), 0.0, 1.0);
+				r_quantized[idx++] = int64_t(Math::round(t * max_value));
+			}
+			r_quantized_count = 3;
+			return largest;
+		}
+		default:
+			break;
+	}
+	r_quantized_count = 0;
+	return 0;
+}
+
+void SceneReplicationCodec::_dequantize(const Quantization &p_quantization, const int64_t *p_quantized, int p_quantized_count, int p_index, real_t *r_components) {
+	const double max_value = double((int64_t(1) << p_quantization.bits) - 1);
+	switch (p_quantization.mode) {
+		case SceneReplicationConfig::QUANTIZATION_FIXED_POINT: {
+			for (int i = 0; i < p_quantized_count; i++) {
+				r_components[i] = p_quantized[i] * double(p_quantization.step);
+			}
+		} break;
+		case SceneReplicationConfig::QUANTIZATION_RANGE: {
+			const double length = p_quantization.range.y - p_quantization.range.x;
+			for (int i = 0; i < p_quantized_count; i++) {
+				r_components[i] = p_quantization.range.x + p_quantized[i] / max_value * length;
+			}
+		} break;
+		case SceneReplicationConfig::QUANTIZATION_SMALLEST_THREE: {
+			double sum = 0;
+			int idx = 0;
+			for (int i = 0; i < 4; i++) {
+				if (i == p_index) {
+					continue;
+				}
+				const double c = p_quantized[idx++] / max_value * (2 * Math_SQRT12) - Math_SQRT12;
+				r_components[i] = c;
+				sum += c * c;
+			}
+			r_components[p_index] = Math::sqrt(MAX(0.0, 1.0 - sum));
+		} break;
+		default:
+			break;
+	}
+}
+
+void SceneReplicationCodec::_encode_value(BitWriter &p_writer, const Variant &p_value, const Quantization &p_quantization, int64_t *r_baseline, bool &r_quantized) {
+	ValueType type;
+	real_t components[4];
+	int count = 0;
+	r_quantized = _get_components(p_value, p_quantization, type, components, count);
+	p_writer.write(r_quantized, 1);
+	if (!r_quantized) {
+		if (r_baseline) {
+			r_baseline[0] = 0; // The value goes through the variant encoding, nothing to diff against next time.
+		}
+		return;
+	}
+	p_writer.write(type, 3);
+
+	int64_t quantized[4];
+	int quantized_count = 0;
+	const int index = _quantize(p_quantization, type, components, count, quantized, quantized_count);
+	if (p_quantization.mode == SceneReplicationConfig::QUANTIZATION_SMALLEST_THREE) {
+		p_writer.write(index, 2);
+	}
+	const int64_t header = 1 + type + (index << 3);
+
+	// With a baseline, a flag tells whether the value is a difference to it. The flag is always present
+	// (even if this baseline is unusable), so the stream stays readable if the receiver's baseline was reset.
+	if (r_baseline) {
+		bool delta = false;
+		if (r_baseline[0] == header) {
+			int absolute_bits = 0;
+			int delta_bits = 0;
+			for (int i = 0; i < quantized_count; i++) {
+				if (p_quantization.mode == SceneReplicationConfig::QUANTIZATION_FIXED_POINT) {
+					absolute_bits += 6 + _bit_length(zigzag_encode(quantized[i]));
+				} else {
+					absolute_bits += p_quantization.bits;
+				}
+				delta_bits += 6 + _bit_length(zigzag_encode(quantized[i] - r_baseline[1 + i]));
+			}
+			delta = delta_bits < absolute_bits;
+		}
+		p_writer.write(delta, 1);
+		if (delta) {
+			for (int i = 0; i < quantized_count; i++) {
+				p_writer.write_varbits(zigzag_encode(quantized[i] - r_baseline[1 + i]));
+				r_baseline[1 + i] = quantized[i];
+			}
+			return;
+		}
+	}
+	for (int i = 0; i < quantized_count; i++) {
+		if (p_quantization.mode == SceneReplicationConfig::QUANTIZATION_FIXED_POINT) {
+			p_writer.write_varbits(zigzag_encode(quantized[i]));
+		} else {
+			p_writer.write(quantized[i], p_quantization.bits);
+		}
+	}
+	if (r_baseline) {
+		r_baseline[0] = header;
+		for (int i = 0; i < quantized_count; i++) {
+			r_baseline[1 + i] = quantized[i];
+		}
+	}
+}
+
+Error SceneReplicationCodec::_decode_value(BitReader &p_reader, const Quantization &p_quantization, int64_t *r_baseline, Variant &r_value, bool &r_quantized) {
+	r_quantized = p_reader.read(1);
+	if (!r_quantized) {
+		if (r_baseline) {
+			r_baseline[0] = 0;
+		}
+		return OK;
+	}
+	const ValueType type = ValueType(p_reader.read(3));
+	ERR_FAIL_COND_V(type >= VALUE_MAX, ERR_INVALID_DATA);
+	int count = 1;
+	switch (type) {
+		case VALUE_VECTOR2:
+			count = 2;
+			break;
+		case VALUE_VECTOR3:
+			count = 3;
+			break;
+		case VALUE_VECTOR4:
+		case VALUE_QUATERNION:
+			count = 4;
+			break;
+		default:
+			break;
+	}
+	int index = 0;
+	int quantized_count = count;
+	if (p_quantization.mode == SceneReplicationConfig::QUANTIZATION_SMALLEST_THREE) {
+		ERR_FAIL_COND_V(type != VALUE_QUATERNION, ERR_INVALID_DATA);
+		index = p_reader.read(2);
+		quantized_count = 3;
+	}
+	const int64_t header = 1 + type + (index << 3);
+
+	int64_t quantized[4];
+	bool delta = false;
+	if (r_baseline) {
+		delta = p_reader.read(1);
+		ERR_FAIL_COND_V_MSG(delta && r_baseline[0] != header, ERR_INVALID_DATA, "Received a quantized delta without a matching baseline.");
+	}
+	for (int i = 0; i < quantized_count; i++) {
+		if (delta) {
+			quantized[i] = r_baseline[1 + i] + zigzag_decode(p_reader.read_varbits());
+		} else if (p_quantization.mode == SceneReplicationConfig::QUANTIZATION_FIXED_POINT) {
+			quantized[i] = zigzag_decode(p_reader.read_varbits());
+		} else {
+			quantized[i] = p_reader.read(p_quantization.bits);
+		}
+	}
+	ERR_FAIL_COND_V(p_reader.has_overflowed(), ERR_INVALID_DATA);
+
+	if (r_baseline) {
+		r_baseline[0] = header;
+		for (int i = 0; i < quantized_count; i++) {
+			r_baseline[1 + i] = quantized[i];
+		}
+	}
+	real_t components[4];
+	_dequantize(p_quantization, quantized, quantized_count, index, components);
+	r_value = _make_value(type, components);
+	return OK;
+}
+
+Error SceneReplicationCodec::encode_state(const Variant *const *p_values, const Quantization *const *p_quantization, int64_t *const *p_baselines, int p_count, LocalVector<uint8_t> &r_buffer) {
+	r_buffer.clear();
+	r_buffer.resize(2);
+	BitWriter writer(r_buffer);
+	LocalVector<const Variant *> fallback;
+	for (int i = 0; i < p_count; i++) {
+		int64_t *baseline = p_baselines ? p_baselines[i] : nullptr;
+		bool quantized = false;
+		if (p_quantization[i]->mode != SceneReplicationConfig::QUANTIZATION_NONE) {
+			_encode_value(writer, *p_values[i], *p_quantization[i], baseline, quantized);
+		} else if (baseline) {
+			baseline[0] = 0;
+		}
+		if (!quantized) {
+			fallback.push_back(p_values[i]);
+		}
+	}
+	writer.flush();
+	const int bits_size = r_buffer.size() - 2;
+	ERR_FAIL_COND_V_MSG(bits_size > UINT16_MAX, ERR_OUT_OF_MEMORY, "Quantized state is too big.");
+	encode_uint16(bits_size, r_buffer.ptr());
+
+	if (fallback.size()) {
+		int size = 0;
+		Error err = MultiplayerAPI::encode_and_compress_variants(fallback.ptr(), fallback.size(), nullptr, size);
+		ERR_FAIL_COND_V(err != OK, err);
+		const int ofs = r_buffer.size();
+		r_buffer.resize(ofs + size);
+		MultiplayerAPI::encode_and_compress_variants(fallback.ptr(), fallback.size(), &r_buffer[ofs], size);
+	}
+	return OK;
+}
+
+Error SceneReplicationCodec::decode_state(const uint8_t *p_buffer, int p_len, const Quantization *const *p_quantization, int64_t *const *p_baselines, Vector<Variant> &r_values, int &r_consumed) {
+	ERR_FAIL_COND_V(p_len < 2, ERR_INVALID_DATA);
+	const int bits_size = decode_uint16(p_buffer);
+	ERR_FAIL_COND_V(bits_size > p_len - 2, ERR_INVALID_DATA);
+	BitReader reader(p_buffer + 2, bits_size);
+
+	const int count = r_values.size();
+	Variant *values = r_values.ptrw();
+	LocalVector<int> fallback;
+	for (int i = 0; i < count; i++) {
+		int64_t *baseline = p_baselines ? p_baselines[i] : nullptr;
+		bool quantized = false;
+		if (p_quantization[i]->mode != SceneReplicationConfig::QUANTIZATION_NONE) {
+			Error err = _decode_value(reader, *p_quantization[i], baseline, values[i], quantized);
+			ERR_FAIL_COND_V(err != OK, err);
+		} else if (baseline) {
+			baseline[0] = 0;
+		}
+		if (!quantized) {
+			fallback.push_back(i);
+		}
+	}
+	ERR_FAIL_COND_V(reader.has_overflowed(), ERR_INVALID_DATA);
+	r_consumed = 2 + bits_size;
+
+	if (fallback.size()) {
+		Vector<Variant> fallback_values;
+		fallback_values.resize(fallback.size());
+		int size = 0;
+		Error err = MultiplayerAPI::decode_and_decompress_variants(fallback_values, p_buffer + r_consumed, p_len - r_consumed, size);
+		ERR_FAIL_COND_V(err != OK, err);
+		for (uint32_t i = 0; i < fallback.size(); i++) {
+			values[fallback[i]] = fallback_values[i];
+		}
+		r_consumed += size;
+	}
+	return OK;
+}
@@ -0,0 +1,114 @@
+/**************************************************************************/
+/*  scene_replication_codec.h                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef SCENE_REPLICATION_CODEC_H
+#define SCENE_REPLICATION_CODEC_H
+
+#include "scene_replication_config.h"
+
+#include "core/templates/local_vector.h"
+#include "core/variant/variant.h"
+
+// Encodes replicated state with per-property quantization.
+//
+// A state is made of a bit-packed section holding every quantized value, followed by the
+// remaining values encoded with MultiplayerAPI::encode_and_compress_variants:
+//
+//   [uint16 bit section size][bit section][encoded variants]
+//
+// Every value can optionally be encoded as a difference to a baseline (the last value the
+// receiver is known to have). Baselines are opaque arrays of BASELINE_STRIDE integers per value,
+// updated in place by both encode_state() and decode_state(), so that sender and receiver stay
+// in lockstep as long as every encoded state is delivered in order.
+class SceneReplicationCodec {
+public:
+	typedef SceneReplicationConfig::Quantization Quantization;
+
+	static const int BASELINE_STRIDE = 5;
+
+	class BitWriter {
+		LocalVector<uint8_t> &buffer;
+		uint64_t scratch = 0;
+		int scratch_bits = 0;
+
+	public:
+		void write(uint64_t p_value, int p_bits);
+		void write_varbits(uint64_t p_value);
+		void flush();
+
+		BitWriter(LocalVector<uint8_t> &r_buffer) :
+				buffer(r_buffer) {}
+	};
+
+	class BitReader {
+		const uint8_t *buffer = nullptr;
+		int size = 0;
+		int bit_pos = 0;
+		bool overflow = false;
+
+	public:
+		uint64_t read(int p_bits);
+		uint64_t read_varbits();
+		bool has_overflowed() const { return overflow; }
+
+		BitReader(const uint8_t *p_buffer, int p_size) {
+			buffer = p_buffer;
+			size = p_size;
+		}
+	};
+
+private:
+	enum ValueType {
+		VALUE_FLOAT,
+		VALUE_VECTOR2,
+		VALUE_VECTOR3,
+		VALUE_VECTOR4,
+		VALUE_QUATERNION,
+		VALUE_MAX,
+	};
+
+	static bool _get_components(const Variant &p_value, const Quantization &p_quantization, ValueType &r_type, real_t *r_components, int &r_count);
+	static Variant _make_value(ValueType p_type, const real_t *p_components);
+	static int _quantize(const Quantization &p_quantization, ValueType p_type, real_t *p_components, int p_count, int64_t *r_quantized, int &r_quantized_count);
+	static void _dequantize(const Quantization &p_quantization, const int64_t *p_quantized, int p_quantized_count, int p_index, real_t *r_components);
+
+	static void _encode_value(BitWriter &p_writer, const Variant &p_value, const Quantization &p_quantization, int64_t *r_baseline, bool &r_quantized);
+	static Error _decode_value(BitReader &p_reader, const Quantization &p_quantization, int64_t *r_baseline, Variant &r_value, bool &r_quantized);
+
+public:
+	static uint64_t zigzag_encode(int64_t p_value) { return (uint64_t(p_value) << 1) ^ uint64_t(p_value >> 63); }
+	static int64_t zigzag_decode(uint64_t p_value) { return int64_t(p_value >> 1) ^ -int64_t(p_value & 1); }
+
+	// p_baselines may be null (no delta encoding), and individual baselines may be null too.
+	static Error encode_state(const Variant *const *p_values, const Quantization *const *p_quantization, int64_t *const *p_baselines, int p_count, LocalVector<uint8_t> &r_buffer);
+	static Error decode_state(const uint8_t *p_buffer, int p_len, const Quantization *const *p_quantization, int64_t *const *p_baselines, Vector<Variant> &r_values, int &r_consumed);
+};
+
+#endif // SCENE_REPLICATION_CODEC_H
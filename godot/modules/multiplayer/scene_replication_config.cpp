@@ -55,6 +55,24 @@ bool SceneReplicationConfig::_set(const StringName &p_name, const Variant &p_val
 			ERR_FAIL_COND_V(mode < REPLICATION_MODE_NEVER || mode > REPLICATION_MODE_ON_CHANGE, false);
 			property_set_replication_mode(prop.name, mode);
 			return true;
+		} else if (what == "quantization") {
+			ERR_FAIL_COND_V(p_value.get_type() != Variant::INT, false);
+			QuantizationMode mode = (QuantizationMode)p_value.operator int();
+			ERR_FAIL_COND_V(mode < QUANTIZATION_NONE || mode > QUANTIZATION_SMALLEST_THREE, false);
+			property_set_quantization(prop.name, mode);
+			return true;
+		} else if (what == "quantization_bits") {
+			ERR_FAIL_COND_V(p_value.get_type() != Variant::INT, false);
+			property_set_quantization_bits(prop.name, p_value);
+			return true;
+		} else if (what == "quantization_step") {
+			ERR_FAIL_COND_V(p_value.get_type() != Variant::FLOAT && p_value.get_type() != Variant::INT, false);
+			property_set_quantization_step(prop.name, p_value);
+			return true;
+		} else if (what == "quantization_range") {
+			ERR_FAIL_COND_V(p_value.get_type() != Variant::VECTOR2, false);
+			property_set_quantization_range(prop.name, p_value);
+			return true;
 		}
 		ERR_FAIL_COND_V(p_value.get_type() != Variant::BOOL, false);
 		if (what == "spawn") {
@@ -90,6 +108,18 @@ bool SceneReplicationConfig::_get(const StringName &p_name, Variant &r_ret) cons
 		} else if (what == "replication_mode") {
 			r_ret = prop.mode;
 			return true;
+		} else if (what == "quantization") {
+			r_ret = prop.quantization.mode;
+			return true;
+		} else if (what == "quantization_bits") {
+			r_ret = prop.quantization.bits;
+			return true;
+		} else if (what == "quantization_step") {
+			r_ret = prop.quantization.step;
+			return true;
+		} else if (what == "quantization_range") {
+			r_ret = prop.quantization.range;
+			return true;
 		}
 	}
 	return false;
@@ -100,6 +130,14 @@ void SceneReplicationConfig::_get_property_list(List<PropertyInfo> *p_list) cons
 		p_list->push_back(PropertyInfo(Variant::STRING, "properties/" + itos(i) + "/path", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL));
 		p_list->push_back(PropertyInfo(Variant::STRING, "properties/" + itos(i) + "/spawn", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL));
 		p_list->push_back(PropertyInfo(Variant::INT, "properties/" + itos(i) + "/replication_mode", PROPERTY_HINT_ENUM, "Never,Always,On Change", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL));
+		const Quantization &quantization = properties.get(i).quantization;
+		if (quantization.mode == QUANTIZATION_NONE) {
+			continue; // Keep configs without quantization unchanged on disk.
+		}
+		p_list->push_back(PropertyInfo(Variant::INT, "properties/" + itos(i) + "/quantization", PROPERTY_HINT_ENUM, "None,Fixed Point,Range,Smallest Three", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL));
+		p_list->push_back(PropertyInfo(Variant::INT, "properties/" + itos(i) + "/quantization_bits", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL));
+		p_list->push_back(PropertyInfo(Variant::FLOAT, "properties/" + itos(i) + "/quantization_step", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL));
+		p_list->push_back(PropertyInfo(Variant::VECTOR2, "properties/" + itos(i) + "/quantization_range", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL));
 	}
 }
 
@@ -109,6 +147,10 @@ void SceneReplicationConfig::reset_state() {
 	sync_props.clear();
 	spawn_props.clear();
 	watch_props.clear();
+	sync_quantization.clear();
+	watch_quantization.clear();
+	sync_quantized = false;
+	watch_quantized = false;
 }
 
 TypedArray<NodePath> SceneReplicationConfig::get_properties() const {
@@ -225,6 +267,64 @@ void SceneReplicationConfig::property_set_replication_mode(const NodePath &p_pat
 	dirty = true;
 }
 
+SceneReplicationConfig::QuantizationMode SceneReplicationConfig::property_get_quantization(const NodePath &p_path) {
+	List<ReplicationProperty>::Element *E = properties.find(p_path);
+	ERR_FAIL_COND_V(!E, QUANTIZATION_NONE);
+	return E->get().quantization.mode;
+}
+
+void SceneReplicationConfig::property_set_quantization(const NodePath &p_path, QuantizationMode p_mode) {
+	List<ReplicationProperty>::Element *E = properties.find(p_path);
+	ERR_FAIL_COND(!E);
+	if (E->get().quantization.mode == p_mode) {
+		return;
+	}
+	E->get().quantization.mode = p_mode;
+	dirty = true;
+}
+
+int SceneReplicationConfig::property_get_quantization_bits(const NodePath &p_path) {
+	List<ReplicationProperty>::Element *E = properties.find(p_path);
+	ERR_FAIL_COND_V(!E, 0);
+	return E->get().quantization.bits;
+}
+
+void SceneReplicationConfig::property_set_quantization_bits(const NodePath &p_path, int p_bits) {
+	ERR_FAIL_COND_MSG(p_bits < 2 || p_bits > 32, "Quantization bits must be between 2 and 32.");
+	List<ReplicationProperty>::Element *E = properties.find(p_path);
+	ERR_FAIL_COND(!E);
+	E->get().quantization.bits = p_bits;
+	dirty = true;
+}
+
+real_t SceneReplicationConfig::property_get_quantization_step(const NodePath &p_path) {
+	List<ReplicationProperty>::Element *E = properties.find(p_path);
+	ERR_FAIL_COND_V(!E, 0);
+	return E->get().quantization.step;
+}
+
+void SceneReplicationConfig::property_set_quantization_step(const NodePath &p_path, real_t p_step) {
+	ERR_FAIL_COND_MSG(p_step <= 0, "Quantization step must be greater than 0.");
+	List<ReplicationProperty>::Element *E = properties.find(p_path);
+	ERR_FAIL_COND(!E);
+	E->get().quantization.step = p_step;
+	dirty = true;
+}
+
+Vector2 SceneReplicationConfig::property_get_quantization_range(const NodePath &p_path) {
+	List<ReplicationProperty>::Element *E = properties.find(p_path);
+	ERR_FAIL_COND_V(!E, Vector2());
+	return E->get().quantization.range;
+}
+
+void SceneReplicationConfig::property_set_quantization_range(const NodePath &p_path, const Vector2 &p_range) {
+	ERR_FAIL_COND_MSG(p_range.x >= p_range.y, "Quantization range minimum must be lower than its maximum.");
+	List<ReplicationProperty>::Element *E = properties.find(p_path);
+	ERR_FAIL_COND(!E);
+	E->get().quantization.range = p_range;
+	dirty = true;
+}
+
 void SceneReplicationConfig::_update() {
 	if (!dirty) {
 		return;
@@ -233,6 +333,10 @@ void SceneReplicationConfig::_update() {
 	sync_props.clear();
 	spawn_props.clear();
 	watch_props.clear();
+	sync_quantization.clear();
+	watch_quantization.clear();
+	sync_quantized = false;
+	watch_quantized = false;
 	for (const ReplicationProperty &prop : properties) {
 		if (prop.spawn) {
 			spawn_props.push_back(prop.name);
@@ -240,9 +344,13 @@ void SceneReplicationConfig::_update() {
 		switch (prop.mode) {
 			case REPLICATION_MODE_ALWAYS:
 				sync_props.push_back(prop.name);
+				sync_quantization.push_back(prop.quantization);
+				sync_quantized = sync_quantized || prop.quantization.mode != QUANTIZATION_NONE;
 				break;
 			case REPLICATION_MODE_ON_CHANGE:
 				watch_props.push_back(prop.name);
+				watch_quantization.push_back(prop.quantization);
+				watch_quantized = watch_quantized || prop.quantization.mode != QUANTIZATION_NONE;
 				break;
 			default:
 				break;
@@ -271,6 +379,34 @@ const List<NodePath> &SceneReplicationConfig::get_watch_properties() {
 	return watch_props;
 }
 
+const LocalVector<SceneReplicationConfig::Quantization> &SceneReplicationConfig::get_sync_quantization() {
+	if (dirty) {
+		_update();
+	}
+	return sync_quantization;
+}
+
+const LocalVector<SceneReplicationConfig::Quantization> &SceneReplicationConfig::get_watch_quantization() {
+	if (dirty) {
+		_update();
+	}
+	return watch_quantization;
+}
+
+bool SceneReplicationConfig::is_sync_quantized() {
+	if (dirty) {
+		_update();
+	}
+	return sync_quantized;
+}
+
+bool SceneReplicationConfig::is_watch_quantized() {
+	if (dirty) {
+		_update();
+	}
+	return watch_quantized;
+}
+
 void SceneReplicationConfig::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_properties"), &SceneReplicationConfig::get_properties);
 	ClassDB::bind_method(D_METHOD("add_property", "path", "index"), &SceneReplicationConfig::add_property, DEFVAL(-1));
@@ -282,10 +418,24 @@ void SceneReplicationConfig::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("property_get_replication_mode", "path"), &SceneReplicationConfig::property_get_replication_mode);
 	ClassDB::bind_method(D_METHOD("property_set_replication_mode", "path", "mode"), &SceneReplicationConfig::property_set_replication_mode);
 
+	ClassDB::bind_method(D_METHOD("property_get_quantization", "path"), &SceneReplicationConfig::property_get_quantization);
+	ClassDB::bind_method(D_METHOD("property_set_quantization", "path", "mode"), &SceneReplicationConfig::property_set_quantization);
+	ClassDB::bind_method(D_METHOD("property_get_quantization_bits", "path"), &SceneReplicationConfig::property_get_quantization_bits);
+	ClassDB::bind_method(D_METHOD("property_set_quantization_bits", "path", "bits"), &SceneReplicationConfig::property_set_quantization_bits);
+	ClassDB::bind_method(D_METHOD("property_get_quantization_step", "path"), &SceneReplicationConfig::property_get_quantization_step);
+	ClassDB::bind_method(D_METHOD("property_set_quantization_step", "path", "step"), &SceneReplicationConfig::property_set_quantization_step);
+	ClassDB::bind_method(D_METHOD("property_get_quantization_range", "path"), &SceneReplicationConfig::property_get_quantization_range);
+	ClassDB::bind_method(D_METHOD("property_set_quantization_range", "path", "range"), &SceneReplicationConfig::property_set_quantization_range);
+
 	BIND_ENUM_CONSTANT(REPLICATION_MODE_NEVER);
 	BIND_ENUM_CONSTANT(REPLICATION_MODE_ALWAYS);
 	BIND_ENUM_CONSTANT(REPLICATION_MODE_ON_CHANGE);
 
+	BIND_ENUM_CONSTANT(QUANTIZATION_NONE);
+	BIND_ENUM_CONSTANT(QUANTIZATION_FIXED_POINT);
+	BIND_ENUM_CONSTANT(QUANTIZATION_RANGE);
+	BIND_ENUM_CONSTANT(QUANTIZATION_SMALLEST_THREE);
+
 	// Deprecated.
 	ClassDB::bind_method(D_METHOD("property_get_sync", "path"), &SceneReplicationConfig::property_get_sync);
 	ClassDB::bind_method(D_METHOD("property_set_sync", "path", "enabled"), &SceneReplicationConfig::property_set_sync);
@@ -32,6 +32,7 @@
 #define SCENE_REPLICATION_CONFIG_H
 
 #include "core/io/resource.h"
+#include "core/templates/local_vector.h"
 #include "core/variant/typed_array.h"
 
 class SceneReplicationConfig : public Resource {
@@ -46,11 +47,26 @@ public:
 		REPLICATION_MODE_ON_CHANGE,
 	};
 
+	enum QuantizationMode {
+		QUANTIZATION_NONE,
+		QUANTIZATION_FIXED_POINT,
+		QUANTIZATION_RANGE,
+		QUANTIZATION_SMALLEST_THREE,
+	};
+
+	struct Quantization {
+		QuantizationMode mode = QUANTIZATION_NONE;
+		int bits = 16; // Used by QUANTIZATION_RANGE and QUANTIZATION_SMALLEST_THREE.
+		real_t step = 0.01; // Used by QUANTIZATION_FIXED_POINT.
+		Vector2 range = Vector2(0, 1); // Used by QUANTIZATION_RANGE.
+	};
+
 private:
 	struct ReplicationProperty {
 		NodePath name;
 		bool spawn = true;
 		ReplicationMode mode = REPLICATION_MODE_ALWAYS;
+		Quantization quantization;
 
 		bool operator==(const ReplicationProperty &p_to) {
 			return name == p_to.name;
@@ -67,6 +83,10 @@ private:
 	List<NodePath> spawn_props;
 	List<NodePath> sync_props;
 	List<NodePath> watch_props;
+	LocalVector<Quantization> sync_quantization;
+	LocalVector<Quantization> watch_quantization;
+	bool sync_quantized = false;
+	bool watch_quantized = false;
 	bool dirty = false;
 
 	void _update();
@@ -100,13 +120,32 @@ public:
 	ReplicationMode property_get_replication_mode(const NodePath &p_path);
 	void property_set_replication_mode(const NodePath &p_path, ReplicationMode p_mode);
 
+	QuantizationMode property_get_quantization(const NodePath &p_path);
+	void property_set_quantization(const NodePath &p_path, QuantizationMode p_mode);
+
+	int property_get_quantization_bits(const NodePath &p_path);
+	void property_set_quantization_bits(const NodePath &p_path, int p_bits);
+
+	real_t property_get_quantization_step(const NodePath &p_path);
+	void property_set_quantization_step(const NodePath &p_path, real_t p_step);
+
+	Vector2 property_get_quantization_range(const NodePath &p_path);
+	void property_set_quantization_range(const NodePath &p_path, const Vector2 &p_range);
+
 	const List<NodePath> &get_spawn_properties();
 	const List<NodePath> &get_sync_properties();
 	const List<NodePath> &get_watch_properties();
 
+	// Quantization of each sync and watch property, in the same order as the lists above.
+	const LocalVector<Quantization> &get_sync_quantization();
+	const LocalVector<Quantization> &get_watch_quantization();
+	bool is_sync_quantized();
+	bool is_watch_quantized();
+
 	SceneReplicationConfig() {}
 };
 
 VARIANT_ENUM_CAST(SceneReplicationConfig::ReplicationMode);
+VARIANT_ENUM_CAST(SceneReplicationConfig::QuantizationMode);
 
 #endif // SCENE_REPLICATION_CONFIG_H
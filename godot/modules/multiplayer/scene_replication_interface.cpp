@@ -31,6 +31,7 @@
 #include "scene_replication_interface.h"
 
 #include "scene_multiplayer.h"
+#include "scene_replication_codec.h"
 
 #include "core/debugger/engine_debugger.h"
 #include "core/io/marshalls.h"
@@ -143,14 +144,166 @@ void SceneReplicationInterface::on_network_process() {
 
 	// Process syncs.
 	uint64_t usec = OS::get_singleton()->get_ticks_usec();
+	double elapsed = last_process_usec ? double(usec - last_process_usec) / 1000000.0 : 0.0;
+	last_process_usec = usec;
+
+	_update_interest();
+
+	LocalVector<ObjectID> to_sync;
 	for (KeyValue<int, PeerInfo> &E : peers_info) {
-		const HashSet<ObjectID> to_sync = E.value.sync_nodes;
-		if (to_sync.is_empty()) {
+		PeerInfo &info = E.value;
+		if (info.sync_nodes.is_empty()) {
 			continue; // Nothing to sync
 		}
-		uint16_t sync_net_time = ++E.value.last_sent_sync;
-		_send_sync(E.key, to_sync, sync_net_time, usec);
-		_send_delta(E.key, to_sync, usec, E.value.last_watch_usecs);
+		to_sync.clear();
+		_collect_peer_syncs(info, usec, to_sync);
+		if (to_sync.is_empty()) {
+			continue; // Nothing relevant to this peer.
+		}
+		int budget = _refill_bandwidth_budget(info, elapsed);
+		const int initial_budget = budget;
+		uint16_t sync_net_time = ++info.last_sent_sync;
+		_send_sync(E.key, to_sync, sync_net_time, usec, budget);
+		_send_delta(E.key, to_sync, usec, info.last_watch_usecs, budget);
+		if (peer_bandwidth > 0) {
+			info.bandwidth_credit -= initial_budget - budget;
+		}
+	}
+}
+
+int SceneReplicationInterface::_refill_bandwidth_budget(PeerInfo &p_info, double p_elapsed) const {
+	if (peer_bandwidth <= 0) {
+		return -1; // Unlimited.
+	}
+	// Token bucket, bursts are capped to one second of bandwidth (or one full packet).
+	const double max_credit = MAX(peer_bandwidth, MAX(sync_mtu, delta_mtu));
+	p_info.bandwidth_credit = MIN(p_info.bandwidth_credit + peer_bandwidth * p_elapsed, max_credit);
+	return int(p_info.bandwidth_credit);
+}
+
+void SceneReplicationInterface::_update_interest() {
+	interest_entries.clear();
+	interest_large_entries.clear();
+	interest_unbounded.clear();
+
+	interest_enabled = false;
+	for (const KeyValue<int, PeerInfo> &E : peers_info) {
+		if (E.value.has_interest_origin) {
+			interest_enabled = true;
+			break;
+		}
+	}
+	if (!interest_enabled) {
+		interest_cells.clear();
+		return;
+	}
+
+	// Cells are cleared in place so their storage is reused by the next rebuild,
+	// only cells which stayed empty for a whole tick are released.
+	for (KeyValue<Vector3i, LocalVector<uint32_t>> &E : interest_cells) {
+		if (E.value.is_empty()) {
+			interest_unused_cells.push_back(E.key);
+		} else {
+			E.value.clear();
+		}
+	}
+	for (const Vector3i &cell : interest_unused_cells) {
+		interest_cells.erase(cell);
+	}
+	interest_unused_cells.clear();
+
+	for (const ObjectID &sid : sync_nodes) {
+		MultiplayerSynchronizer *sync = get_id_as<MultiplayerSynchronizer>(sid);
+		if (!sync || !_has_authority(sync)) {
+			continue;
+		}
+		InterestEntry entry;
+		entry.sid = sid;
+		entry.radius = sync->get_interest_radius();
+		if (entry.radius <= 0 || !sync->get_interest_position(entry.position)) {
+			interest_unbounded.push_back(sid); // Relevant at any distance.
+			continue;
+		}
+		uint32_t index = interest_entries.size();
+		interest_entries.push_back(entry);
+
+		// Register the entry in every cell its interest sphere touches, so peers only look up their own cell.
+		const Vector3 extents = Vector3(entry.radius, entry.radius, entry.radius);
+		const Vector3i from = Vector3i(((entry.position - extents) / interest_cell_size).floor());
+		const Vector3i to = Vector3i(((entry.position + extents) / interest_cell_size).floor());
+		const Vector3i span = to - from;
+		if (span.x >= MAX_INTEREST_CELL_SPAN || span.y >= MAX_INTEREST_CELL_SPAN || span.z >= MAX_INTEREST_CELL_SPAN) {
+			interest_large_entries.push_back(index);
+			continue;
+		}
+		for (int x = from.x; x <= to.x; x++) {
+			for (int y = from.y; y <= to.y; y++) {
+				for (int z = from.z; z <= to.z; z++) {
+					interest_cells[Vector3i(x, y, z)].push_back(index);
+				}
+			}
+		}
+	}
+}
+
+void SceneReplicationInterface::_collect_peer_syncs(const PeerInfo &p_info, uint64_t p_usec, LocalVector<ObjectID> &r_synchronizers) {
+	LocalVector<SyncCandidate> &candidates = sync_candidates_cache;
+	candidates.clear();
+	const bool prioritize = peer_bandwidth > 0;
+
+	// Rank by priority and by how long the peer has been waiting for an update, so throttled
+	// synchronizers rise to the top over the next ticks. Closer ones get a bonus.
+	auto add_candidate = [&](const ObjectID &p_sid, float p_proximity) {
+		if (!prioritize) {
+			r_synchronizers.push_back(p_sid);
+			return;
+		}
+		MultiplayerSynchronizer *sync = get_id_as<MultiplayerSynchronizer>(p_sid);
+		if (!sync) {
+			return;
+		}
+		const uint64_t *last_send = p_info.last_send_usecs.getptr(p_sid);
+		float staleness = float(p_usec - (last_send ? *last_send : 0)) / 1000000.0f;
+		SyncCandidate candidate;
+		candidate.sid = p_sid;
+		candidate.score = sync->get_replication_priority() * (staleness + 0.001f) * (0.5f + p_proximity);
+		candidates.push_back(candidate);
+	};
+
+	if (!interest_enabled || !p_info.has_interest_origin) {
+		for (const ObjectID &sid : p_info.sync_nodes) {
+			add_candidate(sid, 0.5f);
+		}
+	} else {
+		for (const ObjectID &sid : interest_unbounded) {
+			if (p_info.sync_nodes.has(sid)) {
+				add_candidate(sid, 0.5f);
+			}
+		}
+		const Vector3 &origin = p_info.interest_origin;
+		auto test_entry = [&](uint32_t p_index) {
+			const InterestEntry &entry = interest_entries[p_index];
+			real_t distance_squared = origin.distance_squared_to(entry.position);
+			if (distance_squared <= entry.radius * entry.radius && p_info.sync_nodes.has(entry.sid)) {
+				add_candidate(entry.sid, 1.0f - Math::sqrt(distance_squared) / entry.radius);
+			}
+		};
+		const LocalVector<uint32_t> *cell = interest_cells.getptr(Vector3i((origin / interest_cell_size).floor()));
+		if (cell) {
+			for (uint32_t index : *cell) {
+				test_entry(index);
+			}
+		}
+		for (uint32_t index : interest_large_entries) {
+			test_entry(index);
+		}
+	}
+
+	if (prioritize) {
+		candidates.sort();
+		for (const SyncCandidate &candidate : candidates) {
+			r_synchronizers.push_back(candidate.sid);
+		}
 	}
 }
 
@@ -283,6 +436,9 @@ Error SceneReplicationInterface::on_replication_stop(Object *p_obj, Variant p_co
 	for (KeyValue<int, PeerInfo> &E : peers_info) {
 		E.value.sync_nodes.erase(sid);
 		E.value.last_watch_usecs.erase(sid);
+		E.value.last_send_usecs.erase(sid);
+		E.value.delta_baselines.erase(sid);
+		E.value.recv_delta_baselines.erase(sid);
 		if (sync->get_net_id()) {
 			E.value.recv_sync_ids.erase(sync->get_net_id());
 		}
@@ -361,6 +517,8 @@ Error SceneReplicationInterface::_update_sync_visibility(int p_peer, Multiplayer
 			} else {
 				E.value.sync_nodes.erase(sid);
 				E.value.last_watch_usecs.erase(sid);
+				E.value.last_send_usecs.erase(sid);
+				E.value.delta_baselines.erase(sid);
 			}
 		}
 		return OK;
@@ -374,6 +532,8 @@ Error SceneReplicationInterface::_update_sync_visibility(int p_peer, Multiplayer
 		} else {
 			peers_info[p_peer].sync_nodes.erase(sid);
 			peers_info[p_peer].last_watch_usecs.erase(sid);
+			peers_info[p_peer].last_send_usecs.erase(sid);
+			peers_info[p_peer].delta_baselines.erase(sid);
 		}
 		return OK;
 	}
@@ -708,7 +868,24 @@ MultiplayerSynchronizer *SceneReplicationInterface::_find_synchronizer(int p_pee
 	return sync;
 }
 
-void SceneReplicationInterface::_send_delta(int p_peer, const HashSet<ObjectID> &p_synchronizers, uint64_t p_usec, const HashMap<ObjectID, uint64_t> &p_last_watch_usecs) {
+void SceneReplicationInterface::_get_delta_quantization(SceneReplicationConfig *p_config, uint64_t p_indexes, LocalVector<int64_t> &r_baseline, LocalVector<const SceneReplicationConfig::Quantization *> &r_quantization, LocalVector<int64_t *> &r_baselines) {
+	const LocalVector<SceneReplicationConfig::Quantization> &quantization = p_config->get_watch_quantization();
+	const uint32_t stride = SceneReplicationCodec::BASELINE_STRIDE;
+	if (r_baseline.size() != quantization.size() * stride) {
+		// New synchronizer, or its config changed: start from an empty baseline.
+		r_baseline.resize(quantization.size() * stride);
+		memset(r_baseline.ptr(), 0, r_baseline.size() * sizeof(int64_t));
+	}
+	for (uint32_t i = 0; i < quantization.size(); i++) {
+		if ((p_indexes & (1ULL << i)) == 0) {
+			continue;
+		}
+		r_quantization.push_back(&quantization[i]);
+		r_baselines.push_back(&r_baseline[i * stride]);
+	}
+}
+
+void SceneReplicationInterface::_send_delta(int p_peer, const LocalVector<ObjectID> &p_synchronizers, uint64_t p_usec, const HashMap<ObjectID, uint64_t> &p_last_watch_usecs, int &r_budget) {
 	MAKE_ROOM(/* header */ 1 + /* element */ 4 + 8 + 4 + delta_mtu);
 	uint8_t *ptr = packet_cache.ptrw();
 	ptr[0] = SceneMultiplayer::NETWORK_COMMAND_SYNC | (1 << SceneMultiplayer::CMD_FLAG_0_SHIFT);
@@ -737,11 +914,33 @@ void SceneReplicationInterface::_send_delta(int p_peer, const HashSet<ObjectID>
 			i++;
 		}
 		int size;
-		Error err = MultiplayerAPI::encode_and_compress_variants(vptr, varp.size(), nullptr, size);
-		ERR_CONTINUE_MSG(err != OK, "Unable to encode delta state.");
+		SceneReplicationConfig *config = sync->get_replication_config_ptr();
+		const bool quantized = config->is_watch_quantized();
+		if (quantized) {
+			// Encode against a copy of the baseline, only kept if the delta is actually sent.
+			LocalVector<int64_t> *baseline = peers_info[p_peer].delta_baselines.getptr(oid);
+			if (baseline) {
+				baseline_cache = *baseline;
+			} else {
+				baseline_cache.clear();
+			}
+			LocalVector<const SceneReplicationConfig::Quantization *> quantization;
+			LocalVector<int64_t *> baselines;
+			_get_delta_quantization(config, indexes, baseline_cache, quantization, baselines);
+			ERR_CONTINUE(quantization.size() != uint32_t(varp.size()));
+			Error err = SceneReplicationCodec::encode_state(vptr, quantization.ptr(), baselines.ptr(), varp.size(), state_cache);
+			ERR_CONTINUE_MSG(err != OK, "Unable to encode delta state.");
+			size = state_cache.size();
+		} else {
+			Error err = MultiplayerAPI::encode_and_compress_variants(vptr, varp.size(), nullptr, size);
+			ERR_CONTINUE_MSG(err != OK, "Unable to encode delta state.");
+		}
 
 		ERR_CONTINUE_MSG(size > delta_mtu, vformat("Synchronizer delta bigger than MTU will not be sent (%d > %d): %s", size, delta_mtu, sync->get_path()));
 
+		if (r_budget >= 0 && 4 + 8 + 4 + size > r_budget) {
+			break; // Out of bandwidth, the remaining changes accumulate until a later tick.
+		}
 		if (ofs + 4 + 8 + 4 + size > delta_mtu) {
 			// Send what we got, and reset write.
 			_send_raw(packet_cache.ptr(), ofs, p_peer, true);
@@ -751,13 +950,22 @@ void SceneReplicationInterface::_send_delta(int p_peer, const HashSet<ObjectID>
 			ofs += encode_uint32(sync->get_net_id(), &ptr[ofs]);
 			ofs += encode_uint64(indexes, &ptr[ofs]);
 			ofs += encode_uint32(size, &ptr[ofs]);
-			MultiplayerAPI::encode_and_compress_variants(vptr, varp.size(), &ptr[ofs], size);
+			if (quantized) {
+				memcpy(&ptr[ofs], state_cache.ptr(), size);
+				peers_info[p_peer].delta_baselines[oid] = baseline_cache;
+			} else {
+				MultiplayerAPI::encode_and_compress_variants(vptr, varp.size(), &ptr[ofs], size);
+			}
 			ofs += size;
+			if (r_budget >= 0) {
+				r_budget -= 4 + 8 + 4 + size;
+			}
 		}
 #ifdef DEBUG_ENABLED
 		_profile_node_data("delta_out", oid, size);
 #endif
 		peers_info[p_peer].last_watch_usecs[oid] = p_usec;
+		peers_info[p_peer].last_send_usecs[oid] = p_usec;
 	}
 	if (ofs > 1) {
 		// Got some left over to send.
@@ -786,7 +994,18 @@ Error SceneReplicationInterface::on_delta_receive(int p_from, const uint8_t *p_b
 		Vector<Variant> vars;
 		vars.resize(props.size());
 		int consumed = 0;
-		Error err = MultiplayerAPI::decode_and_decompress_variants(vars, p_buffer + ofs, size, consumed);
+		Error err;
+		SceneReplicationConfig *config = sync->get_replication_config_ptr();
+		if (config->is_watch_quantized()) {
+			LocalVector<int64_t> &baseline = peers_info[p_from].recv_delta_baselines[sync->get_instance_id()];
+			LocalVector<const SceneReplicationConfig::Quantization *> quantization;
+			LocalVector<int64_t *> baselines;
+			_get_delta_quantization(config, indexes, baseline, quantization, baselines);
+			ERR_FAIL_COND_V(quantization.size() != uint32_t(vars.size()), ERR_INVALID_DATA);
+			err = SceneReplicationCodec::decode_state(p_buffer + ofs, size, quantization.ptr(), baselines.ptr(), vars, consumed);
+		} else {
+			err = MultiplayerAPI::decode_and_decompress_variants(vars, p_buffer + ofs, size, consumed);
+		}
 		ERR_FAIL_COND_V(err != OK, err);
 		ERR_FAIL_COND_V(uint32_t(consumed) != size, ERR_INVALID_DATA);
 		err = MultiplayerSynchronizer::set_state(props, node, vars);
@@ -800,7 +1019,7 @@ Error SceneReplicationInterface::on_delta_receive(int p_from, const uint8_t *p_b
 	return OK;
 }
 
-void SceneReplicationInterface::_send_sync(int p_peer, const HashSet<ObjectID> &p_synchronizers, uint16_t p_sync_net_time, uint64_t p_usec) {
+void SceneReplicationInterface::_send_sync(int p_peer, const LocalVector<ObjectID> &p_synchronizers, uint16_t p_sync_net_time, uint64_t p_usec, int &r_budget) {
 	MAKE_ROOM(/* header */ 3 + /* element */ 4 + 4 + sync_mtu);
 	uint8_t *ptr = packet_cache.ptrw();
 	ptr[0] = SceneMultiplayer::NETWORK_COMMAND_SYNC;
@@ -825,13 +1044,28 @@ void SceneReplicationInterface::_send_sync(int p_peer, const HashSet<ObjectID> &
 		int size;
 		Vector<Variant> vars;
 		Vector<const Variant *> varp;
-		const List<NodePath> props = sync->get_replication_config_ptr()->get_sync_properties();
+		SceneReplicationConfig *config = sync->get_replication_config_ptr();
+		const List<NodePath> props = config->get_sync_properties();
 		Error err = MultiplayerSynchronizer::get_state(props, node, vars, varp);
 		ERR_CONTINUE_MSG(err != OK, "Unable to retrieve sync state.");
-		err = MultiplayerAPI::encode_and_compress_variants(varp.ptrw(), varp.size(), nullptr, size);
+		// Syncs are unreliable, so quantized values are never encoded against a baseline.
+		const bool quantized = config->is_sync_quantized();
+		if (quantized) {
+			LocalVector<const SceneReplicationConfig::Quantization *> quantization;
+			for (const SceneReplicationConfig::Quantization &q : config->get_sync_quantization()) {
+				quantization.push_back(&q);
+			}
+			err = SceneReplicationCodec::encode_state(varp.ptr(), quantization.ptr(), nullptr, varp.size(), state_cache);
+			size = state_cache.size();
+		} else {
+			err = MultiplayerAPI::encode_and_compress_variants(varp.ptrw(), varp.size(), nullptr, size);
+		}
 		ERR_CONTINUE_MSG(err != OK, "Unable to encode sync state.");
 		// TODO Handle single state above MTU.
 		ERR_CONTINUE_MSG(size > sync_mtu, vformat("Node states bigger than MTU will not be sent (%d > %d): %s", size, sync_mtu, node->get_path()));
+		if (r_budget >= 0 && 4 + 4 + size > r_budget) {
+			break; // Out of bandwidth, lower priority synchronizers wait for a later tick.
+		}
 		if (ofs + 4 + 4 + size > sync_mtu) {
 			// Send what we got, and reset write.
 			_send_raw(packet_cache.ptr(), ofs, p_peer, false);
@@ -840,8 +1074,16 @@ void SceneReplicationInterface::_send_sync(int p_peer, const HashSet<ObjectID> &
 		if (size) {
 			ofs += encode_uint32(sync->get_net_id(), &ptr[ofs]);
 			ofs += encode_uint32(size, &ptr[ofs]);
-			MultiplayerAPI::encode_and_compress_variants(varp.ptrw(), varp.size(), &ptr[ofs], size);
+			if (quantized) {
+				memcpy(&ptr[ofs], state_cache.ptr(), size);
+			} else {
+				MultiplayerAPI::encode_and_compress_variants(varp.ptrw(), varp.size(), &ptr[ofs], size);
+			}
 			ofs += size;
+			if (r_budget >= 0) {
+				r_budget -= 4 + 4 + size;
+			}
+			peers_info[p_peer].last_send_usecs[oid] = p_usec;
 		}
 #ifdef DEBUG_ENABLED
 		_profile_node_data("sync_out", oid, size);
@@ -884,11 +1126,21 @@ Error SceneReplicationInterface::on_sync_receive(int p_from, const uint8_t *p_bu
 			ofs += size;
 			continue;
 		}
-		const List<NodePath> props = sync->get_replication_config_ptr()->get_sync_properties();
+		SceneReplicationConfig *config = sync->get_replication_config_ptr();
+		const List<NodePath> props = config->get_sync_properties();
 		Vector<Variant> vars;
 		vars.resize(props.size());
 		int consumed;
-		Error err = MultiplayerAPI::decode_and_decompress_variants(vars, &p_buffer[ofs], size, consumed);
+		Error err;
+		if (config->is_sync_quantized()) {
+			LocalVector<const SceneReplicationConfig::Quantization *> quantization;
+			for (const SceneReplicationConfig::Quantization &q : config->get_sync_quantization()) {
+				quantization.push_back(&q);
+			}
+			err = SceneReplicationCodec::decode_state(&p_buffer[ofs], size, quantization.ptr(), nullptr, vars, consumed);
+		} else {
+			err = MultiplayerAPI::decode_and_decompress_variants(vars, &p_buffer[ofs], size, consumed);
+		}
 		ERR_FAIL_COND_V(err, err);
 		err = MultiplayerSynchronizer::set_state(props, node, vars);
 		ERR_FAIL_COND_V(err, err);
@@ -918,3 +1170,33 @@ void SceneReplicationInterface::set_max_delta_packet_size(int p_size) {
 int SceneReplicationInterface::get_max_delta_packet_size() const {
 	return delta_mtu;
 }
+
+void SceneReplicationInterface::set_interest_cell_size(real_t p_size) {
+	ERR_FAIL_COND_MSG(p_size <= 0, "Interest cell size must be greater than 0.");
+	interest_cell_size = p_size;
+}
+
+real_t SceneReplicationInterface::get_interest_cell_size() const {
+	return interest_cell_size;
+}
+
+void SceneReplicationInterface::set_peer_interest_origin(int p_peer, const Vector3 &p_origin) {
+	ERR_FAIL_COND_MSG(!peers_info.has(p_peer), vformat("Unknown peer: %d.", p_peer));
+	PeerInfo &info = peers_info[p_peer];
+	info.has_interest_origin = true;
+	info.interest_origin = p_origin;
+}
+
+void SceneReplicationInterface::clear_peer_interest_origin(int p_peer) {
+	ERR_FAIL_COND_MSG(!peers_info.has(p_peer), vformat("Unknown peer: %d.", p_peer));
+	peers_info[p_peer].has_interest_origin = false;
+}
+
+void SceneReplicationInterface::set_max_peer_bandwidth(int p_bytes_per_second) {
+	ERR_FAIL_COND_MSG(p_bytes_per_second < 0, "Peer bandwidth must be greater or equal to 0 (where 0 means unlimited).");
+	peer_bandwidth = p_bytes_per_second;
+}
+
+int SceneReplicationInterface::get_max_peer_bandwidth() const {
+	return peer_bandwidth;
+}
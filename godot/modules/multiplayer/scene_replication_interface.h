@@ -41,6 +41,7 @@ class SceneCacheInterface;
 
 class SceneReplicationInterface : public RefCounted {
 	GDCLASS(SceneReplicationInterface, RefCounted);
+	friend class TestSceneReplicationInterfaceAccessor;
 
 private:
 	struct TrackedNode {
@@ -67,8 +68,34 @@ private:
 		HashMap<uint32_t, ObjectID> recv_sync_ids;
 		HashMap<uint32_t, ObjectID> recv_nodes;
 		uint16_t last_sent_sync = 0;
+
+		// Interest management and bandwidth scheduling.
+		bool has_interest_origin = false;
+		Vector3 interest_origin;
+		HashMap<ObjectID, uint64_t> last_send_usecs;
+		double bandwidth_credit = 0;
+
+		// Quantized watched values last sent to (or received from) this peer, see SceneReplicationCodec.
+		HashMap<ObjectID, LocalVector<int64_t>> delta_baselines;
+		HashMap<ObjectID, LocalVector<int64_t>> recv_delta_baselines;
+	};
+
+	struct InterestEntry {
+		ObjectID sid;
+		Vector3 position;
+		real_t radius = 0;
+	};
+
+	struct SyncCandidate {
+		ObjectID sid;
+		float score = 0;
+
+		bool operator<(const SyncCandidate &p_other) const { return score > p_other.score; } // Highest score first.
 	};
 
+	// Above this many cells per axis, an entry is distance-tested by every peer instead of being gridded.
+	static const int MAX_INTEREST_CELL_SPAN = 8;
+
 	// Replication state.
 	HashMap<int, PeerInfo> peers_info;
 	uint32_t last_net_id = 0;
@@ -90,9 +117,25 @@ private:
 	SceneMultiplayer *multiplayer = nullptr;
 	SceneCacheInterface *multiplayer_cache = nullptr;
 	PackedByteArray packet_cache;
+	LocalVector<uint8_t> state_cache;
+	LocalVector<int64_t> baseline_cache;
 	int sync_mtu = 1350; // Highly dependent on underlying protocol.
 	int delta_mtu = 65535;
 
+	// Interest management: a uniform grid of synchronizers with an interest radius, refilled every tick.
+	real_t interest_cell_size = 64;
+	HashMap<Vector3i, LocalVector<uint32_t>> interest_cells;
+	LocalVector<Vector3i> interest_unused_cells;
+	LocalVector<InterestEntry> interest_entries;
+	LocalVector<uint32_t> interest_large_entries;
+	LocalVector<ObjectID> interest_unbounded;
+	LocalVector<SyncCandidate> sync_candidates_cache;
+	bool interest_enabled = false;
+
+	// Bandwidth scheduling.
+	int peer_bandwidth = 0; // Bytes per second per peer, 0 means unlimited.
+	uint64_t last_process_usec = 0;
+
 	TrackedNode &_track(const ObjectID &p_id);
 	void _untrack(const ObjectID &p_id);
 	void _node_ready(const ObjectID &p_oid);
@@ -101,8 +144,12 @@ private:
 	bool _verify_synchronizer(int p_peer, MultiplayerSynchronizer *p_sync, uint32_t &r_net_id);
 	MultiplayerSynchronizer *_find_synchronizer(int p_peer, uint32_t p_net_ida);
 
-	void _send_sync(int p_peer, const HashSet<ObjectID> &p_synchronizers, uint16_t p_sync_net_time, uint64_t p_usec);
-	void _send_delta(int p_peer, const HashSet<ObjectID> &p_synchronizers, uint64_t p_usec, const HashMap<ObjectID, uint64_t> &p_last_watch_usecs);
+	int _refill_bandwidth_budget(PeerInfo &p_info, double p_elapsed) const;
+	void _update_interest();
+	void _collect_peer_syncs(const PeerInfo &p_info, uint64_t p_usec, LocalVector<ObjectID> &r_synchronizers);
+	void _get_delta_quantization(SceneReplicationConfig *p_config, uint64_t p_indexes, LocalVector<int64_t> &r_baseline, LocalVector<const SceneReplicationConfig::Quantization *> &r_quantization, LocalVector<int64_t *> &r_baselines);
+	void _send_sync(int p_peer, const LocalVector<ObjectID> &p_synchronizers, uint16_t p_sync_net_time, uint64_t p_usec, int &r_budget);
+	void _send_delta(int p_peer, const LocalVector<ObjectID> &p_synchronizers, uint64_t p_usec, const HashMap<ObjectID, uint64_t> &p_last_watch_usecs, int &r_budget);
 	Error _make_spawn_packet(Node *p_node, MultiplayerSpawner *p_spawner, int &r_len);
 	Error _make_despawn_packet(Node *p_node, int &r_len);
 	Error _send_raw(const uint8_t *p_buffer, int p_size, int p_peer, bool p_reliable);
@@ -146,6 +193,15 @@ public:
 	void set_max_delta_packet_size(int p_size);
 	int get_max_delta_packet_size() const;
 
+	void set_interest_cell_size(real_t p_size);
+	real_t get_interest_cell_size() const;
+
+	void set_peer_interest_origin(int p_peer, const Vector3 &p_origin);
+	void clear_peer_interest_origin(int p_peer);
+
+	void set_max_peer_bandwidth(int p_bytes_per_second);
+	int get_max_peer_bandwidth() const;
+
 	SceneReplicationInterface(SceneMultiplayer *p_multiplayer, SceneCacheInterface *p_cache) {
 		multiplayer = p_multiplayer;
 		multiplayer_cache = p_cache;
@@ -35,6 +35,35 @@
 #include "tests/test_utils.h"
 
 #include "../scene_multiplayer.h"
+#include "../scene_replication_codec.h"
+#include "../scene_replication_interface.h"
+
+#include "scene/2d/node_2d.h"
+#include "scene/main/window.h"
+
+class TestSceneReplicationInterfaceAccessor {
+public:
+	static LocalVector<ObjectID> collect_peer_syncs(SceneReplicationInterface *p_replicator, int p_peer, uint64_t p_usec) {
+		LocalVector<ObjectID> synchronizers;
+		p_replicator->_update_interest();
+		p_replicator->_collect_peer_syncs(p_replicator->peers_info[p_peer], p_usec, synchronizers);
+		return synchronizers;
+	}
+
+	static int refill_bandwidth_budget(SceneReplicationInterface *p_replicator, int p_peer, double p_elapsed) {
+		return p_replicator->_refill_bandwidth_budget(p_replicator->peers_info[p_peer], p_elapsed);
+	}
+
+	static int send_sync(SceneReplicationInterface *p_replicator, int p_peer, const LocalVector<ObjectID> &p_synchronizers, uint64_t p_usec, int p_budget) {
+		p_replicator->_send_sync(p_peer, p_synchronizers, 1, p_usec, p_budget);
+		return p_budget;
+	}
+
+	static uint64_t get_last_send_usec(SceneReplicationInterface *p_replicator, int p_peer, const ObjectID &p_sid) {
+		const uint64_t *usec = p_replicator->peers_info[p_peer].last_send_usecs.getptr(p_sid);
+		return usec ? *usec : 0;
+	}
+};
 
 namespace TestSceneMultiplayer {
 
@@ -66,6 +95,8 @@ TEST_CASE("[Multiplayer][SceneMultiplayer] Defaults") {
 	CHECK(scene_multiplayer->is_server_relay_enabled());
 	CHECK_EQ(scene_multiplayer->get_max_sync_packet_size(), 1350);
 	CHECK_EQ(scene_multiplayer->get_max_delta_packet_size(), 65535);
+	CHECK_EQ(scene_multiplayer->get_interest_cell_size(), 64);
+	CHECK_EQ(scene_multiplayer->get_max_peer_bandwidth(), 0);
 	CHECK(scene_multiplayer->is_server());
 }
 
@@ -158,6 +189,310 @@ TEST_CASE("[Multiplayer][SceneMultiplayer] Root Path") {
 	}
 }
 
+TEST_CASE("[Multiplayer][SceneMultiplayer] Interest management and bandwidth") {
+	Ref<SceneMultiplayer> scene_multiplayer;
+	scene_multiplayer.instantiate();
+
+	SUBCASE("Sets interest cell size") {
+		scene_multiplayer->set_interest_cell_size(16);
+		CHECK_EQ(scene_multiplayer->get_interest_cell_size(), 16);
+
+		ERR_PRINT_OFF;
+		scene_multiplayer->set_interest_cell_size(0);
+		ERR_PRINT_ON;
+		CHECK_EQ(scene_multiplayer->get_interest_cell_size(), 16);
+	}
+
+	SUBCASE("Sets peer bandwidth") {
+		scene_multiplayer->set_max_peer_bandwidth(32768);
+		CHECK_EQ(scene_multiplayer->get_max_peer_bandwidth(), 32768);
+
+		ERR_PRINT_OFF;
+		scene_multiplayer->set_max_peer_bandwidth(-1);
+		ERR_PRINT_ON;
+		CHECK_EQ(scene_multiplayer->get_max_peer_bandwidth(), 32768);
+	}
+
+	SUBCASE("Fails to set the interest origin of an unknown peer") {
+		ERR_PRINT_OFF;
+		scene_multiplayer->set_peer_interest_origin(42, Vector3(1, 2, 3));
+		scene_multiplayer->clear_peer_interest_origin(42);
+		ERR_PRINT_ON;
+		CHECK_EQ(scene_multiplayer->poll(), Error::OK);
+	}
+}
+
+TEST_CASE("[Multiplayer][MultiplayerSynchronizer] Interest radius and priority") {
+	MultiplayerSynchronizer *synchronizer = memnew(MultiplayerSynchronizer);
+
+	CHECK_EQ(synchronizer->get_interest_radius(), 0);
+	CHECK_EQ(synchronizer->get_replication_priority(), 1);
+
+	synchronizer->set_interest_radius(25);
+	synchronizer->set_replication_priority(2.5);
+	CHECK_EQ(synchronizer->get_interest_radius(), 25);
+	CHECK_EQ(synchronizer->get_replication_priority(), 2.5);
+
+	ERR_PRINT_OFF;
+	synchronizer->set_interest_radius(-1);
+	synchronizer->set_replication_priority(-1);
+	ERR_PRINT_ON;
+	CHECK_EQ(synchronizer->get_interest_radius(), 25);
+	CHECK_EQ(synchronizer->get_replication_priority(), 2.5);
+
+	Vector3 position;
+	CHECK_FALSE(synchronizer->get_interest_position(position)); // Not in the tree, no root node.
+
+	memdelete(synchronizer);
+}
+
+TEST_CASE("[Multiplayer][SceneReplicationConfig] Quantization settings") {
+	Ref<SceneReplicationConfig> config;
+	config.instantiate();
+	const NodePath position = NodePath(":position");
+	const NodePath rotation = NodePath(":quaternion");
+	config->add_property(position);
+	config->add_property(rotation);
+	config->property_set_replication_mode(rotation, SceneReplicationConfig::REPLICATION_MODE_ON_CHANGE);
+
+	CHECK_EQ(config->property_get_quantization(position), SceneReplicationConfig::QUANTIZATION_NONE);
+	CHECK_FALSE(config->is_sync_quantized());
+	CHECK_FALSE(config->is_watch_quantized());
+
+	config->property_set_quantization(position, SceneReplicationConfig::QUANTIZATION_FIXED_POINT);
+	config->property_set_quantization_step(position, 0.125);
+	CHECK(config->is_sync_quantized());
+	CHECK_FALSE(config->is_watch_quantized());
+	REQUIRE_EQ(config->get_sync_quantization().size(), 1);
+	CHECK_EQ(config->get_sync_quantization()[0].step, 0.125);
+
+	config->property_set_quantization(rotation, SceneReplicationConfig::QUANTIZATION_SMALLEST_THREE);
+	config->property_set_quantization_bits(rotation, 12);
+	CHECK(config->is_watch_quantized());
+	CHECK_EQ(config->get_watch_quantization()[0].bits, 12);
+
+	ERR_PRINT_OFF;
+	config->property_set_quantization_bits(rotation, 64);
+	config->property_set_quantization_step(position, 0);
+	config->property_set_quantization_range(position, Vector2(1, -1));
+	ERR_PRINT_ON;
+	CHECK_EQ(config->property_get_quantization_bits(rotation), 12);
+	CHECK_EQ(config->property_get_quantization_step(position), 0.125);
+	CHECK_EQ(config->property_get_quantization_range(position), Vector2(0, 1));
+
+	// Stored with the resource.
+	CHECK_EQ(config->get("properties/1/quantization"), Variant(SceneReplicationConfig::QUANTIZATION_SMALLEST_THREE));
+	config->set("properties/0/quantization_range", Vector2(-10, 10));
+	CHECK_EQ(config->property_get_quantization_range(position), Vector2(-10, 10));
+}
+
+TEST_CASE("[Multiplayer][SceneReplicationCodec] Quantized state") {
+	SceneReplicationConfig::Quantization fixed;
+	fixed.mode = SceneReplicationConfig::QUANTIZATION_FIXED_POINT;
+	fixed.step = 0.01;
+	SceneReplicationConfig::Quantization range;
+	range.mode = SceneReplicationConfig::QUANTIZATION_RANGE;
+	range.range = Vector2(-1, 1);
+	range.bits = 10;
+	SceneReplicationConfig::Quantization smallest_three;
+	smallest_three.mode = SceneReplicationConfig::QUANTIZATION_SMALLEST_THREE;
+	smallest_three.bits = 16;
+	SceneReplicationConfig::Quantization none;
+
+	const SceneReplicationConfig::Quantization *quantization[4] = { &fixed, &range, &smallest_three, &none };
+
+	SUBCASE("Round trip") {
+		const Variant position = Vector3(1234.567, -0.004, 42);
+		const Variant ratio = 0.5;
+		const Variant rotation = Quaternion(Vector3(0.2, 1, -0.5).normalized(), 2.5);
+		const Variant name = String("not quantized");
+		const Variant *values[4] = { &position, &ratio, &rotation, &name };
+
+		LocalVector<uint8_t> buffer;
+		CHECK_EQ(SceneReplicationCodec::encode_state(values, quantization, nullptr, 4, buffer), OK);
+
+		Vector<Variant> decoded;
+		decoded.resize(4);
+		int consumed = 0;
+		CHECK_EQ(SceneReplicationCodec::decode_state(buffer.ptr(), buffer.size(), quantization, nullptr, decoded, consumed), OK);
+		CHECK_EQ(consumed, (int)buffer.size());
+
+		CHECK(decoded[0].operator Vector3().distance_to(position) <= 0.01);
+		CHECK(Math::abs(decoded[1].operator real_t() - 0.5) <= 1.0 / 1023);
+		const Quaternion q = decoded[2];
+		CHECK(Math::abs(q.dot(rotation)) > 0.9999);
+		CHECK_EQ(decoded[3], name);
+	}
+
+	SUBCASE("Unsupported types fall back to the variant encoding") {
+		const Variant count = 7;
+		const Variant *values[1] = { &count };
+		LocalVector<uint8_t> buffer;
+		CHECK_EQ(SceneReplicationCodec::encode_state(values, quantization, nullptr, 1, buffer), OK);
+
+		Vector<Variant> decoded;
+		decoded.resize(1);
+		int consumed = 0;
+		CHECK_EQ(SceneReplicationCodec::decode_state(buffer.ptr(), buffer.size(), quantization, nullptr, decoded, consumed), OK);
+		CHECK_EQ(decoded[0], count);
+	}
+
+	SUBCASE("Delta against baseline") {
+		int64_t send_baseline[SceneReplicationCodec::BASELINE_STRIDE] = {};
+		int64_t recv_baseline[SceneReplicationCodec::BASELINE_STRIDE] = {};
+		int64_t *send_baselines[1] = { send_baseline };
+		int64_t *recv_baselines[1] = { recv_baseline };
+
+		LocalVector<uint8_t> absolute;
+		LocalVector<uint8_t> delta;
+		Vector<Variant> decoded;
+		decoded.resize(1);
+		int consumed = 0;
+
+		const Variant first = Vector3(5000, 5000, 5000);
+		const Variant *first_values[1] = { &first };
+		CHECK_EQ(SceneReplicationCodec::encode_state(first_values, quantization, send_baselines, 1, absolute), OK);
+		CHECK_EQ(SceneReplicationCodec::decode_state(absolute.ptr(), absolute.size(), quantization, recv_baselines, decoded, consumed), OK);
+		CHECK(decoded[0].operator Vector3().is_equal_approx(first));
+
+		const Variant second = Vector3(5000.01, 5000, 4999.99);
+		const Variant *second_values[1] = { &second };
+		CHECK_EQ(SceneReplicationCodec::encode_state(second_values, quantization, send_baselines, 1, delta), OK);
+		CHECK_LT(delta.size(), absolute.size());
+		CHECK_EQ(SceneReplicationCodec::decode_state(delta.ptr(), delta.size(), quantization, recv_baselines, decoded, consumed), OK);
+		CHECK(decoded[0].operator Vector3().is_equal_approx(second));
+
+		// A receiver that lost its baseline rejects the delta instead of applying garbage.
+		int64_t lost_baseline[SceneReplicationCodec::BASELINE_STRIDE] = {};
+		int64_t *lost_baselines[1] = { lost_baseline };
+		ERR_PRINT_OFF;
+		CHECK_EQ(SceneReplicationCodec::decode_state(delta.ptr(), delta.size(), quantization, lost_baselines, decoded, consumed), ERR_INVALID_DATA);
+		ERR_PRINT_ON;
+	}
+}
+
+static MultiplayerSynchronizer *add_replicated_node(Node *p_parent, SceneReplicationInterface *p_replicator, const Vector2 &p_position, real_t p_interest_radius) {
+	Ref<SceneReplicationConfig> config;
+	config.instantiate();
+	config->add_property(NodePath(":position"));
+
+	Node2D *node = memnew(Node2D);
+	node->set_position(p_position);
+	MultiplayerSynchronizer *synchronizer = memnew(MultiplayerSynchronizer);
+	synchronizer->set_interest_radius(p_interest_radius);
+	synchronizer->set_replication_config(config);
+	node->add_child(synchronizer);
+	p_parent->add_child(node);
+
+	CHECK_EQ(p_replicator->on_replication_start(node, synchronizer), OK);
+	synchronizer->set_net_id(p_parent->get_child_count()); // Skip the path confirmation.
+	return synchronizer;
+}
+
+TEST_CASE("[Multiplayer][SceneReplicationInterface][SceneTree] Interest filtering") {
+	Ref<SceneMultiplayer> scene_multiplayer;
+	scene_multiplayer.instantiate();
+	Ref<SceneReplicationInterface> replicator = memnew(SceneReplicationInterface(scene_multiplayer.ptr(), nullptr));
+	replicator->set_interest_cell_size(16);
+	const int peer_id = 2;
+	replicator->on_peer_change(peer_id, true);
+
+	Node *parent = memnew(Node);
+	SceneTree::get_singleton()->get_root()->add_child(parent);
+	MultiplayerSynchronizer *near = add_replicated_node(parent, replicator.ptr(), Vector2(10, 0), 20);
+	MultiplayerSynchronizer *far = add_replicated_node(parent, replicator.ptr(), Vector2(500, 0), 20);
+	MultiplayerSynchronizer *unbounded = add_replicated_node(parent, replicator.ptr(), Vector2(1000, 0), 0);
+	MultiplayerSynchronizer *large = add_replicated_node(parent, replicator.ptr(), Vector2(2000, 0), 5000); // Spans too many cells to be gridded.
+
+	SUBCASE("Peers without an interest origin receive every synchronizer") {
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::collect_peer_syncs(replicator.ptr(), peer_id, 1000000).size(), 4);
+	}
+
+	SUBCASE("Synchronizers out of their interest radius are dropped") {
+		replicator->set_peer_interest_origin(peer_id, Vector3());
+		LocalVector<ObjectID> synchronizers = TestSceneReplicationInterfaceAccessor::collect_peer_syncs(replicator.ptr(), peer_id, 1000000);
+		CHECK_EQ(synchronizers.size(), 3);
+		CHECK(synchronizers.has(near->get_instance_id()));
+		CHECK_FALSE(synchronizers.has(far->get_instance_id()));
+		CHECK(synchronizers.has(unbounded->get_instance_id()));
+		CHECK(synchronizers.has(large->get_instance_id()));
+
+		// The grid is refilled every tick, so moving nodes are picked up.
+		Object::cast_to<Node2D>(far->get_root_node())->set_position(Vector2(-5, 3));
+		Object::cast_to<Node2D>(near->get_root_node())->set_position(Vector2(-100, 0));
+		synchronizers = TestSceneReplicationInterfaceAccessor::collect_peer_syncs(replicator.ptr(), peer_id, 2000000);
+		CHECK_EQ(synchronizers.size(), 3);
+		CHECK(synchronizers.has(far->get_instance_id()));
+		CHECK_FALSE(synchronizers.has(near->get_instance_id()));
+
+		replicator->clear_peer_interest_origin(peer_id);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::collect_peer_syncs(replicator.ptr(), peer_id, 3000000).size(), 4);
+	}
+
+	memdelete(parent);
+}
+
+TEST_CASE("[Multiplayer][SceneReplicationInterface][SceneTree] Bandwidth scheduling") {
+	Ref<SceneMultiplayer> scene_multiplayer;
+	scene_multiplayer.instantiate();
+	const int peer_id = 2;
+	scene_multiplayer->get_multiplayer_peer()->emit_signal(SNAME("peer_connected"), peer_id);
+	Ref<SceneReplicationInterface> replicator = memnew(SceneReplicationInterface(scene_multiplayer.ptr(), nullptr));
+	replicator->on_peer_change(peer_id, true);
+
+	SUBCASE("Token bucket caps the bytes per tick") {
+		replicator->set_max_delta_packet_size(512);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::refill_bandwidth_budget(replicator.ptr(), peer_id, 10), -1); // Unlimited.
+
+		replicator->set_max_peer_bandwidth(4000);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::refill_bandwidth_budget(replicator.ptr(), peer_id, 0.25), 1000);
+		// Unspent credit carries over to the next tick...
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::refill_bandwidth_budget(replicator.ptr(), peer_id, 0.25), 2000);
+		// ...up to one second of bandwidth.
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::refill_bandwidth_budget(replicator.ptr(), peer_id, 10), 4000);
+
+		// Always enough for a full sync packet.
+		replicator->set_max_peer_bandwidth(1000);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::refill_bandwidth_budget(replicator.ptr(), peer_id, 10), 1350);
+	}
+
+	SUBCASE("Throttled synchronizers rotate") {
+		Node *parent = memnew(Node);
+		SceneTree::get_singleton()->get_root()->add_child(parent);
+		const ObjectID first = add_replicated_node(parent, replicator.ptr(), Vector2(1, 0), 0)->get_instance_id();
+		add_replicated_node(parent, replicator.ptr(), Vector2(2, 0), 0);
+		add_replicated_node(parent, replicator.ptr(), Vector2(3, 0), 0);
+		replicator->set_max_peer_bandwidth(1000);
+
+		// All synchronizers have the same state size.
+		LocalVector<ObjectID> synchronizers;
+		synchronizers.push_back(first);
+		const int cost = 1000 - TestSceneReplicationInterfaceAccessor::send_sync(replicator.ptr(), peer_id, synchronizers, 1000000, 1000);
+		REQUIRE_GT(cost, 0);
+
+		// Sending stops once the budget is spent, the remaining synchronizers are not marked as sent.
+		synchronizers = TestSceneReplicationInterfaceAccessor::collect_peer_syncs(replicator.ptr(), peer_id, 2000000);
+		REQUIRE_EQ(synchronizers.size(), 3);
+		CHECK_EQ(synchronizers[2], first); // Sent most recently.
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::send_sync(replicator.ptr(), peer_id, synchronizers, 2000000, cost * 2 + cost / 2), cost / 2);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::get_last_send_usec(replicator.ptr(), peer_id, synchronizers[0]), 2000000);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::get_last_send_usec(replicator.ptr(), peer_id, synchronizers[1]), 2000000);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::get_last_send_usec(replicator.ptr(), peer_id, first), 1000000);
+
+		// The synchronizer that was cut off is first in line on the next tick.
+		synchronizers = TestSceneReplicationInterfaceAccessor::collect_peer_syncs(replicator.ptr(), peer_id, 3000000);
+		REQUIRE_EQ(synchronizers.size(), 3);
+		CHECK_EQ(synchronizers[0], first);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::send_sync(replicator.ptr(), peer_id, synchronizers, 3000000, cost), 0);
+		CHECK_EQ(TestSceneReplicationInterfaceAccessor::get_last_send_usec(replicator.ptr(), peer_id, first), 3000000);
+
+		synchronizers = TestSceneReplicationInterfaceAccessor::collect_peer_syncs(replicator.ptr(), peer_id, 4000000);
+		CHECK_EQ(synchronizers[2], first);
+
+		memdelete(parent);
+	}
+}
+
 // This one could be a dummy callback because the current set of test is not actually testing the full auth flow.
 static Variant auth_callback(Variant sv, Variant pvav) {
 	return Variant();
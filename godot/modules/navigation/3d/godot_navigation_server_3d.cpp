@@ -1412,6 +1412,22 @@ void GodotNavigationServer3D::query_path(const Ref<NavigationPathQueryParameters
 	NavMeshQueries3D::map_query_path(map, p_query_parameters, p_query_result, p_callback);
 }
 
+void GodotNavigationServer3D::query_path_batch(const TypedArray<NavigationPathQueryParameters3D> &p_queries_parameters, Ref<NavigationPathBatchQueryResult3D> p_query_result, const Callable &p_callback) {
+	ERR_FAIL_COND(p_query_result.is_null());
+
+	LocalVector<NavMap *> maps;
+	maps.resize(p_queries_parameters.size());
+	for (uint32_t i = 0; i < maps.size(); i++) {
+		const Ref<NavigationPathQueryParameters3D> query_parameters = p_queries_parameters[i];
+		maps[i] = nullptr;
+		ERR_CONTINUE_MSG(query_parameters.is_null(), vformat("Invalid query parameters at index %d.", i));
+		maps[i] = map_owner.get_or_null(query_parameters->get_map());
+		ERR_CONTINUE_MSG(maps[i] == nullptr, vformat("Invalid navigation map in query parameters at index %d.", i));
+	}
+
+	NavMeshQueries3D::map_query_path_batch(maps, p_queries_parameters, p_query_result, p_callback);
+}
+
 RID GodotNavigationServer3D::source_geometry_parser_create() {
 #ifndef _3D_DISABLED
 	if (navmesh_generator_3d) {
@@ -173,45 +173,10 @@ void NavMeshQueries3D::map_query_path(NavMap *map, const Ref<NavigationPathQuery
 	ERR_FAIL_COND(p_query_parameters.is_null());
 	ERR_FAIL_COND(p_query_result.is_null());
 
-	using namespace NavigationUtilities;
-
 	NavMeshQueries3D::NavMeshPathQueryTask3D query_task;
-	query_task.start_position = p_query_parameters->get_start_position();
-	query_task.target_position = p_query_parameters->get_target_position();
-	query_task.navigation_layers = p_query_parameters->get_navigation_layers();
+	_query_task_set_query_parameters(query_task, p_query_parameters);
 	query_task.callback = p_callback;
 
-	switch (p_query_parameters->get_pathfinding_algorithm()) {
-		case NavigationPathQueryParameters3D::PathfindingAlgorithm::PATHFINDING_ALGORITHM_ASTAR: {
-			query_task.pathfinding_algorithm = PathfindingAlgorithm::PATHFINDING_ALGORITHM_ASTAR;
-		} break;
-		default: {
-			WARN_PRINT("No match for used PathfindingAlgorithm - fallback to default");
-			query_task.pathfinding_algorithm = PathfindingAlgorithm::PATHFINDING_ALGORITHM_ASTAR;
-		} break;
-	}
-
-	switch (p_query_parameters->get_path_postprocessing()) {
-		case NavigationPathQueryParameters3D::PathPostProcessing::PATH_POSTPROCESSING_CORRIDORFUNNEL: {
-			query_task.path_postprocessing = PathPostProcessing::PATH_POSTPROCESSING_CORRIDORFUNNEL;
-		} break;
-		case NavigationPathQueryParameters3D::PathPostProcessing::PATH_POSTPROCESSING_EDGECENTERED: {
-			query_task.path_postprocessing = PathPostProcessing::PATH_POSTPROCESSING_EDGECENTERED;
-		} break;
-		case NavigationPathQueryParameters3D::PathPostProcessing::PATH_POSTPROCESSING_NONE: {
-			query_task.path_postprocessing = PathPostProcessing::PATH_POSTPROCESSING_NONE;
-		} break;
-		default: {
-			WARN_PRINT("No match for used PathPostProcessing - fallback to default");
-			query_task.path_postprocessing = PathPostProcessing::PATH_POSTPROCESSING_CORRIDORFUNNEL;
-		} break;
-	}
-
-	query_task.metadata_flags = (int64_t)p_query_parameters->get_metadata_flags();
-	query_task.simplify_path = p_query_parameters->get_simplify_path();
-	query_task.simplify_epsilon = p_query_parameters->get_simplify_epsilon();
-	query_task.status = NavMeshPathQueryTask3D::TaskStatus::QUERY_STARTED;
-
 	map->query_path(query_task);
 
 	const uint32_t path_point_size = query_task.path_points.size();
@@ -267,7 +232,137 @@ void NavMeshQueries3D::map_query_path(NavMap *map, const Ref<NavigationPathQuery
 	}
 }
 
-void NavMeshQueries3D::query_task_polygons_get_path(NavMeshPathQueryTask3D &p_query_task, const LocalVector<gd::Polygon> &p_polygons, const Vector3 &p_map_up, uint32_t p_link_polygons_size) {
+void NavMeshQueries3D::map_query_path_batch(const LocalVector<NavMap *> &p_maps, const TypedArray<NavigationPathQueryParameters3D> &p_queries_parameters, Ref<NavigationPathBatchQueryResult3D> p_query_result, const Callable &p_callback) {
+	ERR_FAIL_COND(p_maps.size() != (uint32_t)p_queries_parameters.size());
+	ERR_FAIL_COND(p_query_result.is_null());
+
+	LocalVector<NavMeshPathQueryTask3D> query_tasks;
+	query_tasks.resize(p_maps.size());
+
+	// Each map has a path query slot per thread allowed to query it, with the pathfinding memory reused from
+	// one query to the next. Use no more tasks than that, so the worker threads never wait for a free slot.
+	int task_count = query_tasks.size();
+	for (uint32_t i = 0; i < query_tasks.size(); i++) {
+		const Ref<NavigationPathQueryParameters3D> query_parameters = p_queries_parameters[i];
+		if (p_maps[i] == nullptr || query_parameters.is_null()) {
+			query_tasks[i].status = NavMeshPathQueryTask3D::TaskStatus::QUERY_FAILED;
+			continue;
+		}
+		_query_task_set_query_parameters(query_tasks[i], query_parameters);
+		query_tasks[i].map = p_maps[i];
+		task_count = MIN(task_count, p_maps[i]->get_path_query_slots_max());
+	}
+
+	if (task_count > 1) {
+		WorkerThreadPool::GroupID group_task = WorkerThreadPool::get_singleton()->add_native_group_task(&NavMeshQueries3D::_query_task_process_batched, query_tasks.ptr(), query_tasks.size(), task_count, true, SNAME("NavMeshPathQueryBatch3D"));
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_task);
+	} else {
+		for (uint32_t i = 0; i < query_tasks.size(); i++) {
+			_query_task_process_batched(query_tasks.ptr(), i);
+		}
+	}
+
+	// Pack all paths in the same arrays, the metadata arrays stay aligned with the points even if some queries did not ask for them.
+	uint32_t path_point_count = 0;
+	for (const NavMeshPathQueryTask3D &query_task : query_tasks) {
+		path_point_count += query_task.path_points.size();
+	}
+
+	Vector<Vector3> paths;
+	Vector<int32_t> path_offsets;
+	Vector<int32_t> path_types;
+	TypedArray<RID> path_rids;
+	Vector<int64_t> path_owner_ids;
+
+	paths.resize(path_point_count);
+	path_offsets.resize(query_tasks.size() + 1);
+	path_types.resize(path_point_count);
+	path_rids.resize(path_point_count);
+	path_owner_ids.resize(path_point_count);
+
+	Vector3 *paths_w = paths.ptrw();
+	int32_t *path_offsets_w = path_offsets.ptrw();
+	int32_t *path_types_w = path_types.ptrw();
+	int64_t *path_owner_ids_w = path_owner_ids.ptrw();
+
+	uint32_t path_point_index = 0;
+	for (uint32_t i = 0; i < query_tasks.size(); i++) {
+		const NavMeshPathQueryTask3D &query_task = query_tasks[i];
+		path_offsets_w[i] = path_point_index;
+
+		const bool include_types = query_task.metadata_flags.has_flag(PathMetadataFlags::PATH_INCLUDE_TYPES);
+		const bool include_rids = query_task.metadata_flags.has_flag(PathMetadataFlags::PATH_INCLUDE_RIDS);
+		const bool include_owners = query_task.metadata_flags.has_flag(PathMetadataFlags::PATH_INCLUDE_OWNERS);
+		for (uint32_t j = 0; j < query_task.path_points.size(); j++) {
+			paths_w[path_point_index] = query_task.path_points[j];
+			path_types_w[path_point_index] = include_types ? query_task.path_meta_point_types[j] : 0;
+			if (include_rids) {
+				path_rids[path_point_index] = query_task.path_meta_point_rids[j];
+			}
+			path_owner_ids_w[path_point_index] = include_owners ? query_task.path_meta_point_owners[j] : 0;
+			path_point_index++;
+		}
+	}
+	path_offsets_w[query_tasks.size()] = path_point_index;
+
+	p_query_result->set_paths(paths);
+	p_query_result->set_path_offsets(path_offsets);
+	p_query_result->set_path_types(path_types);
+	p_query_result->set_path_rids(path_rids);
+	p_query_result->set_path_owner_ids(path_owner_ids);
+
+	if (p_callback.is_valid()) {
+		emit_callback(p_callback);
+	}
+}
+
+void NavMeshQueries3D::_query_task_set_query_parameters(NavMeshPathQueryTask3D &p_query_task, const Ref<NavigationPathQueryParameters3D> &p_query_parameters) {
+	using namespace NavigationUtilities;
+
+	p_query_task.start_position = p_query_parameters->get_start_position();
+	p_query_task.target_position = p_query_parameters->get_target_position();
+	p_query_task.navigation_layers = p_query_parameters->get_navigation_layers();
+
+	switch (p_query_parameters->get_pathfinding_algorithm()) {
+		case NavigationPathQueryParameters3D::PathfindingAlgorithm::PATHFINDING_ALGORITHM_ASTAR: {
+			p_query_task.pathfinding_algorithm = PathfindingAlgorithm::PATHFINDING_ALGORITHM_ASTAR;
+		} break;
+		default: {
+			WARN_PRINT("No match for used PathfindingAlgorithm - fallback to default");
+			p_query_task.pathfinding_algorithm = PathfindingAlgorithm::PATHFINDING_ALGORITHM_ASTAR;
+		} break;
+	}
+
+	switch (p_query_parameters->get_path_postprocessing()) {
+		case NavigationPathQueryParameters3D::PathPostProcessing::PATH_POSTPROCESSING_CORRIDORFUNNEL: {
+			p_query_task.path_postprocessing = PathPostProcessing::PATH_POSTPROCESSING_CORRIDORFUNNEL;
+		} break;
+		case NavigationPathQueryParameters3D::PathPostProcessing::PATH_POSTPROCESSING_EDGECENTERED: {
+			p_query_task.path_postprocessing = PathPostProcessing::PATH_POSTPROCESSING_EDGECENTERED;
+		} break;
+		case NavigationPathQueryParameters3D::PathPostProcessing::PATH_POSTPROCESSING_NONE: {
+			p_query_task.path_postprocessing = PathPostProcessing::PATH_POSTPROCESSING_NONE;
+		} break;
+		default: {
+			WARN_PRINT("No match for used PathPostProcessing - fallback to default");
+			p_query_task.path_postprocessing = PathPostProcessing::PATH_POSTPROCESSING_CORRIDORFUNNEL;
+		} break;
+	}
+
+	p_query_task.metadata_flags = (int64_t)p_query_parameters->get_metadata_flags();
+	p_query_task.simplify_path = p_query_parameters->get_simplify_path();
+	p_query_task.simplify_epsilon = p_query_parameters->get_simplify_epsilon();
+	p_query_task.status = NavMeshPathQueryTask3D::TaskStatus::QUERY_STARTED;
+}
+
+void NavMeshQueries3D::_query_task_process_batched(void *p_query_tasks, uint32_t p_index) {
+	NavMeshPathQueryTask3D &query_task = static_cast<NavMeshPathQueryTask3D *>(p_query_tasks)[p_index];
+	if (query_task.map) {
+		query_task.map->query_path(query_task);
+	}
+}
+
+void NavMeshQueries3D::query_task_polygons_get_path(NavMeshPathQueryTask3D &p_query_task, const LocalVector<gd::Polygon> &p_polygons, const NavPolygonBVH &p_polygons_bvh, const Vector3 &p_map_up, uint32_t p_link_polygons_size) {
 	p_query_task.path_points.clear();
 	p_query_task.path_meta_point_types.clear();
 	p_query_task.path_meta_point_rids.clear();
@@ -280,7 +375,7 @@ void NavMeshQueries3D::query_task_polygons_get_path(NavMeshPathQueryTask3D &p_qu
 	Vector3 begin_point;
 	Vector3 end_point;
 
-	_query_task_find_start_end_positions(p_query_task, p_polygons, &begin_poly, begin_point, &end_poly, end_point);
+	_query_task_find_start_end_positions(p_query_task, p_polygons, p_polygons_bvh, &begin_poly, begin_point, &end_poly, end_point);
 
 	// Check for trivial cases
 	if (!begin_poly || !end_poly) {
@@ -700,118 +795,130 @@ void NavMeshQueries3D::_path_corridor_post_process_nopostprocessing(NavMeshPathQ
 	_query_task_push_back_point_with_metadata(p_query_task, p_begin_point, p_begin_poly);
 }
 
-void NavMeshQueries3D::_query_task_find_start_end_positions(NavMeshPathQueryTask3D &p_query_task, const LocalVector<gd::Polygon> &p_polygons, const gd::Polygon **r_begin_poly, Vector3 &r_begin_point, const gd::Polygon **r_end_poly, Vector3 &r_end_point) {
-	real_t begin_d = FLT_MAX;
-	real_t end_d = FLT_MAX;
-
+void NavMeshQueries3D::_query_task_find_start_end_positions(NavMeshPathQueryTask3D &p_query_task, const LocalVector<gd::Polygon> &p_polygons, const NavPolygonBVH &p_polygons_bvh, const gd::Polygon **r_begin_poly, Vector3 &r_begin_point, const gd::Polygon **r_end_poly, Vector3 &r_end_point) {
 	// Find the initial poly and the end poly on this map.
-	for (const gd::Polygon &p : p_polygons) {
+	*r_begin_poly = polygons_get_closest_face_point(p_polygons, p_polygons_bvh, p_query_task.start_position, p_query_task.navigation_layers, r_begin_point);
+	*r_end_poly = polygons_get_closest_face_point(p_polygons, p_polygons_bvh, p_query_task.target_position, p_query_task.navigation_layers, r_end_point);
+}
+
+const gd::Polygon *NavMeshQueries3D::polygons_get_closest_face_point(const LocalVector<gd::Polygon> &p_polygons, const NavPolygonBVH &p_polygons_bvh, const Vector3 &p_point, uint32_t p_navigation_layers, Vector3 &r_closest_point) {
+	const gd::Polygon *closest_polygon = nullptr;
+
+	auto check_polygon = [&](uint32_t p_polygon_index, real_t p_closest_distance_squared) {
+		const gd::Polygon &p = p_polygons[p_polygon_index];
 		// Only consider the polygon if it in a region with compatible layers.
-		if ((p_query_task.navigation_layers & p.owner->get_navigation_layers()) == 0) {
-			continue;
+		if ((p_navigation_layers & p.owner->get_navigation_layers()) == 0) {
+			return p_closest_distance_squared;
 		}
 
-		// For each face check the distance between the origin/destination.
+		// For each face check the distance to the point.
 		for (size_t point_id = 2; point_id < p.points.size(); point_id++) {
 			const Face3 face(p.points[0].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
 
-			Vector3 point = face.get_closest_point_to(p_query_task.start_position);
-			real_t distance_to_point = point.distance_to(p_query_task.start_position);
-			if (distance_to_point < begin_d) {
-				begin_d = distance_to_point;
-				*r_begin_poly = &p;
-				r_begin_point = point;
-			}
-
-			point = face.get_closest_point_to(p_query_task.target_position);
-			distance_to_point = point.distance_to(p_query_task.target_position);
-			if (distance_to_point < end_d) {
-				end_d = distance_to_point;
-				*r_end_poly = &p;
-				r_end_point = point;
+			const Vector3 point = face.get_closest_point_to(p_point);
+			const real_t distance_squared = point.distance_squared_to(p_point);
+			if (distance_squared < p_closest_distance_squared) {
+				p_closest_distance_squared = distance_squared;
+				closest_polygon = &p;
+				r_closest_point = point;
 			}
 		}
-	}
+		return p_closest_distance_squared;
+	};
+	p_polygons_bvh.query_nearest(p_point, FLT_MAX, check_polygon);
+
+	return closest_polygon;
 }
 
-Vector3 NavMeshQueries3D::polygons_get_closest_point_to_segment(const LocalVector<gd::Polygon> &p_polygons, const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision) {
-	bool use_collision = p_use_collision;
+Vector3 NavMeshQueries3D::polygons_get_closest_point_to_segment(const LocalVector<gd::Polygon> &p_polygons, const NavPolygonBVH &p_polygons_bvh, const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision) {
 	Vector3 closest_point;
-	real_t closest_point_distance = FLT_MAX;
+	real_t closest_point_distance_squared = FLT_MAX;
 
-	for (const gd::Polygon &polygon : p_polygons) {
-		// For each face check the distance to the segment.
+	// Intersections with the segment come first, keep the one closest to its start.
+	bool intersects = false;
+	auto check_intersection = [&](uint32_t p_polygon_index) {
+		const gd::Polygon &polygon = p_polygons[p_polygon_index];
 		for (size_t point_id = 2; point_id < polygon.points.size(); point_id += 1) {
 			const Face3 face(polygon.points[0].pos, polygon.points[point_id - 1].pos, polygon.points[point_id].pos);
 			Vector3 intersection_point;
 			if (face.intersects_segment(p_from, p_to, &intersection_point)) {
-				const real_t d = p_from.distance_to(intersection_point);
-				if (!use_collision) {
+				const real_t d = p_from.distance_squared_to(intersection_point);
+				if (d < closest_point_distance_squared) {
 					closest_point = intersection_point;
-					use_collision = true;
-					closest_point_distance = d;
-				} else if (closest_point_distance > d) {
-					closest_point = intersection_point;
-					closest_point_distance = d;
+					closest_point_distance_squared = d;
+					intersects = true;
 				}
 			}
-			// If segment does not itersect face, check the distance from segment's endpoints.
-			else if (!use_collision) {
-				const Vector3 p_from_closest = face.get_closest_point_to(p_from);
-				const real_t d_p_from = p_from.distance_to(p_from_closest);
-				if (closest_point_distance > d_p_from) {
-					closest_point = p_from_closest;
-					closest_point_distance = d_p_from;
-				}
+		}
+	};
+	p_polygons_bvh.query_segment(p_from, p_to, check_intersection);
 
-				const Vector3 p_to_closest = face.get_closest_point_to(p_to);
-				const real_t d_p_to = p_to.distance_to(p_to_closest);
-				if (closest_point_distance > d_p_to) {
-					closest_point = p_to_closest;
-					closest_point_distance = d_p_to;
-				}
+	if (intersects || p_use_collision) {
+		return closest_point;
+	}
+
+	auto check_polygon = [&](uint32_t p_polygon_index, real_t p_closest_distance_squared) {
+		const gd::Polygon &polygon = p_polygons[p_polygon_index];
+
+		// For each face check the distance from segment's endpoints.
+		for (size_t point_id = 2; point_id < polygon.points.size(); point_id += 1) {
+			const Face3 face(polygon.points[0].pos, polygon.points[point_id - 1].pos, polygon.points[point_id].pos);
+
+			const Vector3 p_from_closest = face.get_closest_point_to(p_from);
+			const real_t d_p_from = p_from.distance_squared_to(p_from_closest);
+			if (p_closest_distance_squared > d_p_from) {
+				closest_point = p_from_closest;
+				p_closest_distance_squared = d_p_from;
+			}
+
+			const Vector3 p_to_closest = face.get_closest_point_to(p_to);
+			const real_t d_p_to = p_to.distance_squared_to(p_to_closest);
+			if (p_closest_distance_squared > d_p_to) {
+				closest_point = p_to_closest;
+				p_closest_distance_squared = d_p_to;
 			}
 		}
+
 		// Finally, check for a case when shortest distance is between some point located on a face's edge and some point located on a line segment.
-		if (!use_collision) {
-			for (size_t point_id = 0; point_id < polygon.points.size(); point_id += 1) {
-				Vector3 a, b;
-
-				Geometry3D::get_closest_points_between_segments(
-						p_from,
-						p_to,
-						polygon.points[point_id].pos,
-						polygon.points[(point_id + 1) % polygon.points.size()].pos,
-						a,
-						b);
-
-				const real_t d = a.distance_to(b);
-				if (d < closest_point_distance) {
-					closest_point_distance = d;
-					closest_point = b;
-				}
+		for (size_t point_id = 0; point_id < polygon.points.size(); point_id += 1) {
+			Vector3 a, b;
+
+			Geometry3D::get_closest_points_between_segments(
+					p_from,
+					p_to,
+					polygon.points[point_id].pos,
+					polygon.points[(point_id + 1) % polygon.points.size()].pos,
+					a,
+					b);
+
+			const real_t d = a.distance_squared_to(b);
+			if (d < p_closest_distance_squared) {
+				p_closest_distance_squared = d;
+				closest_point = b;
 			}
 		}
-	}
+		return p_closest_distance_squared;
+	};
+	p_polygons_bvh.query_nearest_to_segment(p_from, p_to, FLT_MAX, check_polygon);
 
 	return closest_point;
 }
 
-Vector3 NavMeshQueries3D::polygons_get_closest_point(const LocalVector<gd::Polygon> &p_polygons, const Vector3 &p_point) {
-	gd::ClosestPointQueryResult cp = polygons_get_closest_point_info(p_polygons, p_point);
+Vector3 NavMeshQueries3D::polygons_get_closest_point(const LocalVector<gd::Polygon> &p_polygons, const NavPolygonBVH &p_polygons_bvh, const Vector3 &p_point) {
+	gd::ClosestPointQueryResult cp = polygons_get_closest_point_info(p_polygons, p_polygons_bvh, p_point);
 	return cp.point;
 }
 
-Vector3 NavMeshQueries3D::polygons_get_closest_point_normal(const LocalVector<gd::Polygon> &p_polygons, const Vector3 &p_point) {
-	gd::ClosestPointQueryResult cp = polygons_get_closest_point_info(p_polygons, p_point);
+Vector3 NavMeshQueries3D::polygons_get_closest_point_normal(const LocalVector<gd::Polygon> &p_polygons, const NavPolygonBVH &p_polygons_bvh, const Vector3 &p_point) {
+	gd::ClosestPointQueryResult cp = polygons_get_closest_point_info(p_polygons, p_polygons_bvh, p_point);
 	return cp.normal;
 }
 
-gd::ClosestPointQueryResult NavMeshQueries3D::polygons_get_closest_point_info(const LocalVector<gd::Polygon> &p_polygons, const Vector3 &p_point) {
+gd::ClosestPointQueryResult NavMeshQueries3D::polygons_get_closest_point_info(const LocalVector<gd::Polygon> &p_polygons, const NavPolygonBVH &p_polygons_bvh, const Vector3 &p_point) {
 	gd::ClosestPointQueryResult result;
-	real_t closest_point_distance_squared = FLT_MAX;
 
-	for (const gd::Polygon &polygon : p_polygons) {
+	auto check_polygon = [&](uint32_t p_polygon_index, real_t p_closest_distance_squared) {
+		const gd::Polygon &polygon = p_polygons[p_polygon_index];
 		Vector3 plane_normal = (polygon.points[1].pos - polygon.points[0].pos).cross(polygon.points[2].pos - polygon.points[0].pos);
 		Vector3 closest_on_polygon;
 		real_t closest = FLT_MAX;
@@ -854,32 +961,35 @@ gd::ClosestPointQueryResult NavMeshQueries3D::polygons_get_closest_point_info(co
 			Vector3 plane_normalized = plane_normal.normalized();
 			real_t distance = plane_normalized.dot(p_point - polygon.points[0].pos);
 			real_t distance_squared = distance * distance;
-			if (distance_squared < closest_point_distance_squared) {
-				closest_point_distance_squared = distance_squared;
+			if (distance_squared < p_closest_distance_squared) {
 				result.point = p_point - plane_normalized * distance;
 				result.normal = plane_normal;
 				result.owner = polygon.owner->get_self();
 
 				if (Math::is_zero_approx(distance)) {
-					break;
+					// Nothing can be closer, stop the search.
+					return (real_t)0.0;
 				}
+				return distance_squared;
 			}
 		} else {
 			real_t distance = closest_on_polygon.distance_squared_to(p_point);
-			if (distance < closest_point_distance_squared) {
-				closest_point_distance_squared = distance;
+			if (distance < p_closest_distance_squared) {
 				result.point = closest_on_polygon;
 				result.normal = plane_normal;
 				result.owner = polygon.owner->get_self();
+				return distance;
 			}
 		}
-	}
+		return p_closest_distance_squared;
+	};
+	p_polygons_bvh.query_nearest(p_point, FLT_MAX, check_polygon);
 
 	return result;
 }
 
-RID NavMeshQueries3D::polygons_get_closest_point_owner(const LocalVector<gd::Polygon> &p_polygons, const Vector3 &p_point) {
-	gd::ClosestPointQueryResult cp = polygons_get_closest_point_info(p_polygons, p_point);
+RID NavMeshQueries3D::polygons_get_closest_point_owner(const LocalVector<gd::Polygon> &p_polygons, const NavPolygonBVH &p_polygons_bvh, const Vector3 &p_point) {
+	gd::ClosestPointQueryResult cp = polygons_get_closest_point_info(p_polygons, p_polygons_bvh, p_point);
 	return cp.owner;
 }
 
@@ -146,7 +146,7 @@ void NavMap::query_path(NavMeshQueries3D::NavMeshPathQueryTask3D &p_query_task)
 
 	p_query_task.map_up = get_up();
 
-	NavMeshQueries3D::query_task_polygons_get_path(p_query_task, polygons, up, link_polygons.size());
+	NavMeshQueries3D::query_task_polygons_get_path(p_query_task, polygons, polygons_bvh, up, link_polygons.size());
 
 	path_query_slots_mutex.lock();
 	uint32_t used_slot_index = p_query_task.path_query_slot->slot_index;
@@ -164,7 +164,7 @@ Vector3 NavMap::get_closest_point_to_segment(const Vector3 &p_from, const Vector
 		return Vector3();
 	}
 
-	return NavMeshQueries3D::polygons_get_closest_point_to_segment(polygons, p_from, p_to, p_use_collision);
+	return NavMeshQueries3D::polygons_get_closest_point_to_segment(polygons, polygons_bvh, p_from, p_to, p_use_collision);
 }
 
 Vector3 NavMap::get_closest_point(const Vector3 &p_point) const {
@@ -174,7 +174,7 @@ Vector3 NavMap::get_closest_point(const Vector3 &p_point) const {
 		return Vector3();
 	}
 
-	return NavMeshQueries3D::polygons_get_closest_point(polygons, p_point);
+	return NavMeshQueries3D::polygons_get_closest_point(polygons, polygons_bvh, p_point);
 }
 
 Vector3 NavMap::get_closest_point_normal(const Vector3 &p_point) const {
@@ -184,7 +184,7 @@ Vector3 NavMap::get_closest_point_normal(const Vector3 &p_point) const {
 		return Vector3();
 	}
 
-	return NavMeshQueries3D::polygons_get_closest_point_normal(polygons, p_point);
+	return NavMeshQueries3D::polygons_get_closest_point_normal(polygons, polygons_bvh, p_point);
 }
 
 RID NavMap::get_closest_point_owner(const Vector3 &p_point) const {
@@ -194,13 +194,13 @@ RID NavMap::get_closest_point_owner(const Vector3 &p_point) const {
 		return RID();
 	}
 
-	return NavMeshQueries3D::polygons_get_closest_point_owner(polygons, p_point);
+	return NavMeshQueries3D::polygons_get_closest_point_owner(polygons, polygons_bvh, p_point);
 }
 
 gd::ClosestPointQueryResult NavMap::get_closest_point_info(const Vector3 &p_point) const {
 	RWLockRead read_lock(map_rwlock);
 
-	return NavMeshQueries3D::polygons_get_closest_point_info(polygons, p_point);
+	return NavMeshQueries3D::polygons_get_closest_point_info(polygons, polygons_bvh, p_point);
 }
 
 void NavMap::add_region(NavRegion *p_region) {
@@ -409,11 +409,15 @@ void NavMap::sync() {
 		polygons.resize(polygon_count);
 
 		// Copy all region polygons in the map.
+		LocalVector<const NavPolygonBVH *> region_polygons_bvhs;
+		LocalVector<uint32_t> region_polygons_offsets;
 		polygon_count = 0;
 		for (const NavRegion *region : regions) {
 			if (!region->get_enabled()) {
 				continue;
 			}
+			region_polygons_bvhs.push_back(&region->get_polygons_bvh());
+			region_polygons_offsets.push_back(polygon_count);
 			const LocalVector<gd::Polygon> &polygons_source = region->get_polygons();
 			for (uint32_t n = 0; n < polygons_source.size(); n++) {
 				polygons[polygon_count] = polygons_source[n];
@@ -424,6 +428,9 @@ void NavMap::sync() {
 
 		performance_data.pm_polygon_count = polygon_count;
 
+		// Only the regions that changed rebuilt their hierarchy, the map one just joins them.
+		polygons_bvh.build_from_subtrees(region_polygons_bvhs, region_polygons_offsets);
+
 		// Group all edges per key.
 		connection_pairs_map.clear();
 		connection_pairs_map.reserve(polygons.size());
@@ -571,8 +578,8 @@ void NavMap::sync() {
 			Vector3 closest_end_point;
 
 			// Create link to any polygons within the search radius of the start point.
-			for (uint32_t start_index = 0; start_index < polygons.size(); start_index++) {
-				gd::Polygon &start_poly = polygons[start_index];
+			auto check_start_polygon = [&](uint32_t p_start_index, real_t p_closest_sqr_dist) {
+				gd::Polygon &start_poly = polygons[p_start_index];
 
 				// For each face check the distance to the start
 				for (uint32_t start_point_id = 2; start_point_id < start_poly.points.size(); start_point_id += 1) {
@@ -581,16 +588,20 @@ void NavMap::sync() {
 					const real_t sqr_dist = start_point.distance_squared_to(start);
 
 					// Pick the polygon that is within our radius and is closer than anything we've seen yet.
-					if (sqr_dist < closest_start_sqr_dist) {
-						closest_start_sqr_dist = sqr_dist;
+					if (sqr_dist < p_closest_sqr_dist) {
+						p_closest_sqr_dist = sqr_dist;
 						closest_start_point = start_point;
 						closest_start_polygon = &start_poly;
 					}
 				}
-			}
+				return p_closest_sqr_dist;
+			};
+			polygons_bvh.query_nearest(start, closest_start_sqr_dist, check_start_polygon);
 
 			// Find any polygons within the search radius of the end point.
-			for (gd::Polygon &end_poly : polygons) {
+			auto check_end_polygon = [&](uint32_t p_end_index, real_t p_closest_sqr_dist) {
+				gd::Polygon &end_poly = polygons[p_end_index];
+
 				// For each face check the distance to the end
 				for (uint32_t end_point_id = 2; end_point_id < end_poly.points.size(); end_point_id += 1) {
 					const Face3 end_face(end_poly.points[0].pos, end_poly.points[end_point_id - 1].pos, end_poly.points[end_point_id].pos);
@@ -598,13 +609,15 @@ void NavMap::sync() {
 					const real_t sqr_dist = end_point.distance_squared_to(end);
 
 					// Pick the polygon that is within our radius and is closer than anything we've seen yet.
-					if (sqr_dist < closest_end_sqr_dist) {
-						closest_end_sqr_dist = sqr_dist;
+					if (sqr_dist < p_closest_sqr_dist) {
+						p_closest_sqr_dist = sqr_dist;
 						closest_end_point = end_point;
 						closest_end_polygon = &end_poly;
 					}
 				}
-			}
+				return p_closest_sqr_dist;
+			};
+			polygons_bvh.query_nearest(end, closest_end_sqr_dist, check_end_polygon);
 
 			// If we have both a start and end point, then create a synthetic polygon to route through.
 			if (closest_start_polygon && closest_end_polygon) {
@@ -86,6 +86,9 @@ class NavMap : public NavRid {
 	/// Map polygons
 	LocalVector<gd::Polygon> polygons;
 
+	/// Map polygons hierarchy, joined from the region ones on sync.
+	NavPolygonBVH polygons_bvh;
+
 	/// RVO avoidance worlds
 	RVO2D::RVOSimulator2D rvo_simulation_2d;
 	RVO3D::RVOSimulator3D rvo_simulation_3d;
@@ -183,6 +186,7 @@ public:
 	gd::PointKey get_point_key(const Vector3 &p_pos) const;
 
 	void query_path(NavMeshQueries3D::NavMeshPathQueryTask3D &p_query_task);
+	int get_path_query_slots_max() const { return path_query_slots_max; }
 
 	Vector3 get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision) const;
 	Vector3 get_closest_point(const Vector3 &p_point) const;
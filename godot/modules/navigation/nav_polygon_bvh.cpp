@@ -0,0 +1,172 @@
+/**************************************************************************/
+/*  nav_polygon_bvh.cpp                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "nav_polygon_bvh.h"
+
+#include "core/templates/sort_array.h"
+
+void NavPolygonBVH::_build(LocalVector<BuildItem> &p_build_items, uint32_t p_node, uint32_t p_from, uint32_t p_to, uint32_t p_max_leaf_items) {
+	AABB aabb = p_build_items[p_from].aabb;
+	AABB centers(p_build_items[p_from].center, Vector3());
+	for (uint32_t i = p_from + 1; i < p_to; i++) {
+		aabb.merge_with(p_build_items[i].aabb);
+		centers.expand_to(p_build_items[i].center);
+	}
+
+	if (p_to - p_from <= p_max_leaf_items) {
+		nodes[p_node].aabb = aabb;
+		nodes[p_node].first = p_from;
+		nodes[p_node].count = p_to - p_from;
+		return;
+	}
+
+	// Median split along the longest axis of the centers, which keeps the tree balanced.
+	const uint32_t middle = (p_from + p_to) / 2;
+	switch (centers.get_longest_axis_index()) {
+		case Vector3::AXIS_X: {
+			SortArray<BuildItem, BuildItemCompare<Vector3::AXIS_X>> sorter;
+			sorter.nth_element(p_from, p_to, middle, p_build_items.ptr());
+		} break;
+		case Vector3::AXIS_Y: {
+			SortArray<BuildItem, BuildItemCompare<Vector3::AXIS_Y>> sorter;
+			sorter.nth_element(p_from, p_to, middle, p_build_items.ptr());
+		} break;
+		default: {
+			SortArray<BuildItem, BuildItemCompare<Vector3::AXIS_Z>> sorter;
+			sorter.nth_element(p_from, p_to, middle, p_build_items.ptr());
+		} break;
+	}
+
+	const uint32_t children = nodes.size();
+	nodes.resize(children + 2);
+	nodes[p_node].aabb = aabb;
+	nodes[p_node].first = children;
+	nodes[p_node].count = 0;
+
+	_build(p_build_items, children, p_from, middle, p_max_leaf_items);
+	_build(p_build_items, children + 1, middle, p_to, p_max_leaf_items);
+}
+
+void NavPolygonBVH::build(const LocalVector<gd::Polygon> &p_polygons) {
+	clear();
+
+	LocalVector<BuildItem> build_items;
+	build_items.reserve(p_polygons.size());
+	for (uint32_t i = 0; i < p_polygons.size(); i++) {
+		const gd::Polygon &polygon = p_polygons[i];
+		if (polygon.points.size() < 3) {
+			continue;
+		}
+
+		BuildItem build_item;
+		build_item.aabb = AABB(polygon.points[0].pos, Vector3());
+		for (uint32_t j = 1; j < polygon.points.size(); j++) {
+			build_item.aabb.expand_to(polygon.points[j].pos);
+		}
+		// Keep flat polygons hit by segments that graze them.
+		build_item.aabb = build_item.aabb.grow(CMP_EPSILON * 100);
+		build_item.center = build_item.aabb.get_center();
+		build_item.item = i;
+		build_items.push_back(build_item);
+	}
+
+	if (build_items.is_empty()) {
+		return;
+	}
+
+	nodes.reserve(2 * build_items.size() / MAX_LEAF_ITEMS + 1);
+	nodes.resize(1);
+	_build(build_items, 0, 0, build_items.size(), MAX_LEAF_ITEMS);
+
+	items.resize(build_items.size());
+	for (uint32_t i = 0; i < build_items.size(); i++) {
+		items[i] = build_items[i].item;
+	}
+}
+
+void NavPolygonBVH::build_from_subtrees(const LocalVector<const NavPolygonBVH *> &p_subtrees, const LocalVector<uint32_t> &p_item_offsets) {
+	ERR_FAIL_COND(p_subtrees.size() != p_item_offsets.size());
+	clear();
+
+	LocalVector<BuildItem> build_items;
+	uint32_t node_count = 0;
+	uint32_t item_count = 0;
+	for (uint32_t i = 0; i < p_subtrees.size(); i++) {
+		if (p_subtrees[i]->is_empty()) {
+			continue;
+		}
+		BuildItem build_item;
+		build_item.aabb = p_subtrees[i]->get_aabb();
+		build_item.center = build_item.aabb.get_center();
+		build_item.item = i;
+		build_items.push_back(build_item);
+		node_count += p_subtrees[i]->nodes.size();
+		item_count += p_subtrees[i]->items.size();
+	}
+
+	if (build_items.is_empty()) {
+		return;
+	}
+
+	// Build the top levels over the subtree bounds, with a single subtree per leaf.
+	nodes.reserve(2 * build_items.size() + node_count);
+	items.reserve(item_count);
+	nodes.resize(1);
+	_build(build_items, 0, 0, build_items.size(), 1);
+
+	// Then replace each leaf with the root of its subtree, appending the other subtree nodes and items.
+	const uint32_t top_node_count = nodes.size();
+	for (uint32_t i = 0; i < top_node_count; i++) {
+		if (nodes[i].count == 0) {
+			continue;
+		}
+
+		const uint32_t subtree_index = build_items[nodes[i].first].item;
+		const NavPolygonBVH *subtree = p_subtrees[subtree_index];
+		const uint32_t node_offset = nodes.size();
+		const uint32_t item_offset = items.size();
+
+		for (const Node &subtree_node : subtree->nodes) {
+			Node node = subtree_node;
+			node.first += node.count > 0 ? item_offset : node_offset;
+			nodes.push_back(node);
+		}
+		for (uint32_t item : subtree->items) {
+			items.push_back(item + p_item_offsets[subtree_index]);
+		}
+
+		nodes[i] = nodes[node_offset];
+	}
+}
+
+void NavPolygonBVH::clear() {
+	nodes.clear();
+	items.clear();
+}
@@ -0,0 +1,188 @@
+/**************************************************************************/
+/*  nav_polygon_bvh.h                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef NAV_POLYGON_BVH_H
+#define NAV_POLYGON_BVH_H
+
+#include "nav_utils.h"
+
+#include "core/math/aabb.h"
+#include "core/templates/local_vector.h"
+
+// Static bounding volume hierarchy over navigation polygons, used to find the polygons
+// closest to a point or a segment without checking every polygon of a region or a map.
+class NavPolygonBVH {
+public:
+	struct Node {
+		AABB aabb;
+		uint32_t first = 0; // First child for internal nodes (the second one follows it), first item for leaves.
+		uint32_t count = 0; // Item count for leaves, 0 for internal nodes.
+	};
+
+private:
+	static const uint32_t MAX_LEAF_ITEMS = 4;
+	static const uint32_t MAX_DEPTH = 64;
+
+	struct BuildItem {
+		AABB aabb;
+		Vector3 center;
+		uint32_t item = 0;
+	};
+
+	template <int AXIS>
+	struct BuildItemCompare {
+		_FORCE_INLINE_ bool operator()(const BuildItem &p_a, const BuildItem &p_b) const {
+			return p_a.center[AXIS] < p_b.center[AXIS];
+		}
+	};
+
+	LocalVector<Node> nodes;
+	LocalVector<uint32_t> items; // Polygon indices.
+
+	void _build(LocalVector<BuildItem> &p_build_items, uint32_t p_node, uint32_t p_from, uint32_t p_to, uint32_t p_max_leaf_items);
+
+	static _FORCE_INLINE_ real_t _get_distance_squared(const AABB &p_a, const AABB &p_b) {
+		real_t distance_squared = 0.0;
+		for (int i = 0; i < 3; i++) {
+			real_t gap = MAX(p_a.position[i] - (p_b.position[i] + p_b.size[i]), p_b.position[i] - (p_a.position[i] + p_a.size[i]));
+			if (gap > 0.0) {
+				distance_squared += gap * gap;
+			}
+		}
+		return distance_squared;
+	}
+
+	// Visits the leaves by increasing lower bound of their distance to the query bounds, skipping the ones
+	// farther than the closest item found so far. The callback gets an item and the squared distance to beat,
+	// and returns the new squared distance to beat.
+	template <typename F>
+	void _query_nearest(const AABB &p_bounds, real_t p_max_distance_squared, F &p_callback) const {
+		if (nodes.is_empty()) {
+			return;
+		}
+
+		struct StackEntry {
+			uint32_t node;
+			real_t distance_squared;
+		};
+		StackEntry stack[MAX_DEPTH];
+		uint32_t stack_size = 0;
+
+		real_t max_distance_squared = p_max_distance_squared;
+		uint32_t node_index = 0;
+		real_t node_distance_squared = _get_distance_squared(nodes[0].aabb, p_bounds);
+
+		while (true) {
+			if (node_distance_squared < max_distance_squared) {
+				const Node &node = nodes[node_index];
+				if (node.count > 0) {
+					for (uint32_t i = node.first; i < node.first + node.count; i++) {
+						max_distance_squared = p_callback(items[i], max_distance_squared);
+					}
+				} else {
+					real_t distance_a = _get_distance_squared(nodes[node.first].aabb, p_bounds);
+					real_t distance_b = _get_distance_squared(nodes[node.first + 1].aabb, p_bounds);
+					uint32_t near = node.first;
+					uint32_t far = node.first + 1;
+					if (distance_b < distance_a) {
+						SWAP(near, far);
+						SWAP(distance_a, distance_b);
+					}
+					ERR_FAIL_COND(stack_size == MAX_DEPTH);
+					stack[stack_size++] = { far, distance_b };
+					node_index = near;
+					node_distance_squared = distance_a;
+					continue;
+				}
+			}
+
+			if (stack_size == 0) {
+				return;
+			}
+			stack_size--;
+			node_index = stack[stack_size].node;
+			node_distance_squared = stack[stack_size].distance_squared;
+		}
+	}
+
+public:
+	// Builds the hierarchy over the polygons with at least 3 points, items are indices in the polygon array.
+	void build(const LocalVector<gd::Polygon> &p_polygons);
+	// Builds the hierarchy by joining prebuilt ones, without going through their items again.
+	// The items of each subtree are offset by the matching value, e.g. where its polygons start in the map polygons.
+	void build_from_subtrees(const LocalVector<const NavPolygonBVH *> &p_subtrees, const LocalVector<uint32_t> &p_item_offsets);
+	void clear();
+
+	bool is_empty() const { return nodes.is_empty(); }
+	AABB get_aabb() const { return nodes.is_empty() ? AABB() : nodes[0].aabb; }
+
+	template <typename F>
+	void query_nearest(const Vector3 &p_point, real_t p_max_distance_squared, F &p_callback) const {
+		_query_nearest(AABB(p_point, Vector3()), p_max_distance_squared, p_callback);
+	}
+
+	// Uses the bounds of the segment as distance lower bound, which is exact for points and axis-aligned segments.
+	template <typename F>
+	void query_nearest_to_segment(const Vector3 &p_from, const Vector3 &p_to, real_t p_max_distance_squared, F &p_callback) const {
+		AABB bounds(p_from, Vector3());
+		bounds.expand_to(p_to);
+		_query_nearest(bounds, p_max_distance_squared, p_callback);
+	}
+
+	// Calls the callback for each item whose bounds intersect the segment.
+	template <typename F>
+	void query_segment(const Vector3 &p_from, const Vector3 &p_to, F &p_callback) const {
+		if (nodes.is_empty()) {
+			return;
+		}
+
+		uint32_t stack[MAX_DEPTH];
+		uint32_t stack_size = 0;
+		stack[stack_size++] = 0;
+
+		while (stack_size > 0) {
+			const Node &node = nodes[stack[--stack_size]];
+			if (!node.aabb.intersects_segment(p_from, p_to)) {
+				continue;
+			}
+			if (node.count > 0) {
+				for (uint32_t i = node.first; i < node.first + node.count; i++) {
+					p_callback(items[i]);
+				}
+			} else {
+				ERR_FAIL_COND(stack_size + 2 > MAX_DEPTH);
+				stack[stack_size++] = node.first + 1;
+				stack[stack_size++] = node.first;
+			}
+		}
+	}
+};
+
+#endif // NAV_POLYGON_BVH_H
@@ -120,13 +120,13 @@ Vector3 NavRegion::get_closest_point_to_segment(const Vector3 &p_from, const Vec
 	RWLockRead read_lock(region_rwlock);
 
 	return NavMeshQueries3D::polygons_get_closest_point_to_segment(
-			get_polygons(), p_from, p_to, p_use_collision);
+			get_polygons(), get_polygons_bvh(), p_from, p_to, p_use_collision);
 }
 
 gd::ClosestPointQueryResult NavRegion::get_closest_point_info(const Vector3 &p_point) const {
 	RWLockRead read_lock(region_rwlock);
 
-	return NavMeshQueries3D::polygons_get_closest_point_info(get_polygons(), p_point);
+	return NavMeshQueries3D::polygons_get_closest_point_info(get_polygons(), get_polygons_bvh(), p_point);
 }
 
 Vector3 NavRegion::get_random_point(uint32_t p_navigation_layers, bool p_uniformly) const {
@@ -154,6 +154,7 @@ void NavRegion::update_polygons() {
 		return;
 	}
 	polygons.clear();
+	polygons_bvh.clear();
 	surface_area = 0.0;
 	polygons_dirty = false;
 
@@ -230,6 +231,8 @@ void NavRegion::update_polygons() {
 	}
 
 	surface_area = _new_region_surface_area;
+
+	polygons_bvh.build(polygons);
 }
 
 void NavRegion::request_sync() {
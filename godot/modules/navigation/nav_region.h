@@ -32,6 +32,7 @@
 #define NAV_REGION_H
 
 #include "nav_base.h"
+#include "nav_polygon_bvh.h"
 #include "nav_utils.h"
 
 #include "core/os/rw_lock.h"
@@ -50,6 +51,7 @@ class NavRegion : public NavBase {
 
 	/// Cache
 	LocalVector<gd::Polygon> polygons;
+	NavPolygonBVH polygons_bvh;
 
 	real_t surface_area = 0.0;
 
@@ -91,6 +93,10 @@ public:
 		return polygons;
 	}
 
+	const NavPolygonBVH &get_polygons_bvh() const {
+		return polygons_bvh;
+	}
+
 	Vector3 get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, bool p_use_collision) const;
 	gd::ClosestPointQueryResult get_closest_point_info(const Vector3 &p_point) const;
 	Vector3 get_random_point(uint32_t p_navigation_layers, bool p_uniformly) const;
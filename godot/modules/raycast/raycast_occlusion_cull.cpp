@@ -49,8 +49,12 @@ void RaycastOcclusionCull::RaycastHZBuffer::clear() {
 		camera_rays = nullptr;
 	}
 	camera_ray_masks.clear();
+	camera_ray_tiles.clear();
+	reprojected_depth.clear();
+	tile_needs_rays.clear();
 	camera_rays_tile_count = 0;
 	tile_grid_size = Size2i();
+	has_history = false;
 }
 
 void RaycastOcclusionCull::RaycastHZBuffer::resize(const Size2i &p_size) {
@@ -78,9 +82,190 @@ void RaycastOcclusionCull::RaycastHZBuffer::resize(const Size2i &p_size) {
 
 	camera_ray_masks.resize(camera_rays_tile_count * TILE_RAYS);
 	memset(camera_ray_masks.ptr(), ~0, camera_rays_tile_count * TILE_RAYS * sizeof(uint32_t));
+
+	camera_ray_tiles.reserve(camera_rays_tile_count);
+	reprojected_depth.resize(p_size.x * p_size.y);
+	tile_needs_rays.resize(camera_rays_tile_count);
+	memset(tile_needs_rays.ptr(), 0, camera_rays_tile_count);
+	has_history = false;
+}
+
+void RaycastOcclusionCull::RaycastHZBuffer::set_requested_size(const Size2i &p_size) {
+	requested_size = p_size;
+	if (p_size == Size2i()) {
+		resize(p_size);
+		return;
+	}
+	resize(Size2i(MAX(1, int(Math::round(p_size.x * resolution_scale))), MAX(1, int(Math::round(p_size.y * resolution_scale)))));
+}
+
+void RaycastOcclusionCull::RaycastHZBuffer::adapt_resolution(uint64_t p_cost_usec, float p_budget_usec) {
+	smoothed_cost_usec = smoothed_cost_usec == 0.0f ? float(p_cost_usec) : Math::lerp(smoothed_cost_usec, float(p_cost_usec), 0.1f);
+
+	frames_since_resize++;
+	if (frames_since_resize < RESOLUTION_ADAPT_FRAMES) {
+		return;
+	}
+
+	// The cost is roughly proportional to the pixel count, so scale both axes by the square root.
+	float scale = resolution_scale;
+	if (smoothed_cost_usec > p_budget_usec) {
+		scale *= MAX(0.5f, Math::sqrt(p_budget_usec / smoothed_cost_usec));
+	} else if (smoothed_cost_usec < p_budget_usec * 0.75f) {
+		scale *= 1.1f;
+	}
+	scale = CLAMP(scale, MIN_RESOLUTION_SCALE, 1.0f);
+
+	// The threshold is relative, so small scales can still grow back in 10% steps.
+	const bool at_limit = scale == 1.0f || scale == MIN_RESOLUTION_SCALE;
+	if (scale == resolution_scale || (!at_limit && Math::abs(scale - resolution_scale) < 0.05f * resolution_scale)) {
+		return; // Not worth dropping the temporal history for.
+	}
+
+	resolution_scale = scale;
+	smoothed_cost_usec = 0.0f;
+	frames_since_resize = 0;
+	set_requested_size(requested_size);
+}
+
+void RaycastOcclusionCull::RaycastHZBuffer::mark_changed_bounds(const LocalVector<AABB> &p_bounds, const Transform3D &p_cam_transform, const Projection &p_cam_projection) {
+	if (!has_history) {
+		return; // Everything is traced anyway.
+	}
+
+	const Size2i &buffer_size = sizes[0];
+	const Transform3D cam_inv_transform = p_cam_transform.affine_inverse();
+
+	for (const AABB &bounds : p_bounds) {
+		Vector2 rect_min = Vector2(FLT_MAX, FLT_MAX);
+		Vector2 rect_max = Vector2(-FLT_MAX, -FLT_MAX);
+
+		for (int i = 0; i < 8; i++) {
+			Vector3 view = cam_inv_transform.xform(bounds.get_endpoint(i));
+			Plane projected = p_cam_projection.xform4(Plane(view, 1.0));
+
+			float w = projected.d;
+			if (w < 1e-5f) {
+				// Crosses the camera plane, assume it covers the whole screen.
+				rect_min = Vector2(0, 0);
+				rect_max = Vector2(1, 1);
+				break;
+			}
+
+			Vector2 normalized = Vector2(projected.normal.x / w * 0.5f + 0.5f, projected.normal.y / w * 0.5f + 0.5f);
+			rect_min = rect_min.min(normalized);
+			rect_max = rect_max.max(normalized);
+		}
+
+		// One extra pixel around the bounds covers the projection jitter.
+		int x_from = MAX(0, int(Math::floor(rect_min.x * buffer_size.x)) - 1) / TILE_SIZE;
+		int y_from = MAX(0, int(Math::floor(rect_min.y * buffer_size.y)) - 1) / TILE_SIZE;
+		int x_to = MIN(buffer_size.x - 1, int(Math::floor(rect_max.x * buffer_size.x)) + 1) / TILE_SIZE;
+		int y_to = MIN(buffer_size.y - 1, int(Math::floor(rect_max.y * buffer_size.y)) + 1) / TILE_SIZE;
+
+		for (int y = y_from; y <= y_to; y++) {
+			for (int x = x_from; x <= x_to; x++) {
+				tile_needs_rays[y * tile_grid_size.x + x] = 1;
+			}
+		}
+	}
+}
+
+void RaycastOcclusionCull::RaycastHZBuffer::_reproject(const CameraRayThreadData &p_camera) {
+	const Size2i &buffer_size = sizes[0];
+	const CameraRayThreadData &prev = history_camera;
+	const float *prev_depth = mips[0];
+	float *depth = reprojected_depth.ptr();
+
+	const float hole = -1.0f;
+	for (uint32_t i = 0; i < reprojected_depth.size(); i++) {
+		depth[i] = hole;
+	}
+
+	const Vector3 u_axis = p_camera.pixel_u_interp / p_camera.pixel_u_interp.length_squared();
+	const Vector3 v_axis = p_camera.pixel_v_interp / p_camera.pixel_v_interp.length_squared();
+
+	// Forward-splat every pixel of the previous frame into the new one, keeping the closest depth.
+	for (int y = 0; y < buffer_size.y; y++) {
+		for (int x = 0; x < buffer_size.x; x++) {
+			float prev_t = prev_depth[y * buffer_size.x + x];
+			bool miss = prev_t >= prev.z_far;
+
+			float u = (float(x) + 0.5f) / buffer_size.x;
+			float v = (float(y) + 0.5f) / buffer_size.y;
+			Vector3 pixel_pos = prev.pixel_corner + u * prev.pixel_u_interp + v * prev.pixel_v_interp;
+
+			Vector3 dir;
+			Vector3 origin;
+			if (prev.camera_orthogonal) {
+				dir = prev.camera_dir;
+				origin = pixel_pos - dir * prev.z_near;
+			} else {
+				dir = (pixel_pos - prev.camera_pos).normalized();
+				origin = prev.camera_pos;
+			}
+
+			Vector3 point;
+			if (!miss) {
+				point = origin + dir * prev_t;
+			} else if (!prev.camera_orthogonal && !p_camera.camera_orthogonal) {
+				point = p_camera.camera_pos + dir; // Misses are at infinity, only the direction matters.
+			} else {
+				point = origin + dir * prev.z_far;
+			}
+
+			float forward = p_camera.camera_dir.dot(point - p_camera.camera_pos);
+			if (forward <= p_camera.z_near) {
+				continue;
+			}
+
+			Vector3 near_pos;
+			float t;
+			if (p_camera.camera_orthogonal) {
+				near_pos = point - p_camera.camera_dir * (forward - p_camera.z_near);
+				t = forward;
+			} else {
+				near_pos = p_camera.camera_pos + (point - p_camera.camera_pos) * (p_camera.z_near / forward);
+				t = (point - p_camera.camera_pos).length();
+			}
+
+			Vector3 rel = near_pos - p_camera.pixel_corner;
+			int new_x = int(Math::floor(rel.dot(u_axis) * buffer_size.x));
+			int new_y = int(Math::floor(rel.dot(v_axis) * buffer_size.y));
+			if (new_x < 0 || new_y < 0 || new_x >= buffer_size.x || new_y >= buffer_size.y) {
+				continue;
+			}
+
+			if (miss || t > p_camera.z_far) {
+				t = p_camera.z_far;
+			}
+
+			float &dst = depth[new_y * buffer_size.x + new_x];
+			if (dst == hole || t < dst) {
+				dst = t;
+			}
+		}
+	}
+
+	// Tiles with any pixel nobody reprojected into were disoccluded and need fresh rays.
+	for (int i = 0; i < tile_grid_size.y; i++) {
+		for (int j = 0; j < tile_grid_size.x; j++) {
+			uint8_t &needs_rays = tile_needs_rays[i * tile_grid_size.x + j];
+			for (int y = i * TILE_SIZE; !needs_rays && y < MIN((i + 1) * TILE_SIZE, buffer_size.y); y++) {
+				for (int x = j * TILE_SIZE; x < MIN((j + 1) * TILE_SIZE, buffer_size.x); x++) {
+					if (depth[y * buffer_size.x + x] == hole) {
+						needs_rays = 1;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	memcpy(mips[0], depth, reprojected_depth.size() * sizeof(float));
 }
 
-void RaycastOcclusionCull::RaycastHZBuffer::update_camera_rays(const Transform3D &p_cam_transform, const Vector3 &p_near_bottom_left, const Vector2 &p_near_extents, real_t p_z_far, bool p_cam_orthogonal) {
+void RaycastOcclusionCull::RaycastHZBuffer::update_camera_rays(const Transform3D &p_cam_transform, const Vector3 &p_near_bottom_left, const Vector2 &p_near_extents, real_t p_z_far, bool p_cam_orthogonal, bool p_temporal) {
 	CameraRayThreadData td;
 	td.thread_count = WorkerThreadPool::get_singleton()->get_thread_count();
 
@@ -100,12 +285,40 @@ void RaycastOcclusionCull::RaycastHZBuffer::update_camera_rays(const Transform3D
 
 	debug_tex_range = td.z_far;
 
+	camera_ray_tiles.clear();
+	if (p_temporal && has_history) {
+		_reproject(td);
+
+		temporal_frame++;
+		for (uint32_t i = 0; i < camera_rays_tile_count; i++) {
+			// Staggered refresh, so errors from reprojection never stick for long.
+			if (tile_needs_rays[i] || (i + temporal_frame) % TEMPORAL_REFRESH_FRAMES == 0) {
+				camera_ray_tiles.push_back(i);
+			}
+		}
+	} else {
+		for (uint32_t i = 0; i < camera_rays_tile_count; i++) {
+			camera_ray_tiles.push_back(i);
+		}
+	}
+	memset(tile_needs_rays.ptr(), 0, camera_rays_tile_count);
+
+	history_camera = td;
+	has_history = p_temporal;
+
+	if (camera_ray_tiles.is_empty()) {
+		return;
+	}
+
+	td.tiles = camera_ray_tiles.ptr();
+	td.thread_count = MIN(td.thread_count, int(camera_ray_tiles.size()));
+
 	WorkerThreadPool::GroupID group_task = WorkerThreadPool::get_singleton()->add_template_group_task(this, &RaycastHZBuffer::_camera_rays_threaded, &td, td.thread_count, -1, true, SNAME("RaycastOcclusionCullUpdateCamera"));
 	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_task);
 }
 
 void RaycastOcclusionCull::RaycastHZBuffer::_camera_rays_threaded(uint32_t p_thread, const CameraRayThreadData *p_data) {
-	uint32_t total_tiles = camera_rays_tile_count;
+	uint32_t total_tiles = camera_ray_tiles.size();
 	uint32_t total_threads = p_data->thread_count;
 	uint32_t from = p_thread * total_tiles / total_threads;
 	uint32_t to = (p_thread + 1 == total_threads) ? total_tiles : ((p_thread + 1) * total_tiles / total_threads);
@@ -115,8 +328,9 @@ void RaycastOcclusionCull::RaycastHZBuffer::_camera_rays_threaded(uint32_t p_thr
 void RaycastOcclusionCull::RaycastHZBuffer::_generate_camera_rays(const CameraRayThreadData *p_data, int p_from, int p_to) {
 	const Size2i &buffer_size = sizes[0];
 
-	for (int i = p_from; i < p_to; i++) {
-		CameraRayTile &tile = camera_rays[i];
+	for (int k = p_from; k < p_to; k++) {
+		CameraRayTile &tile = camera_rays[k];
+		uint32_t i = p_data->tiles[k];
 		int tile_x = (i % tile_grid_size.x) * TILE_SIZE;
 		int tile_y = (i / tile_grid_size.x) * TILE_SIZE;
 
@@ -162,19 +376,19 @@ void RaycastOcclusionCull::RaycastHZBuffer::sort_rays(const Vector3 &p_camera_di
 	ERR_FAIL_COND(is_empty());
 
 	Size2i buffer_size = sizes[0];
-	for (int i = 0; i < tile_grid_size.y; i++) {
-		for (int j = 0; j < tile_grid_size.x; j++) {
-			for (int tile_i = 0; tile_i < TILE_SIZE; tile_i++) {
-				for (int tile_j = 0; tile_j < TILE_SIZE; tile_j++) {
-					int x = j * TILE_SIZE + tile_j;
-					int y = i * TILE_SIZE + tile_i;
-					if (x >= buffer_size.x || y >= buffer_size.y) {
-						continue;
-					}
-					int k = tile_i * TILE_SIZE + tile_j;
-					int tile_index = i * tile_grid_size.x + j;
-					mips[0][y * buffer_size.x + x] = camera_rays[tile_index].ray.tfar[k];
+	for (uint32_t k = 0; k < camera_ray_tiles.size(); k++) {
+		uint32_t tile_index = camera_ray_tiles[k];
+		int i = tile_index / tile_grid_size.x;
+		int j = tile_index % tile_grid_size.x;
+		for (int tile_i = 0; tile_i < TILE_SIZE; tile_i++) {
+			for (int tile_j = 0; tile_j < TILE_SIZE; tile_j++) {
+				int x = j * TILE_SIZE + tile_j;
+				int y = i * TILE_SIZE + tile_i;
+				if (x >= buffer_size.x || y >= buffer_size.y) {
+					continue;
 				}
+				int l = tile_i * TILE_SIZE + tile_j;
+				mips[0][y * buffer_size.x + x] = camera_rays[k].ray.tfar[l];
 			}
 		}
 	}
@@ -208,6 +422,15 @@ void RaycastOcclusionCull::occluder_set_mesh(RID p_occluder, const PackedVector3
 	occluder->vertices = p_vertices;
 	occluder->indices = p_indices;
 
+	occluder->aabb = AABB();
+	for (int i = 0; i < p_vertices.size(); i++) {
+		if (i == 0) {
+			occluder->aabb.position = p_vertices[i];
+		} else {
+			occluder->aabb.expand_to(p_vertices[i]);
+		}
+	}
+
 	for (const InstanceID &E : occluder->users) {
 		RID scenario_rid = E.scenario;
 		RID instance_rid = E.instance;
@@ -215,16 +438,21 @@ void RaycastOcclusionCull::occluder_set_mesh(RID p_occluder, const PackedVector3
 		Scenario &scenario = scenarios[scenario_rid];
 		ERR_CONTINUE(!scenario.instances.has(instance_rid));
 
-		if (!scenario.dirty_instances.has(instance_rid)) {
-			scenario.dirty_instances.insert(instance_rid);
-			scenario.dirty_instances_array.push_back(instance_rid);
-		}
+		scenario.mark_dirty(instance_rid);
 	}
 }
 
 void RaycastOcclusionCull::free_occluder(RID p_occluder) {
 	Occluder *occluder = occluder_owner.get_or_null(p_occluder);
 	ERR_FAIL_NULL(occluder);
+
+	for (const InstanceID &E : occluder->users) {
+		Scenario *scenario = scenarios.getptr(E.scenario);
+		if (scenario && scenario->instances.has(E.instance)) {
+			scenario->mark_dirty(E.instance);
+		}
+	}
+
 	memdelete(occluder);
 	occluder_owner.free(p_occluder);
 }
@@ -287,10 +515,8 @@ void RaycastOcclusionCull::scenario_set_instance(RID p_scenario, RID p_instance,
 		scenario.dirty = true; // The scenario needs a scene re-build, but the instance doesn't need update
 	}
 
-	if (changed && !scenario.dirty_instances.has(p_instance)) {
-		scenario.dirty_instances.insert(p_instance);
-		scenario.dirty_instances_array.push_back(p_instance);
-		scenario.dirty = true;
+	if (changed) {
+		scenario.mark_dirty(p_instance);
 	}
 }
 
@@ -313,6 +539,26 @@ void RaycastOcclusionCull::scenario_remove_instance(RID p_scenario, RID p_instan
 	}
 }
 
+void RaycastOcclusionCull::Scenario::mark_dirty(RID p_instance) {
+	if (!dirty_instances.has(p_instance)) {
+		dirty_instances.insert(p_instance);
+		dirty_instances_array.push_back(p_instance);
+	}
+	dirty = true;
+}
+
+void RaycastOcclusionCull::Scenario::_push_change(const AABB &p_aabb) {
+	if (commit_changes_overflow) {
+		return;
+	}
+	if (commit_changes.size() >= MAX_TRACKED_CHANGES) {
+		commit_changes.clear();
+		commit_changes_overflow = true;
+		return;
+	}
+	commit_changes.push_back(p_aabb);
+}
+
 void RaycastOcclusionCull::Scenario::_update_dirty_instance_thread(int p_idx, RID *p_instances) {
 	_update_dirty_instance(p_idx, p_instances);
 }
@@ -410,6 +656,12 @@ void RaycastOcclusionCull::Scenario::update() {
 		if (commit_done) {
 			commit_thread->wait_to_finish();
 			current_scene_idx = 1 - current_scene_idx;
+
+			// Every scene is built from scratch, so the new one differs from the previous one by
+			// exactly the changes found while building it.
+			changes = commit_changes;
+			changes_overflow = commit_changes_overflow;
+			version++;
 		} else {
 			return;
 		}
@@ -419,7 +671,14 @@ void RaycastOcclusionCull::Scenario::update() {
 		return;
 	}
 
+	commit_changes.clear();
+	commit_changes_overflow = false;
+
 	for (const RID &scenario : removed_instances) {
+		const OccluderInstance *occ_inst = instances.getptr(scenario);
+		if (occ_inst && occ_inst->committed) {
+			_push_change(occ_inst->committed_aabb);
+		}
 		instances.erase(scenario);
 	}
 
@@ -435,8 +694,6 @@ void RaycastOcclusionCull::Scenario::update() {
 		}
 	}
 
-	dirty_instances.clear();
-	dirty_instances_array.clear();
 	removed_instances.clear();
 
 	if (raycast_singleton->ebr_device == nullptr) {
@@ -453,11 +710,24 @@ void RaycastOcclusionCull::Scenario::update() {
 	next_scene = rtcNewScene(raycast_singleton->ebr_device);
 	rtcSetSceneBuildQuality(next_scene, RTCBuildQuality(raycast_singleton->build_quality));
 
-	for (const KeyValue<RID, OccluderInstance> &E : instances) {
-		const OccluderInstance *occ_inst = &E.value;
+	for (KeyValue<RID, OccluderInstance> &E : instances) {
+		OccluderInstance *occ_inst = &E.value;
 		const Occluder *occ = raycast_singleton->occluder_owner.get_or_null(occ_inst->occluder);
 
-		if (!occ || !occ_inst->enabled) {
+		const bool visible = occ && occ_inst->enabled;
+		const AABB aabb = visible ? occ_inst->xform.xform(occ->aabb) : AABB();
+		if (visible != occ_inst->committed || (visible && (aabb != occ_inst->committed_aabb || dirty_instances.has(E.key)))) {
+			if (occ_inst->committed) {
+				_push_change(occ_inst->committed_aabb);
+			}
+			if (visible) {
+				_push_change(aabb);
+			}
+		}
+		occ_inst->committed = visible;
+		occ_inst->committed_aabb = aabb;
+
+		if (!visible) {
 			continue;
 		}
 
@@ -469,6 +739,9 @@ void RaycastOcclusionCull::Scenario::update() {
 		rtcReleaseGeometry(geom);
 	}
 
+	dirty_instances.clear();
+	dirty_instances_array.clear();
+
 	dirty = false;
 	commit_done = false;
 	commit_thread->start(&Scenario::_commit_scene, this);
@@ -490,7 +763,7 @@ void RaycastOcclusionCull::Scenario::raycast(CameraRayTile *r_rays, const uint32
 		return; // Embree is initialized on demand when there is some scenario with occluders in it.
 	}
 
-	if (ebr_scene[current_scene_idx] == nullptr) {
+	if (ebr_scene[current_scene_idx] == nullptr || p_tile_count == 0) {
 		return;
 	}
 
@@ -518,11 +791,12 @@ void RaycastOcclusionCull::buffer_set_scenario(RID p_buffer, RID p_scenario) {
 	ERR_FAIL_COND(!buffers.has(p_buffer));
 	ERR_FAIL_COND(p_scenario.is_valid() && !scenarios.has(p_scenario));
 	buffers[p_buffer].scenario_rid = p_scenario;
+	buffers[p_buffer].invalidate_history();
 }
 
 void RaycastOcclusionCull::buffer_set_size(RID p_buffer, const Vector2i &p_size) {
 	ERR_FAIL_COND(!buffers.has(p_buffer));
-	buffers[p_buffer].resize(p_size);
+	buffers[p_buffer].set_requested_size(p_size);
 }
 
 Vector2 RaycastOcclusionCull::_jitter_half_extents(const Vector2 &p_half_extents, const Size2i &p_viewport_size) {
@@ -592,18 +866,34 @@ void RaycastOcclusionCull::buffer_update(RID p_buffer, const Transform3D &p_cam_
 		return;
 	}
 
+	const uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+
 	Scenario &scenario = scenarios[buffer.scenario_rid];
 	scenario.update();
 
+	if (buffer.scenario_version != scenario.version) {
+		// Occluders changed since the last frame, the history is only reusable outside of them.
+		if (buffer.scenario_version + 1 == scenario.version && !scenario.changes_overflow) {
+			buffer.mark_changed_bounds(scenario.changes, p_cam_transform, p_cam_projection);
+		} else {
+			buffer.invalidate_history();
+		}
+		buffer.scenario_version = scenario.version;
+	}
+
 	Vector2 viewport_half = p_cam_projection.get_viewport_half_extents();
 	Vector2 jitter_viewport_half = _jitter_half_extents(viewport_half, buffer.get_occlusion_buffer_size());
 	Vector3 near_bottom_left = Vector3(-jitter_viewport_half.x, -jitter_viewport_half.y, -p_cam_projection.get_z_near());
 
-	buffer.update_camera_rays(p_cam_transform, near_bottom_left, 2 * viewport_half, p_cam_projection.get_z_far(), p_cam_orthogonal);
+	buffer.update_camera_rays(p_cam_transform, near_bottom_left, 2 * viewport_half, p_cam_projection.get_z_far(), p_cam_orthogonal, _temporal_enabled);
 
-	scenario.raycast(buffer.camera_rays, buffer.camera_ray_masks.ptr(), buffer.camera_rays_tile_count);
+	scenario.raycast(buffer.camera_rays, buffer.camera_ray_masks.ptr(), buffer.camera_ray_tiles.size());
 	buffer.sort_rays(-p_cam_transform.basis.get_column(2), p_cam_orthogonal);
 	buffer.update_mips();
+
+	if (_cpu_budget_msec > 0.0f) {
+		buffer.adapt_resolution(OS::get_singleton()->get_ticks_usec() - begin_usec, _cpu_budget_msec * 1000.0f);
+	}
 }
 
 RaycastOcclusionCull::HZBuffer *RaycastOcclusionCull::buffer_get_ptr(RID p_buffer) {
@@ -646,6 +936,8 @@ RaycastOcclusionCull::RaycastOcclusionCull() {
 	raycast_singleton = this;
 	int default_quality = GLOBAL_GET("rendering/occlusion_culling/bvh_build_quality");
 	_jitter_enabled = GLOBAL_GET("rendering/occlusion_culling/jitter_projection");
+	_temporal_enabled = GLOBAL_GET("rendering/occlusion_culling/temporal_reprojection");
+	_cpu_budget_msec = GLOBAL_GET("rendering/occlusion_culling/cpu_budget_msec");
 	build_quality = RS::ViewportOcclusionCullingBuildQuality(default_quality);
 }
 
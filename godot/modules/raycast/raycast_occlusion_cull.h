@@ -43,12 +43,14 @@
 #include <embree4/rtcore.h>
 
 class RaycastOcclusionCull : public RendererSceneOcclusionCull {
+	friend class TestRaycastOcclusionCullAccessor;
 	typedef RTCRayHit16 CameraRayTile;
 
 public:
 	class RaycastHZBuffer : public HZBuffer {
 	private:
 		Size2i tile_grid_size;
+		Size2i requested_size; // Size set by the viewport, before resolution scaling.
 
 		struct CameraRayThreadData {
 			int thread_count;
@@ -61,22 +63,43 @@ public:
 			Vector3 pixel_v_interp;
 			bool camera_orthogonal;
 			Size2i buffer_size;
+			const uint32_t *tiles = nullptr;
 		};
 
+		// Temporal reprojection: the camera the depth in mips[0] was traced with,
+		// so it can be reprojected into the next frame instead of traced again.
+		CameraRayThreadData history_camera;
+		bool has_history = false;
+		uint32_t temporal_frame = 0;
+		LocalVector<float> reprojected_depth;
+		LocalVector<uint8_t> tile_needs_rays;
+
+		// Adaptive resolution.
+		float resolution_scale = 1.0f;
+		float smoothed_cost_usec = 0.0f;
+		uint32_t frames_since_resize = 0;
+
 		void _camera_rays_threaded(uint32_t p_thread, const CameraRayThreadData *p_data);
 		void _generate_camera_rays(const CameraRayThreadData *p_data, int p_from, int p_to);
+		void _reproject(const CameraRayThreadData &p_camera);
 
 	public:
 		unsigned int camera_rays_tile_count = 0;
 		uint8_t *camera_rays_unaligned_buffer = nullptr;
 		CameraRayTile *camera_rays = nullptr;
 		LocalVector<uint32_t> camera_ray_masks;
+		LocalVector<uint32_t> camera_ray_tiles; // Tiles traced this frame, camera_rays[i] belongs to tile camera_ray_tiles[i].
 		RID scenario_rid;
+		uint64_t scenario_version = 0;
 
 		virtual void clear() override;
 		virtual void resize(const Size2i &p_size) override;
+		void set_requested_size(const Size2i &p_size);
+		void invalidate_history() { has_history = false; }
+		void mark_changed_bounds(const LocalVector<AABB> &p_bounds, const Transform3D &p_cam_transform, const Projection &p_cam_projection);
+		void adapt_resolution(uint64_t p_cost_usec, float p_budget_usec);
 		void sort_rays(const Vector3 &p_camera_dir, bool p_orthogonal);
-		void update_camera_rays(const Transform3D &p_cam_transform, const Vector3 &p_near_bottom_left, const Vector2 &p_near_extents, real_t p_z_far, bool p_cam_orthogonal);
+		void update_camera_rays(const Transform3D &p_cam_transform, const Vector3 &p_near_bottom_left, const Vector2 &p_near_extents, real_t p_z_far, bool p_cam_orthogonal, bool p_temporal);
 
 		~RaycastHZBuffer();
 	};
@@ -104,6 +127,7 @@ private:
 		PackedVector3Array vertices;
 		PackedInt32Array indices;
 		HashSet<InstanceID, InstanceID> users;
+		AABB aabb;
 	};
 
 	struct OccluderInstance {
@@ -113,6 +137,8 @@ private:
 		Transform3D xform;
 		bool enabled = true;
 		bool removed = false;
+		bool committed = false; // Part of the last scene built, with committed_aabb as its world bounds.
+		AABB committed_aabb;
 	};
 
 	struct Scenario {
@@ -141,6 +167,17 @@ private:
 		LocalVector<RID> dirty_instances_array; // To iterate and split into threads
 		LocalVector<RID> removed_instances;
 
+		// World bounds of the occluders that differ between the scene being committed and the
+		// current one, so temporal buffers only re-trace the tiles covering them after a swap.
+		LocalVector<AABB> commit_changes;
+		bool commit_changes_overflow = false;
+		LocalVector<AABB> changes; // Differences between the current scene and the previous one.
+		bool changes_overflow = false;
+		uint64_t version = 0; // Incremented every time the current scene is swapped.
+
+		void _push_change(const AABB &p_aabb);
+
+		void mark_dirty(RID p_instance);
 		void _update_dirty_instance_thread(int p_idx, RID *p_instances);
 		void _update_dirty_instance(int p_idx, RID *p_instances);
 		void _transform_vertices_thread(uint32_t p_thread, TransformThreadData *p_data);
@@ -157,6 +194,10 @@ private:
 
 	static const int TILE_SIZE = 4;
 	static const int TILE_RAYS = TILE_SIZE * TILE_SIZE;
+	static const uint32_t MAX_TRACKED_CHANGES = 256; // Beyond this, a scene swap re-traces whole buffers.
+	static const uint32_t TEMPORAL_REFRESH_FRAMES = 16; // Every tile is traced again at least this often.
+	static const uint32_t RESOLUTION_ADAPT_FRAMES = 30; // Minimum frames between resolution changes.
+	static constexpr float MIN_RESOLUTION_SCALE = 0.25f;
 
 	RTCDevice ebr_device = nullptr;
 	RID_PtrOwner<Occluder> occluder_owner;
@@ -164,6 +205,8 @@ private:
 	HashMap<RID, RaycastHZBuffer> buffers;
 	RS::ViewportOcclusionCullingBuildQuality build_quality;
 	bool _jitter_enabled = false;
+	bool _temporal_enabled = false;
+	float _cpu_budget_msec = 0.0f;
 
 	void _init_embree();
 	Vector2 _jitter_half_extents(const Vector2 &p_half_extents, const Size2i &p_viewport_size);
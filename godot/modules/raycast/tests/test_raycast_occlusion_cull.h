@@ -0,0 +1,287 @@
+/**************************************************************************/
+/*  test_raycast_occlusion_cull.h                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+#ifndef TEST_RAYCAST_OCCLUSION_CULL_H
+#define TEST_RAYCAST_OCCLUSION_CULL_H
+
+#include "tests/test_macros.h"
+
+#include "../raycast_occlusion_cull.h"
+
+#include "core/os/os.h"
+
+class TestRaycastOcclusionCullAccessor {
+public:
+	static uint32_t get_temporal_refresh_frames() { return RaycastOcclusionCull::TEMPORAL_REFRESH_FRAMES; }
+	static uint32_t get_resolution_adapt_frames() { return RaycastOcclusionCull::RESOLUTION_ADAPT_FRAMES; }
+	static float get_min_resolution_scale() { return RaycastOcclusionCull::MIN_RESOLUTION_SCALE; }
+	static int get_tile_size() { return RaycastOcclusionCull::TILE_SIZE; }
+};
+
+namespace TestRaycastOcclusionCull {
+
+static const Vector2i BUFFER_SIZE = Vector2i(64, 64);
+
+static RID create_quad_occluder(RendererSceneOcclusionCull *p_cull, real_t p_half_size) {
+	PackedVector3Array vertices;
+	vertices.push_back(Vector3(-p_half_size, -p_half_size, 0));
+	vertices.push_back(Vector3(p_half_size, -p_half_size, 0));
+	vertices.push_back(Vector3(p_half_size, p_half_size, 0));
+	vertices.push_back(Vector3(-p_half_size, p_half_size, 0));
+
+	PackedInt32Array indices;
+	indices.push_back(0);
+	indices.push_back(1);
+	indices.push_back(2);
+	indices.push_back(0);
+	indices.push_back(2);
+	indices.push_back(3);
+
+	RID occluder = p_cull->occluder_allocate();
+	p_cull->occluder_initialize(occluder);
+	p_cull->occluder_set_mesh(occluder, vertices, indices);
+	return occluder;
+}
+
+struct TestView {
+	RendererSceneOcclusionCull *cull = nullptr;
+	RID scenario = RID::from_uint64(0x7a5e000000000001);
+	RID buffer = RID::from_uint64(0x7a5e000000000002);
+	Transform3D cam_transform;
+	Projection cam_projection;
+	// A small box straight ahead of the camera, 20 units away.
+	const real_t probe_bounds[6] = { -0.5, -0.5, -20.5, 0.5, 0.5, -19.5 };
+
+	bool is_probe_occluded() {
+		uint64_t timeout = 0;
+		return cull->buffer_get_ptr(buffer)->is_occluded(probe_bounds, cam_transform.origin, cam_transform.affine_inverse(), cam_projection, cam_projection.get_z_near(), timeout);
+	}
+
+	// Runs occlusion frames until the probe reaches the expected state, returns the elapsed time
+	// in microseconds or -1 if it never did. Includes the asynchronous commit of the scene.
+	int64_t wait_for_probe(bool p_occluded) {
+		const uint64_t from = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < 10000; i++) {
+			cull->buffer_update(buffer, cam_transform, cam_projection, false);
+			if (is_probe_occluded() == p_occluded) {
+				return OS::get_singleton()->get_ticks_usec() - from;
+			}
+			OS::get_singleton()->delay_usec(50);
+		}
+		return -1;
+	}
+
+	TestView() {
+		cull = RendererSceneOcclusionCull::get_singleton();
+		cam_projection.set_perspective(60, 1, 0.1, 100);
+		cull->add_scenario(scenario);
+		cull->add_buffer(buffer);
+		cull->buffer_set_scenario(buffer, scenario);
+		cull->buffer_set_size(buffer, BUFFER_SIZE);
+	}
+
+	~TestView() {
+		cull->remove_buffer(buffer);
+		cull->remove_scenario(scenario);
+	}
+};
+
+TEST_CASE("[Modules][Raycast] Moving an occluder updates the occlusion buffer") {
+	TestView view;
+	REQUIRE(view.cull != nullptr);
+
+	RID occluder = create_quad_occluder(view.cull, 5);
+	RID instance = RID::from_uint64(0x7a5e000000001000);
+
+	view.cull->scenario_set_instance(view.scenario, instance, occluder, Transform3D(Basis(), Vector3(0, 0, -5)), true);
+	CHECK_MESSAGE(view.wait_for_probe(true) >= 0, "An occluder in front of the camera should hide the probe.");
+
+	view.cull->scenario_set_instance(view.scenario, instance, occluder, Transform3D(Basis(), Vector3(100, 0, -5)), true);
+	CHECK_MESSAGE(view.wait_for_probe(false) >= 0, "Moving the occluder away should reveal the probe.");
+
+	view.cull->scenario_set_instance(view.scenario, instance, occluder, Transform3D(Basis(), Vector3(0, 0, -5)), false);
+	CHECK_MESSAGE(view.wait_for_probe(false) >= 0, "A disabled occluder should not hide the probe.");
+
+	view.cull->scenario_set_instance(view.scenario, instance, occluder, Transform3D(Basis(), Vector3(0, 0, -5)), true);
+	CHECK_MESSAGE(view.wait_for_probe(true) >= 0, "Re-enabling the occluder should hide the probe again.");
+
+	view.cull->scenario_remove_instance(view.scenario, instance);
+	CHECK_MESSAGE(view.wait_for_probe(false) >= 0, "A removed occluder should not hide the probe.");
+
+	view.cull->free_occluder(occluder);
+}
+
+// Generates the rays of a frame the way buffer_update does, without tracing them.
+// Every ray then misses, as in an empty scenario.
+static void update_rays(RaycastOcclusionCull::RaycastHZBuffer &p_buffer, const Transform3D &p_cam_transform, const Projection &p_cam_projection) {
+	const Vector2 half_extents = p_cam_projection.get_viewport_half_extents();
+	const Vector3 near_bottom_left = Vector3(-half_extents.x, -half_extents.y, -p_cam_projection.get_z_near());
+	p_buffer.update_camera_rays(p_cam_transform, near_bottom_left, 2 * half_extents, p_cam_projection.get_z_far(), false, true);
+	p_buffer.sort_rays(-p_cam_transform.basis.get_column(2), false);
+}
+
+TEST_CASE("[Modules][Raycast] Temporal reprojection retraces changed and stale tiles") {
+	RaycastOcclusionCull::RaycastHZBuffer buffer;
+	buffer.set_requested_size(BUFFER_SIZE);
+	Transform3D cam_transform;
+	Projection cam_projection;
+	cam_projection.set_perspective(60, 1, 0.1, 100);
+
+	const int tile_size = TestRaycastOcclusionCullAccessor::get_tile_size();
+	const int tiles_per_row = BUFFER_SIZE.x / tile_size;
+	const uint32_t tile_count = buffer.camera_rays_tile_count;
+
+	// Without history, every tile is traced.
+	update_rays(buffer, cam_transform, cam_projection);
+	CHECK_EQ(buffer.camera_ray_tiles.size(), tile_count);
+
+	SUBCASE("Tiles covered by changed bounds are retraced") {
+		LocalVector<AABB> changes;
+		changes.push_back(AABB(Vector3(-1, -1, -11), Vector3(2, 2, 2)));
+		buffer.mark_changed_bounds(changes, cam_transform, cam_projection);
+		update_rays(buffer, cam_transform, cam_projection);
+
+		CHECK(buffer.camera_ray_tiles.size() < tile_count);
+		// The bounds are in the middle of the screen.
+		const uint32_t center = (BUFFER_SIZE.y / 2 / tile_size) * tiles_per_row + BUFFER_SIZE.x / 2 / tile_size;
+		for (int y = -1; y <= 0; y++) {
+			for (int x = -1; x <= 0; x++) {
+				CHECK_MESSAGE(buffer.camera_ray_tiles.has(center + y * tiles_per_row + x), "Tiles under changed bounds should be traced again.");
+			}
+		}
+		CHECK_FALSE_MESSAGE(buffer.camera_ray_tiles.has(0), "A corner tile away from the bounds should be reprojected.");
+	}
+
+	SUBCASE("Every tile is refreshed within the refresh period") {
+		LocalVector<uint8_t> traced;
+		traced.resize(tile_count);
+		memset(traced.ptr(), 0, tile_count);
+		const uint32_t refresh_frames = TestRaycastOcclusionCullAccessor::get_temporal_refresh_frames();
+		for (uint32_t frame = 0; frame < refresh_frames; frame++) {
+			update_rays(buffer, cam_transform, cam_projection);
+			CHECK_MESSAGE(buffer.camera_ray_tiles.size() < tile_count, "A static camera should reuse most of the previous frame.");
+			for (uint32_t tile : buffer.camera_ray_tiles) {
+				traced[tile] = 1;
+			}
+		}
+		uint32_t traced_count = 0;
+		for (uint32_t i = 0; i < tile_count; i++) {
+			traced_count += traced[i];
+		}
+		CHECK_EQ(traced_count, tile_count);
+	}
+}
+
+TEST_CASE("[Modules][Raycast] Adaptive resolution stays within its bounds") {
+	RaycastOcclusionCull::RaycastHZBuffer buffer;
+	buffer.set_requested_size(BUFFER_SIZE);
+	const uint32_t adapt_frames = TestRaycastOcclusionCullAccessor::get_resolution_adapt_frames();
+	const int min_width = int(Math::round(BUFFER_SIZE.x * TestRaycastOcclusionCullAccessor::get_min_resolution_scale()));
+	const float budget_usec = 1000.0f;
+
+	// Far over budget: the resolution drops, down to the minimum scale and never below it.
+	for (uint32_t frame = 0; frame < adapt_frames; frame++) {
+		buffer.adapt_resolution(100000, budget_usec);
+	}
+	CHECK(buffer.get_occlusion_buffer_size().x < BUFFER_SIZE.x);
+	for (uint32_t frame = 0; frame < adapt_frames * 10; frame++) {
+		buffer.adapt_resolution(100000, budget_usec);
+		CHECK(buffer.get_occlusion_buffer_size().x >= min_width);
+	}
+	CHECK_EQ(buffer.get_occlusion_buffer_size(), Size2i(min_width, min_width));
+
+	// Well within budget: it grows back to the requested size, and no further.
+	for (uint32_t frame = 0; frame < adapt_frames * 40; frame++) {
+		buffer.adapt_resolution(1, budget_usec);
+		CHECK(buffer.get_occlusion_buffer_size().x <= BUFFER_SIZE.x);
+	}
+	CHECK_EQ(buffer.get_occlusion_buffer_size(), Size2i(BUFFER_SIZE));
+}
+
+// Opt-in benchmark, skipped by default. Run it with `--test --no-skip --test-case="*Benchmark*"`.
+TEST_CASE("[Modules][Raycast][Benchmark] Commit latency with thousands of dynamic occluders" * doctest::skip()) {
+	TestView view;
+	REQUIRE(view.cull != nullptr);
+
+	const int grid_size = 64; // 4096 moving occluders.
+	const int frames = 16;
+
+	RID small_occluder = create_quad_occluder(view.cull, 0.25);
+	RID blocker_occluder = create_quad_occluder(view.cull, 5);
+	RID blocker = RID::from_uint64(0x7a5e000000001000);
+
+	LocalVector<RID> instances;
+	for (int i = 0; i < grid_size * grid_size; i++) {
+		instances.push_back(RID::from_uint64(0x7a5e000000002000 + i));
+	}
+
+	uint64_t submit_usec = 0;
+	uint64_t latency_usec = 0;
+	int visible_frames = 0;
+
+	for (int frame = 0; frame < frames; frame++) {
+		// The blocker alternates between hiding and revealing the probe, so the frame at which the
+		// probe changes state tells when the whole batch of moves became visible to raycasts.
+		const bool blocking = (frame % 2) == 0;
+		view.cull->scenario_set_instance(view.scenario, blocker, blocker_occluder, Transform3D(Basis(), Vector3(blocking ? 0 : 100, 0, -5)), true);
+
+		const real_t offset = Math::sin(frame * 0.5);
+		for (int i = 0; i < grid_size * grid_size; i++) {
+			// Behind the probe, so they never change its state.
+			Vector3 position((i % grid_size) - grid_size / 2 + offset, (i / grid_size) - grid_size / 2, -60 + offset);
+			view.cull->scenario_set_instance(view.scenario, instances[i], small_occluder, Transform3D(Basis(Vector3(0, 1, 0), frame * 0.1), position), true);
+		}
+
+		const uint64_t from = OS::get_singleton()->get_ticks_usec();
+		view.cull->buffer_update(view.buffer, view.cam_transform, view.cam_projection, false);
+		submit_usec += OS::get_singleton()->get_ticks_usec() - from;
+
+		if (view.wait_for_probe(blocking) >= 0) {
+			latency_usec += OS::get_singleton()->get_ticks_usec() - from;
+			visible_frames++;
+		}
+	}
+
+	CHECK_MESSAGE(visible_frames == frames, "Every batch of moved occluders should eventually become visible.");
+	MESSAGE(vformat("%d dynamic occluders: %.3f ms average submit, %.3f ms average commit latency.",
+			grid_size * grid_size, submit_usec / (frames * 1000.0), latency_usec / (MAX(visible_frames, 1) * 1000.0))
+					.utf8()
+					.get_data());
+
+	for (const RID &instance : instances) {
+		view.cull->scenario_remove_instance(view.scenario, instance);
+	}
+	view.cull->scenario_remove_instance(view.scenario, blocker);
+	view.cull->free_occluder(small_occluder);
+	view.cull->free_occluder(blocker_occluder);
+}
+
+} // namespace TestRaycastOcclusionCull
+
+#endif // TEST_RAYCAST_OCCLUSION_CULL_H
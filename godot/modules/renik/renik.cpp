@@ -31,7 +31,11 @@
 #include "renik.h"
 
 #include "core/math/quaternion.h"
+#include "core/object/message_queue.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/thread.h"
 #include "scene/3d/marker_3d.h"
+#include "scene/main/scene_tree.h"
 
 #ifndef _3D_DISABLED
 
@@ -65,12 +69,17 @@
 #define RENIK_PROPERTY_STRING_FOOT_LEFT_TARGET_PATH "armature_left_foot_target"
 #define RENIK_PROPERTY_STRING_FOOT_RIGHT_TARGET_PATH "armature_right_foot_target"
 
+HashMap<ObjectID, RenIK::Batch *> RenIK::batches;
+BinaryMutex RenIK::batches_mutex;
+
 RenIK::RenIK() {}
 
 void RenIK::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_live_preview", "p_enable"),
 			&RenIK::set_live_preview);
 	ClassDB::bind_method(D_METHOD("get_live_preview"), &RenIK::get_live_preview);
+	ClassDB::bind_method(D_METHOD("set_batch_mode", "enable"), &RenIK::set_batch_mode);
+	ClassDB::bind_method(D_METHOD("is_batch_mode_enabled"), &RenIK::is_batch_mode_enabled);
 
 	ClassDB::bind_method(D_METHOD("enable_solve_ik_every_frame", "p_enable"),
 			&RenIK::enable_solve_ik_every_frame);
@@ -363,6 +372,16 @@ void RenIK::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_collide_with_bodies_enabled"),
 			&RenIK::is_collide_with_bodies_enabled);
 
+	ClassDB::bind_method(D_METHOD("set_ground_probe_reuse_distance", "distance"),
+			&RenIK::set_ground_probe_reuse_distance);
+	ClassDB::bind_method(D_METHOD("get_ground_probe_reuse_distance"),
+			&RenIK::get_ground_probe_reuse_distance);
+
+	ClassDB::bind_method(D_METHOD("set_ground_probe_max_reuse", "max_reuse"),
+			&RenIK::set_ground_probe_max_reuse);
+	ClassDB::bind_method(D_METHOD("get_ground_probe_max_reuse"),
+			&RenIK::get_ground_probe_max_reuse);
+
 	ClassDB::bind_method(D_METHOD("set_collision_mask", "mask"),
 			&RenIK::set_collision_mask);
 	ClassDB::bind_method(D_METHOD("get_collision_mask"),
@@ -779,6 +798,8 @@ void RenIK::_bind_methods() {
 
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "live_preview"), "set_live_preview",
 			"get_live_preview");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "batch_mode"), "set_batch_mode",
+			"is_batch_mode_enabled");
 
 	ADD_GROUP("Armature", "armature_");
 	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH,
@@ -960,6 +981,12 @@ void RenIK::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "walk_collide_with_bodies",
 						 PROPERTY_HINT_LAYERS_3D_PHYSICS),
 			"set_collide_with_bodies", "is_collide_with_bodies_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "walk_ground_probe_reuse_distance",
+						 PROPERTY_HINT_RANGE, "0,0.5,0.001,or_greater,suffix:m"),
+			"set_ground_probe_reuse_distance", "get_ground_probe_reuse_distance");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "walk_ground_probe_max_reuse",
+						 PROPERTY_HINT_RANGE, "0,60,1,or_greater"),
+			"set_ground_probe_max_reuse", "get_ground_probe_max_reuse");
 
 	ADD_GROUP("Forward Gait (Advanced)", "forward_");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "forward_speed_scalar_min",
@@ -1348,15 +1375,33 @@ void RenIK::_notification(int p_what) {
 		case NOTIFICATION_READY: {
 			_initialize();
 		} break;
+		case NOTIFICATION_ENTER_TREE: {
+			if (batch_mode) {
+				_batch_register();
+			}
+		} break;
+		case NOTIFICATION_EXIT_TREE: {
+			if (batch_mode) {
+				_batch_unregister();
+			}
+		} break;
 		case NOTIFICATION_INTERNAL_PROCESS: {
 			if (!Engine::get_singleton()->is_editor_hint() || live_preview) {
-				update_ik();
+				if (batch_mode) {
+					_request_batch_solve();
+				} else {
+					update_ik();
+				}
 			}
 			break;
 		}
 		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS: {
 			if (!Engine::get_singleton()->is_editor_hint() || live_preview) {
-				update_placement(get_physics_process_delta_time());
+				if (batch_mode) {
+					_request_batch_placement(get_physics_process_delta_time());
+				} else {
+					update_placement(get_physics_process_delta_time());
+				}
 			}
 		} break;
 	}
@@ -1399,32 +1444,226 @@ void RenIK::enable_hip_placement(bool enabled) { hip_placement = enabled; }
 void RenIK::enable_foot_placement(bool enabled) { foot_placement = enabled; }
 
 void RenIK::update_ik() {
-	// Saracen: since the foot placement is updated in the physics frame,
-	// interpolate the results to avoid jitter
-	placement.interpolate_transforms(
-			Engine::get_singleton()->get_physics_interpolation_fraction(),
-			!hip_target_spatial, foot_placement);
+	if (_snapshot_pose()) {
+		_solve_pose();
+		_commit_pose();
+	}
+}
 
-	if (skeleton) {
-		Transform3D skel_inverse = skeleton->get_global_transform().affine_inverse();
-		SpineTransforms spine_global_transforms = perform_torso_ik();
-		if (hand_left_target_spatial) {
-			perform_hand_left_ik(spine_global_transforms.left_arm_parent_transform, skel_inverse * hand_left_target_spatial->get_global_transform());
+void RenIK::set_batch_mode(bool p_enable) {
+	if (batch_mode == p_enable) {
+		return;
+	}
+	batch_mode = p_enable;
+	if (is_inside_tree()) {
+		if (batch_mode) {
+			_batch_register();
+		} else {
+			_batch_unregister();
+		}
+	}
+}
+
+bool RenIK::is_batch_mode_enabled() const {
+	return batch_mode;
+}
+
+RenIK::Batch *RenIK::_get_batch(SceneTree *p_tree) {
+	ERR_FAIL_NULL_V(p_tree, nullptr);
+	MutexLock lock(batches_mutex);
+	Batch **batch_ptr = batches.getptr(p_tree->get_instance_id());
+	return batch_ptr ? *batch_ptr : nullptr;
+}
+
+void RenIK::_batch_register() {
+	if (batch) {
+		return;
+	}
+	SceneTree *tree = get_tree();
+	MutexLock lock(batches_mutex);
+	Batch **batch_ptr = batches.getptr(tree->get_instance_id());
+	if (batch_ptr) {
+		batch = *batch_ptr;
+	} else {
+		batch = memnew(Batch);
+		batch->tree = tree->get_instance_id();
+		batches.insert(batch->tree, batch);
+	}
+	MutexLock batch_lock(batch->mutex);
+	batch->instances.push_back(this);
+}
+
+void RenIK::_batch_unregister() {
+	if (!batch) {
+		return;
+	}
+	MutexLock lock(batches_mutex);
+	{
+		MutexLock batch_lock(batch->mutex);
+		batch->instances.erase(this);
+		batch_requested = false;
+		batch_placement_requested = false;
+	}
+	// A flush still queued for this tree finds no batch and does nothing.
+	if (batch->instances.is_empty()) {
+		batches.erase(batch->tree);
+		memdelete(batch);
+	}
+	batch = nullptr;
+}
+
+void RenIK::_request_batch_solve() {
+	ERR_FAIL_NULL(batch);
+	MutexLock lock(batch->mutex);
+	batch_requested = true;
+	if (!batch->solve_scheduled) {
+		// Deferred so that every node gets to move its targets during this
+		// frame's process step before anything is snapshotted. Always queued on
+		// the main MessageQueue, call_deferred() from a sub-thread group would
+		// flush on that group's thread.
+		batch->solve_scheduled = true;
+		MessageQueue::get_main_singleton()->push_callable(callable_mp_static(&RenIK::_flush_batch_solve), batch->tree);
+	}
+}
+
+void RenIK::_flush_batch_solve(ObjectID p_tree) {
+	SceneTree *tree = Object::cast_to<SceneTree>(ObjectDB::get_instance(p_tree));
+	if (tree) {
+		solve_batch(tree);
+	}
+}
+
+void RenIK::_solve_batch_element(void *p_userdata, uint32_t p_index) {
+	static_cast<RenIK **>(p_userdata)[p_index]->_solve_pose();
+}
+
+void RenIK::solve_batch(SceneTree *p_tree) {
+	ERR_FAIL_COND_MSG(!Thread::is_main_thread(), "RenIK batches can only be solved from the main thread.");
+	Batch *tree_batch = _get_batch(p_tree);
+	if (!tree_batch) {
+		return;
+	}
+
+	LocalVector<RenIK *> &solving = tree_batch->solving;
+	solving.clear();
+	{
+		MutexLock lock(tree_batch->mutex);
+		tree_batch->solve_scheduled = false;
+		for (RenIK *renik : tree_batch->instances) {
+			if (renik->batch_requested) {
+				renik->batch_requested = false;
+				solving.push_back(renik);
+			}
 		}
-		if (hand_right_target_spatial) {
-			perform_hand_right_ik(spine_global_transforms.right_arm_parent_transform, skel_inverse * hand_right_target_spatial->get_global_transform());
+	}
+
+	// The tree only changes on the main thread, so the collected nodes stay
+	// valid until the poses are committed.
+	uint32_t count = 0;
+	for (RenIK *renik : solving) {
+		if (renik->_snapshot_pose()) {
+			solving[count++] = renik;
 		}
-		if (foot_left_target_spatial) {
-			perform_foot_left_ik(spine_global_transforms.hip_transform, skel_inverse * foot_left_target_spatial->get_global_transform());
-		} else if (foot_placement) {
-			perform_foot_left_ik(spine_global_transforms.hip_transform, skel_inverse * placement.interpolated_left_foot);
+	}
+	solving.resize(count);
+
+	if (solving.size() == 1) {
+		solving[0]->_solve_pose();
+	} else if (solving.size() > 1) {
+		WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_native_group_task(
+				&RenIK::_solve_batch_element, solving.ptr(), solving.size(), -1, true, SNAME("RenIK batch solve"));
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+	}
+
+	for (RenIK *renik : solving) {
+		renik->_commit_pose();
+	}
+	solving.clear();
+}
+
+void RenIK::_request_batch_placement(float p_delta) {
+	ERR_FAIL_NULL(batch);
+	MutexLock lock(batch->mutex);
+	batch_placement_requested = true;
+	batch_placement_delta = p_delta;
+	if (!batch->placement_scheduled) {
+		// Flushed at the end of this physics step, while the direct space state
+		// can still be queried.
+		batch->placement_scheduled = true;
+		MessageQueue::get_main_singleton()->push_callable(callable_mp_static(&RenIK::_flush_batch_placement), batch->tree);
+	}
+}
+
+void RenIK::_flush_batch_placement(ObjectID p_tree) {
+	SceneTree *tree = Object::cast_to<SceneTree>(ObjectDB::get_instance(p_tree));
+	if (tree) {
+		place_batch(tree);
+	}
+}
+
+void RenIK::place_batch(SceneTree *p_tree) {
+	ERR_FAIL_COND_MSG(!Thread::is_main_thread(), "RenIK batches can only be placed from the main thread.");
+	Batch *tree_batch = _get_batch(p_tree);
+	if (!tree_batch) {
+		return;
+	}
+
+	LocalVector<RenIK *> &placing = tree_batch->placing;
+	placing.clear();
+	{
+		MutexLock lock(tree_batch->mutex);
+		tree_batch->placement_scheduled = false;
+		for (RenIK *renik : tree_batch->instances) {
+			if (renik->batch_placement_requested) {
+				renik->batch_placement_requested = false;
+				placing.push_back(renik);
+			}
 		}
-		if (foot_right_target_spatial) {
-			perform_foot_right_ik(spine_global_transforms.hip_transform, skel_inverse * foot_right_target_spatial->get_global_transform());
-		} else if (foot_placement) {
-			perform_foot_right_ik(spine_global_transforms.hip_transform, skel_inverse * placement.interpolated_right_foot);
+	}
+
+	for (RenIK *renik : placing) {
+		renik->placement.save_previous_transforms();
+		renik->batch_placement_space = RID();
+		if (renik->foot_placement && renik->head_target_spatial &&
+				renik->head_target_spatial->is_inside_world()) {
+			renik->batch_placement_head = renik->head_target_spatial->get_global_transform();
+			renik->batch_placement_space = renik->head_target_spatial->get_world_3d()->get_space();
+			renik->placement.prepare_ground_probes(renik->batch_placement_head);
 		}
 	}
+
+	// Cast the probes one physics space at a time.
+	struct SpaceSort {
+		_FORCE_INLINE_ bool operator()(const RenIK *p_a, const RenIK *p_b) const {
+			return p_a->batch_placement_space < p_b->batch_placement_space;
+		}
+	};
+	placing.sort_custom<SpaceSort>();
+	RID space;
+	PhysicsDirectSpaceState3D *dss = nullptr;
+	for (RenIK *renik : placing) {
+		if (!renik->batch_placement_space.is_valid()) {
+			continue;
+		}
+		if (renik->batch_placement_space != space) {
+			space = renik->batch_placement_space;
+			dss = PhysicsServer3D::get_singleton()->space_get_direct_state(space);
+		}
+		if (dss) {
+			renik->placement.cast_ground_probes(dss, true);
+		} else {
+			renik->batch_placement_space = RID();
+		}
+	}
+
+	for (RenIK *renik : placing) {
+		if (renik->batch_placement_space.is_valid()) {
+			renik->placement.apply_ground_probes(renik->batch_placement_delta,
+					renik->batch_placement_head, false);
+		}
+		renik->_place_hips(renik->batch_placement_delta);
+	}
+	placing.clear();
 }
 
 void RenIK::update_placement(float delta) {
@@ -1439,35 +1678,56 @@ void RenIK::update_placement(float delta) {
 		placement.foot_place(delta, head_target_spatial->get_global_transform(),
 				head_target_spatial->get_world_3d(), false);
 	}
+	_place_hips(delta);
+}
+
+void RenIK::_place_hips(float p_delta) {
 	if (hip_placement && head_target_spatial) {
 		// calc twist from hands here
 		float twist = 0;
 		if (foot_placement) {
-			placement.hip_place(delta, head_target_spatial->get_global_transform(),
+			placement.hip_place(p_delta, head_target_spatial->get_global_transform(),
 					placement.target_left_foot,
 					placement.target_right_foot, twist, false);
 		} else {
 			if (foot_left_target_spatial != nullptr &&
 					foot_right_target_spatial != nullptr) {
-				placement.hip_place(delta, head_target_spatial->get_global_transform(),
+				placement.hip_place(p_delta, head_target_spatial->get_global_transform(),
 						foot_left_target_spatial->get_global_transform(),
 						foot_right_target_spatial->get_global_transform(),
 						twist, false);
-			} else {
-				// I have no idea when you would hit this code, but if you do, it'll lag
-				// everything because of the call to get_bone_global_pose
+			} else if (skeleton) {
+				// Read the feet from the pose RenIK last committed rather than
+				// making the skeleton resolve its global poses mid-tick.
 				placement.hip_place(
-						delta, head_target_spatial->get_global_transform(),
+						p_delta, head_target_spatial->get_global_transform(),
 						skeleton->get_global_transform() *
-								skeleton->get_bone_global_pose(get_foot_left_bone()),
+								_get_cached_bone_global_pose(get_foot_left_bone()),
 						skeleton->get_global_transform() *
-								skeleton->get_bone_global_pose(get_foot_right_bone()),
+								_get_cached_bone_global_pose(get_foot_right_bone()),
 						twist, false);
 			}
 		}
 	}
 }
 
+Transform3D RenIK::_get_cached_bone_global_pose(BoneId p_bone) {
+	PoseSnapshot &pose = pose_snapshot;
+	if (!pose.valid || skeleton->get_bone_count() != (int)pose.bone_rotations.size()) {
+		return skeleton->get_bone_global_pose(p_bone);
+	}
+	ERR_FAIL_INDEX_V(p_bone, (BoneId)pose.bone_rotations.size(), Transform3D());
+	if (!pose.bone_global_pose_cached[p_bone]) {
+		Transform3D bone_pose;
+		bone_pose.basis.set_quaternion_scale(pose.bone_rotations[p_bone], pose.bone_scales[p_bone]);
+		bone_pose.origin = pose.bone_positions[p_bone];
+		BoneId parent = pose.bone_parents[p_bone];
+		pose.bone_global_poses[p_bone] = parent >= 0 ? _get_cached_bone_global_pose(parent) * bone_pose : bone_pose;
+		pose.bone_global_pose_cached[p_bone] = 1;
+	}
+	return pose.bone_global_poses[p_bone];
+}
+
 void RenIK::apply_ik_map(HashMap<BoneId, Quaternion> ik_map,
 		Transform3D global_parent,
 		Vector<BoneId> apply_order) {
@@ -1517,13 +1777,11 @@ Transform3D RenIK::get_global_parent_pose(BoneId child,
 }
 
 RenIK::SpineTransforms RenIK::perform_torso_ik() {
-	if (head_target_spatial && skeleton && spine_chain->is_valid()) {
-		Transform3D skel_inverse = skeleton->get_global_transform().affine_inverse();
-		Transform3D headGlobalTransform =
-				skel_inverse * head_target_spatial->get_global_transform();
+	PoseSnapshot &pose = pose_snapshot;
+	if (pose.solve_torso) {
+		Transform3D headGlobalTransform = pose.head_target;
 		Transform3D hipGlobalTransform =
-				skel_inverse * (hip_target_spatial ? hip_target_spatial->get_global_transform() : placement.interpolated_hip) *
-				skeleton->get_bone_rest(hip).basis;
+				pose.hip_target * _get_pose_rest(hip).basis;
 		Vector3 delta = hipGlobalTransform.origin +
 				hipGlobalTransform.basis.xform(
 						spine_chain->get_joints()[0].relative_prev) -
@@ -1536,38 +1794,43 @@ RenIK::SpineTransforms RenIK::perform_torso_ik() {
 							spine_chain->get_joints()[0].relative_prev));
 		}
 
-		Transform3D hipLocalPose = skeleton->get_bone_pose(hip);
 		Transform3D correctedHipTransform = hipGlobalTransform;
-		correctedHipTransform.set_origin(-hipLocalPose.origin);
+		correctedHipTransform.set_origin(hip >= 0 && hip < (BoneId)pose.bone_positions.size() ? -pose.bone_positions[hip] : Vector3());
 
-		HashMap<BoneId, Quaternion> ik_map = RenIK::solve_ifabrik(
+		RenIK::solve_ifabrik(
 				spine_chain,
-				correctedHipTransform * skeleton->get_bone_rest(hip).basis.inverse(),
-				headGlobalTransform, 0.01, 10);
-		skeleton->set_bone_pose_rotation(hip, hipGlobalTransform.get_basis().get_rotation_quaternion());
-		skeleton->set_bone_pose_position(hip, hipGlobalTransform.get_origin());
+				correctedHipTransform * _get_pose_rest(hip).basis.inverse(),
+				headGlobalTransform, 0.01, 10, pose.spine_joint_points,
+				pose.spine_joint_rotations);
+		_set_pose_rotation(hip, hipGlobalTransform.get_basis().get_rotation_quaternion());
+		if (hip >= 0 && hip < (BoneId)pose.bone_rests.size()) {
+			pose.bone_positions[hip] = hipGlobalTransform.get_origin();
+			pose.hip_position_dirty = true;
+		}
 
-		apply_ik_map(ik_map, hipGlobalTransform,
-				bone_id_order(spine_chain));
+		Vector<RenIKChain::Joint> spine_joints = spine_chain->get_joints();
+		for (uint32_t i = 0; i < pose.spine_joint_rotations.size(); i++) {
+			_set_pose_rotation(spine_joints[i].id, pose.spine_joint_rotations[i]);
+		}
 
 		Quaternion neckQuaternion = Quaternion();
-		int parent_bone = skeleton->get_bone_parent(head);
+		BoneId parent_bone = _get_pose_parent(head);
 		while (parent_bone != -1) {
-			neckQuaternion = skeleton->get_bone_pose_rotation(parent_bone) * neckQuaternion;
-			parent_bone = skeleton->get_bone_parent(parent_bone);
+			neckQuaternion = pose.bone_rotations[parent_bone] * neckQuaternion;
+			parent_bone = _get_pose_parent(parent_bone);
 		}
-		skeleton->set_bone_pose_rotation(head, neckQuaternion.inverse() * headGlobalTransform.get_basis().get_rotation_quaternion());
+		_set_pose_rotation(head, neckQuaternion.inverse() * headGlobalTransform.get_basis().get_rotation_quaternion());
 
 		// Calculate and return the parent bone position for the arms
 		Transform3D left_global_parent_pose = Transform3D();
 		Transform3D right_global_parent_pose = Transform3D();
 		if (limb_arm_left.is_valid()) {
-			left_global_parent_pose = get_global_parent_pose(
-					limb_arm_left->upper_id, ik_map, hipGlobalTransform);
+			left_global_parent_pose = _get_pose_global_parent(
+					limb_arm_left->upper_id, hipGlobalTransform);
 		}
 		if (limb_arm_right.is_valid()) {
-			right_global_parent_pose = get_global_parent_pose(
-					limb_arm_right->upper_id, ik_map, hipGlobalTransform);
+			right_global_parent_pose = _get_pose_global_parent(
+					limb_arm_right->upper_id, hipGlobalTransform);
 		}
 		return SpineTransforms(hipGlobalTransform, left_global_parent_pose,
 				right_global_parent_pose, headGlobalTransform);
@@ -1576,14 +1839,12 @@ RenIK::SpineTransforms RenIK::perform_torso_ik() {
 }
 
 void RenIK::perform_hand_left_ik(Transform3D global_parent, Transform3D target) {
-	if (hand_left_target_spatial && skeleton &&
-			limb_arm_left->is_valid_in_skeleton(skeleton)) {
+	if (pose_snapshot.solve_hand_left) {
 		Transform3D root = global_parent;
-		BoneId rootBone =
-				skeleton->get_bone_parent(limb_arm_left->get_upper_bone());
+		BoneId rootBone = _get_pose_parent(limb_arm_left->get_upper_bone());
 		if (rootBone >= 0) {
 			if (left_shoulder_enabled) {
-				root = root * skeleton->get_bone_rest(rootBone);
+				root = root * _get_pose_rest(rootBone);
 				Vector3 targetVector = root.affine_inverse().xform(target.origin);
 				Quaternion offsetQuat = Quaternion::from_euler(left_shoulder_offset);
 				Quaternion poleOffset = Quaternion::from_euler(left_shoulder_pole_offset);
@@ -1596,25 +1857,24 @@ void RenIK::perform_hand_left_ik(Transform3D global_parent, Transform3D target)
 								.slerp(Quaternion(), 1 - shoulder_influence);
 				Transform3D customPose =
 						Transform3D(offsetQuat * quatAlignToTarget, Vector3());
-				skeleton->set_bone_pose_rotation(rootBone, skeleton->get_bone_rest(rootBone).get_basis().get_rotation_quaternion() * offsetQuat * quatAlignToTarget);
+				_set_pose_rotation(rootBone, _get_pose_rest(rootBone).get_basis().get_rotation_quaternion() * offsetQuat * quatAlignToTarget);
 				root = root * customPose;
 			}
 		}
-		apply_ik_map(
-				solve_trig_ik_redux(limb_arm_left, root, target),
-				root, bone_id_order(limb_arm_left));
+		Basis upper, lower, leaf;
+		if (solve_trig_ik_redux(limb_arm_left, root, target, upper, lower, leaf)) {
+			_set_limb_pose(limb_arm_left, upper, lower, leaf);
+		}
 	}
 }
 
 void RenIK::perform_hand_right_ik(Transform3D global_parent, Transform3D target) {
-	if (hand_right_target_spatial && skeleton &&
-			limb_arm_right->is_valid_in_skeleton(skeleton)) {
+	if (pose_snapshot.solve_hand_right) {
 		Transform3D root = global_parent;
-		BoneId rootBone =
-				skeleton->get_bone_parent(limb_arm_right->get_upper_bone());
+		BoneId rootBone = _get_pose_parent(limb_arm_right->get_upper_bone());
 		if (rootBone >= 0) {
 			if (right_shoulder_enabled) {
-				root = root * skeleton->get_bone_rest(rootBone);
+				root = root * _get_pose_rest(rootBone);
 				Vector3 targetVector = root.affine_inverse().xform(target.origin);
 				Quaternion offsetQuat = Quaternion::from_euler(right_shoulder_offset);
 				Quaternion poleOffset = Quaternion::from_euler(right_shoulder_pole_offset);
@@ -1628,32 +1888,194 @@ void RenIK::perform_hand_right_ik(Transform3D global_parent, Transform3D target)
 								.slerp(Quaternion(), 1 - shoulder_influence);
 				Transform3D customPose =
 						Transform3D(offsetQuat * quatAlignToTarget, Vector3());
-				skeleton->set_bone_pose_rotation(rootBone, skeleton->get_bone_rest(rootBone).get_basis().get_rotation_quaternion() * offsetQuat * quatAlignToTarget);
+				_set_pose_rotation(rootBone, _get_pose_rest(rootBone).get_basis().get_rotation_quaternion() * offsetQuat * quatAlignToTarget);
 				root = root * customPose;
 			}
 		}
-		apply_ik_map(
-				solve_trig_ik_redux(limb_arm_right, root, target),
-				root, bone_id_order(limb_arm_right));
+		Basis upper, lower, leaf;
+		if (solve_trig_ik_redux(limb_arm_right, root, target, upper, lower, leaf)) {
+			_set_limb_pose(limb_arm_right, upper, lower, leaf);
+		}
 	}
 }
 
 void RenIK::perform_foot_left_ik(Transform3D global_parent, Transform3D target) {
-	if (skeleton && limb_leg_left->is_valid_in_skeleton(skeleton)) {
-		Transform3D root = global_parent;
-		apply_ik_map(
-				solve_trig_ik_redux(limb_leg_left, root, target),
-				global_parent, bone_id_order(limb_leg_left));
+	if (pose_snapshot.solve_foot_left) {
+		Basis upper, lower, leaf;
+		if (solve_trig_ik_redux(limb_leg_left, global_parent, target, upper, lower, leaf)) {
+			_set_limb_pose(limb_leg_left, upper, lower, leaf);
+		}
 	}
 }
 
 void RenIK::perform_foot_right_ik(Transform3D global_parent, Transform3D target) {
-	if (skeleton && limb_leg_right->is_valid_in_skeleton(skeleton)) {
-		Transform3D root = global_parent;
-		apply_ik_map(solve_trig_ik_redux(
-							 limb_leg_right, root, target),
-				global_parent, bone_id_order(limb_leg_right));
+	if (pose_snapshot.solve_foot_right) {
+		Basis upper, lower, leaf;
+		if (solve_trig_ik_redux(limb_leg_right, global_parent, target, upper, lower, leaf)) {
+			_set_limb_pose(limb_leg_right, upper, lower, leaf);
+		}
+	}
+}
+
+BoneId RenIK::_get_pose_parent(BoneId p_bone) const {
+	if (p_bone < 0 || p_bone >= (BoneId)pose_snapshot.bone_parents.size()) {
+		return -1;
+	}
+	return pose_snapshot.bone_parents[p_bone];
+}
+
+Transform3D RenIK::_get_pose_rest(BoneId p_bone) const {
+	if (p_bone < 0 || p_bone >= (BoneId)pose_snapshot.bone_rests.size()) {
+		return Transform3D();
+	}
+	return pose_snapshot.bone_rests[p_bone];
+}
+
+void RenIK::_set_pose_rotation(BoneId p_bone, const Quaternion &p_rotation) {
+	PoseSnapshot &pose = pose_snapshot;
+	if (p_bone < 0 || p_bone >= (BoneId)pose.bone_rotations.size()) {
+		return;
+	}
+	pose.bone_rotations[p_bone] = p_rotation;
+	if (!pose.bone_dirty[p_bone]) {
+		pose.bone_dirty[p_bone] = 1;
+		pose.dirty_bones.push_back(p_bone);
+	}
+}
+
+void RenIK::_set_limb_pose(Ref<RenIKLimb> p_limb, const Basis &p_upper, const Basis &p_lower, const Basis &p_leaf) {
+	_set_pose_rotation(p_limb->get_upper_bone(), p_upper.get_rotation_quaternion());
+	for (int i = 0; i < p_limb->upper_extra_bone_ids.size(); i++) {
+		_set_pose_rotation(p_limb->upper_extra_bone_ids[i], Quaternion());
+	}
+	_set_pose_rotation(p_limb->get_lower_bone(), p_lower.get_rotation_quaternion());
+	for (int i = 0; i < p_limb->lower_extra_bone_ids.size(); i++) {
+		_set_pose_rotation(p_limb->lower_extra_bone_ids[i], Quaternion());
+	}
+	_set_pose_rotation(p_limb->get_leaf_bone(), p_leaf.get_rotation_quaternion());
+}
+
+Transform3D RenIK::_get_pose_global_parent(BoneId p_child,
+		const Transform3D &p_map_global_parent) const {
+	const PoseSnapshot &pose = pose_snapshot;
+	Transform3D full_transform;
+	BoneId parent_id = _get_pose_parent(p_child);
+	while (parent_id >= 0) {
+		int32_t joint = pose.spine_joint_index[parent_id];
+		if (joint >= 0) {
+			BoneId super_parent = parent_id;
+			full_transform = _get_pose_rest(super_parent) *
+					Transform3D(pose.spine_joint_rotations[joint]) * full_transform;
+			while (_get_pose_parent(super_parent) >= 0) {
+				super_parent = _get_pose_parent(super_parent);
+				joint = pose.spine_joint_index[super_parent];
+				if (joint >= 0) {
+					full_transform = _get_pose_rest(super_parent) *
+							Transform3D(pose.spine_joint_rotations[joint]) * full_transform;
+				} else {
+					full_transform = p_map_global_parent * full_transform;
+					break;
+				}
+			}
+			return full_transform;
+		}
+		parent_id = _get_pose_parent(parent_id);
+	}
+	return Transform3D();
+}
+
+bool RenIK::_snapshot_pose() {
+	PoseSnapshot &pose = pose_snapshot;
+	pose.valid = false;
+
+	// Saracen: since the foot placement is updated in the physics frame,
+	// interpolate the results to avoid jitter
+	placement.interpolate_transforms(
+			Engine::get_singleton()->get_physics_interpolation_fraction(),
+			!hip_target_spatial, foot_placement);
+
+	if (!skeleton) {
+		return false;
+	}
+
+	const int bone_count = skeleton->get_bone_count();
+	pose.bone_parents.resize(bone_count);
+	pose.bone_rests.resize(bone_count);
+	pose.bone_rotations.resize(bone_count);
+	pose.bone_positions.resize(bone_count);
+	pose.bone_scales.resize(bone_count);
+	pose.bone_dirty.resize(bone_count);
+	pose.bone_global_poses.resize(bone_count);
+	pose.bone_global_pose_cached.resize(bone_count);
+	pose.spine_joint_index.resize(bone_count);
+	for (int i = 0; i < bone_count; i++) {
+		pose.bone_parents[i] = skeleton->get_bone_parent(i);
+		pose.bone_rests[i] = skeleton->get_bone_rest(i);
+		pose.bone_rotations[i] = skeleton->get_bone_pose_rotation(i);
+		pose.bone_positions[i] = skeleton->get_bone_pose_position(i);
+		pose.bone_scales[i] = skeleton->get_bone_pose_scale(i);
+		pose.bone_dirty[i] = 0;
+		pose.bone_global_pose_cached[i] = 0;
+		pose.spine_joint_index[i] = -1;
+	}
+	pose.dirty_bones.clear();
+	pose.hip_position_dirty = false;
+	pose.spine_joint_rotations.clear();
+
+	Transform3D skel_inverse = skeleton->get_global_transform().affine_inverse();
+	pose.solve_torso = head_target_spatial && spine_chain->is_valid();
+	if (pose.solve_torso) {
+		pose.head_target = skel_inverse * head_target_spatial->get_global_transform();
+		pose.hip_target = skel_inverse * (hip_target_spatial ? hip_target_spatial->get_global_transform() : placement.interpolated_hip);
+		Vector<RenIKChain::Joint> spine_joints = spine_chain->get_joints();
+		for (int i = 0; i < spine_joints.size(); i++) {
+			if (spine_joints[i].id >= 0 && spine_joints[i].id < bone_count) {
+				pose.spine_joint_index[spine_joints[i].id] = i;
+			}
+		}
+	}
+	pose.solve_hand_left = hand_left_target_spatial && limb_arm_left->is_valid_in_skeleton(skeleton);
+	if (pose.solve_hand_left) {
+		pose.hand_left_target = skel_inverse * hand_left_target_spatial->get_global_transform();
+	}
+	pose.solve_hand_right = hand_right_target_spatial && limb_arm_right->is_valid_in_skeleton(skeleton);
+	if (pose.solve_hand_right) {
+		pose.hand_right_target = skel_inverse * hand_right_target_spatial->get_global_transform();
+	}
+	pose.solve_foot_left = (foot_left_target_spatial || foot_placement) && limb_leg_left->is_valid_in_skeleton(skeleton);
+	if (pose.solve_foot_left) {
+		pose.foot_left_target = skel_inverse * (foot_left_target_spatial ? foot_left_target_spatial->get_global_transform() : placement.interpolated_left_foot);
+	}
+	pose.solve_foot_right = (foot_right_target_spatial || foot_placement) && limb_leg_right->is_valid_in_skeleton(skeleton);
+	if (pose.solve_foot_right) {
+		pose.foot_right_target = skel_inverse * (foot_right_target_spatial ? foot_right_target_spatial->get_global_transform() : placement.interpolated_right_foot);
+	}
+	pose.valid = true;
+	return true;
+}
+
+void RenIK::_solve_pose() {
+	const PoseSnapshot &pose = pose_snapshot;
+	SpineTransforms spine_global_transforms = perform_torso_ik();
+	perform_hand_left_ik(spine_global_transforms.left_arm_parent_transform, pose.hand_left_target);
+	perform_hand_right_ik(spine_global_transforms.right_arm_parent_transform, pose.hand_right_target);
+	perform_foot_left_ik(spine_global_transforms.hip_transform, pose.foot_left_target);
+	perform_foot_right_ik(spine_global_transforms.hip_transform, pose.foot_right_target);
+}
+
+void RenIK::_commit_pose() {
+	PoseSnapshot &pose = pose_snapshot;
+	if (!pose.valid || !skeleton || skeleton->get_bone_count() != (int)pose.bone_rotations.size()) {
+		return;
+	}
+	for (const BoneId &bone : pose.dirty_bones) {
+		skeleton->set_bone_pose_rotation(bone, pose.bone_rotations[bone]);
 	}
+	if (pose.hip_position_dirty) {
+		skeleton->set_bone_pose_position(hip, pose.bone_positions[hip]);
+	}
+	pose.dirty_bones.clear();
+	pose.hip_position_dirty = false;
 }
 
 void RenIK::reset_chain(Ref<RenIKChain> chain) {
@@ -1818,6 +2240,28 @@ HashMap<BoneId, Basis> RenIK::solve_trig_ik_redux(Ref<RenIKLimb> limb,
 		Transform3D root,
 		Transform3D target) {
 	HashMap<BoneId, Basis> map;
+	Basis upperTransform;
+	Basis lowerTransform;
+	Basis leafTransform;
+	if (solve_trig_ik_redux(limb, root, target, upperTransform, lowerTransform, leafTransform)) {
+		map[limb->get_upper_bone()] = upperTransform;
+		for (int i = 0; i < limb->upper_extra_bone_ids.size(); i++) {
+			map[limb->upper_extra_bone_ids[i]] = Basis();
+		}
+
+		map[limb->get_lower_bone()] =
+				lowerTransform;
+		for (int i = 0; i < limb->lower_extra_bone_ids.size(); i++) {
+			map[limb->lower_extra_bone_ids[i]] = Basis();
+		}
+
+		map[limb->get_leaf_bone()] = leafTransform;
+	}
+	return map;
+}
+
+bool RenIK::solve_trig_ik_redux(Ref<RenIKLimb> limb, Transform3D root,
+		Transform3D target, Basis &r_upper, Basis &r_lower, Basis &r_leaf) {
 	if (limb->is_valid()) {
 		// The true root of the limb is the point where the upper bone starts
 		Transform3D trueRoot = root.translated_local(limb->get_upper().get_origin());
@@ -1947,28 +2391,17 @@ HashMap<BoneId, Basis> RenIK::solve_trig_ik_redux(Ref<RenIKLimb> limb,
 		lowerBasis.rotate_local(Vector3(0, 1, 0), lowerTwist);
 		lowerBasis.rotate(Vector3(0, 1, 0), -upperTwist);
 
-		Basis upperTransform =
+		r_upper =
 				((full_upper.get_basis().inverse() * upperBasis).orthonormalized());
-		Basis lowerTransform =
+		r_lower =
 				((full_lower.get_basis().inverse() * lowerBasis).orthonormalized());
-		Basis leafTransform =
+		r_leaf =
 				(limb->get_leaf().get_basis().inverse() *
 						(upperBasis * lowerBasis).inverse() * localTarget.get_basis() *
 						limb->get_leaf().get_basis());
-		map[limb->get_upper_bone()] = upperTransform;
-		for (int i = 0; i < limb->upper_extra_bone_ids.size(); i++) {
-			map[limb->upper_extra_bone_ids[i]] = Basis();
-		}
-
-		map[limb->get_lower_bone()] =
-				lowerTransform;
-		for (int i = 0; i < limb->lower_extra_bone_ids.size(); i++) {
-			map[limb->lower_extra_bone_ids[i]] = Basis();
-		}
-
-		map[limb->get_leaf_bone()] = leafTransform;
+		return true;
 	}
-	return map;
+	return false;
 }
 
 Vector<BoneId> RenIK::calculate_bone_chain(BoneId root, BoneId leaf) {
@@ -2801,6 +3234,22 @@ bool RenIK::is_collide_with_bodies_enabled() const {
 	return placement.is_collide_with_bodies_enabled();
 }
 
+void RenIK::set_ground_probe_reuse_distance(float p_distance) {
+	placement.set_ground_probe_reuse_distance(p_distance);
+}
+
+float RenIK::get_ground_probe_reuse_distance() const {
+	return placement.get_ground_probe_reuse_distance();
+}
+
+void RenIK::set_ground_probe_max_reuse(int p_max_reuse) {
+	placement.set_ground_probe_max_reuse(p_max_reuse);
+}
+
+int RenIK::get_ground_probe_max_reuse() const {
+	return placement.get_ground_probe_max_reuse();
+}
+
 void RenIK::set_forward_speed_scalar_min(float speed_scalar_min) {
 	placement.forward_gait.speed_scalar_min = speed_scalar_min / 100.0;
 }
@@ -3435,6 +3884,23 @@ HashMap<BoneId, Quaternion>
 RenIK::solve_ifabrik(Ref<RenIKChain> chain, Transform3D root,
 		Transform3D target, float threshold, int loopLimit) {
 	HashMap<BoneId, Quaternion> map;
+	LocalVector<Vector3> joint_points;
+	LocalVector<Quaternion> joint_rotations;
+	if (solve_ifabrik(chain, root, target, threshold, loopLimit, joint_points, joint_rotations)) {
+		Vector<RenIKChain::Joint> joints = chain->get_joints();
+		for (uint32_t i = 0; i < joint_rotations.size(); i++) {
+			map.insert(joints[i].id, joint_rotations[i]);
+		}
+	}
+	return map;
+}
+
+bool RenIK::solve_ifabrik(Ref<RenIKChain> chain, Transform3D root,
+		Transform3D target, float threshold, int loopLimit,
+		LocalVector<Vector3> &r_joint_points,
+		LocalVector<Quaternion> &r_joint_rotations) {
+	r_joint_points.clear();
+	r_joint_rotations.clear();
 	if (chain->is_valid()) { // if the chain is valid there's at least one joint
 							 // in the chain and there's one bone between it and
 							 // the root
@@ -3464,7 +3930,7 @@ RenIK::solve_ifabrik(Ref<RenIKChain> chain, Transform3D root,
 								joints[0].relative_prev); // The angle root is rotated
 														  // to point at the target;
 
-		Vector<Vector3> globalJointPoints;
+		LocalVector<Vector3> &globalJointPoints = r_joint_points;
 
 		// We generate the starting points
 		// Here is where we take into account root and target influences and the
@@ -3495,7 +3961,7 @@ RenIK::solve_ifabrik(Ref<RenIKChain> chain, Transform3D root,
 						   // that joint
 				Vector3 delta = globalJointPoints[j - 1] - lastJoint;
 				delta = delta.normalized() * joints[j].next_distance;
-				globalJointPoints.set(j - 1, lastJoint + delta);
+				globalJointPoints[j - 1] = lastJoint + delta;
 				lastJoint = globalJointPoints[j - 1];
 			}
 			lastJoint = trueRoot.origin; // the root joint
@@ -3506,7 +3972,7 @@ RenIK::solve_ifabrik(Ref<RenIKChain> chain, Transform3D root,
 						   // that joint
 				Vector3 delta = globalJointPoints[j - 1] - lastJoint;
 				delta = delta.normalized() * joints[j].prev_distance;
-				globalJointPoints.set(j - 1, lastJoint + delta);
+				globalJointPoints[j - 1] = lastJoint + delta;
 				lastJoint = globalJointPoints[j - 1];
 			}
 
@@ -3551,12 +4017,13 @@ RenIK::solve_ifabrik(Ref<RenIKChain> chain, Transform3D root,
 					Quaternion(Vector3(0, 1, 0), maxTwist * joints[i].twist_influence);
 			pose = prevTwist.inverse() * joints[i].rotation * pose * twist;
 			prevTwist = twist;
-			map.insert(joints[i].id, pose);
+			r_joint_rotations.push_back(pose);
 			parentRot = parentRot * pose;
 			parentPos = globalJointPoints[i];
 		}
+		return true;
 	}
-	return map;
+	return false;
 }
 
 #endif // _3D_DISABLED
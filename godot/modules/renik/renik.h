@@ -37,6 +37,9 @@
 #include "renik/renik_helper.h"
 #include "renik/renik_limb.h"
 #include "renik/renik_placement.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "servers/physics_server_3d.h"
 #include <core/config/engine.h>
 #include <core/variant/variant.h>
@@ -83,6 +86,19 @@ public:
 	void update_ik();
 	void update_placement(float delta);
 
+	void set_batch_mode(bool p_enable);
+	bool is_batch_mode_enabled() const;
+	// Solves every batched RenIK of the tree that requested an update this
+	// frame: targets are snapshotted on the calling thread, the solves run in
+	// parallel on the WorkerThreadPool and the poses are written back to the
+	// skeletons at the end. Must be called from the main thread.
+	static void solve_batch(SceneTree *p_tree);
+	// Places every batched RenIK of the tree that requested a placement this
+	// physics tick. Ground probes are grouped by physics space so each space is
+	// queried in one pass, and probes that still match their last hit are not
+	// recast. Must be called from the main thread.
+	static void place_batch(SceneTree *p_tree);
+
 	void apply_ik_map(HashMap<BoneId, Quaternion> ik_map, Transform3D global_parent,
 			Vector<BoneId> apply_order);
 	void apply_ik_map(HashMap<BoneId, Basis> ik_map, Transform3D global_parent,
@@ -94,6 +110,8 @@ public:
 			HashMap<BoneId, Quaternion> ik_map,
 			Transform3D map_global_parent);
 
+	// Solve steps of update_ik. They read and write the pose snapshot taken at
+	// the start of the update, the skeleton is only written when it is committed.
 	SpineTransforms perform_torso_ik();
 	void perform_hand_left_ik(Transform3D global_parent, Transform3D target);
 	void perform_hand_right_ik(Transform3D global_parent, Transform3D target);
@@ -282,6 +300,10 @@ public:
 	bool is_collide_with_areas_enabled() const;
 	void set_collide_with_bodies(bool p_clip);
 	bool is_collide_with_bodies_enabled() const;
+	void set_ground_probe_reuse_distance(float p_distance);
+	float get_ground_probe_reuse_distance() const;
+	void set_ground_probe_max_reuse(int p_max_reuse);
+	int get_ground_probe_max_reuse() const;
 
 	void set_forward_speed_scalar_min(float speed_scalar_min);
 	float get_forward_speed_scalar_min() const;
@@ -466,10 +488,20 @@ public:
 	static HashMap<BoneId, Basis>
 	solve_trig_ik_redux(Ref<RenIKLimb> limb, Transform3D limb_parent_transform,
 			Transform3D target);
+	// Allocation-free variant, returns the upper, lower and leaf rotations.
+	// The extra bones of the limb are left at identity.
+	static bool solve_trig_ik_redux(Ref<RenIKLimb> limb, Transform3D limb_parent_transform,
+			Transform3D target, Basis &r_upper, Basis &r_lower, Basis &r_leaf);
 
 	static HashMap<BoneId, Quaternion>
 	solve_ifabrik(Ref<RenIKChain> chain, Transform3D root,
 			Transform3D target, float threshold, int loopLimit);
+	// Allocation-free variant, writes one rotation per chain joint into
+	// r_joint_rotations. r_joint_points is scratch space reused between calls.
+	static bool solve_ifabrik(Ref<RenIKChain> chain, Transform3D root,
+			Transform3D target, float threshold, int loopLimit,
+			LocalVector<Vector3> &r_joint_points,
+			LocalVector<Quaternion> &r_joint_rotations);
 
 private:
 	// Setup -------------------------
@@ -538,6 +570,92 @@ private:
 	bool leftFootTrackerEnabled = true;
 	bool rightFootTrackerEnabled = true;
 
+	// Everything a solve reads from the scene, captured up front so the solve
+	// itself never touches the skeleton or the target nodes. Bone data is kept
+	// in flat arrays indexed by BoneId and reused from frame to frame.
+	struct PoseSnapshot {
+		bool valid = false;
+
+		bool solve_torso = false;
+		bool solve_hand_left = false;
+		bool solve_hand_right = false;
+		bool solve_foot_left = false;
+		bool solve_foot_right = false;
+
+		// Targets in skeleton space.
+		Transform3D head_target;
+		Transform3D hip_target;
+		Transform3D hand_left_target;
+		Transform3D hand_right_target;
+		Transform3D foot_left_target;
+		Transform3D foot_right_target;
+
+		LocalVector<BoneId> bone_parents;
+		LocalVector<Transform3D> bone_rests;
+		LocalVector<Quaternion> bone_rotations;
+		LocalVector<Vector3> bone_positions;
+		LocalVector<Vector3> bone_scales;
+		LocalVector<uint8_t> bone_dirty;
+		LocalVector<BoneId> dirty_bones;
+		bool hip_position_dirty = false;
+
+		// Skeleton-space bone poses, filled lazily from the committed pose.
+		LocalVector<Transform3D> bone_global_poses;
+		LocalVector<uint8_t> bone_global_pose_cached;
+
+		// Index of each bone in the spine solve, or -1.
+		LocalVector<int32_t> spine_joint_index;
+		LocalVector<Vector3> spine_joint_points;
+		LocalVector<Quaternion> spine_joint_rotations;
+	};
+	PoseSnapshot pose_snapshot;
+
+	// Batched RenIKs of one SceneTree. Nodes in sub-thread process groups
+	// request their updates from worker threads, so the request flags and the
+	// scheduled flags are only touched with the mutex held.
+	struct Batch {
+		BinaryMutex mutex;
+		ObjectID tree;
+		LocalVector<RenIK *> instances;
+		LocalVector<RenIK *> solving;
+		LocalVector<RenIK *> placing;
+		bool solve_scheduled = false;
+		bool placement_scheduled = false;
+	};
+	// Keyed by SceneTree. Batches are created and freed on the main thread,
+	// as nodes enter and exit the tree.
+	static HashMap<ObjectID, Batch *> batches;
+	static BinaryMutex batches_mutex;
+	static Batch *_get_batch(SceneTree *p_tree);
+
+	bool batch_mode = false;
+	Batch *batch = nullptr;
+	bool batch_requested = false;
+
+	bool batch_placement_requested = false;
+	float batch_placement_delta = 0;
+	RID batch_placement_space;
+	Transform3D batch_placement_head;
+
+	void _batch_register();
+	void _batch_unregister();
+	void _request_batch_solve();
+	static void _flush_batch_solve(ObjectID p_tree);
+	static void _solve_batch_element(void *p_userdata, uint32_t p_index);
+	void _request_batch_placement(float p_delta);
+	static void _flush_batch_placement(ObjectID p_tree);
+	void _place_hips(float p_delta);
+
+	bool _snapshot_pose();
+	void _solve_pose();
+	void _commit_pose();
+	BoneId _get_pose_parent(BoneId p_bone) const;
+	Transform3D _get_pose_rest(BoneId p_bone) const;
+	void _set_pose_rotation(BoneId p_bone, const Quaternion &p_rotation);
+	void _set_limb_pose(Ref<RenIKLimb> p_limb, const Basis &p_upper, const Basis &p_lower, const Basis &p_leaf);
+	Transform3D _get_pose_global_parent(BoneId p_child, const Transform3D &p_map_global_parent) const;
+	Transform3D _get_cached_bone_global_pose(BoneId p_bone);
+
 	void calculate_hip_offset();
 	Vector<BoneId> calculate_bone_chain(BoneId root, BoneId leaf);
 };
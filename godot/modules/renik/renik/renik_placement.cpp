@@ -112,25 +112,30 @@ void RenIKPlacement::foot_place(float p_delta, Transform3D p_head, Ref<World3D>
 					p_world_3d->get_space());
 	ERR_FAIL_COND(!dss);
 
-	PhysicsDirectSpaceState3D::RayResult left_raycast;
-	PhysicsDirectSpaceState3D::RayResult right_raycast;
-	PhysicsDirectSpaceState3D::RayResult laying_raycast;
+	prepare_ground_probes(p_head);
+	cast_ground_probes(dss);
+	apply_ground_probes(p_delta, p_head, p_instant);
+}
 
+void RenIKPlacement::prepare_ground_probes(Transform3D p_head) {
 	float startOffset = ((spine_length) * -center_of_balance_position) / sqrt(2);
-	Vector3 leftStart =
+	GroundProbe &left = ground_probes[GROUND_PROBE_LEFT_FOOT];
+	GroundProbe &right = ground_probes[GROUND_PROBE_RIGHT_FOOT];
+	GroundProbe &laying = ground_probes[GROUND_PROBE_LAYING];
+	left.from =
 			p_head.translated_local(Vector3(0, startOffset, startOffset) + left_hip_offset)
 					.origin;
-	Vector3 rightStart =
+	right.from =
 			p_head.translated_local(Vector3(0, startOffset, startOffset) + right_hip_offset)
 					.origin;
-	Vector3 leftStop = p_head.origin +
+	left.to = p_head.origin +
 			Vector3(0,
 					(-spine_length - left_leg_length - floor_offset) *
 									(1 + raycast_allowance) +
 							left_hip_offset[1],
 					0) +
 			p_head.basis.xform(left_hip_offset);
-	Vector3 rightStop =
+	right.to =
 			p_head.origin +
 			Vector3(0,
 					(-spine_length - right_leg_length - floor_offset) *
@@ -138,33 +143,85 @@ void RenIKPlacement::foot_place(float p_delta, Transform3D p_head, Ref<World3D>
 							right_hip_offset[1],
 					0) +
 			p_head.basis.xform(right_hip_offset);
+	laying.from = p_head.origin;
+	laying.to = p_head.origin - Vector3(0, spine_length + floor_offset, 0);
+}
+
+bool RenIKPlacement::_reuse_ground_probe(GroundProbe &p_probe) const {
+	if (!p_probe.collided || p_probe.reuse_count >= ground_probe_max_reuse) {
+		return false;
+	}
+	float reuse_distance_squared = ground_probe_reuse_distance * ground_probe_reuse_distance;
+	if (p_probe.from.distance_squared_to(p_probe.cast_from) > reuse_distance_squared ||
+			p_probe.to.distance_squared_to(p_probe.cast_to) > reuse_distance_squared) {
+		return false;
+	}
+	Node3D *collider = Object::cast_to<Node3D>(ObjectDB::get_instance(p_probe.result.collider_id));
+	if (!collider || !collider->is_inside_tree() ||
+			!collider->get_global_transform().is_equal_approx(p_probe.collider_transform)) {
+		return false;
+	}
+	// The ray only moved a little, so slide the previous hit along the surface
+	// it landed on instead of asking the physics server again.
+	Vector3 position;
+	if (!Plane(p_probe.result.normal, p_probe.result.position).intersects_segment(p_probe.from, p_probe.to, &position)) {
+		return false;
+	}
+	p_probe.result.position = position;
+	p_probe.result.collider = collider;
+	p_probe.reuse_count++;
+	return true;
+}
+
+void RenIKPlacement::cast_ground_probes(PhysicsDirectSpaceState3D *p_space_state, bool p_allow_reuse) {
+	ERR_FAIL_NULL(p_space_state);
 
 	PhysicsDirectSpaceState3D::RayParameters ray_query_parameters;
-	ray_query_parameters.from = leftStart;
-	ray_query_parameters.to = leftStop;
 	ray_query_parameters.collision_mask = collision_mask;
 	ray_query_parameters.collide_with_areas = collide_with_areas;
 	ray_query_parameters.collide_with_bodies = collide_with_bodies;
-	bool left_collided = dss->intersect_ray(ray_query_parameters, left_raycast);
-	ray_query_parameters.from = rightStart;
-	ray_query_parameters.to = rightStop;
-	bool right_collided = dss->intersect_ray(ray_query_parameters, right_raycast);
-	ray_query_parameters.from = p_head.origin;
-	ray_query_parameters.to = p_head.origin - Vector3(0, spine_length + floor_offset, 0);
-	bool laying_down = dss->intersect_ray(ray_query_parameters, laying_raycast);
-	if (!left_collided) {
+	for (GroundProbe &probe : ground_probes) {
+		if (p_allow_reuse && _reuse_ground_probe(probe)) {
+			continue;
+		}
+		ray_query_parameters.from = probe.from;
+		ray_query_parameters.to = probe.to;
+		probe.result = PhysicsDirectSpaceState3D::RayResult();
+		probe.collided = p_space_state->intersect_ray(ray_query_parameters, probe.result);
+		probe.cast_from = probe.from;
+		probe.cast_to = probe.to;
+		probe.reuse_count = 0;
+		Node3D *collider = probe.collided ? Object::cast_to<Node3D>(probe.result.collider) : nullptr;
+		if (collider) {
+			probe.collider_transform = collider->get_global_transform();
+		} else {
+			// Hits on anything that cannot report a transform are never reused.
+			probe.reuse_count = UINT32_MAX;
+		}
+	}
+}
+
+void RenIKPlacement::apply_ground_probes(float p_delta, Transform3D p_head,
+		bool p_instant) {
+	const GroundProbe &left = ground_probes[GROUND_PROBE_LEFT_FOOT];
+	const GroundProbe &right = ground_probes[GROUND_PROBE_RIGHT_FOOT];
+	const GroundProbe &laying = ground_probes[GROUND_PROBE_LAYING];
+	PhysicsDirectSpaceState3D::RayResult left_raycast = left.result;
+	PhysicsDirectSpaceState3D::RayResult right_raycast = right.result;
+	PhysicsDirectSpaceState3D::RayResult laying_raycast = laying.result;
+	if (!left.collided) {
 		left_raycast.collider = nullptr;
 	}
-	if (!right_collided) {
+	if (!right.collided) {
 		right_raycast.collider = nullptr;
 	}
-	if (!laying_down) {
+	if (!laying.collided) {
 		laying_raycast.collider = nullptr;
 	}
 	Vector3 left_offset =
-			(leftStart - leftStop).normalized() * floor_offset * left_leg_length;
+			(left.from - left.to).normalized() * floor_offset * left_leg_length;
 	Vector3 right_offset =
-			(rightStart - rightStop).normalized() * floor_offset * right_leg_length;
+			(right.from - right.to).normalized() * floor_offset * right_leg_length;
 	Vector3 laying_offset =
 			Vector3(0, floor_offset * (left_leg_length + right_leg_length) / 2, 0);
 	left_raycast.position += left_offset;
@@ -920,4 +977,20 @@ bool RenIKPlacement::is_collide_with_bodies_enabled() const {
 	return collide_with_bodies;
 }
 
+void RenIKPlacement::set_ground_probe_reuse_distance(float p_distance) {
+	ground_probe_reuse_distance = MAX(p_distance, 0.0f);
+}
+
+float RenIKPlacement::get_ground_probe_reuse_distance() const {
+	return ground_probe_reuse_distance;
+}
+
+void RenIKPlacement::set_ground_probe_max_reuse(int p_max_reuse) {
+	ground_probe_max_reuse = MAX(p_max_reuse, 0);
+}
+
+int RenIKPlacement::get_ground_probe_max_reuse() const {
+	return ground_probe_max_reuse;
+}
+
 #endif // _3D_DISABLED
@@ -232,6 +232,36 @@ public:
 			PhysicsDirectSpaceState3D::RayResult p_right_raycast,
 			PhysicsDirectSpaceState3D::RayResult p_laying_raycast,
 			bool p_instant);
+
+	// The rays foot_place casts. They can also be prepared, cast and applied as
+	// separate steps, which lets RenIK::place_batch cast the rays of every
+	// placement in a physics space together.
+	enum GroundProbeIndex {
+		GROUND_PROBE_LEFT_FOOT,
+		GROUND_PROBE_RIGHT_FOOT,
+		GROUND_PROBE_LAYING,
+		GROUND_PROBE_MAX,
+	};
+	struct GroundProbe {
+		Vector3 from;
+		Vector3 to;
+		PhysicsDirectSpaceState3D::RayResult result;
+		bool collided = false;
+		// Where the result was last cast from, and the collider it hit at the time.
+		// A hit is reused while the ray stays close and the collider stays put.
+		Vector3 cast_from;
+		Vector3 cast_to;
+		Transform3D collider_transform;
+		uint32_t reuse_count = 0;
+	};
+	GroundProbe ground_probes[GROUND_PROBE_MAX];
+
+	void prepare_ground_probes(Transform3D p_head);
+	// With p_allow_reuse, a hit can be reused for a few ticks instead of recast,
+	// so an obstacle appearing in the ray may be missed until the next recast.
+	void cast_ground_probes(PhysicsDirectSpaceState3D *p_space_state, bool p_allow_reuse = false);
+	void apply_ground_probes(float p_delta, Transform3D p_head, bool p_instant);
+
 	// All used in leg trace
 	void set_falling(bool p_falling);
 	void set_collision_mask_bit(int p_bit, bool p_value);
@@ -242,6 +272,10 @@ public:
 	bool is_collide_with_areas_enabled() const;
 	void set_collide_with_bodies(bool p_clip);
 	bool is_collide_with_bodies_enabled() const;
+	void set_ground_probe_reuse_distance(float p_distance);
+	float get_ground_probe_reuse_distance() const;
+	void set_ground_probe_max_reuse(int p_max_reuse);
+	int get_ground_probe_max_reuse() const;
 
 private:
 #define LOOP_GROUND_IN 0
@@ -250,6 +284,8 @@ private:
 #define LOOP_APEX_OUT 3
 #define LOOP_DROP 4
 #define LOOP_GROUND_OUT 5
+	bool _reuse_ground_probe(GroundProbe &p_probe) const;
+
 	bool fall_override = false;
 	bool prone_override = false;
 	int walk_state =
@@ -261,6 +297,8 @@ private:
 	uint32_t collision_mask = 1; // the first bit is on but all others are off
 	bool collide_with_areas = false;
 	bool collide_with_bodies = true;
+	float ground_probe_reuse_distance = 0.02;
+	uint32_t ground_probe_max_reuse = 8; // forces a recast every few ticks
 
 	// Standing
 	Transform3D left_stand;
@@ -32,6 +32,12 @@
 #define TEST_RENIK_H
 
 #include "core/math/basis.h"
+#include "core/object/message_queue.h"
+#include "scene/3d/physics/collision_shape_3d.h"
+#include "scene/3d/physics/static_body_3d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/resources/3d/box_shape_3d.h"
+#include "scene/main/window.h"
 #include "tests/test_macros.h"
 
 #include "../renik.h"
@@ -82,6 +88,233 @@ TEST_CASE("[Modules][RENIK] math") {
 			"math 7");
 }
 
+TEST_CASE("[Modules][RENIK] flat limb solve matches map solve") {
+	Skeleton3D *skeleton = memnew(Skeleton3D);
+	skeleton->add_bone("upper");
+	skeleton->add_bone("lower");
+	skeleton->add_bone("leaf");
+	skeleton->set_bone_parent(1, 0);
+	skeleton->set_bone_parent(2, 1);
+	skeleton->set_bone_rest(1, Transform3D(Basis(), Vector3(0, 1, 0)));
+	skeleton->set_bone_rest(2, Transform3D(Basis(), Vector3(0, 1, 0)));
+
+	Ref<RenIKLimb> limb;
+	limb.instantiate();
+	limb->set_leaf(skeleton, 2);
+	REQUIRE(limb->is_valid());
+
+	Transform3D target(Basis(), Vector3(0.5, 1.2, 0.3));
+	Basis upper, lower, leaf;
+	HashMap<BoneId, Basis> map = RenIK::solve_trig_ik_redux(limb, Transform3D(), target);
+	REQUIRE(RenIK::solve_trig_ik_redux(limb, Transform3D(), target, upper, lower, leaf));
+	CHECK(map[0].is_equal_approx(upper));
+	CHECK(map[1].is_equal_approx(lower));
+	CHECK(map[2].is_equal_approx(leaf));
+
+	memdelete(skeleton);
+}
+
+struct HumanoidRig {
+	Node3D *root = nullptr;
+	Skeleton3D *skeleton = nullptr;
+	RenIK *renik = nullptr;
+};
+
+static HumanoidRig create_humanoid_rig(int p_variant, bool p_foot_placement = false) {
+	HumanoidRig rig;
+	rig.root = memnew(Node3D);
+	rig.skeleton = memnew(Skeleton3D);
+	rig.skeleton->set_name("Skeleton");
+	rig.root->add_child(rig.skeleton);
+
+	struct BoneDesc {
+		const char *name;
+		int parent;
+		Vector3 offset;
+	};
+	const BoneDesc bones[] = {
+		{ "Hips", -1, Vector3(0, 1, 0) },
+		{ "Spine", 0, Vector3(0, 0.15, 0) },
+		{ "Chest", 1, Vector3(0, 0.15, 0.02) },
+		{ "Neck", 2, Vector3(0, 0.2, -0.02) },
+		{ "Head", 3, Vector3(0, 0.1, 0) },
+		{ "LeftUpperArm", 2, Vector3(0.2, 0.15, 0) },
+		{ "LeftLowerArm", 5, Vector3(0.3, 0, 0) },
+		{ "LeftHand", 6, Vector3(0.25, 0, 0) },
+		{ "RightUpperArm", 2, Vector3(-0.2, 0.15, 0) },
+		{ "RightLowerArm", 8, Vector3(-0.3, 0, 0) },
+		{ "RightHand", 9, Vector3(-0.25, 0, 0) },
+		{ "LeftUpperLeg", 0, Vector3(0.1, -0.05, 0) },
+		{ "LeftLowerLeg", 11, Vector3(0, -0.45, 0) },
+		{ "LeftFoot", 12, Vector3(0, -0.45, 0) },
+		{ "RightUpperLeg", 0, Vector3(-0.1, -0.05, 0) },
+		{ "RightLowerLeg", 14, Vector3(0, -0.45, 0) },
+		{ "RightFoot", 15, Vector3(0, -0.45, 0) },
+	};
+	for (const BoneDesc &bone : bones) {
+		int index = rig.skeleton->get_bone_count();
+		rig.skeleton->add_bone(bone.name);
+		rig.skeleton->set_bone_parent(index, bone.parent);
+		rig.skeleton->set_bone_rest(index, Transform3D(Basis(), bone.offset));
+	}
+	rig.skeleton->reset_bone_poses();
+
+	// Each variant reaches for slightly different targets, so the batch holds
+	// several distinct solves.
+	const real_t shift = 0.05 * p_variant;
+	struct TargetDesc {
+		const char *name;
+		Transform3D transform;
+	};
+	const TargetDesc targets[] = {
+		{ "HeadTarget", Transform3D(Basis(Vector3(0, 1, 0), 0.3 * shift), Vector3(shift, 1.5, 0.1)) },
+		{ "HipTarget", Transform3D(Basis(), Vector3(0, 0.95 - shift, 0)) },
+		{ "LeftHandTarget", Transform3D(Basis(), Vector3(0.4, 1.2 + shift, 0.3)) },
+		{ "RightHandTarget", Transform3D(Basis(), Vector3(-0.45, 1.1, 0.2 + shift)) },
+		{ "LeftFootTarget", Transform3D(Basis(), Vector3(0.12, 0.05, 0.1 + shift)) },
+		{ "RightFootTarget", Transform3D(Basis(), Vector3(-0.12, 0.05, -0.1)) },
+	};
+	for (const TargetDesc &target : targets) {
+		if (p_foot_placement && String(target.name) != "HeadTarget") {
+			// The hips and feet are placed on the ground instead.
+			continue;
+		}
+		Node3D *node = memnew(Node3D);
+		node->set_name(target.name);
+		node->set_transform(target.transform);
+		rig.root->add_child(node);
+	}
+
+	// Parented to the skeleton, which RenIK picks up when it becomes ready.
+	rig.renik = memnew(RenIK);
+	rig.renik->set_head_bone_by_name("Head");
+	rig.renik->set_hip_bone_by_name("Hips");
+	rig.renik->set_hand_left_bone_by_name("LeftHand");
+	rig.renik->set_lower_arm_left_bone_by_name("LeftLowerArm");
+	rig.renik->set_upper_arm_left_bone_by_name("LeftUpperArm");
+	rig.renik->set_hand_right_bone_by_name("RightHand");
+	rig.renik->set_lower_arm_right_bone_by_name("RightLowerArm");
+	rig.renik->set_upper_arm_right_bone_by_name("RightUpperArm");
+	rig.renik->set_foot_left_bone_by_name("LeftFoot");
+	rig.renik->set_lower_leg_left_bone_by_name("LeftLowerLeg");
+	rig.renik->set_upper_leg_left_bone_by_name("LeftUpperLeg");
+	rig.renik->set_foot_right_bone_by_name("RightFoot");
+	rig.renik->set_lower_leg_right_bone_by_name("RightLowerLeg");
+	rig.renik->set_upper_leg_right_bone_by_name("RightUpperLeg");
+	rig.renik->set_head_target_path(NodePath("../../HeadTarget"));
+	if (p_foot_placement) {
+		rig.renik->enable_foot_placement(true);
+		rig.renik->enable_hip_placement(true);
+	} else {
+		rig.renik->set_hip_target_path(NodePath("../../HipTarget"));
+		rig.renik->set_hand_left_target_path(NodePath("../../LeftHandTarget"));
+		rig.renik->set_hand_right_target_path(NodePath("../../RightHandTarget"));
+		rig.renik->set_foot_left_target_path(NodePath("../../LeftFootTarget"));
+		rig.renik->set_foot_right_target_path(NodePath("../../RightFootTarget"));
+	}
+	rig.skeleton->add_child(rig.renik);
+
+	SceneTree::get_singleton()->get_root()->add_child(rig.root);
+	return rig;
+}
+
+TEST_CASE("[Modules][RENIK][SceneTree] batch solve matches serial solve") {
+	const int rig_count = 4;
+	HumanoidRig serial[rig_count];
+	HumanoidRig batched[rig_count];
+	for (int i = 0; i < rig_count; i++) {
+		serial[i] = create_humanoid_rig(i);
+		batched[i] = create_humanoid_rig(i);
+		batched[i].renik->set_batch_mode(true);
+	}
+
+	for (int i = 0; i < rig_count; i++) {
+		serial[i].renik->update_ik();
+	}
+	// Requests the solves the way the internal process step does, then lets
+	// the main MessageQueue run the single scheduled batch flush.
+	for (int i = 0; i < rig_count; i++) {
+		batched[i].renik->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+	}
+	MessageQueue::get_singleton()->flush();
+
+	const int spine_bone = serial[0].skeleton->find_bone("Spine");
+	const int chest_bone = serial[0].skeleton->find_bone("Chest");
+	for (int i = 0; i < rig_count; i++) {
+		Skeleton3D *expected = serial[i].skeleton;
+		Skeleton3D *actual = batched[i].skeleton;
+		// The spine is solved by the flat FABRIK pass, make sure it moved.
+		CHECK_FALSE(expected->get_bone_pose_rotation(spine_bone).is_equal_approx(Quaternion()));
+		CHECK_FALSE(expected->get_bone_pose_rotation(chest_bone).is_equal_approx(Quaternion()));
+		for (int bone = 0; bone < expected->get_bone_count(); bone++) {
+			CHECK_MESSAGE(actual->get_bone_pose_rotation(bone).is_equal_approx(expected->get_bone_pose_rotation(bone)),
+					vformat("Rig %d, bone %s", i, expected->get_bone_name(bone)));
+			CHECK(actual->get_bone_pose_position(bone).is_equal_approx(expected->get_bone_pose_position(bone)));
+		}
+	}
+
+	for (int i = 0; i < rig_count; i++) {
+		memdelete(serial[i].root);
+		memdelete(batched[i].root);
+	}
+}
+
+TEST_CASE("[Modules][RENIK][SceneTree] batch placement matches serial placement on a flat floor") {
+	StaticBody3D *floor = memnew(StaticBody3D);
+	CollisionShape3D *floor_shape = memnew(CollisionShape3D);
+	Ref<BoxShape3D> box;
+	box.instantiate();
+	box->set_size(Vector3(20, 1, 20));
+	floor_shape->set_shape(box);
+	floor_shape->set_position(Vector3(0, -0.5, 0));
+	floor->add_child(floor_shape);
+	SceneTree::get_singleton()->get_root()->add_child(floor);
+
+	const int rig_count = 3;
+	HumanoidRig serial[rig_count];
+	HumanoidRig batched[rig_count];
+	for (int i = 0; i < rig_count; i++) {
+		serial[i] = create_humanoid_rig(i, true);
+		batched[i] = create_humanoid_rig(i, true);
+		batched[i].renik->set_batch_mode(true);
+	}
+
+	// The heads drift by less than the reuse distance each tick, so the
+	// batched probes mix reused hits with recasts.
+	const float delta = batched[0].renik->get_physics_process_delta_time();
+	for (int tick = 0; tick < 12; tick++) {
+		const Vector3 drift(0.005, 0, 0.003);
+		for (int i = 0; i < rig_count; i++) {
+			Node3D *serial_head = Object::cast_to<Node3D>(serial[i].root->get_node(NodePath("HeadTarget")));
+			Node3D *batched_head = Object::cast_to<Node3D>(batched[i].root->get_node(NodePath("HeadTarget")));
+			serial_head->set_position(serial_head->get_position() + drift);
+			batched_head->set_position(batched_head->get_position() + drift);
+
+			serial[i].renik->update_placement(delta);
+			batched[i].renik->notification(Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
+		}
+		MessageQueue::get_singleton()->flush();
+
+		for (int i = 0; i < rig_count; i++) {
+			serial[i].renik->update_ik();
+			batched[i].renik->update_ik();
+			Skeleton3D *expected = serial[i].skeleton;
+			Skeleton3D *actual = batched[i].skeleton;
+			for (int bone = 0; bone < expected->get_bone_count(); bone++) {
+				CHECK_MESSAGE(actual->get_bone_pose_rotation(bone).is_equal_approx(expected->get_bone_pose_rotation(bone)),
+						vformat("Tick %d, rig %d, bone %s", tick, i, expected->get_bone_name(bone)));
+				CHECK(actual->get_bone_pose_position(bone).is_equal_approx(expected->get_bone_pose_position(bone)));
+			}
+		}
+	}
+
+	for (int i = 0; i < rig_count; i++) {
+		memdelete(serial[i].root);
+		memdelete(batched[i].root);
+	}
+	memdelete(floor);
+}
+
 } // namespace TestRenIK
 
 #endif // TEST_RENIK_H
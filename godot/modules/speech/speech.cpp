@@ -35,15 +35,10 @@
 #include "speech_processor.h"
 
 void Speech::preallocate_buffers() {
-	input_byte_array.resize(SpeechProcessor::SPEECH_SETTING_PCM_BUFFER_SIZE);
-	input_byte_array.fill(0);
-	compression_output_byte_array.resize(
-			SpeechProcessor::SPEECH_SETTING_PCM_BUFFER_SIZE);
-	compression_output_byte_array.fill(0);
-	for (int i = 0; i < MAX_AUDIO_BUFFER_ARRAY_SIZE; i++) {
-		input_audio_buffer_array[i].compressed_byte_array.resize(
+	for (uint32_t i = 0; i < input_packets.get_slot_count(); i++) {
+		input_packets.get_slot(i).compressed_byte_array.resize(
 				SpeechProcessor::SPEECH_SETTING_PCM_BUFFER_SIZE);
-		input_audio_buffer_array[i].compressed_byte_array.fill(0);
+		input_packets.get_slot(i).compressed_byte_array.fill(0);
 	}
 }
 
@@ -55,58 +50,29 @@ void Speech::setup_connections() {
 	}
 }
 
-Speech::InputPacket *Speech::get_next_valid_input_packet() {
-	if (current_input_size < MAX_AUDIO_BUFFER_ARRAY_SIZE) {
-		InputPacket *input_packet = &input_audio_buffer_array[current_input_size];
-		current_input_size++;
-		return input_packet;
-	} else {
-		for (int i = MAX_AUDIO_BUFFER_ARRAY_SIZE - 1; i > 0; i--) {
-			memcpy(input_audio_buffer_array[i - 1].compressed_byte_array.ptrw(),
-					input_audio_buffer_array[i].compressed_byte_array.ptr(),
-					SpeechProcessor::SPEECH_SETTING_PCM_BUFFER_SIZE);
-
-			input_audio_buffer_array[i - 1].buffer_size =
-					input_audio_buffer_array[i].buffer_size;
-			input_audio_buffer_array[i - 1].loudness =
-					input_audio_buffer_array[i].loudness;
-		}
-		skipped_audio_packets++;
-		return &input_audio_buffer_array[MAX_AUDIO_BUFFER_ARRAY_SIZE - 1];
-	}
-}
-
 void Speech::speech_processed(SpeechProcessor::SpeechInput *p_mic_input) {
-	// Copy the raw PCM data from the SpeechInput packet to the input byte array
-	PackedByteArray *mic_input_byte_array = p_mic_input->pcm_byte_array;
-	memcpy(input_byte_array.ptrw(), mic_input_byte_array->ptr(),
-			SpeechProcessor::SPEECH_SETTING_PCM_BUFFER_SIZE);
+	InputPacket *input_packet = input_packets.get_write_slot();
+	if (!input_packet) {
+		skipped_audio_packets.increment();
+		return;
+	}
 
-	// Create a new SpeechProcessor::CompressedBufferInput to be passed into the
-	// compressor and assign it the compressed_byte_array from the input packet
+	// Compress the raw PCM data from the SpeechInput packet directly into the
+	// preallocated buffer of the input packet
 	SpeechProcessor::CompressedSpeechBuffer compressed_buffer_input;
 	compressed_buffer_input.compressed_byte_array =
-			&compression_output_byte_array;
+			&input_packet->compressed_byte_array;
 
 	// Compress the packet
-	speech_processor->compress_buffer_internal(&input_byte_array,
-			&compressed_buffer_input);
-	{
-		// Lock
-		MutexLock mutex_lock(audio_mutex);
-
-		int64_t size = compressed_buffer_input.buffer_size;
-		ERR_FAIL_COND(size > SpeechProcessor::SPEECH_SETTING_PCM_BUFFER_SIZE);
-		// Find the next valid input packet in the queue
-		InputPacket *input_packet = get_next_valid_input_packet();
-		// Copy the buffer size from the compressed_buffer_input back into the
-		// input packet
-		memcpy(input_packet->compressed_byte_array.ptrw(),
-				compressed_buffer_input.compressed_byte_array->ptr(), size);
-
-		input_packet->buffer_size = size;
-		input_packet->loudness = p_mic_input->volume;
+	if (!speech_processor->compress_buffer_internal(p_mic_input->pcm_byte_array,
+				&compressed_buffer_input)) {
+		return;
 	}
+	ERR_FAIL_COND(compressed_buffer_input.buffer_size > SpeechProcessor::SPEECH_SETTING_PCM_BUFFER_SIZE);
+
+	input_packet->buffer_size = compressed_buffer_input.buffer_size;
+	input_packet->loudness = p_mic_input->volume;
+	input_packets.commit_write();
 }
 
 int Speech::get_jitter_buffer_speedup() const {
@@ -333,11 +299,11 @@ void Speech::_bind_methods() {
 }
 
 int Speech::get_skipped_audio_packets() {
-	return skipped_audio_packets;
+	return skipped_audio_packets.get();
 }
 
 void Speech::clear_skipped_audio_packets() {
-	skipped_audio_packets = 0;
+	skipped_audio_packets.set(0);
 }
 
 PackedVector2Array Speech::decompress_buffer(Ref<SpeechDecoder> p_speech_decoder, PackedByteArray p_read_byte_array, const int p_read_size, PackedVector2Array p_write_vec2_array) {
@@ -356,21 +322,27 @@ PackedVector2Array Speech::decompress_buffer(Ref<SpeechDecoder> p_speech_decoder
 }
 
 Array Speech::copy_and_clear_buffers() {
-	MutexLock mutex_lock(audio_mutex);
-
 	Array output_array;
-	output_array.resize(current_input_size);
+	output_array.resize(input_packets.size());
 
-	for (int i = 0; i < current_input_size; i++) {
+	int i = 0;
+	while (InputPacket *input_packet = input_packets.get_read_slot()) {
 		Dictionary dict;
 
-		dict["byte_array"] = input_audio_buffer_array[i].compressed_byte_array;
-		dict["buffer_size"] = input_audio_buffer_array[i].buffer_size;
-		dict["loudness"] = input_audio_buffer_array[i].loudness;
+		// Hand out a right-sized copy so the ring slot never becomes shared and
+		// the next compression into it does not trigger copy-on-write.
+		dict["byte_array"] = input_packet->compressed_byte_array.slice(0, input_packet->buffer_size);
+		dict["buffer_size"] = input_packet->buffer_size;
+		dict["loudness"] = input_packet->loudness;
 
-		output_array[i] = dict;
+		input_packets.commit_read();
+		if (i < output_array.size()) {
+			output_array[i] = dict;
+		} else {
+			output_array.push_back(dict);
+		}
+		i++;
 	}
-	current_input_size = 0;
 
 	return output_array;
 }
@@ -386,7 +358,7 @@ Ref<SpeechDecoder> Speech::get_speech_decoder() {
 bool Speech::start_recording() {
 	if (speech_processor) {
 		speech_processor->start();
-		skipped_audio_packets = 0;
+		skipped_audio_packets.set(0);
 		return true;
 	}
 
@@ -731,8 +703,8 @@ void Speech::attempt_to_feed_stream(int p_skip_count, Ref<SpeechDecoder> p_decod
 		bool packet_pushed = false;
 		bool push_result = false;
 		PackedByteArray buffer = packet["packet"];
-		uncompressed_audio = decompress_buffer(p_decoder, buffer, buffer.size(), uncompressed_audio);
-		if (uncompressed_audio.size()) {
+		// Decode in place into the preallocated uncompressed_audio buffer.
+		if (speech_processor->decompress_buffer_internal(p_decoder.ptr(), &buffer, buffer.size(), &uncompressed_audio)) {
 			if (uncompressed_audio.size() == SpeechProcessor::SPEECH_SETTING_BUFFER_FRAME_COUNT) {
 				push_result = playback->push_buffer(uncompressed_audio);
 			}
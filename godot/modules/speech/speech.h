@@ -36,7 +36,7 @@
 
 #include "core/config/engine.h"
 #include "core/config/project_settings.h"
-#include "core/os/mutex.h"
+#include "core/templates/safe_refcount.h"
 #include "core/variant/array.h"
 #include "core/variant/dictionary.h"
 #include "scene/main/node.h"
@@ -44,6 +44,7 @@
 
 #include "servers/audio/effects/audio_stream_generator.h"
 #include "speech_processor.h"
+#include "spsc_ring_buffer.h"
 
 class PlaybackStats : public RefCounted {
 	GDCLASS(PlaybackStats, RefCounted);
@@ -78,12 +79,9 @@ class Speech : public Node {
 
 	static const int MAX_AUDIO_BUFFER_ARRAY_SIZE = 10;
 
-	PackedByteArray input_byte_array;
 	float volume = 0.0;
 
-	Mutex audio_mutex;
-
-	int skipped_audio_packets = 0;
+	SafeNumeric<uint32_t> skipped_audio_packets;
 
 	SpeechProcessor *speech_processor = nullptr;
 
@@ -93,9 +91,9 @@ class Speech : public Node {
 		float loudness = 0.0;
 	};
 
-	int current_input_size = 0;
-	PackedByteArray compression_output_byte_array;
-	InputPacket input_audio_buffer_array[MAX_AUDIO_BUFFER_ARRAY_SIZE];
+	// Compressed packets travel from the capture side (producer) to
+	// copy_and_clear_buffers (consumer) without locking or shifting.
+	SPSCRingBuffer<InputPacket, MAX_AUDIO_BUFFER_ARRAY_SIZE> input_packets;
 	//
 private:
 	// Assigns the memory to the fixed audio buffer arrays
@@ -104,14 +102,9 @@ private:
 	// Assigns a callback from the speech_processor to this object.
 	void setup_connections();
 
-	// Returns a pointer to the first valid input packet
-	// If the current_input_size has exceeded MAX_AUDIO_BUFFER_ARRAY_SIZE,
-	// The front packet will be popped from the queue back recursively
-	// copying from the back.
-	InputPacket *get_next_valid_input_packet();
-
 	// Is responsible for recieving packets from the SpeechProcessor and then
-	// compressing them
+	// compressing them straight into the next free input packet. When the
+	// queue is full the new packet is dropped and counted as skipped.
 	void speech_processed(SpeechProcessor::SpeechInput *p_mic_input);
 
 private:
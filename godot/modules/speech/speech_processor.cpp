@@ -33,6 +33,12 @@
 
 #include <algorithm>
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define STEREO_CHANNEL_COUNT 2
 
 #define SIGNED_32_BIT_SIZE 2147483647
@@ -43,6 +49,114 @@
 #define RECORD_MIX_FRAMES 1024 * 2
 #define RESAMPLED_BUFFER_FACTOR sizeof(int)
 
+// Converts interleaved stereo frames to mono by averaging both channels.
+static void _stereo_to_mono(const float *p_src, uint32_t p_frame_count, float *p_dst) {
+	uint32_t i = 0;
+#if defined(__SSE2__)
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (; i + 4 <= p_frame_count; i += 4) {
+		__m128 a = _mm_loadu_ps(p_src + i * 2);
+		__m128 b = _mm_loadu_ps(p_src + i * 2 + 4);
+		__m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+		_mm_storeu_ps(p_dst + i, _mm_add_ps(_mm_mul_ps(left, half), _mm_mul_ps(right, half)));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 4 <= p_frame_count; i += 4) {
+		float32x4x2_t frames = vld2q_f32(p_src + i * 2);
+		vst1q_f32(p_dst + i, vaddq_f32(vmulq_n_f32(frames.val[0], 0.5f), vmulq_n_f32(frames.val[1], 0.5f)));
+	}
+#endif
+	for (; i < p_frame_count; i++) {
+		p_dst[i] = p_src[i * 2] * 0.5f + p_src[i * 2 + 1] * 0.5f;
+	}
+}
+
+// Same conversion as webrtc::FloatToS16 (scale, clamp, round half away from zero).
+// Returns the sum of the absolute input values, used for the packet loudness.
+static float _float_to_s16(const float *p_src, uint32_t p_count, int16_t *p_dst) {
+	uint32_t i = 0;
+	float sum = 0.0f;
+#if defined(__SSE2__)
+	const __m128 scale = _mm_set1_ps(32768.0f);
+	const __m128 max_value = _mm_set1_ps(32767.0f);
+	const __m128 min_value = _mm_set1_ps(-32768.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 sign_mask = _mm_set1_ps(-0.0f);
+	__m128 abs_sum = _mm_setzero_ps();
+	for (; i + 8 <= p_count; i += 8) {
+		__m128 a = _mm_loadu_ps(p_src + i);
+		__m128 b = _mm_loadu_ps(p_src + i + 4);
+		abs_sum = _mm_add_ps(abs_sum, _mm_add_ps(_mm_andnot_ps(sign_mask, a), _mm_andnot_ps(sign_mask, b)));
+		a = _mm_max_ps(_mm_min_ps(_mm_mul_ps(a, scale), max_value), min_value);
+		b = _mm_max_ps(_mm_min_ps(_mm_mul_ps(b, scale), max_value), min_value);
+		a = _mm_add_ps(a, _mm_or_ps(half, _mm_and_ps(a, sign_mask)));
+		b = _mm_add_ps(b, _mm_or_ps(half, _mm_and_ps(b, sign_mask)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(p_dst + i), _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+	}
+	float lanes[4];
+	_mm_storeu_ps(lanes, abs_sum);
+	sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__ARM_NEON)
+	const float32x4_t half = vdupq_n_f32(0.5f);
+	const uint32x4_t sign_mask = vdupq_n_u32(0x80000000);
+	float32x4_t abs_sum = vdupq_n_f32(0.0f);
+	for (; i + 8 <= p_count; i += 8) {
+		float32x4_t a = vld1q_f32(p_src + i);
+		float32x4_t b = vld1q_f32(p_src + i + 4);
+		abs_sum = vaddq_f32(abs_sum, vaddq_f32(vabsq_f32(a), vabsq_f32(b)));
+		a = vmaxq_f32(vminq_f32(vmulq_n_f32(a, 32768.0f), vdupq_n_f32(32767.0f)), vdupq_n_f32(-32768.0f));
+		b = vmaxq_f32(vminq_f32(vmulq_n_f32(b, 32768.0f), vdupq_n_f32(32767.0f)), vdupq_n_f32(-32768.0f));
+		a = vaddq_f32(a, vbslq_f32(sign_mask, a, half));
+		b = vaddq_f32(b, vbslq_f32(sign_mask, b, half));
+		vst1q_s16(p_dst + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)), vqmovn_s32(vcvtq_s32_f32(b))));
+	}
+	float lanes[4];
+	vst1q_f32(lanes, abs_sum);
+	sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+	for (; i < p_count; i++) {
+		sum += fabsf(p_src[i]);
+		p_dst[i] = webrtc::FloatToS16(p_src[i]);
+	}
+	return sum;
+}
+
+// Converts mono 16-bit samples to stereo floats in [-1, 1), writing each sample to both channels.
+static void _s16_to_stereo_float(const int16_t *p_src, uint32_t p_count, float *p_dst) {
+	uint32_t i = 0;
+#if defined(__SSE2__)
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+	for (; i + 8 <= p_count; i += 8) {
+		__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_src + i));
+		__m128 low = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)), scale);
+		__m128 high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)), scale);
+		float *dst = p_dst + i * 2;
+		_mm_storeu_ps(dst, _mm_unpacklo_ps(low, low));
+		_mm_storeu_ps(dst + 4, _mm_unpackhi_ps(low, low));
+		_mm_storeu_ps(dst + 8, _mm_unpacklo_ps(high, high));
+		_mm_storeu_ps(dst + 12, _mm_unpackhi_ps(high, high));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 8 <= p_count; i += 8) {
+		int16x8_t samples = vld1q_s16(p_src + i);
+		float32x4x2_t low;
+		low.val[0] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), 1.0f / 32768.0f);
+		low.val[1] = low.val[0];
+		float32x4x2_t high;
+		high.val[0] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), 1.0f / 32768.0f);
+		high.val[1] = high.val[0];
+		vst2q_f32(p_dst + i * 2, low);
+		vst2q_f32(p_dst + i * 2 + 8, high);
+	}
+#endif
+	for (; i < p_count; i++) {
+		float value = ((float)p_src[i]) / 32768.0f;
+		p_dst[i * 2 + 0] = value;
+		p_dst[i * 2 + 1] = value;
+	}
+}
+
 void SpeechProcessor::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("start"), &SpeechProcessor::start);
 	ClassDB::bind_method(D_METHOD("stop"), &SpeechProcessor::stop);
@@ -107,11 +221,15 @@ void SpeechProcessor::_get_capture_block(AudioServer *p_audio_server,
 		const uint32_t &p_mix_frame_count,
 		const Vector2 *p_process_buffer_in,
 		float *p_process_buffer_out) {
+#ifdef REAL_T_IS_DOUBLE
 	for (size_t i = 0; i < p_mix_frame_count; i++) {
 		float mono =
 				p_process_buffer_in[i].x * 0.5f + p_process_buffer_in[i].y * 0.5f;
 		p_process_buffer_out[i] = mono;
 	}
+#else
+	_stereo_to_mono(reinterpret_cast<const float *>(p_process_buffer_in), p_mix_frame_count, p_process_buffer_out);
+#endif
 }
 
 void SpeechProcessor::_mix_audio(const Vector2 *p_capture_buffer, const Vector2 *p_reference_buffer) {
@@ -139,21 +257,14 @@ void SpeechProcessor::_mix_audio(const Vector2 *p_capture_buffer, const Vector2
 		capture_real_array_offset = 0;
 		const float *capture_real_array_read_ptr = capture_real_array.ptr();
 		const float *reference_real_array_read_ptr = reference_real_array.ptr();
-		double_t sum = 0;
+		int16_t *mix_reference_buffer_write_ptr = mix_reference_buffer.ptrw();
+		int16_t *mix_capture_buffer_write_ptr = mix_capture_buffer.ptrw();
 		while (capture_real_array_offset < resampled_frame_count - SPEECH_SETTING_BUFFER_FRAME_COUNT) {
-			sum = 0.0;
 			// Speaker frame.
-			for (int64_t i = 0; i < SPEECH_SETTING_BUFFER_FRAME_COUNT; i++) {
-				float frame_error_cancellation_float = reference_real_array_read_ptr[static_cast<size_t>(capture_real_array_offset) + i];
-				mix_reference_buffer.write[i] = webrtc::FloatToS16(frame_error_cancellation_float);
-			}
+			_float_to_s16(reference_real_array_read_ptr + capture_real_array_offset, SPEECH_SETTING_BUFFER_FRAME_COUNT, mix_reference_buffer_write_ptr);
 			ref_frame.UpdateFrame(0, mix_reference_buffer.ptr(), SPEECH_SETTING_BUFFER_FRAME_COUNT, SPEECH_SETTING_VOICE_SAMPLE_RATE, webrtc::AudioFrame::kNormalSpeech, webrtc::AudioFrame::kVadActive, 1);
 			// Microphone frame.
-			for (int64_t i = 0; i < SPEECH_SETTING_BUFFER_FRAME_COUNT; i++) {
-				float frame_float = capture_real_array_read_ptr[static_cast<size_t>(capture_real_array_offset) + i];
-				sum += fabsf(frame_float);
-				mix_capture_buffer.write[i] = webrtc::FloatToS16(frame_float);
-			}
+			float sum = _float_to_s16(capture_real_array_read_ptr + capture_real_array_offset, SPEECH_SETTING_BUFFER_FRAME_COUNT, mix_capture_buffer_write_ptr);
 			capture_frame.UpdateFrame(0, mix_capture_buffer.ptr(), SPEECH_SETTING_BUFFER_FRAME_COUNT, SPEECH_SETTING_VOICE_SAMPLE_RATE, webrtc::AudioFrame::kNormalSpeech, webrtc::AudioFrame::kVadActive, 1);
 			capture_audio->CopyFrom(&capture_frame);
 			reference_audio->CopyFrom(&ref_frame);
@@ -167,12 +278,16 @@ void SpeechProcessor::_mix_audio(const Vector2 *p_capture_buffer, const Vector2
 			capture_audio->MergeFrequencyBands();
 			capture_audio->CopyTo(&capture_frame);
 			memcpy(mix_byte_array.ptrw(), capture_frame.data(), mix_byte_array.size());
-			Dictionary voice_data_packet;
-			voice_data_packet["buffer"] = mix_byte_array;
-			float average = (float)sum / (float)SPEECH_SETTING_BUFFER_FRAME_COUNT;
-			voice_data_packet["loudness"] = average;
-
-			emit_signal("speech_processed", voice_data_packet);
+			float average = sum / (float)SPEECH_SETTING_BUFFER_FRAME_COUNT;
+
+			// Building the signal payload shares mix_byte_array, which would force a
+			// copy on the next write, so only do it when someone is listening.
+			if (has_connections(SNAME("speech_processed"))) {
+				Dictionary voice_data_packet;
+				voice_data_packet["buffer"] = mix_byte_array;
+				voice_data_packet["loudness"] = average;
+				emit_signal(SNAME("speech_processed"), voice_data_packet);
+			}
 
 			if (speech_processed) {
 				SpeechInput speech_input;
@@ -250,11 +365,13 @@ bool SpeechProcessor::_16_pcm_mono_to_real_stereo(
 	ERR_FAIL_COND_V(buffer_size % 2, false);
 
 	uint32_t frame_count = buffer_size / 2;
+	ERR_FAIL_COND_V(uint32_t(p_dst_buffer->size()) < frame_count, false);
 
 	const int16_t *src_buffer_ptr =
 			reinterpret_cast<const int16_t *>(p_src_buffer->ptr());
 	real_t *real_buffer_ptr = reinterpret_cast<real_t *>(p_dst_buffer->ptrw());
 
+#ifdef REAL_T_IS_DOUBLE
 	for (uint32_t i = 0; i < frame_count; i++) {
 		float value = ((float)*src_buffer_ptr) / 32768.0f;
 
@@ -264,6 +381,9 @@ bool SpeechProcessor::_16_pcm_mono_to_real_stereo(
 		real_buffer_ptr += 2;
 		src_buffer_ptr++;
 	}
+#else
+	_s16_to_stereo_float(src_buffer_ptr, frame_count, real_buffer_ptr);
+#endif
 
 	return true;
 }
@@ -0,0 +1,94 @@
+/**************************************************************************/
+/*  spsc_ring_buffer.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Fixed capacity queue for one producer thread and one consumer thread.
+// Slots are preallocated and reused in place: the producer fills the slot
+// returned by get_write_slot() and publishes it with commit_write(), the consumer
+// reads the slot returned by get_read_slot() and releases it with commit_read().
+template <typename T, uint32_t CAPACITY>
+class SPSCRingBuffer {
+	// One slot stays empty to tell a full queue from an empty one.
+	static constexpr uint32_t SLOT_COUNT = CAPACITY + 1;
+
+	T slots[SLOT_COUNT];
+	alignas(64) std::atomic<uint32_t> write_index{ 0 };
+	alignas(64) std::atomic<uint32_t> read_index{ 0 };
+
+	static uint32_t _next(uint32_t p_index) {
+		return p_index + 1 == SLOT_COUNT ? 0 : p_index + 1;
+	}
+
+public:
+	static constexpr uint32_t capacity() { return CAPACITY; }
+
+	// Direct access to every slot, to preallocate them before both threads start.
+	T &get_slot(uint32_t p_index) { return slots[p_index]; }
+	static constexpr uint32_t get_slot_count() { return SLOT_COUNT; }
+
+	// Producer side. Returns nullptr when the queue is full.
+	T *get_write_slot() {
+		const uint32_t index = write_index.load(std::memory_order_relaxed);
+		if (_next(index) == read_index.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+		return &slots[index];
+	}
+
+	void commit_write() {
+		write_index.store(_next(write_index.load(std::memory_order_relaxed)), std::memory_order_release);
+	}
+
+	// Consumer side. Returns nullptr when the queue is empty.
+	T *get_read_slot() {
+		const uint32_t index = read_index.load(std::memory_order_relaxed);
+		if (index == write_index.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+		return &slots[index];
+	}
+
+	void commit_read() {
+		read_index.store(_next(read_index.load(std::memory_order_relaxed)), std::memory_order_release);
+	}
+
+	uint32_t size() const {
+		const uint32_t write = write_index.load(std::memory_order_acquire);
+		const uint32_t read = read_index.load(std::memory_order_acquire);
+		return write >= read ? write - read : write + SLOT_COUNT - read;
+	}
+};
+
+#endif // SPSC_RING_BUFFER_H
@@ -12,7 +12,10 @@ def configure(env):
 def get_doc_classes():
     return [
         "SQLite",
+        "SQLiteCursor",
         "SQLiteQuery",
+        "SQLiteTask",
+        "SQLiteWorker",
     ]
 
 
@@ -0,0 +1,80 @@
+extends Node
+
+# Writes the same rows through SQLite and through SQLiteWorker and reports how
+# long the main thread was blocked in each case.
+
+const ROW_COUNT := 10000
+const ROWS_PER_FRAME := 250
+
+const SYNC_PATH := "user://async_benchmark_sync.db"
+const ASYNC_PATH := "user://async_benchmark_async.db"
+const CREATE_TABLE := "CREATE TABLE IF NOT EXISTS bench (id INTEGER, name TEXT, value REAL);"
+const INSERT_ROW := "INSERT INTO bench VALUES (?, ?, ?);"
+
+
+func _ready() -> void:
+	for path in [SYNC_PATH, ASYNC_PATH]:
+		DirAccess.remove_absolute(ProjectSettings.globalize_path(path))
+
+	var batches: Array = []
+	for first in range(0, ROW_COUNT, ROWS_PER_FRAME):
+		var rows: Array = []
+		for id in range(first, mini(first + ROWS_PER_FRAME, ROW_COUNT)):
+			rows.append([id, "item_%d" % id, id * 0.5])
+		batches.append(rows)
+
+	_report("SQLite", _run_sync(batches))
+	_report("SQLiteWorker", _run_async(batches))
+
+
+func _run_sync(batches: Array) -> Array:
+	var db := SQLite.new()
+	if not db.open(SYNC_PATH):
+		return []
+	db.fetch_rows(CREATE_TABLE)
+	var insert: SQLiteQuery = db.create_query(INSERT_ROW)
+
+	var stalls: Array = []
+	var start := Time.get_ticks_usec()
+	for rows in batches:
+		var frame_start := Time.get_ticks_usec()
+		insert.batch_execute(rows)
+		stalls.append(Time.get_ticks_usec() - frame_start)
+	stalls.append(Time.get_ticks_usec() - start)
+	db.close()
+	return stalls
+
+
+func _run_async(batches: Array) -> Array:
+	var worker := SQLiteWorker.new()
+	if not worker.open(ASYNC_PATH):
+		return []
+	worker.query(CREATE_TABLE)
+
+	var stalls: Array = []
+	var last: SQLiteTask
+	var start := Time.get_ticks_usec()
+	for rows in batches:
+		var frame_start := Time.get_ticks_usec()
+		for row in rows:
+			last = worker.query(INSERT_ROW, row)
+		stalls.append(Time.get_ticks_usec() - frame_start)
+	last.wait()
+	stalls.append(Time.get_ticks_usec() - start)
+	worker.close()
+	return stalls
+
+
+# The last entry of stalls is the wall time until every row was committed.
+func _report(label: String, stalls: Array) -> void:
+	if stalls.is_empty():
+		print("%s: failed to open the database." % label)
+		return
+	var total_usec: int = stalls.pop_back()
+	var stall_usec := 0
+	var worst_usec := 0
+	for stall in stalls:
+		stall_usec += stall
+		worst_usec = maxi(worst_usec, stall)
+	print("%s: %d rows, main thread blocked %.2f ms in total, worst frame %.2f ms, all rows committed after %.2f ms." % [
+			label, ROW_COUNT, stall_usec / 1000.0, worst_usec / 1000.0, total_usec / 1000.0])
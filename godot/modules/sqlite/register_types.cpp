@@ -32,17 +32,23 @@
 
 #include "core/object/class_db.h"
 #include "src/godot_sqlite.h"
+#include "src/godot_sqlite_vfs.h"
 
 void initialize_sqlite_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SERVERS) {
 		return;
 	}
+	SQLiteFileAccessVFS::register_vfs();
 	ClassDB::register_class<SQLite>();
 	ClassDB::register_class<SQLiteQuery>();
+	ClassDB::register_class<SQLiteCursor>();
+	ClassDB::register_class<SQLiteTask>();
+	ClassDB::register_class<SQLiteWorker>();
 }
 
 void uninitialize_sqlite_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SERVERS) {
 		return;
 	}
+	SQLiteFileAccessVFS::unregister_vfs();
 }
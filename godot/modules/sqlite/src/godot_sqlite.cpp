@@ -36,50 +36,190 @@
 #include "sqlite/sqlite3.h"
 
 #include "godot_sqlite.h"
+#include "godot_sqlite_vfs.h"
 
-Array fast_parse_row(sqlite3_stmt *stmt) {
+static Variant column_value(sqlite3_stmt *stmt, int column) {
+	const int column_type = sqlite3_column_type(stmt, column);
+	switch (column_type) {
+		case SQLITE_INTEGER:
+			return Variant((int64_t)sqlite3_column_int64(stmt, column));
+
+		case SQLITE_FLOAT:
+			return Variant(sqlite3_column_double(stmt, column));
+
+		case SQLITE_TEXT: {
+			int size = sqlite3_column_bytes(stmt, column);
+			return Variant(String::utf8((const char *)sqlite3_column_text(stmt, column), size));
+		}
+		case SQLITE_BLOB: {
+			PackedByteArray arr;
+			int size = sqlite3_column_bytes(stmt, column);
+			arr.resize(size);
+			if (size > 0) {
+				memcpy(arr.ptrw(), sqlite3_column_blob(stmt, column), size);
+			}
+			return Variant(arr);
+		}
+		case SQLITE_NULL:
+			return Variant();
+		default:
+			ERR_PRINT("This kind of data is not yet supported: " + itos(column_type));
+			return Variant();
+	}
+}
+
+static Array fast_parse_row(sqlite3_stmt *stmt) {
 	Array result;
 
 	const int column_count = sqlite3_column_count(stmt);
+	result.resize(column_count);
 
 	for (int i = 0; i < column_count; i++) {
-		const int column_type = sqlite3_column_type(stmt, i);
-		Variant value;
-		switch (column_type) {
-			case SQLITE_INTEGER:
-				value = Variant(sqlite3_column_int(stmt, i));
-				break;
+		result[i] = column_value(stmt, i);
+	}
 
-			case SQLITE_FLOAT:
-				value = Variant(sqlite3_column_double(stmt, i));
-				break;
+	return result;
+}
 
-			case SQLITE_TEXT: {
-				int size = sqlite3_column_bytes(stmt, i);
-				String str =
-						String::utf8((const char *)sqlite3_column_text(stmt, i), size);
-				value = Variant(str);
-				break;
+static Vector<String> column_names(sqlite3_stmt *stmt) {
+	Vector<String> names;
+	const int column_count = sqlite3_column_count(stmt);
+	names.resize(column_count);
+	for (int i = 0; i < column_count; i++) {
+		names.write[i] = String::utf8(sqlite3_column_name(stmt, i));
+	}
+	return names;
+}
+
+// Collects one result column into a typed packed array. The array type is
+// picked by the first non-NULL value; NULLs read as 0 or an empty string.
+// Integers in a REAL column are widened, blobs and any other mix of types
+// fall back to a plain Array of Variants.
+class ColumnBuilder {
+	int type = SQLITE_NULL;
+	int64_t size = 0;
+	PackedInt64Array ints;
+	PackedFloat64Array floats;
+	PackedStringArray strings;
+	Array values;
+	bool generic = false;
+
+	void make_generic() {
+		values.resize(size);
+		for (int64_t i = 0; i < size; i++) {
+			switch (type) {
+				case SQLITE_INTEGER:
+					values[i] = ints[i];
+					break;
+				case SQLITE_FLOAT:
+					values[i] = floats[i];
+					break;
+				case SQLITE_TEXT:
+					values[i] = strings[i];
+					break;
+				default:
+					break;
 			}
-			case SQLITE_BLOB: {
-				PackedByteArray arr;
-				int size = sqlite3_column_bytes(stmt, i);
-				arr.resize(size);
-				memcpy(arr.ptrw(), sqlite3_column_blob(stmt, i), size);
-				value = Variant(arr);
-				break;
+		}
+		ints.clear();
+		floats.clear();
+		strings.clear();
+		generic = true;
+	}
+
+public:
+	void append(sqlite3_stmt *stmt, int column) {
+		const int value_type = sqlite3_column_type(stmt, column);
+		if (type == SQLITE_NULL && value_type != SQLITE_NULL && !generic) {
+			// First real value, pad the NULLs seen so far.
+			type = value_type;
+			switch (type) {
+				case SQLITE_INTEGER:
+					ints.resize(size);
+					ints.fill(0);
+					break;
+				case SQLITE_FLOAT:
+					floats.resize(size);
+					floats.fill(0.0);
+					break;
+				case SQLITE_TEXT:
+					strings.resize(size);
+					break;
+				default:
+					values.resize(size);
+					generic = true;
+					break;
 			}
-			case SQLITE_NULL: {
-			} break;
-			default:
-				ERR_PRINT("This kind of data is not yet supported: " + itos(column_type));
-				break;
+		}
+		if (!generic && value_type != type && value_type != SQLITE_NULL &&
+				!(type == SQLITE_FLOAT && value_type == SQLITE_INTEGER)) {
+			make_generic();
 		}
 
-		result.push_back(value);
+		if (generic) {
+			values.push_back(column_value(stmt, column));
+		} else {
+			switch (type) {
+				case SQLITE_INTEGER:
+					ints.push_back(sqlite3_column_int64(stmt, column));
+					break;
+				case SQLITE_FLOAT:
+					floats.push_back(sqlite3_column_double(stmt, column));
+					break;
+				case SQLITE_TEXT: {
+					int bytes = sqlite3_column_bytes(stmt, column);
+					strings.push_back(String::utf8((const char *)sqlite3_column_text(stmt, column), bytes));
+				} break;
+				default:
+					break;
+			}
+		}
+		size++;
 	}
 
-	return result;
+	Variant get_result() const {
+		if (generic) {
+			return values;
+		}
+		switch (type) {
+			case SQLITE_INTEGER:
+				return ints;
+			case SQLITE_FLOAT:
+				return floats;
+			case SQLITE_TEXT:
+				return strings;
+			default: {
+				// Only NULLs.
+				Array nulls;
+				nulls.resize(size);
+				return nulls;
+			}
+		}
+	}
+};
+
+// Steps stmt up to p_max_rows times (-1 for no limit) and appends every row to
+// r_columns, keyed by column name. Returns the last sqlite3_step result.
+static int fetch_columnar(sqlite3_stmt *stmt, int p_max_rows, Dictionary &r_columns) {
+	const int column_count = sqlite3_column_count(stmt);
+	LocalVector<ColumnBuilder> builders;
+	builders.resize(column_count);
+
+	int res = SQLITE_ROW;
+	for (int row = 0; p_max_rows < 0 || row < p_max_rows; row++) {
+		res = sqlite3_step(stmt);
+		if (res != SQLITE_ROW) {
+			break;
+		}
+		for (int i = 0; i < column_count; i++) {
+			builders[i].append(stmt, i);
+		}
+	}
+
+	for (int i = 0; i < column_count; i++) {
+		r_columns[String::utf8(sqlite3_column_name(stmt, i))] = builders[i].get_result();
+	}
+	return res;
 }
 
 SQLiteQuery::SQLiteQuery() {}
@@ -151,6 +291,8 @@ void SQLiteQuery::_bind_methods() {
 			DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("batch_execute", "rows"),
 			&SQLiteQuery::batch_execute);
+	ClassDB::bind_method(D_METHOD("execute_columns", "arguments"),
+			&SQLiteQuery::execute_columns, DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("get_columns"), &SQLiteQuery::get_columns);
 }
 
@@ -165,6 +307,12 @@ bool SQLite::open_in_memory() {
 }
 
 void SQLite::close() {
+	// Cursors hold statements of this connection, close them first.
+	while (cursors.size()) {
+		cursors[cursors.size() - 1]->close();
+	}
+	clear_statement_cache();
+
 	// Finalize all queries before close the DB.
 	// Reverse order because I need to remove the not available queries.
 	for (uint32_t i = queries.size(); i > 0; i -= 1) {
@@ -212,60 +360,24 @@ sqlite3_stmt *SQLite::prepare(const char *query) {
 	return stmt;
 }
 
-Dictionary SQLite::parse_row(sqlite3_stmt *stmt, int result_type) {
+Dictionary SQLite::parse_row(sqlite3_stmt *stmt, int result_type, const Vector<String> &column_names) {
 	Dictionary result;
 
 	// Get column count
-	int col_count = sqlite3_column_count(stmt);
+	int col_count = column_names.size();
 
 	// Fetch all column
 	for (int i = 0; i < col_count; i++) {
-		// Key name
-		const char *col_name = sqlite3_column_name(stmt, i);
-		String key = String(col_name);
-
-		// Value
-		int col_type = sqlite3_column_type(stmt, i);
-		Variant value;
-
-		// Get column value
-		switch (col_type) {
-			case SQLITE_INTEGER:
-				value = Variant(sqlite3_column_int(stmt, i));
-				break;
-
-			case SQLITE_FLOAT:
-				value = Variant(sqlite3_column_double(stmt, i));
-				break;
-
-			case SQLITE_TEXT: {
-				int size = sqlite3_column_bytes(stmt, i);
-				String str =
-						String::utf8((const char *)sqlite3_column_text(stmt, i), size);
-				value = Variant(str);
-				break;
-			}
-			case SQLITE_BLOB: {
-				PackedByteArray arr;
-				int size = sqlite3_column_bytes(stmt, i);
-				arr.resize(size);
-				memcpy((void *)arr.ptr(), sqlite3_column_blob(stmt, i), size);
-				value = Variant(arr);
-				break;
-			}
-
-			default:
-				break;
-		}
+		Variant value = column_value(stmt, i);
 
 		// Set dictionary value
 		if (result_type == RESULT_NUM) {
 			result[i] = value;
 		} else if (result_type == RESULT_ASSOC) {
-			result[key] = value;
+			result[column_names[i]] = value;
 		} else {
 			result[i] = value;
-			result[key] = value;
+			result[column_names[i]] = value;
 		}
 	}
 
@@ -291,11 +403,30 @@ void SQLite::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("open_in_memory"), &SQLite::open_in_memory);
 	ClassDB::bind_method(D_METHOD("open_buffered", "path", "buffers", "size"),
 			&SQLite::open_buffered);
+	ClassDB::bind_method(D_METHOD("open_read_only", "path", "cache_size_kib"),
+			&SQLite::open_read_only, DEFVAL(2048));
 
 	ClassDB::bind_method(D_METHOD("close"), &SQLite::close);
 
 	ClassDB::bind_method(D_METHOD("create_query", "statement"),
 			&SQLite::create_query);
+	ClassDB::bind_method(D_METHOD("fetch_rows", "statement", "arguments", "result_type"),
+			&SQLite::fetch_rows, DEFVAL(Array()), DEFVAL(RESULT_BOTH));
+	ClassDB::bind_method(D_METHOD("fetch_columns", "statement", "arguments"),
+			&SQLite::fetch_columns, DEFVAL(Array()));
+	ClassDB::bind_method(D_METHOD("open_cursor", "statement", "arguments"),
+			&SQLite::open_cursor, DEFVAL(Array()));
+
+	ClassDB::bind_method(D_METHOD("set_statement_cache_size", "size"),
+			&SQLite::set_statement_cache_size);
+	ClassDB::bind_method(D_METHOD("get_statement_cache_size"),
+			&SQLite::get_statement_cache_size);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "statement_cache_size", PROPERTY_HINT_RANGE, "0,1024,1"),
+			"set_statement_cache_size", "get_statement_cache_size");
+
+	BIND_CONSTANT(RESULT_BOTH);
+	BIND_CONSTANT(RESULT_NUM);
+	BIND_CONSTANT(RESULT_ASSOC);
 }
 
 bool SQLite::open(const String &path) {
@@ -389,6 +520,29 @@ bool SQLite::bind_args(sqlite3_stmt *stmt, const Array &args) {
 	return true;
 }
 
+bool SQLite::open_read_only(const String &path, int cache_size_kib) {
+	const String file_path = path.strip_edges();
+	if (!file_path.length()) {
+		return false;
+	}
+	ERR_FAIL_COND_V(cache_size_kib < 0, false);
+
+	int result = sqlite3_open_v2(file_path.utf8().get_data(), &db, SQLITE_OPEN_READONLY,
+			SQLiteFileAccessVFS::NAME);
+	if (result != SQLITE_OK) {
+		print_error("Cannot open read-only database: " + String(sqlite3_errstr(result)));
+		sqlite3_close_v2(db);
+		db = nullptr;
+		return false;
+	}
+
+	// Pages are read from the file on demand; only this many KiB of them are
+	// kept in memory.
+	const String cache_pragma = "PRAGMA cache_size = -" + itos(cache_size_kib) + ";";
+	sqlite3_exec(db, cache_pragma.utf8().get_data(), nullptr, nullptr, nullptr);
+	return true;
+}
+
 bool SQLite::open_buffered(const String &name, const PackedByteArray &buffers, int64_t size) {
 	if (!name.strip_edges().length()) {
 		return false;
@@ -448,6 +602,32 @@ Variant SQLiteQuery::execute(const Array p_args) {
 	return result;
 }
 
+Variant SQLiteQuery::execute_columns(const Array p_args) {
+	if (is_ready() == false) {
+		ERR_FAIL_COND_V(prepare() == false, Variant());
+	}
+
+	ERR_FAIL_NULL_V(stmt, Variant());
+
+	if (!SQLite::bind_args(stmt, p_args)) {
+		ERR_FAIL_V_MSG(Variant(),
+				"Error during arguments set: " + get_last_error_message());
+	}
+
+	Dictionary result;
+	const int res = fetch_columnar(stmt, -1, result);
+	if (res != SQLITE_DONE) {
+		ERR_PRINT("There was an error during an SQL execution: " + get_last_error_message());
+	}
+
+	if (SQLITE_OK != sqlite3_reset(stmt)) {
+		finalize();
+		ERR_FAIL_V_MSG(result, "Was not possible to reset the query: " + get_last_error_message());
+	}
+
+	return result;
+}
+
 Variant SQLiteQuery::batch_execute(Array p_rows) {
 	Array res;
 	for (int i = 0; i < p_rows.size(); i += 1) {
@@ -474,3 +654,474 @@ Ref<SQLiteQuery> SQLite::create_query(String p_query) {
 
 	return query;
 }
+
+void SQLite::_finalize_cached_statement(String &p_query, sqlite3_stmt *&p_stmt) {
+	sqlite3_finalize(p_stmt);
+	p_stmt = nullptr;
+}
+
+sqlite3_stmt *SQLite::acquire_statement(const String &query) {
+	sqlite3_stmt *const *cached = statement_cache.getptr(query);
+	if (cached) {
+		sqlite3_stmt *stmt = *cached;
+		statement_cache.erase(query);
+		return stmt;
+	}
+	return prepare(query.utf8().get_data());
+}
+
+void SQLite::release_statement(const String &query, sqlite3_stmt *stmt) {
+	if (stmt == nullptr) {
+		return;
+	}
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	if (statement_cache_size == 0) {
+		sqlite3_finalize(stmt);
+		return;
+	}
+	// Replaces (and finalizes) an identical statement released earlier.
+	statement_cache.insert(query, stmt);
+}
+
+void SQLite::clear_statement_cache() {
+	// LRUCache::clear() skips the eviction callback, shrinking to zero does not.
+	statement_cache.set_capacity(0);
+	statement_cache = StatementCache(statement_cache_size);
+}
+
+void SQLite::set_statement_cache_size(int p_size) {
+	ERR_FAIL_COND(p_size < 0);
+	statement_cache_size = p_size;
+	if (p_size == 0 || statement_cache.get_capacity() == 0) {
+		clear_statement_cache();
+	} else {
+		statement_cache.set_capacity(p_size);
+	}
+}
+
+int SQLite::get_statement_cache_size() const {
+	return statement_cache_size;
+}
+
+Array SQLite::fetch_rows(const String &query, const Array &args, int result_type) {
+	sqlite3_stmt *stmt = acquire_statement(query);
+	ERR_FAIL_NULL_V(stmt, Array());
+
+	if (!bind_args(stmt, args)) {
+		release_statement(query, stmt);
+		ERR_FAIL_V_MSG(Array(), "Error during arguments set: " + get_last_error_message());
+	}
+
+	const Vector<String> names = column_names(stmt);
+	Array result;
+	while (true) {
+		const int res = sqlite3_step(stmt);
+		if (res == SQLITE_ROW) {
+			result.append(parse_row(stmt, result_type, names));
+		} else if (res == SQLITE_DONE) {
+			break;
+		} else {
+			ERR_BREAK_MSG(true, "There was an error during an SQL execution: " + get_last_error_message());
+		}
+	}
+
+	release_statement(query, stmt);
+	return result;
+}
+
+Dictionary SQLite::fetch_columns(const String &query, const Array &args) {
+	sqlite3_stmt *stmt = acquire_statement(query);
+	ERR_FAIL_NULL_V(stmt, Dictionary());
+
+	if (!bind_args(stmt, args)) {
+		release_statement(query, stmt);
+		ERR_FAIL_V_MSG(Dictionary(), "Error during arguments set: " + get_last_error_message());
+	}
+
+	Dictionary result;
+	if (fetch_columnar(stmt, -1, result) != SQLITE_DONE) {
+		ERR_PRINT("There was an error during an SQL execution: " + get_last_error_message());
+	}
+
+	release_statement(query, stmt);
+	return result;
+}
+
+Ref<SQLiteCursor> SQLite::open_cursor(const String &query, const Array &args) {
+	sqlite3_stmt *stmt = acquire_statement(query);
+	ERR_FAIL_NULL_V(stmt, Ref<SQLiteCursor>());
+
+	if (!bind_args(stmt, args)) {
+		release_statement(query, stmt);
+		ERR_FAIL_V_MSG(Ref<SQLiteCursor>(), "Error during arguments set: " + get_last_error_message());
+	}
+
+	Ref<SQLiteCursor> cursor;
+	cursor.instantiate();
+	cursor->db = Ref<SQLite>(this);
+	cursor->stmt = stmt;
+	cursor->query = query;
+	cursors.push_back(cursor.ptr());
+	return cursor;
+}
+
+Array SQLiteCursor::fetch(int p_max_rows) {
+	Array result;
+	ERR_FAIL_COND_V(p_max_rows <= 0, result);
+	if (finished || stmt == nullptr) {
+		return result;
+	}
+
+	for (int row = 0; row < p_max_rows; row++) {
+		const int res = sqlite3_step(stmt);
+		if (res == SQLITE_ROW) {
+			result.append(fast_parse_row(stmt));
+			continue;
+		}
+		if (res != SQLITE_DONE) {
+			ERR_PRINT("There was an error during an SQL execution: " + db->get_last_error_message());
+		}
+		close();
+		break;
+	}
+	return result;
+}
+
+Dictionary SQLiteCursor::fetch_columns(int p_max_rows) {
+	Dictionary result;
+	ERR_FAIL_COND_V(p_max_rows <= 0, result);
+	if (finished || stmt == nullptr) {
+		return result;
+	}
+
+	const int res = fetch_columnar(stmt, p_max_rows, result);
+	if (res != SQLITE_ROW) {
+		if (res != SQLITE_DONE) {
+			ERR_PRINT("There was an error during an SQL execution: " + db->get_last_error_message());
+		}
+		close();
+	}
+	return result;
+}
+
+Array SQLiteCursor::get_columns() const {
+	Array res;
+	if (stmt == nullptr) {
+		return res;
+	}
+	const Vector<String> names = column_names(stmt);
+	res.resize(names.size());
+	for (int i = 0; i < names.size(); i++) {
+		res[i] = names[i];
+	}
+	return res;
+}
+
+bool SQLiteCursor::is_finished() const {
+	return finished;
+}
+
+void SQLiteCursor::close() {
+	finished = true;
+	if (db.is_null()) {
+		return;
+	}
+	db->cursors.erase(this);
+	db->release_statement(query, stmt);
+	stmt = nullptr;
+	// Dropping the reference may free the database, do it last.
+	db.unref();
+}
+
+SQLiteCursor::~SQLiteCursor() {
+	close();
+}
+
+void SQLiteCursor::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("fetch", "max_rows"), &SQLiteCursor::fetch, DEFVAL(1024));
+	ClassDB::bind_method(D_METHOD("fetch_columns", "max_rows"), &SQLiteCursor::fetch_columns, DEFVAL(1024));
+	ClassDB::bind_method(D_METHOD("get_columns"), &SQLiteCursor::get_columns);
+	ClassDB::bind_method(D_METHOD("is_finished"), &SQLiteCursor::is_finished);
+	ClassDB::bind_method(D_METHOD("close"), &SQLiteCursor::close);
+}
+
+void SQLiteTask::_complete() {
+	completed.set();
+	completed_semaphore.post();
+	callable_mp(this, &SQLiteTask::_emit_completed).call_deferred();
+}
+
+void SQLiteTask::_emit_completed() {
+	emit_signal(SNAME("completed"), result);
+}
+
+bool SQLiteTask::is_completed() const {
+	return completed.is_set();
+}
+
+bool SQLiteTask::has_error() const {
+	return completed.is_set() && !error.is_empty();
+}
+
+String SQLiteTask::get_error() const {
+	ERR_FAIL_COND_V_MSG(!completed.is_set(), String(), "The task has not completed yet.");
+	return error;
+}
+
+Array SQLiteTask::get_result() const {
+	ERR_FAIL_COND_V_MSG(!completed.is_set(), Array(), "The task has not completed yet.");
+	return result;
+}
+
+Array SQLiteTask::wait() {
+	if (!completed.is_set()) {
+		completed_semaphore.wait();
+		// Let other waiters through as well.
+		completed_semaphore.post();
+	}
+	return result;
+}
+
+void SQLiteTask::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("is_completed"), &SQLiteTask::is_completed);
+	ClassDB::bind_method(D_METHOD("has_error"), &SQLiteTask::has_error);
+	ClassDB::bind_method(D_METHOD("get_error"), &SQLiteTask::get_error);
+	ClassDB::bind_method(D_METHOD("get_result"), &SQLiteTask::get_result);
+	ClassDB::bind_method(D_METHOD("wait"), &SQLiteTask::wait);
+
+	ADD_SIGNAL(MethodInfo("completed", PropertyInfo(Variant::ARRAY, "result")));
+}
+
+bool SQLiteWorker::open(const String &p_path) {
+	ERR_FAIL_COND_V_MSG(db != nullptr, false, "The worker already has an open database.");
+	ERR_FAIL_COND_V_MSG(p_path.begins_with("res://") && !Engine::get_singleton()->is_editor_hint(), false,
+			"SQLiteWorker needs a writable database; res:// is read-only once exported.");
+	String path = p_path.strip_edges();
+	ERR_FAIL_COND_V(path.is_empty(), false);
+	if (path != ":memory:") {
+		path = ProjectSettings::get_singleton()->globalize_path(path);
+	}
+
+	int result = sqlite3_open_v2(path.utf8().get_data(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+	if (result != SQLITE_OK) {
+		print_error("Cannot open database: " + String(sqlite3_errstr(result)));
+		sqlite3_close_v2(db);
+		db = nullptr;
+		return false;
+	}
+
+	// One writer, many readers: WAL lets other connections keep reading while
+	// the worker writes, and NORMAL sync is safe in WAL mode.
+	sqlite3_exec(db, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+	sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+	sqlite3_busy_timeout(db, 5000);
+
+	exit_requested = false;
+	thread.start(&SQLiteWorker::_thread_func, this);
+	return true;
+}
+
+void SQLiteWorker::close() {
+	if (db == nullptr) {
+		return;
+	}
+
+	// Everything queued so far still runs before the thread exits.
+	{
+		MutexLock lock(mutex);
+		exit_requested = true;
+	}
+	semaphore.post();
+	thread.wait_to_finish();
+
+	if (sqlite3_close_v2(db) != SQLITE_OK) {
+		print_error("Cannot close database: " + String(sqlite3_errmsg(db)));
+	}
+	db = nullptr;
+}
+
+bool SQLiteWorker::is_open() const {
+	return db != nullptr;
+}
+
+Ref<SQLiteTask> SQLiteWorker::query(const String &p_statement, const Array &p_arguments) {
+	ERR_FAIL_COND_V_MSG(db == nullptr, Ref<SQLiteTask>(), "Cannot queue query. The database was not opened.");
+
+	Ref<SQLiteTask> task;
+	task.instantiate();
+	task->query = p_statement;
+	// The arguments are read on the worker thread, keep a private copy.
+	task->arguments = p_arguments.duplicate(true);
+	{
+		MutexLock lock(mutex);
+		pending_tasks.push_back(task);
+	}
+	semaphore.post();
+	return task;
+}
+
+void SQLiteWorker::set_max_transaction_size(int p_size) {
+	ERR_FAIL_COND(p_size < 1);
+	MutexLock lock(mutex);
+	max_transaction_size = p_size;
+}
+
+int SQLiteWorker::get_max_transaction_size() const {
+	return max_transaction_size;
+}
+
+void SQLiteWorker::_thread_func(void *p_self) {
+	SQLiteWorker *self = static_cast<SQLiteWorker *>(p_self);
+	SQLite::StatementCache statements(64);
+	LocalVector<Ref<SQLiteTask>> tasks;
+
+	while (true) {
+		self->semaphore.wait();
+
+		bool exit;
+		{
+			MutexLock lock(self->mutex);
+			tasks = self->pending_tasks;
+			self->pending_tasks.clear();
+			exit = self->exit_requested;
+		}
+
+		self->_run_tasks(tasks, statements);
+		tasks.clear();
+
+		if (exit) {
+			break;
+		}
+	}
+
+	statements.set_capacity(0);
+}
+
+void SQLiteWorker::_run_task(sqlite3_stmt *p_stmt, SQLiteTask *p_task) {
+	if (!SQLite::bind_args(p_stmt, p_task->arguments)) {
+		p_task->error = "Error during arguments set: " + String(sqlite3_errmsg(db));
+		return;
+	}
+
+	while (true) {
+		const int res = sqlite3_step(p_stmt);
+		if (res == SQLITE_ROW) {
+			p_task->result.append(fast_parse_row(p_stmt));
+		} else if (res == SQLITE_DONE) {
+			break;
+		} else {
+			p_task->error = String::utf8(sqlite3_errmsg(db));
+			break;
+		}
+	}
+}
+
+void SQLiteWorker::_run_tasks(LocalVector<Ref<SQLiteTask>> &p_tasks, SQLite::StatementCache &r_statements) {
+	int transaction_size;
+	{
+		MutexLock lock(mutex);
+		transaction_size = max_transaction_size;
+	}
+
+	auto acquire = [&](SQLiteTask *p_task) -> sqlite3_stmt * {
+		sqlite3_stmt *const *cached = r_statements.getptr(p_task->query);
+		if (cached) {
+			sqlite3_stmt *stmt = *cached;
+			r_statements.erase(p_task->query);
+			return stmt;
+		}
+		sqlite3_stmt *stmt = nullptr;
+		if (sqlite3_prepare_v2(db, p_task->query.utf8().get_data(), -1, &stmt, nullptr) != SQLITE_OK) {
+			p_task->error = "SQL Error: " + String::utf8(sqlite3_errmsg(db));
+			sqlite3_finalize(stmt);
+			return nullptr;
+		}
+		return stmt;
+	};
+	auto release = [&](SQLiteTask *p_task, sqlite3_stmt *p_stmt) {
+		sqlite3_reset(p_stmt);
+		sqlite3_clear_bindings(p_stmt);
+		r_statements.insert(p_task->query, p_stmt);
+	};
+
+	uint32_t i = 0;
+	while (i < p_tasks.size()) {
+		SQLiteTask *task = p_tasks[i].ptr();
+		sqlite3_stmt *stmt = acquire(task);
+		if (stmt == nullptr) {
+			task->_complete();
+			i++;
+			continue;
+		}
+
+		const bool coalesce = !sqlite3_stmt_readonly(stmt) && sqlite3_get_autocommit(db) &&
+				i + 1 < p_tasks.size() && transaction_size > 1;
+		if (!coalesce ||
+				sqlite3_exec(db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+			_run_task(stmt, task);
+			release(task, stmt);
+			task->_complete();
+			i++;
+			continue;
+		}
+
+		// Run this write and the writes queued right after it in one transaction.
+		// Reads and transaction control statements end the group.
+		const uint32_t group_begin = i;
+		bool rolled_back = false;
+		while (true) {
+			_run_task(stmt, task);
+			release(task, stmt);
+			i++;
+			if (sqlite3_get_autocommit(db)) {
+				// The error made SQLite roll the transaction back.
+				rolled_back = true;
+				break;
+			}
+			if (i >= p_tasks.size() || int(i - group_begin) >= transaction_size) {
+				break;
+			}
+			task = p_tasks[i].ptr();
+			stmt = acquire(task);
+			if (stmt == nullptr) {
+				break;
+			}
+			if (sqlite3_stmt_readonly(stmt)) {
+				release(task, stmt);
+				break;
+			}
+		}
+
+		String group_error;
+		if (rolled_back) {
+			group_error = "The transaction was rolled back: " + String::utf8(sqlite3_errmsg(db));
+		} else if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+			group_error = "Cannot commit the transaction: " + String::utf8(sqlite3_errmsg(db));
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		}
+		for (uint32_t j = group_begin; j < i; j++) {
+			SQLiteTask *group_task = p_tasks[j].ptr();
+			if (!group_error.is_empty() && group_task->error.is_empty()) {
+				group_task->error = group_error;
+			}
+			group_task->_complete();
+		}
+	}
+}
+
+SQLiteWorker::~SQLiteWorker() {
+	close();
+}
+
+void SQLiteWorker::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("open", "path"), &SQLiteWorker::open);
+	ClassDB::bind_method(D_METHOD("close"), &SQLiteWorker::close);
+	ClassDB::bind_method(D_METHOD("is_open"), &SQLiteWorker::is_open);
+	ClassDB::bind_method(D_METHOD("query", "statement", "arguments"), &SQLiteWorker::query, DEFVAL(Array()));
+
+	ClassDB::bind_method(D_METHOD("set_max_transaction_size", "size"), &SQLiteWorker::set_max_transaction_size);
+	ClassDB::bind_method(D_METHOD("get_max_transaction_size"), &SQLiteWorker::get_max_transaction_size);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_transaction_size", PROPERTY_HINT_RANGE, "1,65536,1"),
+			"set_max_transaction_size", "get_max_transaction_size");
+}
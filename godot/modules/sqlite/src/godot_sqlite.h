@@ -32,11 +32,17 @@
 #define GODOT_SQLITE_H
 
 #include "core/object/ref_counted.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/templates/safe_refcount.h"
 #include "core/templates/local_vector.h"
+#include "core/templates/lru.h"
 #include "spmemvfs/spmemvfs.h"
 #include "sqlite/sqlite3.h"
 
 class SQLite;
+class SQLiteWorker;
 
 class SQLiteQuery : public RefCounted {
 	GDCLASS(SQLiteQuery, RefCounted);
@@ -57,28 +63,68 @@ public:
 	Array get_columns();
 	void finalize();
 	Variant execute(const Array p_args);
+	Variant execute_columns(const Array p_args);
 	Variant batch_execute(Array p_rows);
 
 private:
 	bool prepare();
 };
 
+// Streams the rows of a statement in chunks instead of collecting the whole
+// result up front. The statement is checked out of the database's statement
+// cache while the cursor is open and handed back once it is exhausted.
+class SQLiteCursor : public RefCounted {
+	GDCLASS(SQLiteCursor, RefCounted);
+
+	friend SQLite;
+
+	Ref<SQLite> db;
+	sqlite3_stmt *stmt = nullptr;
+	String query;
+	bool finished = false;
+
+protected:
+	static void _bind_methods();
+
+public:
+	Array fetch(int p_max_rows = 1024);
+	Dictionary fetch_columns(int p_max_rows = 1024);
+	Array get_columns() const;
+	bool is_finished() const;
+	void close();
+
+	~SQLiteCursor();
+};
+
 class SQLite : public RefCounted {
 	GDCLASS(SQLite, RefCounted);
 
 	friend SQLiteQuery;
+	friend SQLiteCursor;
+	friend SQLiteWorker;
 
 private:
+	static void _finalize_cached_statement(String &p_query, sqlite3_stmt *&p_stmt);
+	typedef LRUCache<String, sqlite3_stmt *, HashMapHasherDefault, HashMapComparatorDefault<String>, &SQLite::_finalize_cached_statement> StatementCache;
+
 	sqlite3 *db = nullptr;
 	spmemvfs_db_t spmemvfs_db{};
 	bool memory_read = false;
 
 	::LocalVector<WeakRef *, uint32_t, true> queries;
+	::LocalVector<SQLiteCursor *> cursors;
+
+	// Prepared statements keyed by their SQL text. A statement is taken out of
+	// the cache while it is in use, so two users never share one.
+	int statement_cache_size = 32;
+	StatementCache statement_cache = StatementCache(32);
 
 	sqlite3_stmt *prepare(const char *statement);
-	Array fetch_rows(const String &query, const Array &args, int result_type = RESULT_BOTH);
+	sqlite3_stmt *acquire_statement(const String &query);
+	void release_statement(const String &query, sqlite3_stmt *stmt);
+	void clear_statement_cache();
 	sqlite3 *get_handler() const { return memory_read ? spmemvfs_db.handle : db; }
-	Dictionary parse_row(sqlite3_stmt *stmt, int result_type);
+	Dictionary parse_row(sqlite3_stmt *stmt, int result_type, const Vector<String> &column_names);
 
 public:
 	static bool bind_args(sqlite3_stmt *stmt, const Array &args);
@@ -97,10 +143,81 @@ public:
 	bool open(const String &path);
 	bool open_in_memory();
 	bool open_buffered(const String &name, const PackedByteArray &buffers, int64_t size);
+	bool open_read_only(const String &path, int cache_size_kib = 2048);
 	void close();
 
 	Ref<SQLiteQuery> create_query(String p_query);
+	Array fetch_rows(const String &query, const Array &args = Array(), int result_type = RESULT_BOTH);
+	Dictionary fetch_columns(const String &query, const Array &args = Array());
+	Ref<SQLiteCursor> open_cursor(const String &query, const Array &args = Array());
+
+	void set_statement_cache_size(int p_size);
+	int get_statement_cache_size() const;
 
 	String get_last_error_message() const;
 };
+
+// Completion handle for a statement queued on an SQLiteWorker. The result is
+// filled in on the worker thread; "completed" is emitted on the main thread.
+class SQLiteTask : public RefCounted {
+	GDCLASS(SQLiteTask, RefCounted);
+
+	friend SQLiteWorker;
+
+	String query;
+	Array arguments;
+	Array result;
+	String error;
+	SafeFlag completed;
+	Semaphore completed_semaphore;
+
+	void _complete();
+	void _emit_completed();
+
+protected:
+	static void _bind_methods();
+
+public:
+	bool is_completed() const;
+	bool has_error() const;
+	String get_error() const;
+	Array get_result() const;
+	Array wait();
+};
+
+// A database connection owned by a dedicated thread. Statements are queued
+// from any thread and run in order; consecutive writes are grouped into a
+// single transaction so a burst of inserts costs one commit. The database is
+// switched to WAL so readers on other connections are not blocked by it.
+class SQLiteWorker : public RefCounted {
+	GDCLASS(SQLiteWorker, RefCounted);
+
+	sqlite3 *db = nullptr;
+	Thread thread;
+	Mutex mutex;
+	Semaphore semaphore;
+	LocalVector<Ref<SQLiteTask>> pending_tasks; // Guarded by mutex.
+	bool exit_requested = false; // Guarded by mutex.
+	int max_transaction_size = 1024;
+
+	static void _thread_func(void *p_self);
+	void _run_tasks(LocalVector<Ref<SQLiteTask>> &p_tasks, SQLite::StatementCache &r_statements);
+	void _run_task(sqlite3_stmt *p_stmt, SQLiteTask *p_task);
+
+protected:
+	static void _bind_methods();
+
+public:
+	bool open(const String &p_path);
+	void close();
+	bool is_open() const;
+
+	Ref<SQLiteTask> query(const String &p_statement, const Array &p_arguments = Array());
+
+	void set_max_transaction_size(int p_size);
+	int get_max_transaction_size() const;
+
+	~SQLiteWorker();
+};
+
 #endif // GODOT_SQLITE_H
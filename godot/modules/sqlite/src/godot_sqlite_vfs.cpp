@@ -0,0 +1,244 @@
+/**************************************************************************/
+/*  godot_sqlite_vfs.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "godot_sqlite_vfs.h"
+
+#include "core/io/file_access.h"
+
+namespace {
+
+struct FileAccessFile {
+	sqlite3_file base;
+	Ref<FileAccess> file;
+	uint64_t length = 0;
+};
+
+// Everything unrelated to file access is forwarded to the platform VFS.
+sqlite3_vfs *fallback(sqlite3_vfs *p_vfs) {
+	return static_cast<sqlite3_vfs *>(p_vfs->pAppData);
+}
+
+int file_close(sqlite3_file *p_file) {
+	FileAccessFile *f = reinterpret_cast<FileAccessFile *>(p_file);
+	f->file.unref();
+	f->~FileAccessFile();
+	return SQLITE_OK;
+}
+
+int file_read(sqlite3_file *p_file, void *r_buffer, int p_amount, sqlite3_int64 p_offset) {
+	FileAccessFile *f = reinterpret_cast<FileAccessFile *>(p_file);
+	if (p_offset < 0) {
+		return SQLITE_IOERR_READ;
+	}
+	uint64_t read = 0;
+	if ((uint64_t)p_offset < f->length) {
+		f->file->seek(p_offset);
+		read = f->file->get_buffer(static_cast<uint8_t *>(r_buffer), p_amount);
+	}
+	if (read < (uint64_t)p_amount) {
+		// SQLite expects the missing tail to be zero filled.
+		memset(static_cast<uint8_t *>(r_buffer) + read, 0, p_amount - read);
+		return SQLITE_IOERR_SHORT_READ;
+	}
+	return SQLITE_OK;
+}
+
+int file_write(sqlite3_file *p_file, const void *p_buffer, int p_amount, sqlite3_int64 p_offset) {
+	return SQLITE_READONLY;
+}
+
+int file_truncate(sqlite3_file *p_file, sqlite3_int64 p_size) {
+	return SQLITE_READONLY;
+}
+
+int file_sync(sqlite3_file *p_file, int p_flags) {
+	return SQLITE_OK;
+}
+
+int file_size(sqlite3_file *p_file, sqlite3_int64 *r_size) {
+	*r_size = reinterpret_cast<FileAccessFile *>(p_file)->length;
+	return SQLITE_OK;
+}
+
+int file_lock(sqlite3_file *p_file, int p_lock) {
+	// Nothing can write to the file, so no locking is needed.
+	return SQLITE_OK;
+}
+
+int file_check_reserved_lock(sqlite3_file *p_file, int *r_result) {
+	*r_result = 0;
+	return SQLITE_OK;
+}
+
+int file_control(sqlite3_file *p_file, int p_op, void *p_arg) {
+	return SQLITE_NOTFOUND;
+}
+
+int file_sector_size(sqlite3_file *p_file) {
+	return 0;
+}
+
+int file_device_characteristics(sqlite3_file *p_file) {
+	// Tells SQLite the content never changes, which skips hot journal checks.
+	return SQLITE_IOCAP_IMMUTABLE;
+}
+
+const sqlite3_io_methods io_methods = {
+	1, // iVersion
+	file_close,
+	file_read,
+	file_write,
+	file_truncate,
+	file_sync,
+	file_size,
+	file_lock,
+	file_lock, // xUnlock
+	file_check_reserved_lock,
+	file_control,
+	file_sector_size,
+	file_device_characteristics,
+};
+
+int vfs_open(sqlite3_vfs *p_vfs, sqlite3_filename p_name, sqlite3_file *r_file, int p_flags, int *r_out_flags) {
+	r_file->pMethods = nullptr;
+	if (p_name == nullptr || !(p_flags & SQLITE_OPEN_MAIN_DB)) {
+		// Journals and temporary files are never needed for a read-only database.
+		return SQLITE_CANTOPEN;
+	}
+	if (p_flags & (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)) {
+		return SQLITE_READONLY;
+	}
+
+	Ref<FileAccess> file = FileAccess::open(String::utf8(p_name), FileAccess::READ);
+	if (file.is_null()) {
+		return SQLITE_CANTOPEN;
+	}
+
+	FileAccessFile *f = memnew_placement(r_file, FileAccessFile);
+	f->file = file;
+	f->length = file->get_length();
+	f->base.pMethods = &io_methods;
+	if (r_out_flags) {
+		*r_out_flags = SQLITE_OPEN_READONLY;
+	}
+	return SQLITE_OK;
+}
+
+int vfs_delete(sqlite3_vfs *p_vfs, const char *p_name, int p_sync_dir) {
+	return SQLITE_READONLY;
+}
+
+int vfs_access(sqlite3_vfs *p_vfs, const char *p_name, int p_flags, int *r_result) {
+	// Only the database itself exists; SQLite also asks for journals here.
+	*r_result = p_flags != SQLITE_ACCESS_READWRITE && FileAccess::exists(String::utf8(p_name));
+	return SQLITE_OK;
+}
+
+int vfs_full_pathname(sqlite3_vfs *p_vfs, const char *p_name, int p_out_size, char *r_out) {
+	// Godot paths (res://, user://) are already absolute.
+	sqlite3_snprintf(p_out_size, r_out, "%s", p_name);
+	return SQLITE_OK;
+}
+
+void *vfs_dl_open(sqlite3_vfs *p_vfs, const char *p_path) {
+	return fallback(p_vfs)->xDlOpen(fallback(p_vfs), p_path);
+}
+
+void vfs_dl_error(sqlite3_vfs *p_vfs, int p_size, char *r_message) {
+	fallback(p_vfs)->xDlError(fallback(p_vfs), p_size, r_message);
+}
+
+void (*vfs_dl_sym(sqlite3_vfs *p_vfs, void *p_handle, const char *p_symbol))(void) {
+	return fallback(p_vfs)->xDlSym(fallback(p_vfs), p_handle, p_symbol);
+}
+
+void vfs_dl_close(sqlite3_vfs *p_vfs, void *p_handle) {
+	fallback(p_vfs)->xDlClose(fallback(p_vfs), p_handle);
+}
+
+int vfs_randomness(sqlite3_vfs *p_vfs, int p_size, char *r_out) {
+	return fallback(p_vfs)->xRandomness(fallback(p_vfs), p_size, r_out);
+}
+
+int vfs_sleep(sqlite3_vfs *p_vfs, int p_microseconds) {
+	return fallback(p_vfs)->xSleep(fallback(p_vfs), p_microseconds);
+}
+
+int vfs_current_time(sqlite3_vfs *p_vfs, double *r_time) {
+	return fallback(p_vfs)->xCurrentTime(fallback(p_vfs), r_time);
+}
+
+int vfs_get_last_error(sqlite3_vfs *p_vfs, int p_size, char *r_message) {
+	return fallback(p_vfs)->xGetLastError(fallback(p_vfs), p_size, r_message);
+}
+
+} // namespace
+
+sqlite3_vfs SQLiteFileAccessVFS::vfs = {
+	1, // iVersion
+	sizeof(FileAccessFile), // szOsFile
+	1024, // mxPathname
+	nullptr, // pNext
+	SQLiteFileAccessVFS::NAME,
+	nullptr, // pAppData, the default VFS once registered
+	vfs_open,
+	vfs_delete,
+	vfs_access,
+	vfs_full_pathname,
+	vfs_dl_open,
+	vfs_dl_error,
+	vfs_dl_sym,
+	vfs_dl_close,
+	vfs_randomness,
+	vfs_sleep,
+	vfs_current_time,
+	vfs_get_last_error,
+};
+
+bool SQLiteFileAccessVFS::registered = false;
+
+void SQLiteFileAccessVFS::register_vfs() {
+	if (registered) {
+		return;
+	}
+	sqlite3_vfs *fallback = sqlite3_vfs_find(nullptr);
+	ERR_FAIL_NULL_MSG(fallback, "SQLite has no default VFS to fall back on.");
+	vfs.pAppData = fallback;
+	ERR_FAIL_COND(sqlite3_vfs_register(&vfs, 0) != SQLITE_OK);
+	registered = true;
+}
+
+void SQLiteFileAccessVFS::unregister_vfs() {
+	if (!registered) {
+		return;
+	}
+	sqlite3_vfs_unregister(&vfs);
+	registered = false;
+}
@@ -1208,6 +1208,52 @@ BitField<Node::ProcessThreadMessages> Node::get_process_thread_messages() const
 	return data.process_thread_messages;
 }
 
+void Node::set_process_parallel(bool p_enabled) {
+	ERR_THREAD_GUARD
+	if (data.process_parallel == p_enabled) {
+		return;
+	}
+
+	data.process_parallel = p_enabled;
+	notify_property_list_changed();
+}
+
+bool Node::is_process_parallel() const {
+	return data.process_parallel;
+}
+
+void Node::set_process_parallel_reads(const PackedStringArray &p_tags) {
+	ERR_THREAD_GUARD
+	data.process_parallel_reads.resize(p_tags.size());
+	for (int i = 0; i < p_tags.size(); i++) {
+		data.process_parallel_reads.write[i] = p_tags[i];
+	}
+}
+
+PackedStringArray Node::get_process_parallel_reads() const {
+	PackedStringArray tags;
+	for (const StringName &tag : data.process_parallel_reads) {
+		tags.push_back(tag);
+	}
+	return tags;
+}
+
+void Node::set_process_parallel_writes(const PackedStringArray &p_tags) {
+	ERR_THREAD_GUARD
+	data.process_parallel_writes.resize(p_tags.size());
+	for (int i = 0; i < p_tags.size(); i++) {
+		data.process_parallel_writes.write[i] = p_tags[i];
+	}
+}
+
+PackedStringArray Node::get_process_parallel_writes() const {
+	PackedStringArray tags;
+	for (const StringName &tag : data.process_parallel_writes) {
+		tags.push_back(tag);
+	}
+	return tags;
+}
+
 void Node::set_process_input(bool p_enable) {
 	ERR_THREAD_GUARD
 	if (p_enable == data.input) {
@@ -3503,6 +3549,9 @@ void Node::_validate_property(PropertyInfo &p_property) const {
 	if ((p_property.name == "process_thread_group_order" || p_property.name == "process_thread_messages") && data.process_thread_group == PROCESS_THREAD_GROUP_INHERIT) {
 		p_property.usage = 0;
 	}
+	if ((p_property.name == "process_parallel_reads" || p_property.name == "process_parallel_writes") && !data.process_parallel) {
+		p_property.usage = PROPERTY_USAGE_NO_EDITOR;
+	}
 }
 
 void Node::input(const Ref<InputEvent> &p_event) {
@@ -3683,6 +3732,13 @@ void Node::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_process_thread_group_order", "order"), &Node::set_process_thread_group_order);
 	ClassDB::bind_method(D_METHOD("get_process_thread_group_order"), &Node::get_process_thread_group_order);
 
+	ClassDB::bind_method(D_METHOD("set_process_parallel", "enabled"), &Node::set_process_parallel);
+	ClassDB::bind_method(D_METHOD("is_process_parallel"), &Node::is_process_parallel);
+	ClassDB::bind_method(D_METHOD("set_process_parallel_reads", "tags"), &Node::set_process_parallel_reads);
+	ClassDB::bind_method(D_METHOD("get_process_parallel_reads"), &Node::get_process_parallel_reads);
+	ClassDB::bind_method(D_METHOD("set_process_parallel_writes", "tags"), &Node::set_process_parallel_writes);
+	ClassDB::bind_method(D_METHOD("get_process_parallel_writes"), &Node::get_process_parallel_writes);
+
 	ClassDB::bind_method(D_METHOD("set_display_folded", "fold"), &Node::set_display_folded);
 	ClassDB::bind_method(D_METHOD("is_displayed_folded"), &Node::is_displayed_folded);
 
@@ -3891,6 +3947,11 @@ void Node::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "process_thread_group_order"), "set_process_thread_group_order", "get_process_thread_group_order");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "process_thread_messages", PROPERTY_HINT_FLAGS, "Process,Physics Process"), "set_process_thread_messages", "get_process_thread_messages");
 
+	ADD_SUBGROUP("Parallel", "process_parallel");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "process_parallel"), "set_process_parallel", "is_process_parallel");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_STRING_ARRAY, "process_parallel_reads"), "set_process_parallel_reads", "get_process_parallel_reads");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_STRING_ARRAY, "process_parallel_writes"), "set_process_parallel_writes", "get_process_parallel_writes");
+
 	ADD_GROUP("Physics Interpolation", "physics_interpolation_");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "physics_interpolation_mode", PROPERTY_HINT_ENUM, "Inherit,On,Off"), "set_physics_interpolation_mode", "get_physics_interpolation_mode");
 
@@ -3936,6 +3997,7 @@ Node::Node() {
 
 	data.physics_process = false;
 	data.process = false;
+	data.process_parallel = false;
 
 	data.physics_process_internal = false;
 	data.process_internal = false;
@@ -205,12 +205,17 @@ private:
 		int process_priority = 0;
 		int physics_process_priority = 0;
 
+		// What the node accesses when processing, used to process nodes in parallel.
+		Vector<StringName> process_parallel_reads;
+		Vector<StringName> process_parallel_writes;
+
 		// Keep bitpacked values together to get better packing.
 		ProcessMode process_mode : 3;
 		PhysicsInterpolationMode physics_interpolation_mode : 2;
 
 		bool physics_process : 1;
 		bool process : 1;
+		bool process_parallel : 1;
 
 		bool physics_process_internal : 1;
 		bool process_internal : 1;
@@ -625,8 +630,8 @@ public:
 			// or access will happen from a node-safe thread.
 			return !data.inside_tree || is_current_thread_safe_for_nodes();
 		} else {
-			// Thread processing.
-			return current_process_thread_group == data.process_thread_group_owner;
+			// Thread processing (a node processed in parallel acts as the owner of its own group).
+			return current_process_thread_group == data.process_thread_group_owner || current_process_thread_group == this;
 		}
 	}
 
@@ -692,6 +697,13 @@ public:
 	void set_process_thread_group(ProcessThreadGroup p_mode);
 	ProcessThreadGroup get_process_thread_group() const;
 
+	void set_process_parallel(bool p_enabled);
+	bool is_process_parallel() const;
+	void set_process_parallel_reads(const PackedStringArray &p_tags);
+	PackedStringArray get_process_parallel_reads() const;
+	void set_process_parallel_writes(const PackedStringArray &p_tags);
+	PackedStringArray get_process_parallel_writes() const;
+
 	static void print_orphan_nodes();
 
 #ifdef TOOLS_ENABLED
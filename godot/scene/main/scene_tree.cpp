@@ -1041,36 +1041,177 @@ void SceneTree::_process_group(ProcessGroup *p_group, bool p_physics) {
 	uint32_t node_count = nodes_copy.size();
 	Node **nodes_ptr = (Node **)nodes_copy.ptr(); // Force cast, pointer will not change.
 
-	for (uint32_t i = 0; i < node_count; i++) {
-		Node *n = nodes_ptr[i];
-		if (nodes_removed_on_group_call.has(n)) {
-			// Node may have been removed during process, skip it.
-			// Keep in mind removals can only happen on the main thread.
-			continue;
+	// Parallel processing is only scheduled from the main thread, nodes of sub-thread groups already run on their own thread.
+	if (parallel_processing_mode != PARALLEL_PROCESSING_DISABLED && Node::current_process_thread_group == nullptr) {
+		_process_nodes_parallel(nodes_ptr, node_count, p_physics);
+	} else {
+		for (uint32_t i = 0; i < node_count; i++) {
+			_process_node(nodes_ptr[i], p_physics);
+		}
+	}
+
+	p_group->call_queue.flush(); // Flush messages also after processing (for potential deferred calls).
+}
+
+void SceneTree::_process_node(Node *p_node, bool p_physics) {
+	if (nodes_removed_on_group_call.has(p_node)) {
+		// Node may have been removed during process, skip it.
+		// Keep in mind removals can only happen on the main thread.
+		return;
+	}
+
+	if (!p_node->can_process() || !p_node->is_inside_tree()) {
+		return;
+	}
+
+	if (p_physics) {
+		if (p_node->is_physics_processing_internal()) {
+			p_node->notification(Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
+		}
+		if (p_node->is_physics_processing()) {
+			p_node->notification(Node::NOTIFICATION_PHYSICS_PROCESS);
+		}
+	} else {
+		if (p_node->is_processing_internal()) {
+			p_node->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+		}
+		if (p_node->is_processing()) {
+			p_node->notification(Node::NOTIFICATION_PROCESS);
+		}
+	}
+}
+
+void SceneTree::_process_nodes_parallel(Node **p_nodes, uint32_t p_node_count, bool p_physics) {
+	bool any_parallel = false;
+	for (uint32_t i = 0; i < p_node_count; i++) {
+		if (p_nodes[i]->data.process_parallel) {
+			any_parallel = true;
+			break;
+		}
+	}
+
+	if (!any_parallel) {
+		for (uint32_t i = 0; i < p_node_count; i++) {
+			_process_node(p_nodes[i], p_physics);
 		}
+		return;
+	}
+
+	// Build the levels. A node goes right after the last level holding a conflicting access (a write
+	// and any other access to the same tag), and nodes that did not declare their accesses get a level
+	// of their own, after every node that precedes them and before every node that follows them.
+	parallel_accesses.clear();
+	parallel_node_levels.resize(p_node_count);
+	uint32_t level_count = 0;
+	uint32_t first_free_level = 0; // First level after the last serial node.
+
+	for (uint32_t i = 0; i < p_node_count; i++) {
+		const Node *n = p_nodes[i];
 
-		if (!n->can_process() || !n->is_inside_tree()) {
+		if (!n->data.process_parallel) {
+			parallel_node_levels[i] = level_count;
+			level_count++;
+			first_free_level = level_count;
 			continue;
 		}
 
-		if (p_physics) {
-			if (n->is_physics_processing_internal()) {
-				n->notification(Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
-			}
-			if (n->is_physics_processing()) {
-				n->notification(Node::NOTIFICATION_PHYSICS_PROCESS);
+		int32_t level = first_free_level;
+		for (const StringName &tag : n->data.process_parallel_reads) {
+			HashMap<StringName, ParallelAccess>::Iterator E = parallel_accesses.find(tag);
+			if (E) {
+				level = MAX(level, E->value.last_write_level + 1);
 			}
-		} else {
-			if (n->is_processing_internal()) {
-				n->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+		}
+		for (const StringName &tag : n->data.process_parallel_writes) {
+			HashMap<StringName, ParallelAccess>::Iterator E = parallel_accesses.find(tag);
+			if (E) {
+				level = MAX(level, MAX(E->value.last_read_level, E->value.last_write_level) + 1);
 			}
-			if (n->is_processing()) {
-				n->notification(Node::NOTIFICATION_PROCESS);
+		}
+
+		for (const StringName &tag : n->data.process_parallel_reads) {
+			ParallelAccess &access = parallel_accesses[tag];
+			access.last_read_level = MAX(access.last_read_level, level);
+		}
+		for (const StringName &tag : n->data.process_parallel_writes) {
+			ParallelAccess &access = parallel_accesses[tag];
+			access.last_write_level = MAX(access.last_write_level, level);
+		}
+
+		parallel_node_levels[i] = level;
+		level_count = MAX(level_count, uint32_t(level + 1));
+	}
+
+	// Sort the nodes by level, keeping the processing order within each level.
+	parallel_level_offsets.resize(level_count + 1);
+	parallel_level_serial.resize(level_count);
+	for (uint32_t i = 0; i <= level_count; i++) {
+		parallel_level_offsets[i] = 0;
+	}
+	for (uint32_t i = 0; i < p_node_count; i++) {
+		parallel_level_offsets[parallel_node_levels[i] + 1]++;
+		parallel_level_serial[parallel_node_levels[i]] = !p_nodes[i]->data.process_parallel;
+	}
+	for (uint32_t i = 0; i < level_count; i++) {
+		parallel_level_offsets[i + 1] += parallel_level_offsets[i];
+	}
+	parallel_nodes.resize(p_node_count);
+	for (uint32_t i = 0; i < p_node_count; i++) {
+		parallel_nodes[parallel_level_offsets[parallel_node_levels[i]]++] = p_nodes[i];
+	}
+	// Offsets now point to the end of each level, shift them back.
+	for (uint32_t i = level_count; i > 0; i--) {
+		parallel_level_offsets[i] = parallel_level_offsets[i - 1];
+	}
+	parallel_level_offsets[0] = 0;
+
+	// The deterministic mode runs the same schedule on the main thread, in a reproducible order.
+	const bool use_threads = parallel_processing_mode == PARALLEL_PROCESSING_ENABLED && !node_threading_disabled;
+	if (use_threads) {
+		for (uint32_t i = parallel_call_queues.size(); i < uint32_t(WorkerThreadPool::get_singleton()->get_thread_count()); i++) {
+			parallel_call_queues.push_back(memnew(CallQueue(process_group_call_queue_allocator)));
+		}
+	}
+
+	for (uint32_t i = 0; i < level_count; i++) {
+		uint32_t from = parallel_level_offsets[i];
+		uint32_t count = parallel_level_offsets[i + 1] - from;
+
+		if (!use_threads || parallel_level_serial[i] || count == 1) {
+			for (uint32_t j = 0; j < count; j++) {
+				_process_node(parallel_nodes[from + j], p_physics);
 			}
+			continue;
+		}
+
+		parallel_level_from = from;
+		WorkerThreadPool::GroupID id = WorkerThreadPool::get_singleton()->add_template_group_task(this, &SceneTree::_process_parallel_nodes_thread, p_physics, count, -1, true);
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(id);
+
+		// Run what the nodes deferred before the next level, so it never overlaps other nodes processing.
+		for (CallQueue *call_queue : parallel_call_queues) {
+			call_queue->flush();
 		}
 	}
 
-	p_group->call_queue.flush(); // Flush messages also after processing (for potential deferred calls).
+	parallel_nodes.clear();
+}
+
+void SceneTree::_process_parallel_nodes_thread(uint32_t p_index, bool p_physics) {
+	// The node is processed like the owner of a sub-thread group, so thread guards only let it modify itself.
+	Node *node = parallel_nodes[parallel_level_from + p_index];
+	int thread_index = WorkerThreadPool::get_thread_index();
+	CallQueue *call_queue = thread_index >= 0 && thread_index < int(parallel_call_queues.size()) ? parallel_call_queues[thread_index] : nullptr;
+
+	Node::current_process_thread_group = node;
+	if (call_queue) {
+		MessageQueue::set_thread_singleton_override(call_queue);
+	}
+	_process_node(node, p_physics);
+	if (call_queue) {
+		MessageQueue::set_thread_singleton_override(nullptr);
+	}
+	Node::current_process_thread_group = nullptr;
 }
 
 void SceneTree::_process_groups_thread(uint32_t p_index, bool p_physics) {
@@ -1722,6 +1863,9 @@ void SceneTree::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_physics_interpolation_enabled", "enabled"), &SceneTree::set_physics_interpolation_enabled);
 	ClassDB::bind_method(D_METHOD("is_physics_interpolation_enabled"), &SceneTree::is_physics_interpolation_enabled);
 
+	ClassDB::bind_method(D_METHOD("set_parallel_processing_mode", "mode"), &SceneTree::set_parallel_processing_mode);
+	ClassDB::bind_method(D_METHOD("get_parallel_processing_mode"), &SceneTree::get_parallel_processing_mode);
+
 	ClassDB::bind_method(D_METHOD("queue_delete", "obj"), &SceneTree::queue_delete);
 
 	MethodInfo mi;
@@ -1774,6 +1918,7 @@ void SceneTree::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "root", PROPERTY_HINT_RESOURCE_TYPE, "Node", PROPERTY_USAGE_NONE), "", "get_root");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "multiplayer_poll"), "set_multiplayer_poll_enabled", "is_multiplayer_poll_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "physics_interpolation"), "set_physics_interpolation_enabled", "is_physics_interpolation_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "parallel_processing_mode", PROPERTY_HINT_ENUM, "Disabled,Enabled,Deterministic"), "set_parallel_processing_mode", "get_parallel_processing_mode");
 
 	ADD_SIGNAL(MethodInfo("tree_changed"));
 	ADD_SIGNAL(MethodInfo("tree_process_mode_changed")); //editor only signal, but due to API hash it can't be removed in run-time
@@ -1789,6 +1934,10 @@ void SceneTree::_bind_methods() {
 	BIND_ENUM_CONSTANT(GROUP_CALL_REVERSE);
 	BIND_ENUM_CONSTANT(GROUP_CALL_DEFERRED);
 	BIND_ENUM_CONSTANT(GROUP_CALL_UNIQUE);
+
+	BIND_ENUM_CONSTANT(PARALLEL_PROCESSING_DISABLED);
+	BIND_ENUM_CONSTANT(PARALLEL_PROCESSING_ENABLED);
+	BIND_ENUM_CONSTANT(PARALLEL_PROCESSING_DETERMINISTIC);
 }
 
 SceneTree *SceneTree::singleton = nullptr;
@@ -1830,6 +1979,15 @@ void SceneTree::set_disable_node_threading(bool p_disable) {
 	node_threading_disabled = p_disable;
 }
 
+void SceneTree::set_parallel_processing_mode(ParallelProcessingMode p_mode) {
+	ERR_FAIL_INDEX(p_mode, 3);
+	parallel_processing_mode = p_mode;
+}
+
+SceneTree::ParallelProcessingMode SceneTree::get_parallel_processing_mode() const {
+	return parallel_processing_mode;
+}
+
 SceneTree::SceneTree() {
 	if (singleton == nullptr) {
 		singleton = this;
@@ -1867,6 +2025,8 @@ SceneTree::SceneTree() {
 
 	set_physics_interpolation_enabled(GLOBAL_DEF("physics/common/physics_interpolation", false));
 
+	set_parallel_processing_mode(ParallelProcessingMode(int(GLOBAL_DEF(PropertyInfo(Variant::INT, "application/run/parallel_processing_mode", PROPERTY_HINT_ENUM, "Disabled,Enabled,Deterministic"), 0))));
+
 	// Always disable jitter fix if physics interpolation is enabled -
 	// Jitter fix will interfere with interpolation, and is not necessary
 	// when interpolation is active.
@@ -2019,6 +2179,9 @@ SceneTree::~SceneTree() {
 		}
 	}
 
+	for (CallQueue *call_queue : parallel_call_queues) {
+		memdelete(call_queue);
+	}
 	memdelete(process_group_call_queue_allocator);
 
 	if (singleton == this) {
@@ -89,6 +89,12 @@ class SceneTree : public MainLoop {
 public:
 	typedef void (*IdleCallback)();
 
+	enum ParallelProcessingMode {
+		PARALLEL_PROCESSING_DISABLED,
+		PARALLEL_PROCESSING_ENABLED,
+		PARALLEL_PROCESSING_DETERMINISTIC,
+	};
+
 private:
 	CallQueue::Allocator *process_group_call_queue_allocator = nullptr;
 
@@ -118,6 +124,23 @@ private:
 
 	bool node_threading_disabled = false;
 
+	// Scheduling of the nodes that declared their process accesses (see Node::set_process_parallel()).
+	// Nodes are assigned to levels, so that nodes in a same level have no conflicting accesses
+	// and can be processed concurrently, while conflicting nodes keep their processing order.
+	struct ParallelAccess {
+		int32_t last_read_level = -1;
+		int32_t last_write_level = -1;
+	};
+
+	ParallelProcessingMode parallel_processing_mode = PARALLEL_PROCESSING_DISABLED;
+	HashMap<StringName, ParallelAccess> parallel_accesses;
+	LocalVector<uint32_t> parallel_node_levels;
+	LocalVector<uint32_t> parallel_level_offsets;
+	LocalVector<bool> parallel_level_serial; // Levels holding a single node that did not declare its accesses.
+	LocalVector<Node *> parallel_nodes; // Sorted by level.
+	uint32_t parallel_level_from = 0;
+	LocalVector<CallQueue *> parallel_call_queues; // Per worker thread, flushed on the main thread after each level.
+
 	struct Group {
 		Vector<Node *> nodes;
 		bool changed = false;
@@ -225,8 +248,11 @@ private:
 	void remove_from_group(const StringName &p_group, Node *p_node);
 	void make_group_changed(const StringName &p_group);
 
+	void _process_node(Node *p_node, bool p_physics);
 	void _process_group(ProcessGroup *p_group, bool p_physics);
 	void _process_groups_thread(uint32_t p_index, bool p_physics);
+	void _process_nodes_parallel(Node **p_nodes, uint32_t p_node_count, bool p_physics);
+	void _process_parallel_nodes_thread(uint32_t p_index, bool p_physics);
 	void _process(bool p_physics);
 
 	void _remove_process_group(Node *p_node);
@@ -432,6 +458,9 @@ public:
 	static void add_idle_callback(IdleCallback p_callback);
 
 	void set_disable_node_threading(bool p_disable);
+
+	void set_parallel_processing_mode(ParallelProcessingMode p_mode);
+	ParallelProcessingMode get_parallel_processing_mode() const;
 	//default texture settings
 
 	void set_physics_interpolation_enabled(bool p_enabled);
@@ -447,5 +476,6 @@ public:
 };
 
 VARIANT_ENUM_CAST(SceneTree::GroupCallFlags);
+VARIANT_ENUM_CAST(SceneTree::ParallelProcessingMode);
 
 #endif // SCENE_TREE_H
@@ -0,0 +1,115 @@
+/**************************************************************************/
+/*  navigation_path_batch_query_result_3d.cpp                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+#include "navigation_path_batch_query_result_3d.h"
+
+void NavigationPathBatchQueryResult3D::set_paths(const Vector<Vector3> &p_paths) {
+	paths = p_paths;
+}
+
+const Vector<Vector3> &NavigationPathBatchQueryResult3D::get_paths() const {
+	return paths;
+}
+
+void NavigationPathBatchQueryResult3D::set_path_offsets(const Vector<int32_t> &p_path_offsets) {
+	path_offsets = p_path_offsets;
+}
+
+const Vector<int32_t> &NavigationPathBatchQueryResult3D::get_path_offsets() const {
+	return path_offsets;
+}
+
+void NavigationPathBatchQueryResult3D::set_path_types(const Vector<int32_t> &p_path_types) {
+	path_types = p_path_types;
+}
+
+const Vector<int32_t> &NavigationPathBatchQueryResult3D::get_path_types() const {
+	return path_types;
+}
+
+void NavigationPathBatchQueryResult3D::set_path_rids(const TypedArray<RID> &p_path_rids) {
+	path_rids = p_path_rids;
+}
+
+TypedArray<RID> NavigationPathBatchQueryResult3D::get_path_rids() const {
+	return path_rids;
+}
+
+void NavigationPathBatchQueryResult3D::set_path_owner_ids(const Vector<int64_t> &p_path_owner_ids) {
+	path_owner_ids = p_path_owner_ids;
+}
+
+const Vector<int64_t> &NavigationPathBatchQueryResult3D::get_path_owner_ids() const {
+	return path_owner_ids;
+}
+
+int NavigationPathBatchQueryResult3D::get_path_count() const {
+	return MAX(path_offsets.size() - 1, 0);
+}
+
+Vector<Vector3> NavigationPathBatchQueryResult3D::get_path(int p_index) const {
+	ERR_FAIL_INDEX_V(p_index, get_path_count(), Vector<Vector3>());
+	return paths.slice(path_offsets[p_index], path_offsets[p_index + 1]);
+}
+
+void NavigationPathBatchQueryResult3D::reset() {
+	paths.clear();
+	path_offsets.clear();
+	path_types.clear();
+	path_rids.clear();
+	path_owner_ids.clear();
+}
+
+void NavigationPathBatchQueryResult3D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_paths", "paths"), &NavigationPathBatchQueryResult3D::set_paths);
+	ClassDB::bind_method(D_METHOD("get_paths"), &NavigationPathBatchQueryResult3D::get_paths);
+
+	ClassDB::bind_method(D_METHOD("set_path_offsets", "path_offsets"), &NavigationPathBatchQueryResult3D::set_path_offsets);
+	ClassDB::bind_method(D_METHOD("get_path_offsets"), &NavigationPathBatchQueryResult3D::get_path_offsets);
+
+	ClassDB::bind_method(D_METHOD("set_path_types", "path_types"), &NavigationPathBatchQueryResult3D::set_path_types);
+	ClassDB::bind_method(D_METHOD("get_path_types"), &NavigationPathBatchQueryResult3D::get_path_types);
+
+	ClassDB::bind_method(D_METHOD("set_path_rids", "path_rids"), &NavigationPathBatchQueryResult3D::set_path_rids);
+	ClassDB::bind_method(D_METHOD("get_path_rids"), &NavigationPathBatchQueryResult3D::get_path_rids);
+
+	ClassDB::bind_method(D_METHOD("set_path_owner_ids", "path_owner_ids"), &NavigationPathBatchQueryResult3D::set_path_owner_ids);
+	ClassDB::bind_method(D_METHOD("get_path_owner_ids"), &NavigationPathBatchQueryResult3D::get_path_owner_ids);
+
+	ClassDB::bind_method(D_METHOD("get_path_count"), &NavigationPathBatchQueryResult3D::get_path_count);
+	ClassDB::bind_method(D_METHOD("get_path", "index"), &NavigationPathBatchQueryResult3D::get_path);
+
+	ClassDB::bind_method(D_METHOD("reset"), &NavigationPathBatchQueryResult3D::reset);
+
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR3_ARRAY, "paths"), "set_paths", "get_paths");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_INT32_ARRAY, "path_offsets"), "set_path_offsets", "get_path_offsets");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_INT32_ARRAY, "path_types"), "set_path_types", "get_path_types");
+	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "path_rids", PROPERTY_HINT_ARRAY_TYPE, "RID"), "set_path_rids", "get_path_rids");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_INT64_ARRAY, "path_owner_ids"), "set_path_owner_ids", "get_path_owner_ids");
+}
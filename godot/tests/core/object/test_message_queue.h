@@ -0,0 +1,200 @@
+/**************************************************************************/
+/*  test_message_queue.h                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_MESSAGE_QUEUE_H
+#define TEST_MESSAGE_QUEUE_H
+
+#include "core/object/message_queue.h"
+#include "core/os/os.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMessageQueue {
+
+static const int PRODUCER_COUNT = 4;
+static const int PUSHES_PER_PRODUCER = 2000;
+
+static int last_received[PRODUCER_COUNT];
+static int received_count = 0;
+static bool received_in_order = true;
+
+static void receive(int p_producer, int p_index) {
+	if (p_index != last_received[p_producer] + 1) {
+		received_in_order = false;
+	}
+	last_received[p_producer] = p_index;
+	received_count++;
+}
+
+struct ProducerData {
+	CallQueue *queue = nullptr;
+	int index = 0;
+	int failed = 0;
+};
+
+static void produce_ordered(void *p_userdata) {
+	ProducerData *data = (ProducerData *)p_userdata;
+	for (int i = 0; i < PUSHES_PER_PRODUCER; i++) {
+		if (data->queue->push_callable(callable_mp_static(&receive), data->index, i) != OK) {
+			data->failed++;
+		}
+	}
+}
+
+static void run_producers(bool p_per_thread_buffers) {
+	CallQueue queue;
+	queue.set_per_thread_buffers_enabled(p_per_thread_buffers);
+	CHECK(queue.is_per_thread_buffers_enabled() == p_per_thread_buffers);
+
+	for (int i = 0; i < PRODUCER_COUNT; i++) {
+		last_received[i] = -1;
+	}
+	received_count = 0;
+	received_in_order = true;
+
+	Thread threads[PRODUCER_COUNT];
+	ProducerData data[PRODUCER_COUNT];
+	for (int i = 0; i < PRODUCER_COUNT; i++) {
+		data[i].queue = &queue;
+		data[i].index = i;
+		threads[i].start(produce_ordered, &data[i]);
+	}
+
+	// Flushing while producers are still pushing must not lose or reorder anything.
+	for (int i = 0; i < 8; i++) {
+		queue.flush();
+		OS::get_singleton()->delay_usec(100);
+	}
+	for (int i = 0; i < PRODUCER_COUNT; i++) {
+		threads[i].wait_to_finish();
+		CHECK(data[i].failed == 0);
+	}
+	queue.flush();
+
+	CHECK_FALSE(queue.has_messages());
+	CHECK(received_count == PRODUCER_COUNT * PUSHES_PER_PRODUCER);
+	CHECK_MESSAGE(received_in_order, "Messages pushed from a same thread must be received in order.");
+	CHECK(queue.get_max_buffer_usage() > 0);
+}
+
+TEST_CASE("[MessageQueue] Deferred calls from several threads") {
+	SUBCASE("Shared buffer") {
+		run_producers(false);
+	}
+	SUBCASE("Per-thread buffers") {
+		run_producers(true);
+	}
+}
+
+TEST_CASE("[MessageQueue] Flush statistics") {
+	CallQueue queue;
+	last_received[0] = -1;
+	received_count = 0;
+	received_in_order = true;
+
+	for (int i = 0; i < 10; i++) {
+		queue.push_callable(callable_mp_static(&receive), 0, i);
+	}
+	queue.flush();
+	CHECK(queue.get_last_flush_push_count() == 10);
+	CHECK(queue.get_last_flush_message_count() == 10);
+
+	queue.flush();
+	CHECK(queue.get_last_flush_push_count() == 0);
+	CHECK(queue.get_last_flush_message_count() == 0);
+}
+
+struct LingeringProducerData {
+	ProducerData producer;
+	Semaphore pushed;
+	Semaphore exit;
+};
+
+static void produce_and_linger(void *p_userdata) {
+	LingeringProducerData *data = (LingeringProducerData *)p_userdata;
+	produce_ordered(&data->producer);
+	data->pushed.post();
+	data->exit.wait();
+}
+
+TEST_CASE("[MessageQueue] Flush statistics with per-thread buffers") {
+	CallQueue queue;
+	queue.set_per_thread_buffers_enabled(true);
+	last_received[0] = -1;
+	received_count = 0;
+	received_in_order = true;
+
+	LingeringProducerData data;
+	data.producer.queue = &queue;
+	Thread thread;
+	thread.start(produce_and_linger, &data);
+	data.pushed.wait();
+	queue.flush();
+	CHECK(queue.get_last_flush_push_count() == PUSHES_PER_PRODUCER);
+	CHECK(queue.get_last_flush_message_count() == PUSHES_PER_PRODUCER);
+
+	// The buffer of the exited thread is released on the next flush, its pushes must not be counted again or go missing.
+	data.exit.post();
+	thread.wait_to_finish();
+	queue.flush();
+	CHECK(queue.get_last_flush_push_count() == 0);
+	CHECK(queue.get_last_flush_message_count() == 0);
+
+	queue.push_callable(callable_mp_static(&receive), 0, PUSHES_PER_PRODUCER);
+	queue.flush();
+	CHECK(queue.get_last_flush_push_count() == 1);
+	CHECK(received_count == PUSHES_PER_PRODUCER + 1);
+	CHECK(received_in_order);
+}
+
+TEST_CASE("[MessageQueue] Clearing per-thread buffers") {
+	CallQueue queue;
+	queue.set_per_thread_buffers_enabled(true);
+	last_received[0] = -1;
+	received_count = 0;
+
+	ProducerData data;
+	data.queue = &queue;
+	Thread thread;
+	thread.start(produce_ordered, &data);
+	thread.wait_to_finish();
+
+	CHECK(queue.has_messages());
+	queue.clear();
+	CHECK_FALSE(queue.has_messages());
+	queue.flush();
+	CHECK(received_count == 0);
+}
+
+} // namespace TestMessageQueue
+
+#endif // TEST_MESSAGE_QUEUE_H
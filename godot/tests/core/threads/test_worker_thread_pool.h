@@ -47,7 +47,7 @@ static void static_test(void *p_arg) {
 static void static_callable_test() {
 	counter[0].sub(2);
 }
-TEST_CASE("[WorkerThreadPool] Process threads using individual tasks") {
+static void run_individual_tasks() {
 	for (int iterations = 0; iterations < 500; iterations++) {
 		const int count = Math::pow(2.0f, Math::random(0.0f, 5.0f));
 		const bool low_priority = Math::rand() % 2;
@@ -77,6 +77,10 @@ TEST_CASE("[WorkerThreadPool] Process threads using individual tasks") {
 	}
 }
 
+TEST_CASE("[WorkerThreadPool] Process threads using individual tasks") {
+	run_individual_tasks();
+}
+
 static void static_group_test(void *p_arg, uint32_t p_index) {
 	counter[p_index].increment();
 	counter[0].add((uintptr_t)p_arg);
@@ -85,7 +89,7 @@ static void static_callable_group_test(uint32_t p_index) {
 	counter[p_index].increment();
 	counter[0].sub(2);
 }
-TEST_CASE("[WorkerThreadPool] Process elements using group tasks") {
+static void run_group_tasks() {
 	for (int iterations = 0; iterations < 500; iterations++) {
 		const int count = Math::pow(2.0f, Math::random(0.0f, 5.0f));
 		const int tasks = Math::pow(2.0f, Math::random(0.0f, 5.0f));
@@ -107,6 +111,10 @@ TEST_CASE("[WorkerThreadPool] Process elements using group tasks") {
 	}
 }
 
+TEST_CASE("[WorkerThreadPool] Process elements using group tasks") {
+	run_group_tasks();
+}
+
 static void static_test_daemon(void *p_arg) {
 	while (!exit.is_set()) {
 		counter[0].add(1);
@@ -125,7 +133,7 @@ static void static_legit_task(void *p_arg) {
 	counter[1].add(1);
 }
 
-TEST_CASE("[WorkerThreadPool] Run a yielding daemon as the only hope for other tasks to run") {
+static void run_yielding_daemon() {
 	exit.clear();
 	counter.clear();
 	counter.resize(2);
@@ -173,6 +181,191 @@ TEST_CASE("[WorkerThreadPool] Run a yielding daemon as the only hope for other t
 	CHECK_MESSAGE(all_needed_yield, "All legit tasks should have needed the daemon yielding to run.");
 }
 
+TEST_CASE("[WorkerThreadPool] Run a yielding daemon as the only hope for other tasks to run") {
+	run_yielding_daemon();
+}
+
+static SafeNumeric<uint64_t> fan_out_leaves;
+
+static const int FAN_OUT_CHILDREN = 8;
+
+static void static_fan_out_group_leaf(void *p_arg, uint32_t p_index) {
+	fan_out_leaves.increment();
+}
+
+static void static_fan_out_task(void *p_arg) {
+	const int depth = (int)(uintptr_t)p_arg;
+	if (depth == 0) {
+		fan_out_leaves.increment();
+		return;
+	}
+
+	// Posted from a pool thread, so with work stealing the children go to this thread's deque,
+	// and waiting for them pops it while other threads steal from it.
+	WorkerThreadPool::TaskID task_ids[FAN_OUT_CHILDREN];
+	for (int i = 0; i < FAN_OUT_CHILDREN; i++) {
+		task_ids[i] = WorkerThreadPool::get_singleton()->add_native_task(static_fan_out_task, (void *)(uintptr_t)(depth - 1), i % 2);
+	}
+	WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_native_group_task(static_fan_out_group_leaf, nullptr, FAN_OUT_CHILDREN, -1, true);
+	for (int i = 0; i < FAN_OUT_CHILDREN; i++) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(task_ids[i]);
+	}
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+}
+
+static uint64_t fan_out_leaf_count(int p_depth) {
+	return p_depth == 0 ? 1 : FAN_OUT_CHILDREN * (fan_out_leaf_count(p_depth - 1) + 1);
+}
+
+// Restarts the pool with work stealing enabled, then restores the default pool.
+struct WorkStealingPool {
+	WorkStealingPool() {
+		WorkerThreadPool::get_singleton()->finish();
+		WorkerThreadPool::get_singleton()->init(-1, 0.3, true);
+	}
+
+	~WorkStealingPool() {
+		WorkerThreadPool::get_singleton()->finish();
+		WorkerThreadPool::get_singleton()->init();
+	}
+};
+
+TEST_CASE("[WorkerThreadPool] Work stealing") {
+	WorkStealingPool pool;
+
+	SUBCASE("Individual tasks") {
+		run_individual_tasks();
+	}
+
+	SUBCASE("Group tasks") {
+		run_group_tasks();
+	}
+
+	SUBCASE("Yielding daemon") {
+		run_yielding_daemon();
+	}
+
+	SUBCASE("Backlog posted from the main thread") {
+		// A deep global queue makes threads take batches of it into their deques.
+		const int count = 4096;
+		fan_out_leaves.set(0);
+		LocalVector<WorkerThreadPool::TaskID> task_ids;
+		task_ids.resize(count);
+		for (int i = 0; i < count; i++) {
+			task_ids[i] = WorkerThreadPool::get_singleton()->add_native_task(static_fan_out_task, nullptr, true);
+		}
+		for (int i = 0; i < count; i++) {
+			WorkerThreadPool::get_singleton()->wait_for_task_completion(task_ids[i]);
+		}
+		CHECK_EQ(fan_out_leaves.get(), uint64_t(count));
+	}
+
+	SUBCASE("Nested fan-out") {
+		fan_out_leaves.set(0);
+		const int roots = 4;
+		WorkerThreadPool::TaskID root_ids[roots];
+		uint64_t expected_leaves = 0;
+		for (int i = 0; i < roots; i++) {
+			const int depth = 2 + i % 2;
+			root_ids[i] = WorkerThreadPool::get_singleton()->add_native_task(static_fan_out_task, (void *)(uintptr_t)depth, true);
+			expected_leaves += fan_out_leaf_count(depth);
+		}
+		for (int i = 0; i < roots; i++) {
+			WorkerThreadPool::get_singleton()->wait_for_task_completion(root_ids[i]);
+		}
+		CHECK_EQ(fan_out_leaves.get(), expected_leaves);
+	}
+}
+
+static SafeNumeric<uint64_t> benchmark_counter;
+static SafeNumeric<uint64_t> benchmark_latency_usec;
+
+static void static_benchmark_task(void *p_arg) {
+	benchmark_counter.increment();
+}
+
+static void static_benchmark_latency_task(void *p_arg) {
+	benchmark_latency_usec.add(OS::get_singleton()->get_ticks_usec() - *(uint64_t *)p_arg);
+}
+
+static void static_benchmark_fan_out_task(void *p_arg) {
+	// Tasks posted from a pool thread, the case work stealing is meant for.
+	const int count = (int)(uintptr_t)p_arg;
+	LocalVector<WorkerThreadPool::TaskID> task_ids;
+	task_ids.resize(count);
+	for (int i = 0; i < count; i++) {
+		task_ids[i] = WorkerThreadPool::get_singleton()->add_native_task(static_benchmark_task, nullptr, true);
+	}
+	for (int i = 0; i < count; i++) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(task_ids[i]);
+	}
+}
+
+// Opt-in benchmark, skipped by default. Run it with `--test --no-skip --test-case="*Benchmark*"`.
+TEST_CASE("[WorkerThreadPool][Benchmark] Task throughput and latency with and without work stealing" * doctest::skip()) {
+	const int fan_outs = 16;
+	const int tasks_per_fan_out = 1024;
+	const int latency_samples = 256;
+	const int default_thread_count = OS::get_singleton()->get_default_thread_pool_size();
+
+	LocalVector<int> thread_counts;
+	for (int count = 2; count < default_thread_count; count *= 2) {
+		thread_counts.push_back(count);
+	}
+	thread_counts.push_back(MAX(2, default_thread_count));
+
+	for (int thread_count : thread_counts) {
+		for (int work_stealing = 0; work_stealing < 2; work_stealing++) {
+			WorkerThreadPool::get_singleton()->finish();
+			WorkerThreadPool::get_singleton()->init(thread_count, 0.3, work_stealing);
+
+			// Throughput: several pool tasks each spawning and awaiting many small tasks.
+			benchmark_counter.set(0);
+			uint64_t from = OS::get_singleton()->get_ticks_usec();
+			LocalVector<WorkerThreadPool::TaskID> fan_out_ids;
+			for (int i = 0; i < fan_outs; i++) {
+				fan_out_ids.push_back(WorkerThreadPool::get_singleton()->add_native_task(static_benchmark_fan_out_task, (void *)(uintptr_t)tasks_per_fan_out, true));
+			}
+			for (const WorkerThreadPool::TaskID &id : fan_out_ids) {
+				WorkerThreadPool::get_singleton()->wait_for_task_completion(id);
+			}
+			const uint64_t fan_out_usec = MAX(uint64_t(1), OS::get_singleton()->get_ticks_usec() - from);
+			CHECK(benchmark_counter.get() == uint64_t(fan_outs * tasks_per_fan_out));
+
+			// Throughput: small tasks posted from the main thread, which always go through the global queue.
+			benchmark_counter.set(0);
+			from = OS::get_singleton()->get_ticks_usec();
+			LocalVector<WorkerThreadPool::TaskID> task_ids;
+			for (int i = 0; i < fan_outs * tasks_per_fan_out; i++) {
+				task_ids.push_back(WorkerThreadPool::get_singleton()->add_native_task(static_benchmark_task, nullptr, true));
+			}
+			for (const WorkerThreadPool::TaskID &id : task_ids) {
+				WorkerThreadPool::get_singleton()->wait_for_task_completion(id);
+			}
+			const uint64_t injected_usec = MAX(uint64_t(1), OS::get_singleton()->get_ticks_usec() - from);
+			CHECK(benchmark_counter.get() == uint64_t(fan_outs * tasks_per_fan_out));
+
+			// Latency: time from posting a task to it starting, on an otherwise idle pool.
+			benchmark_latency_usec.set(0);
+			for (int i = 0; i < latency_samples; i++) {
+				uint64_t posted_usec = OS::get_singleton()->get_ticks_usec();
+				WorkerThreadPool::TaskID id = WorkerThreadPool::get_singleton()->add_native_task(static_benchmark_latency_task, &posted_usec, true);
+				WorkerThreadPool::get_singleton()->wait_for_task_completion(id);
+			}
+
+			const double total_tasks = fan_outs * tasks_per_fan_out;
+			MESSAGE(vformat("%d threads, work stealing %s: %d tasks/ms nested, %d tasks/ms from main thread, %.1f usec start latency.",
+					thread_count, work_stealing ? "on" : "off",
+					int(total_tasks * 1000 / fan_out_usec), int(total_tasks * 1000 / injected_usec),
+					double(benchmark_latency_usec.get()) / latency_samples));
+		}
+	}
+
+	// Back to the pool every other test expects.
+	WorkerThreadPool::get_singleton()->finish();
+	WorkerThreadPool::get_singleton()->init();
+}
+
 } // namespace TestWorkerThreadPool
 
 #endif // TEST_WORKER_THREAD_POOL_H
@@ -99,6 +99,29 @@ public:
 	Array get_exported_nodes() const { return exported_nodes; }
 };
 
+class TestParallelNode : public Node {
+	GDCLASS(TestParallelNode, Node);
+
+	void _deferred() {
+		deferred_on_main_thread = Thread::is_main_thread();
+	}
+
+protected:
+	void _notification(int p_what) {
+		if (p_what == NOTIFICATION_PROCESS) {
+			self_accessible = is_accessible_from_caller_thread();
+			other_accessible = other->is_accessible_from_caller_thread();
+			callable_mp(this, &TestParallelNode::_deferred).call_deferred();
+		}
+	}
+
+public:
+	Node *other = nullptr;
+	bool self_accessible = false;
+	bool other_accessible = true;
+	bool deferred_on_main_thread = false;
+};
+
 TEST_CASE("[SceneTree][Node] Testing node operations with a very simple scene tree") {
 	Node *node = memnew(Node);
 
@@ -892,6 +915,109 @@ TEST_CASE("[SceneTree][Node] Test the process priority") {
 	memdelete(node4);
 }
 
+TEST_CASE("[SceneTree][Node] Test parallel processing") {
+	List<Node *> process_order;
+	TestNode *nodes[4];
+	for (int i = 0; i < 4; i++) {
+		nodes[i] = memnew(TestNode);
+		nodes[i]->callback_list = &process_order;
+		nodes[i]->set_process(true);
+		nodes[i]->set_process_priority(i);
+		SceneTree::get_singleton()->get_root()->add_child(nodes[i]);
+	}
+
+	PackedStringArray tag_a;
+	tag_a.push_back("a");
+
+	// 0 writes "a", 1 reads "a" so it goes after 0, 2 doesn't conflict with anything,
+	// and 3 didn't declare its accesses so it goes after all the others.
+	nodes[0]->set_process_parallel(true);
+	nodes[0]->set_process_parallel_writes(tag_a);
+	nodes[1]->set_process_parallel(true);
+	nodes[1]->set_process_parallel_reads(tag_a);
+	nodes[2]->set_process_parallel(true);
+
+	CHECK(nodes[0]->is_process_parallel());
+	CHECK_FALSE(nodes[3]->is_process_parallel());
+	CHECK_EQ(nodes[1]->get_process_parallel_reads(), tag_a);
+	CHECK(nodes[1]->get_process_parallel_writes().is_empty());
+
+	SUBCASE("Disabled") {
+		SceneTree::get_singleton()->set_parallel_processing_mode(SceneTree::PARALLEL_PROCESSING_DISABLED);
+		SceneTree::get_singleton()->process(0);
+
+		CHECK_EQ(4, process_order.size());
+		List<Node *>::Element *E = process_order.front();
+		for (int i = 0; i < 4; i++) {
+			CHECK_EQ(E->get(), nodes[i]);
+			E = E->next();
+		}
+	}
+
+	SUBCASE("Deterministic") {
+		SceneTree::get_singleton()->set_parallel_processing_mode(SceneTree::PARALLEL_PROCESSING_DETERMINISTIC);
+		SceneTree::get_singleton()->process(0);
+
+		CHECK_EQ(4, process_order.size());
+		List<Node *>::Element *E = process_order.front();
+		CHECK_EQ(E->get(), nodes[0]);
+		E = E->next();
+		CHECK_EQ(E->get(), nodes[2]);
+		E = E->next();
+		CHECK_EQ(E->get(), nodes[1]);
+		E = E->next();
+		CHECK_EQ(E->get(), nodes[3]);
+	}
+
+	SUBCASE("Enabled") {
+		// The order within a level is not defined when using threads, only count the callbacks.
+		for (int i = 0; i < 4; i++) {
+			nodes[i]->callback_list = nullptr;
+		}
+		SceneTree::get_singleton()->set_parallel_processing_mode(SceneTree::PARALLEL_PROCESSING_ENABLED);
+		SceneTree::get_singleton()->process(0);
+		SceneTree::get_singleton()->process(0);
+
+		for (int i = 0; i < 4; i++) {
+			CHECK_EQ(2, nodes[i]->process_counter);
+		}
+	}
+
+	SceneTree::get_singleton()->set_parallel_processing_mode(SceneTree::PARALLEL_PROCESSING_DISABLED);
+	for (int i = 0; i < 4; i++) {
+		memdelete(nodes[i]);
+	}
+}
+
+#ifdef THREADS_ENABLED
+TEST_CASE("[SceneTree][Node] Test thread guards during parallel processing") {
+	TestParallelNode *nodes[2];
+	for (int i = 0; i < 2; i++) {
+		nodes[i] = memnew(TestParallelNode);
+		nodes[i]->set_process(true);
+		nodes[i]->set_process_parallel(true);
+		SceneTree::get_singleton()->get_root()->add_child(nodes[i]);
+	}
+	nodes[0]->other = nodes[1];
+	nodes[1]->other = nodes[0];
+
+	SceneTree::get_singleton()->set_parallel_processing_mode(SceneTree::PARALLEL_PROCESSING_ENABLED);
+	SceneTree::get_singleton()->process(0);
+
+	// Both nodes are in the same level, each can only modify itself, and deferred calls are run on the main thread.
+	for (int i = 0; i < 2; i++) {
+		CHECK(nodes[i]->self_accessible);
+		CHECK_FALSE(nodes[i]->other_accessible);
+		CHECK(nodes[i]->deferred_on_main_thread);
+	}
+
+	SceneTree::get_singleton()->set_parallel_processing_mode(SceneTree::PARALLEL_PROCESSING_DISABLED);
+	for (int i = 0; i < 2; i++) {
+		memdelete(nodes[i]);
+	}
+}
+#endif // THREADS_ENABLED
+
 } // namespace TestNode
 
 #endif // TEST_NODE_H
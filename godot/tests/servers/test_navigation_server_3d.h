@@ -790,11 +790,118 @@ TEST_SUITE("[Navigation]") {
 			CHECK_EQ(query_result->get_path_owner_ids().size(), 0);
 		}
 
+		SUBCASE("Batched queries should yield the same paths as single queries") {
+			TypedArray<NavigationPathQueryParameters3D> queries_parameters;
+			for (int i = 0; i < 16; i++) {
+				Ref<NavigationPathQueryParameters3D> query_parameters = memnew(NavigationPathQueryParameters3D);
+				query_parameters->set_map(map);
+				query_parameters->set_start_position(Vector3(i % 4, 0, i / 4));
+				query_parameters->set_target_position(Vector3(10 - i % 4, 0, 10 - i / 4));
+				queries_parameters.push_back(query_parameters);
+			}
+			// A query on an invalid map gets an empty path and keeps the other paths in place.
+			ERR_PRINT_OFF;
+			queries_parameters.insert(3, memnew(NavigationPathQueryParameters3D));
+
+			Ref<NavigationPathBatchQueryResult3D> batch_query_result = memnew(NavigationPathBatchQueryResult3D);
+			navigation_server->query_path_batch(queries_parameters, batch_query_result);
+			ERR_PRINT_ON;
+			REQUIRE_EQ(batch_query_result->get_path_count(), queries_parameters.size());
+			CHECK_EQ(batch_query_result->get_path_offsets()[batch_query_result->get_path_count()], batch_query_result->get_paths().size());
+			CHECK_EQ(batch_query_result->get_path_types().size(), batch_query_result->get_paths().size());
+			CHECK_EQ(batch_query_result->get_path_rids().size(), batch_query_result->get_paths().size());
+			CHECK_EQ(batch_query_result->get_path_owner_ids().size(), batch_query_result->get_paths().size());
+			CHECK_EQ(batch_query_result->get_path(3).size(), 0);
+
+			for (int i = 0; i < queries_parameters.size(); i++) {
+				if (i == 3) {
+					continue;
+				}
+				Ref<NavigationPathQueryResult3D> query_result = memnew(NavigationPathQueryResult3D);
+				navigation_server->query_path(queries_parameters[i], query_result);
+				CHECK_NE(query_result->get_path().size(), 0);
+				CHECK_EQ(batch_query_result->get_path(i), query_result->get_path());
+				CHECK_EQ(batch_query_result->get_path_rids()[batch_query_result->get_path_offsets()[i]], query_result->get_path_rids()[0]);
+			}
+		}
+
 		navigation_server->free(region);
 		navigation_server->free(map);
 		navigation_server->process(0.0); // Give server some cycles to commit.
 	}
 
+	TEST_CASE("[NavigationServer3D] Server should answer closest point queries on a map with many regions") {
+		NavigationServer3D *navigation_server = NavigationServer3D::get_singleton();
+
+		// A 4x4 meters region made of 1x1 meter quads.
+		Ref<NavigationMesh> navigation_mesh = memnew(NavigationMesh);
+		Vector<Vector3> vertices;
+		for (int z = 0; z <= 4; z++) {
+			for (int x = 0; x <= 4; x++) {
+				vertices.push_back(Vector3(x, 0, z));
+			}
+		}
+		navigation_mesh->set_vertices(vertices);
+		for (int z = 0; z < 4; z++) {
+			for (int x = 0; x < 4; x++) {
+				Vector<int> polygon;
+				polygon.push_back(z * 5 + x);
+				polygon.push_back((z + 1) * 5 + x);
+				polygon.push_back((z + 1) * 5 + x + 1);
+				polygon.push_back(z * 5 + x + 1);
+				navigation_mesh->add_polygon(polygon);
+			}
+		}
+
+		// A 16x16 meters map made of 4x4 regions.
+		RID map = navigation_server->map_create();
+		navigation_server->map_set_active(map, true);
+		LocalVector<RID> regions;
+		for (int z = 0; z < 4; z++) {
+			for (int x = 0; x < 4; x++) {
+				RID region = navigation_server->region_create();
+				navigation_server->region_set_map(region, map);
+				navigation_server->region_set_transform(region, Transform3D(Basis(), Vector3(x * 4, 0, z * 4)));
+				navigation_server->region_set_navigation_mesh(region, navigation_mesh);
+				regions.push_back(region);
+			}
+		}
+		navigation_server->process(0.0); // Give server some cycles to commit.
+
+		SUBCASE("Closest point should be found in any region") {
+			CHECK(navigation_server->map_get_closest_point(map, Vector3(5.5, 3, 7.25)).is_equal_approx(Vector3(5.5, 0, 7.25)));
+			CHECK(navigation_server->map_get_closest_point(map, Vector3(14.5, -1, 13.5)).is_equal_approx(Vector3(14.5, 0, 13.5)));
+			CHECK(navigation_server->map_get_closest_point(map, Vector3(-2, 1, 3.5)).is_equal_approx(Vector3(0, 0, 3.5)));
+			CHECK(navigation_server->map_get_closest_point(map, Vector3(20, 0, 20)).is_equal_approx(Vector3(16, 0, 16)));
+		}
+
+		SUBCASE("Closest point owner should be the region containing the point") {
+			CHECK_EQ(navigation_server->map_get_closest_point_owner(map, Vector3(9.5, 1, 2.5)), regions[2]);
+			CHECK_EQ(navigation_server->map_get_closest_point_owner(map, Vector3(1.5, 1, 13.5)), regions[12]);
+			CHECK_EQ(navigation_server->map_get_closest_point_owner(map, Vector3(6.5, -1, 5.5)), regions[5]);
+		}
+
+		SUBCASE("Closest point to segment should prefer intersections and fall back to the nearest point") {
+			CHECK(navigation_server->map_get_closest_point_to_segment(map, Vector3(10.5, 2, 6.5), Vector3(10.5, -2, 6.5), true).is_equal_approx(Vector3(10.5, 0, 6.5)));
+			CHECK(navigation_server->map_get_closest_point_to_segment(map, Vector3(-3, 1, 6.5), Vector3(-1, 1, 6.5), false).is_equal_approx(Vector3(0, 0, 6.5)));
+			CHECK_EQ(navigation_server->map_get_closest_point_to_segment(map, Vector3(-3, 1, 6.5), Vector3(-1, 1, 6.5), true), Vector3());
+		}
+
+		SUBCASE("Disabled regions should not be considered") {
+			navigation_server->region_set_enabled(regions[5], false);
+			navigation_server->process(0.0); // Give server some cycles to commit.
+			const Vector3 closest_point = navigation_server->map_get_closest_point(map, Vector3(6, 1, 6));
+			CHECK(Math::is_equal_approx(closest_point.distance_to(Vector3(6, 0, 6)), (real_t)2.0));
+			CHECK_NE(navigation_server->map_get_closest_point_owner(map, Vector3(6, 1, 6)), regions[5]);
+		}
+
+		for (const RID &region : regions) {
+			navigation_server->free(region);
+		}
+		navigation_server->free(map);
+		navigation_server->process(0.0); // Give server some cycles to commit.
+	}
+
 	// FIXME: The race condition mentioned below is actually a problem and fails on CI (GH-90613).
 	/*
 	TEST_CASE("[NavigationServer3D] Server should be able to bake asynchronously") {